@@ -17,6 +17,7 @@
 from blueberry.tests.gd.cert.cert_self_test import CertSelfTest
 from blueberry.tests.gd.hal.simple_hal_test import SimpleHalTest
 from blueberry.tests.gd.hci.acl_manager_test import AclManagerTest
+from blueberry.tests.gd.hci.controller_pipelined_commands_test import ControllerPipelinedCommandsTest
 from blueberry.tests.gd.hci.controller_test import ControllerTest
 from blueberry.tests.gd.hci.direct_hci_test import DirectHciTest
 from blueberry.tests.gd.hci.le_acl_manager_test import LeAclManagerTest
@@ -37,9 +38,10 @@ from blueberry.tests.gd.shim.stack_test import StackTest
 from mobly import suite_runner
 
 ALL_TESTS = {
-    CertSelfTest, SimpleHalTest, AclManagerTest, ControllerTest, DirectHciTest, LeAclManagerTest,
-    LeAdvertisingManagerTest, LeScanningManagerTest, LeScanningWithSecurityTest, LeIsoTest, L2capPerformanceTest,
-    L2capTest, DualL2capTest, LeL2capTest, NeighborTest, LeSecurityTest, SecurityTest, ShimTest, StackTest
+    CertSelfTest, SimpleHalTest, AclManagerTest, ControllerPipelinedCommandsTest, ControllerTest, DirectHciTest,
+    LeAclManagerTest, LeAdvertisingManagerTest, LeScanningManagerTest, LeScanningWithSecurityTest, LeIsoTest,
+    L2capPerformanceTest, L2capTest, DualL2capTest, LeL2capTest, NeighborTest, LeSecurityTest, SecurityTest, ShimTest,
+    StackTest
 }
 
 DISABLED_TESTS = set()
@@ -0,0 +1,33 @@
+#!/usr/bin/env python3
+#
+#   Copyright 2022 - The Android Open Source Project
+#
+#   Licensed under the Apache License, Version 2.0 (the "License");
+#   you may not use this file except in compliance with the License.
+#   You may obtain a copy of the License at
+#
+#       http://www.apache.org/licenses/LICENSE-2.0
+#
+#   Unless required by applicable law or agreed to in writing, software
+#   distributed under the License is distributed on an "AS IS" BASIS,
+#   WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+#   See the License for the specific language governing permissions and
+#   limitations under the License.
+
+from blueberry.tests.gd.cert import gd_base_test
+from blueberry.tests.gd.hci.controller_test import ControllerTest
+from mobly import test_runner
+
+
+class ControllerPipelinedCommandsTest(ControllerTest):
+    """Runs the controller tests against a controller that takes several commands at a time, so that the stack sends
+    its commands, starting with the burst that configures the controller, without waiting for each to complete."""
+
+    def setup_test(self):
+        gd_base_test.GdBaseTestClass.set_controller_properties_path(
+            self, 'blueberry/tests/gd/hci/pipelined_commands_config.json')
+        gd_base_test.GdBaseTestClass.setup_test(self)
+
+
+if __name__ == '__main__':
+    test_runner.main()
@@ -15,11 +15,15 @@
 #   limitations under the License.
 
 import logging
+import os
+import struct
+import time
 
 from bluetooth_packets_python3 import hci_packets
 from blueberry.tests.gd.cert.closable import safeClose
 from blueberry.tests.gd.cert.event_stream import EventStream
 from blueberry.tests.gd.cert.matchers import ScanningMatchers
+from blueberry.tests.gd.cert.performance_test_logger import PerformanceTestLogger
 from blueberry.tests.gd.cert.truth import assertThat
 from blueberry.tests.gd.cert import gd_base_test
 from blueberry.facade import common_pb2 as common
@@ -34,6 +38,24 @@ from blueberry.facade.hci.le_scanning_manager_facade_pb2 import ScanningStatus
 from mobly import test_runner
 
 
+def read_hci_commands(btsnoop_path):
+    """Returns the (op code, parameters) of the HCI commands in a btsnoop log, in the order they were sent"""
+    commands = []
+    with open(btsnoop_path, 'rb') as btsnoop:
+        # Identification pattern, version and datalink type
+        btsnoop.read(16)
+        while True:
+            record_header = btsnoop.read(24)
+            if len(record_header) < 24:
+                break
+            _, included_length, _, _, _ = struct.unpack('>IIIIq', record_header)
+            packet = btsnoop.read(included_length)
+            # H4 type byte, then op code and parameter length
+            if len(packet) >= 4 and packet[0] == 0x01:
+                commands.append((struct.unpack('<H', packet[1:3])[0], packet[4:]))
+    return commands
+
+
 class LeScanningManagerTestBase():
 
     def setup_test(self, cert, dut):
@@ -221,6 +243,91 @@ class LeScanningManagerTestBase():
         remove_request = le_advertising_facade.RemoveAdvertiserRequest(advertiser_id=create_response.advertiser_id)
         self.cert.hci_le_advertising_manager.RemoveAdvertiser(remove_request)
 
+    def test_scan_gap_during_address_rotation(self):
+        # DUT rotates its resolvable private address every one to two seconds while it scans
+        privacy_policy = le_initiator_address_facade.PrivacyPolicy(
+            address_policy=le_initiator_address_facade.AddressPolicy.USE_RESOLVABLE_ADDRESS,
+            address_with_type=common.BluetoothAddressWithType(
+                address=common.BluetoothAddress(address=bytes(b'D0:05:04:03:02:01')),
+                type=common.RANDOM_DEVICE_ADDRESS),
+            rotation_irk=b'\x44\xfb\x4b\x8d\x6c\x58\x21\x0c\xf9\x3d\xda\xf1\x64\xa3\xbb\x7f',
+            minimum_rotation_time=1000,
+            maximum_rotation_time=2000)
+        self.dut.hci_le_initiator_address.SetPrivacyPolicyForInitiatorAddress(privacy_policy)
+        cert_privacy_policy = le_initiator_address_facade.PrivacyPolicy(
+            address_policy=le_initiator_address_facade.AddressPolicy.USE_STATIC_ADDRESS,
+            address_with_type=common.BluetoothAddressWithType(
+                address=common.BluetoothAddress(address=bytes(b'C0:05:04:03:02:01')),
+                type=common.RANDOM_DEVICE_ADDRESS),
+            rotation_irk=b'\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00',
+            minimum_rotation_time=0,
+            maximum_rotation_time=0)
+        self.cert.hci_le_initiator_address.SetPrivacyPolicyForInitiatorAddress(cert_privacy_policy)
+
+        # CERT Advertises every 20 ms
+        gap_name = hci_packets.GapData()
+        gap_name.data_type = hci_packets.GapDataType.COMPLETE_LOCAL_NAME
+        gap_name.data = list(bytes(b'Im_The_CERT!'))
+        gap_data = le_advertising_facade.GapDataMsg(data=bytes(gap_name.Serialize()))
+        config = le_advertising_facade.AdvertisingConfig(
+            advertisement=[gap_data],
+            interval_min=32,
+            interval_max=32,
+            advertising_type=le_advertising_facade.AdvertisingEventType.ADV_NONCONN_IND,
+            own_address_type=common.USE_RANDOM_DEVICE_ADDRESS,
+            channel_map=7,
+            filter_policy=le_advertising_facade.AdvertisingFilterPolicy.ALL_DEVICES)
+        request = le_advertising_facade.CreateAdvertiserRequest(config=config)
+        create_response = self.cert.hci_le_advertising_manager.CreateAdvertiser(request)
+
+        performance_test_logger = PerformanceTestLogger()
+        report_matcher = lambda packet: b'Im_The_CERT' in packet.event
+        report_callback = lambda packet: performance_test_logger.log_single_point("report")
+        self.dut.advertising_report_stream.register_callback(report_callback, report_matcher)
+
+        scan_request = le_scanning_facade.ScanRequest(start=True)
+        self.dut.hci_le_scanning_manager.Scan(scan_request)
+        # Long enough for several rotations
+        time.sleep(8)
+        self.dut.hci_le_scanning_manager.Scan(le_scanning_facade.ScanRequest(start=False))
+        self.dut.advertising_report_stream.unregister_callback(report_callback, report_matcher)
+
+        reports = performance_test_logger.single_points.get("report", [])
+        assertThat(len(reports)).isGreaterThan(1)
+        max_gap = max(later - earlier for earlier, later in zip(reports, reports[1:]))
+        logging.info("%d advertising reports, longest gap between reports %s" % (len(reports), max_gap))
+        # The scan must not stop for the whole time between two rotations
+        assertThat(max_gap.total_seconds()).isLessThan(1)
+
+        # Every rotation while scanning stops the scan before LE Set Random Address, which controllers up to Core 5.2
+        # disallow while scanning, and starts the scan again after it so that it uses the new address
+        commands = read_hci_commands(os.path.join(self.dut.log_path_base, '%s_btsnoop_hci.log' % self.dut.label))
+        scan_enable_op_codes = (int(hci_packets.OpCode.LE_SET_SCAN_ENABLE),
+                                int(hci_packets.OpCode.LE_SET_EXTENDED_SCAN_ENABLE))
+        sequence = []
+        for op_code, parameters in commands:
+            if op_code == int(hci_packets.OpCode.LE_SET_RANDOM_ADDRESS):
+                sequence.append('address')
+            elif op_code in scan_enable_op_codes:
+                sequence.append('enable' if parameters[0] == 1 else 'disable')
+        # Addresses set after the scan was stopped for good do not restart it
+        last_stop = len(sequence) - 1 - sequence[::-1].index('disable')
+        scanning = False
+        rotations_while_scanning = 0
+        for i, command in enumerate(sequence[:last_stop]):
+            if command != 'address':
+                scanning = command == 'enable'
+                continue
+            assertThat(scanning).isFalse()
+            if sequence[max(i - 2, 0):i] == ['enable', 'disable']:
+                rotations_while_scanning += 1
+                assertThat(sequence[i + 1:i + 2]).isEqualTo(['enable'])
+        logging.info("%d rotations while scanning" % rotations_while_scanning)
+        assertThat(rotations_while_scanning).isGreaterThan(2)
+
+        remove_request = le_advertising_facade.RemoveAdvertiserRequest(advertiser_id=create_response.advertiser_id)
+        self.cert.hci_le_advertising_manager.RemoveAdvertiser(remove_request)
+
 
 class LeScanningManagerTest(gd_base_test.GdBaseTestClass, LeScanningManagerTestBase):
 
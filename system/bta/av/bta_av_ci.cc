@@ -42,7 +42,8 @@
  *
  ******************************************************************************/
 void bta_av_ci_src_data_ready(tBTA_AV_CHNL chnl) {
-  BT_HDR_RIGID* p_buf = (BT_HDR_RIGID*)osi_malloc(sizeof(BT_HDR_RIGID));
+  /* Sent on every media tick, serve it from the buffer pool */
+  BT_HDR_RIGID* p_buf = (BT_HDR_RIGID*)osi_pool_malloc(sizeof(BT_HDR_RIGID));
 
   p_buf->layer_specific = chnl;
   p_buf->event = BTA_AV_CI_SRC_DATA_READY_EVT;
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <base/location.h>
+#include <benchmark/benchmark.h>
+
+#include <future>
+
+#include "bta/sys/bta_sys.h"
+#include "osi/include/allocator.h"
+#include "stack/include/bt_hdr.h"
+#include "test/common/main_handler.h"
+
+using ::benchmark::State;
+
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+// Events sent per iteration, a burst the size of an A2DP streaming second
+constexpr int kEventsPerIteration = 1000;
+constexpr uint8_t kBenchmarkId = BTA_ID_JV;
+
+bool benchmark_hdl_event(BT_HDR_RIGID* p_msg) {
+  benchmark::DoNotOptimize(p_msg->event);
+  return true;
+}
+
+const tBTA_SYS_REG benchmark_reg = {benchmark_hdl_event, nullptr};
+
+// How BTA dispatched before: one closure bound per message
+void bind_per_message(void* p_msg) {
+  do_in_main_thread(FROM_HERE, base::Bind(
+                                   [](BT_HDR_RIGID* p_msg) {
+                                     if (benchmark_hdl_event(p_msg)) {
+                                       osi_free(p_msg);
+                                     }
+                                   },
+                                   static_cast<BT_HDR_RIGID*>(p_msg)));
+}
+
+void wait_for_main_thread() {
+  std::promise<void> promise;
+  std::future<void> future = promise.get_future();
+  do_in_main_thread(FROM_HERE, base::Bind([](std::promise<void>* promise) {
+                                 promise->set_value();
+                               },
+                               &promise));
+  future.wait();
+}
+
+// Every iteration sends a burst of API-sized events from this thread and
+// waits until the main thread has dispatched all of them.
+template <void (*sendmsg)(void*), void* (*alloc)(size_t)>
+void BM_BtaEventsThroughMainThread(State& state) {
+  main_thread_start_up();
+  bta_sys_init();
+  bta_sys_register(kBenchmarkId, &benchmark_reg);
+
+  for (auto _ : state) {
+    for (int i = 0; i < kEventsPerIteration; i++) {
+      BT_HDR_RIGID* p_msg = (BT_HDR_RIGID*)alloc(sizeof(BT_HDR_RIGID));
+      p_msg->event = BTA_SYS_EVT_START(kBenchmarkId);
+      p_msg->layer_specific = 0;
+      sendmsg(p_msg);
+    }
+    wait_for_main_thread();
+  }
+  state.SetItemsProcessed(state.iterations() * kEventsPerIteration);
+
+  bta_sys_deregister(kBenchmarkId);
+  main_thread_shut_down();
+}
+BENCHMARK_TEMPLATE(BM_BtaEventsThroughMainThread, bind_per_message, osi_malloc)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BtaEventsThroughMainThread, bta_sys_sendmsg, osi_malloc)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_BtaEventsThroughMainThread, bta_sys_sendmsg,
+                   osi_pool_malloc)
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
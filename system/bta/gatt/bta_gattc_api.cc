@@ -379,7 +379,7 @@ void BTA_GATTC_ReadCharacteristic(uint16_t conn_id, uint16_t handle,
                                   tGATT_AUTH_REQ auth_req,
                                   GATT_READ_OP_CB callback, void* cb_data) {
   tBTA_GATTC_API_READ* p_buf =
-      (tBTA_GATTC_API_READ*)osi_calloc(sizeof(tBTA_GATTC_API_READ));
+      (tBTA_GATTC_API_READ*)osi_pool_calloc(sizeof(tBTA_GATTC_API_READ));
 
   p_buf->hdr.event = BTA_GATTC_API_READ_EVT;
   p_buf->hdr.layer_specific = conn_id;
@@ -492,7 +492,7 @@ void BTA_GATTC_WriteCharValue(uint16_t conn_id, uint16_t handle,
                               std::vector<uint8_t> value,
                               tGATT_AUTH_REQ auth_req,
                               GATT_WRITE_OP_CB callback, void* cb_data) {
-  tBTA_GATTC_API_WRITE* p_buf = (tBTA_GATTC_API_WRITE*)osi_calloc(
+  tBTA_GATTC_API_WRITE* p_buf = (tBTA_GATTC_API_WRITE*)osi_pool_calloc(
       sizeof(tBTA_GATTC_API_WRITE) + value.size());
 
   p_buf->hdr.event = BTA_GATTC_API_WRITE_EVT;
@@ -139,7 +139,7 @@ static void bta_hh_snd_write_dev(uint8_t dev_handle, uint8_t t_type,
                                  uint8_t param, uint16_t data, uint8_t rpt_id,
                                  BT_HDR* p_data) {
   tBTA_HH_CMD_DATA* p_buf =
-      (tBTA_HH_CMD_DATA*)osi_calloc(sizeof(tBTA_HH_CMD_DATA));
+      (tBTA_HH_CMD_DATA*)osi_pool_calloc(sizeof(tBTA_HH_CMD_DATA));
 
   p_buf->hdr.event = BTA_HH_API_WRITE_DEV_EVT;
   p_buf->hdr.layer_specific = (uint16_t)dev_handle;
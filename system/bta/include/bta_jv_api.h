@@ -147,6 +147,7 @@ typedef int tBTA_JV_CONN_TYPE;
   21 /* L2CAP connection congestion status changed */
 #define BTA_JV_L2CAP_READ_EVT 22  /* the result for BTA_JvL2capRead */
 #define BTA_JV_L2CAP_WRITE_EVT 24 /* the result for BTA_JvL2capWrite*/
+#define BTA_JV_L2CAP_TX_DONE_EVT 25 /* L2CAP connection sent written data */
 
 /* events received by tBTA_JV_RFCOMM_CBACK */
 #define BTA_JV_RFCOMM_OPEN_EVT                                                \
@@ -250,6 +251,12 @@ typedef struct {
   bool cong;             /* congestion status */
 } tBTA_JV_L2CAP_WRITE;
 
+/* data associated with BTA_JV_L2CAP_TX_DONE_EVT */
+typedef struct {
+  uint32_t handle;    /* The connection handle */
+  uint16_t sdus_sent; /* SDUs sent, 0xFFFF if all written data is sent */
+} tBTA_JV_L2CAP_TX_DONE;
+
 /* data associated with BTA_JV_RFCOMM_OPEN_EVT */
 typedef struct {
   tBTA_JV_STATUS status; /* Whether the operation succeeded or failed. */
@@ -342,6 +349,7 @@ typedef union {
   tBTA_JV_L2CAP_CONG l2c_cong;               /* BTA_JV_L2CAP_CONG_EVT */
   tBTA_JV_L2CAP_READ l2c_read;               /* BTA_JV_L2CAP_READ_EVT */
   tBTA_JV_L2CAP_WRITE l2c_write;             /* BTA_JV_L2CAP_WRITE_EVT */
+  tBTA_JV_L2CAP_TX_DONE l2c_tx_done;         /* BTA_JV_L2CAP_TX_DONE_EVT */
   tBTA_JV_RFCOMM_OPEN rfc_open;              /* BTA_JV_RFCOMM_OPEN_EVT */
   tBTA_JV_RFCOMM_SRV_OPEN rfc_srv_open;      /* BTA_JV_RFCOMM_SRV_OPEN_EVT */
   tBTA_JV_RFCOMM_CLOSE rfc_close;            /* BTA_JV_RFCOMM_CLOSE_EVT */
@@ -571,7 +579,8 @@ tBTA_JV_STATUS BTA_JvL2capReady(uint32_t handle, uint32_t* p_data_size);
  *
  * Description      This function writes data to an L2CAP connection
  *                  When the operation is complete, tBTA_JV_L2CAP_CBACK is
- *                  called with BTA_JV_L2CAP_WRITE_EVT. Works for
+ *                  called with BTA_JV_L2CAP_WRITE_EVT, and with
+ *                  BTA_JV_L2CAP_TX_DONE_EVT once the data is sent. Works for
  *                  PSM-based connections
  *
  * Returns          BTA_JV_SUCCESS, if the request is being processed.
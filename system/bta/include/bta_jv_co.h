@@ -24,6 +24,8 @@
 #ifndef BTA_JV_CO_H
 #define BTA_JV_CO_H
 
+#include <sys/uio.h>
+
 #include <cstdint>
 
 #include "stack/include/bt_hdr.h"
@@ -48,5 +50,7 @@ extern int bta_co_rfc_data_incoming(uint32_t rfcomm_slot_id, BT_HDR* p_buf);
 extern int bta_co_rfc_data_outgoing_size(uint32_t rfcomm_slot_id, int* size);
 extern int bta_co_rfc_data_outgoing(uint32_t rfcomm_slot_id, uint8_t* buf,
                                     uint16_t size);
+extern int bta_co_rfc_data_outgoing_iov(uint32_t rfcomm_slot_id,
+                                        struct iovec* iov, int count);
 
 #endif /* BTA_DG_CO_H */
@@ -897,6 +897,13 @@ static void bta_jv_l2cap_client_cback(uint16_t gap_handle, uint16_t event,
       bta_jv_pm_conn_idle(p_cb->p_pm_cb);
       break;
 
+    case GAP_EVT_TX_DONE:
+      evt_data.l2c_tx_done.handle = gap_handle;
+      evt_data.l2c_tx_done.sdus_sent = data->tx_done.sdus_sent;
+      p_cb->p_cback(BTA_JV_L2CAP_TX_DONE_EVT, &evt_data,
+                    p_cb->l2cap_socket_id);
+      break;
+
     case GAP_EVT_TX_EMPTY:
       bta_jv_pm_conn_idle(p_cb->p_pm_cb);
       break;
@@ -1041,6 +1048,13 @@ static void bta_jv_l2cap_server_cback(uint16_t gap_handle, uint16_t event,
       bta_jv_pm_conn_idle(p_cb->p_pm_cb);
       break;
 
+    case GAP_EVT_TX_DONE:
+      evt_data.l2c_tx_done.handle = gap_handle;
+      evt_data.l2c_tx_done.sdus_sent = data->tx_done.sdus_sent;
+      p_cb->p_cback(BTA_JV_L2CAP_TX_DONE_EVT, &evt_data,
+                    p_cb->l2cap_socket_id);
+      break;
+
     case GAP_EVT_TX_EMPTY:
       bta_jv_pm_conn_idle(p_cb->p_pm_cb);
       break;
@@ -1209,6 +1223,9 @@ static int bta_jv_port_data_co_cback(uint16_t port_handle, uint8_t* buf,
         return bta_co_rfc_data_outgoing_size(p_pcb->rfcomm_slot_id, (int*)buf);
       case DATA_CO_CALLBACK_TYPE_OUTGOING:
         return bta_co_rfc_data_outgoing(p_pcb->rfcomm_slot_id, buf, len);
+      case DATA_CO_CALLBACK_TYPE_OUTGOING_IOV:
+        return bta_co_rfc_data_outgoing_iov(p_pcb->rfcomm_slot_id,
+                                            (struct iovec*)buf, len);
       default:
         LOG(ERROR) << __func__ << ": unknown callout type=" << type;
         break;
@@ -28,6 +28,8 @@
 #include <base/logging.h>
 
 #include <cstring>
+#include <mutex>
+#include <vector>
 
 #include "bt_target.h"  // Must be first to define build configuration
 #include "bta/sys/bta_sys.h"
@@ -50,6 +52,20 @@ tBTA_SYS_CB bta_sys_cb;
 uint8_t appl_trace_level = APPL_INITIAL_TRACE_LEVEL;
 uint8_t btif_trace_level = BT_TRACE_LEVEL_WARNING;
 
+/* Messages sent to BTA and not yet dispatched, oldest first. Every message
+ * posts one copy of a shared closure that dispatches the oldest message, so
+ * sending binds no closure per message and messages keep their order against
+ * the other tasks of the main thread. */
+#define BTA_SYS_MSG_RING_SIZE 64
+
+static std::mutex bta_sys_msg_mutex;
+static std::vector<BT_HDR_RIGID*> bta_sys_msg_ring(BTA_SYS_MSG_RING_SIZE);
+static size_t bta_sys_msg_head = 0;
+static size_t bta_sys_msg_count = 0;
+
+static void bta_sys_msg_push(BT_HDR_RIGID* p_msg);
+static BT_HDR_RIGID* bta_sys_msg_pop(void);
+
 /*******************************************************************************
  *
  * Function         bta_sys_init
@@ -62,6 +78,13 @@ uint8_t btif_trace_level = BT_TRACE_LEVEL_WARNING;
  ******************************************************************************/
 void bta_sys_init(void) {
   memset(&bta_sys_cb, 0, sizeof(tBTA_SYS_CB));
+
+  /* Messages left over from a previous run lost their dispatch task */
+  std::lock_guard<std::mutex> lock(bta_sys_msg_mutex);
+  BT_HDR_RIGID* p_msg;
+  while ((p_msg = bta_sys_msg_pop()) != NULL) {
+    osi_free(p_msg);
+  }
 }
 
 void bta_set_forward_hw_failures(bool value) {
@@ -76,15 +99,17 @@ void BTA_sys_signal_hw_error() {
 
 /*******************************************************************************
  *
- * Function         bta_sys_event
+ * Function         bta_sys_dispatch
  *
- * Description      BTA event handler; called from task event handler.
+ * Description      Call the event handler of the subsystem owning the event
+ *                  of |p_msg|.
  *
  *
- * Returns          void
+ * Returns          true if the caller should free |p_msg|, false if the
+ *                  subsystem kept it.
  *
  ******************************************************************************/
-static void bta_sys_event(BT_HDR_RIGID* p_msg) {
+static bool bta_sys_dispatch(BT_HDR_RIGID* p_msg) {
   uint8_t id;
   bool freebuf = true;
 
@@ -101,11 +126,103 @@ static void bta_sys_event(BT_HDR_RIGID* p_msg) {
              BtaIdSysText(id).c_str());
   }
 
-  if (freebuf) {
+  return freebuf;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_sys_event
+ *
+ * Description      BTA event handler; called from task event handler.
+ *
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_sys_event(BT_HDR_RIGID* p_msg) {
+  if (bta_sys_dispatch(p_msg)) {
     osi_free(p_msg);
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_sys_msg_push
+ *
+ * Description      Append |p_msg| to the pending messages, growing the ring
+ *                  when it is full. Called with bta_sys_msg_mutex held.
+ *
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_sys_msg_push(BT_HDR_RIGID* p_msg) {
+  size_t capacity = bta_sys_msg_ring.size();
+
+  if (bta_sys_msg_count == capacity) {
+    std::vector<BT_HDR_RIGID*> ring(capacity * 2);
+    for (size_t i = 0; i < bta_sys_msg_count; i++) {
+      ring[i] = bta_sys_msg_ring[(bta_sys_msg_head + i) % capacity];
+    }
+    bta_sys_msg_ring.swap(ring);
+    bta_sys_msg_head = 0;
+    capacity = bta_sys_msg_ring.size();
+  }
+
+  bta_sys_msg_ring[(bta_sys_msg_head + bta_sys_msg_count) % capacity] = p_msg;
+  bta_sys_msg_count++;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_sys_msg_pop
+ *
+ * Description      Remove the oldest pending message. Called with
+ *                  bta_sys_msg_mutex held.
+ *
+ *
+ * Returns          The oldest pending message, NULL if there is none.
+ *
+ ******************************************************************************/
+static BT_HDR_RIGID* bta_sys_msg_pop(void) {
+  if (bta_sys_msg_count == 0) return NULL;
+
+  BT_HDR_RIGID* p_msg = bta_sys_msg_ring[bta_sys_msg_head];
+  bta_sys_msg_head = (bta_sys_msg_head + 1) % bta_sys_msg_ring.size();
+  bta_sys_msg_count--;
+  return p_msg;
+}
+
+/*******************************************************************************
+ *
+ * Function         bta_sys_dispatch_next
+ *
+ * Description      Main thread task posted by bta_sys_sendmsg; dispatches
+ *                  the oldest pending message.
+ *
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_sys_dispatch_next() {
+  BT_HDR_RIGID* p_msg;
+  {
+    std::lock_guard<std::mutex> lock(bta_sys_msg_mutex);
+    p_msg = bta_sys_msg_pop();
+  }
+
+  if (p_msg != NULL) {
+    bta_sys_event(p_msg);
+  }
+}
+
+/* Copies share the bound state, posting one does not allocate a closure */
+static const base::Closure& bta_sys_dispatch_closure() {
+  static const base::Closure* closure =
+      new base::Closure(base::Bind(&bta_sys_dispatch_next));
+  return *closure;
+}
+
 /*******************************************************************************
  *
  * Function         bta_sys_register
@@ -164,12 +281,14 @@ bool bta_sys_is_register(uint8_t id) { return bta_sys_cb.is_reg[id]; }
  *
  ******************************************************************************/
 void bta_sys_sendmsg(void* p_msg) {
-  if (do_in_main_thread(
-          FROM_HERE,
-          base::Bind(&bta_sys_event, static_cast<BT_HDR_RIGID*>(p_msg))) !=
+  /* Post and queue under the lock, the task can not run before the push */
+  std::lock_guard<std::mutex> lock(bta_sys_msg_mutex);
+  if (do_in_main_thread(FROM_HERE, bta_sys_dispatch_closure()) !=
       BT_STATUS_SUCCESS) {
     LOG(ERROR) << __func__ << ": do_in_main_thread failed";
+    return;
   }
+  bta_sys_msg_push(static_cast<BT_HDR_RIGID*>(p_msg));
 }
 
 void bta_sys_sendmsg_delayed(void* p_msg, const base::TimeDelta& delay) {
@@ -181,6 +300,29 @@ void bta_sys_sendmsg_delayed(void* p_msg, const base::TimeDelta& delay) {
   }
 }
 
+/*******************************************************************************
+ *
+ * Function         bta_sys_timer_cback
+ *
+ * Description      Alarm callback of bta_sys_start_timer, run on the main
+ *                  thread. |data| carries the event and the layer specific
+ *                  value, the event is dispatched from a header on the stack.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void bta_sys_timer_cback(void* data) {
+  uintptr_t timer_param = reinterpret_cast<uintptr_t>(data);
+  BT_HDR_RIGID hdr = {};
+
+  hdr.event = (uint16_t)(timer_param >> 16);
+  hdr.layer_specific = (uint16_t)timer_param;
+
+  bool freebuf = bta_sys_dispatch(&hdr);
+  CHECK(freebuf) << "Timer event 0x" << std::hex << hdr.event
+                 << " can not be kept by its subsystem";
+}
+
 /*******************************************************************************
  *
  * Function         bta_sys_start_timer
@@ -193,12 +335,10 @@ void bta_sys_sendmsg_delayed(void* p_msg, const base::TimeDelta& delay) {
  ******************************************************************************/
 void bta_sys_start_timer(alarm_t* alarm, uint64_t interval_ms, uint16_t event,
                          uint16_t layer_specific) {
-  BT_HDR_RIGID* p_buf = (BT_HDR_RIGID*)osi_malloc(sizeof(BT_HDR_RIGID));
-
-  p_buf->event = event;
-  p_buf->layer_specific = layer_specific;
+  uintptr_t timer_param = ((uintptr_t)event << 16) | layer_specific;
 
-  alarm_set_on_mloop(alarm, interval_ms, bta_sys_sendmsg, p_buf);
+  alarm_set_on_mloop(alarm, interval_ms, bta_sys_timer_cback,
+                     reinterpret_cast<void*>(timer_param));
 }
 
 /*******************************************************************************
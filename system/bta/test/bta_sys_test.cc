@@ -0,0 +1,131 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <base/location.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "bta/sys/bta_sys.h"
+#include "stack/include/bt_hdr.h"
+#include "test/common/main_handler.h"
+#include "test/common/mock_functions.h"
+#include "test/mock/mock_osi_alarm.h"
+
+namespace {
+
+// Subsystem not used by the other tests of this binary
+constexpr uint8_t kTestId = BTA_ID_JV;
+constexpr uint16_t kTestEvt = BTA_SYS_EVT_START(kTestId);
+// Marks a main thread task that is not a BTA message
+constexpr uint16_t kTaskMarker = 0xffff;
+
+std::vector<uint16_t> received;
+std::vector<uint16_t> received_layer_specific;
+
+bool test_hdl_event(BT_HDR_RIGID* p_msg) {
+  received.push_back(p_msg->event);
+  received_layer_specific.push_back(p_msg->layer_specific);
+  return true;
+}
+
+const tBTA_SYS_REG test_reg = {test_hdl_event, nullptr};
+
+}  // namespace
+
+class BtaSysTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    mock_function_count_map.clear();
+    received.clear();
+    received_layer_specific.clear();
+    main_thread_start_up();
+    bta_sys_init();
+    bta_sys_register(kTestId, &test_reg);
+  }
+
+  void TearDown() override {
+    sync_main_handler();
+    bta_sys_deregister(kTestId);
+    test::mock::osi_alarm::alarm_set_on_mloop = {};
+    main_thread_shut_down();
+  }
+
+  // Messages are owned by the test, the mocked osi_free does not release them
+  std::vector<BT_HDR_RIGID> MakeMessages(size_t count) {
+    std::vector<BT_HDR_RIGID> msgs(count);
+    for (size_t i = 0; i < count; i++) {
+      msgs[i].event = kTestEvt + (uint16_t)i;
+    }
+    return msgs;
+  }
+};
+
+TEST_F(BtaSysTest, messages_are_dispatched_in_order) {
+  // More than the initial capacity of the pending message ring
+  std::vector<BT_HDR_RIGID> msgs = MakeMessages(200);
+
+  for (auto& msg : msgs) bta_sys_sendmsg(&msg);
+  sync_main_handler();
+
+  ASSERT_EQ(msgs.size(), received.size());
+  for (size_t i = 0; i < msgs.size(); i++) {
+    ASSERT_EQ(msgs[i].event, received[i]);
+  }
+  ASSERT_EQ(200, mock_function_count_map["osi_free"]);
+}
+
+TEST_F(BtaSysTest, messages_keep_order_with_other_main_thread_tasks) {
+  std::vector<BT_HDR_RIGID> msgs = MakeMessages(3);
+
+  bta_sys_sendmsg(&msgs[0]);
+  do_in_main_thread(FROM_HERE,
+                    base::Bind([]() { received.push_back(kTaskMarker); }));
+  bta_sys_sendmsg(&msgs[1]);
+  bta_sys_sendmsg(&msgs[2]);
+  do_in_main_thread(FROM_HERE,
+                    base::Bind([]() { received.push_back(kTaskMarker); }));
+  sync_main_handler();
+
+  std::vector<uint16_t> expected = {msgs[0].event, kTaskMarker, msgs[1].event,
+                                    msgs[2].event, kTaskMarker};
+  ASSERT_EQ(expected, received);
+}
+
+TEST_F(BtaSysTest, timer_event_is_dispatched_without_allocation) {
+  alarm_callback_t timer_cb = nullptr;
+  void* timer_data = nullptr;
+  test::mock::osi_alarm::alarm_set_on_mloop.body =
+      [&](alarm_t* alarm, uint64_t interval_ms, alarm_callback_t cb,
+          void* data) {
+        timer_cb = cb;
+        timer_data = data;
+      };
+
+  bta_sys_start_timer(nullptr, 1000, kTestEvt + 1, 0xabcd);
+  ASSERT_NE(nullptr, timer_cb);
+  ASSERT_EQ(0, mock_function_count_map["osi_malloc"]);
+
+  do_in_main_thread(FROM_HERE, base::Bind(timer_cb, timer_data));
+  sync_main_handler();
+
+  ASSERT_EQ(1U, received.size());
+  ASSERT_EQ(kTestEvt + 1, received[0]);
+  ASSERT_EQ(0xabcd, received_layer_specific[0]);
+  ASSERT_EQ(0, mock_function_count_map["osi_free"]);
+}
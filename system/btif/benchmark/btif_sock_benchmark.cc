@@ -0,0 +1,128 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "btif/include/btif_sock_util.h"
+#include "internal_include/bt_trace.h"
+
+using ::benchmark::State;
+
+// Global trace level referred in the code under test
+uint8_t btif_trace_level = BT_TRACE_LEVEL_WARNING;
+
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+// Every iteration moves |range(0)| packets of |range(1)| bytes across the
+// SEQPACKET socket pair that connects a Bluetooth socket to its app, with
+// one sock_send_packets() or sock_recv_packets() call on the stack side. A
+// batch of 1 is the cost of a system call per packet.
+
+class SockPair {
+ public:
+  SockPair() {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) == 0) {
+      stack_fd_ = fds[0];
+      app_fd_ = fds[1];
+    }
+  }
+
+  ~SockPair() {
+    close(stack_fd_);
+    close(app_fd_);
+  }
+
+  int stack_fd_ = -1;
+  int app_fd_ = -1;
+};
+
+struct Packets {
+  Packets(int count, size_t size)
+      : data(count, std::vector<uint8_t>(size)), iov(count), lens(count) {
+    for (int i = 0; i < count; i++) {
+      iov[i].iov_base = data[i].data();
+      iov[i].iov_len = size;
+    }
+  }
+
+  std::vector<std::vector<uint8_t>> data;
+  std::vector<struct iovec> iov;
+  std::vector<size_t> lens;
+};
+
+void BM_SockSendPackets(State& state) {
+  int count = state.range(0);
+  size_t size = state.range(1);
+  SockPair pair;
+  Packets packets(count, size);
+  std::vector<uint8_t> buf(size);
+  for (auto _ : state) {
+    if (sock_send_packets(pair.stack_fd_, packets.iov.data(), count,
+                          packets.lens.data()) != count) {
+      state.SkipWithError("Short batch");
+      return;
+    }
+    for (int i = 0; i < count; i++) {
+      recv(pair.app_fd_, buf.data(), buf.size(), 0);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * count * size);
+}
+
+void BM_SockRecvPackets(State& state) {
+  int count = state.range(0);
+  size_t size = state.range(1);
+  SockPair pair;
+  Packets packets(count, size);
+  std::vector<uint8_t> buf(size);
+  for (auto _ : state) {
+    for (int i = 0; i < count; i++) {
+      send(pair.app_fd_, buf.data(), buf.size(), 0);
+    }
+    if (sock_recv_packets(pair.stack_fd_, packets.iov.data(), count,
+                          packets.lens.data()) != count) {
+      state.SkipWithError("Short batch");
+      return;
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * count);
+  state.SetBytesProcessed(state.iterations() * count * size);
+}
+
+// The default L2CAP MTU, and a larger one. Batches stay under the default queue length of the socket so that
+// they never block.
+void Batches(benchmark::internal::Benchmark* benchmark) {
+  for (int64_t size : {672, 1024}) {
+    for (int64_t count : {1, 4, 8}) {
+      benchmark->Args({count, size});
+    }
+  }
+}
+
+BENCHMARK(BM_SockSendPackets)->Apply(Batches);
+BENCHMARK(BM_SockRecvPackets)->Apply(Batches);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "btif/include/btif_sock_thread.h"
+#include "internal_include/bt_trace.h"
+
+using ::benchmark::State;
+
+// Global trace level referred in the code under test
+uint8_t appl_trace_level = BT_TRACE_LEVEL_WARNING;
+
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+// Every iteration is one wakeup of the socket poll thread: the app writes to
+// one of the sockets, and the iteration ends when the poll thread signals it.
+// The socket is armed again for the next iteration, as the RFCOMM and L2CAP
+// sockets do after handling their data. |range(0)| sockets are monitored,
+// all idle but the signaled one.
+
+constexpr uint32_t kSignaledId = 0;
+constexpr auto kTimeout = std::chrono::seconds(5);
+
+std::mutex signaled_mutex;
+std::condition_variable signaled_cv;
+bool signaled = false;
+
+void signaled_cb(int fd, int type, int flags, uint32_t user_id) {
+  if (user_id != kSignaledId) return;
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  signaled = true;
+  signaled_cv.notify_one();
+}
+
+void BM_SockThreadWakeup(State& state) {
+  int num_sockets = state.range(0);
+  btsock_thread_init();
+  int handle = btsock_thread_create(signaled_cb, NULL);
+  if (handle < 0) {
+    state.SkipWithError("No socket poll thread");
+    return;
+  }
+  std::vector<int> our_fds;
+  std::vector<int> app_fds;
+  for (int i = 0; i < num_sockets; i++) {
+    int fds[2];
+    if (socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds) != 0) break;
+    our_fds.push_back(fds[0]);
+    app_fds.push_back(fds[1]);
+    if (i != kSignaledId) {
+      btsock_thread_add_fd(handle, fds[0], BTSOCK_RFCOMM, SOCK_THREAD_FD_RD, i);
+    }
+  }
+  if (our_fds.size() != (size_t)num_sockets) {
+    state.SkipWithError("Out of sockets");
+  }
+
+  char byte = 0;
+  for (auto _ : state) {
+    if (our_fds.size() != (size_t)num_sockets) break;
+    btsock_thread_add_fd(handle, our_fds[kSignaledId], BTSOCK_RFCOMM,
+                         SOCK_THREAD_FD_RD, kSignaledId);
+    write(app_fds[kSignaledId], &byte, 1);
+    std::unique_lock<std::mutex> lock(signaled_mutex);
+    if (!signaled_cv.wait_for(lock, kTimeout, [] { return signaled; })) {
+      state.SkipWithError("Not signaled");
+      break;
+    }
+    signaled = false;
+    lock.unlock();
+    read(our_fds[kSignaledId], &byte, 1);
+  }
+
+  btsock_thread_exit(handle);
+  for (int fd : our_fds) close(fd);
+  for (int fd : app_fds) close(fd);
+}
+// Up to the 64 poll slots per thread of the poll() based loop, and beyond
+BENCHMARK(BM_SockThreadWakeup)->Arg(1)->Arg(16)->Arg(60)->Arg(256)
+    ->UseRealTime();
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -27,10 +27,30 @@
 #ifndef BTIF_SOCK_UTIL_H
 #define BTIF_SOCK_UTIL_H
 
+#include <stddef.h>
 #include <stdint.h>
+#include <sys/uio.h>
 
 int sock_send_fd(int sock_fd, const uint8_t* buffer, int len, int send_fd);
 int sock_send_all(int sock_fd, const uint8_t* buf, int len);
 int sock_recv_all(int sock_fd, uint8_t* buf, int len);
 
+/* Largest |count| taken by sock_send_packets() and sock_recv_packets() */
+#define SOCK_MAX_PACKET_BATCH 16
+
+/* Sends up to |count| packets, one per |iov| entry, to a SOCK_SEQPACKET
+ * socket with a single non-blocking sendmmsg(). |sent_lens| receives the
+ * number of bytes sent of each packet. Returns the number of packets sent,
+ * which is less than |count| once the socket is full, or -1 with errno set
+ * (EAGAIN if not even the first packet fits). */
+int sock_send_packets(int sock_fd, struct iovec* iov, int count,
+                      size_t* sent_lens);
+
+/* Receives up to |count| packets from a SOCK_SEQPACKET socket with a single
+ * non-blocking recvmmsg(), one into each |iov| buffer. |lens| receives the
+ * length of each packet, which is larger than its buffer if the packet was
+ * truncated. Returns the number of packets received, or -1 with errno set
+ * (EAGAIN if there was none). */
+int sock_recv_packets(int sock_fd, struct iovec* iov, int count, size_t* lens);
+
 #endif
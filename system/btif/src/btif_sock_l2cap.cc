@@ -19,6 +19,7 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 
@@ -39,6 +40,15 @@
 
 #include <base/logging.h>
 
+/* Max number of app packets handed to the stack and not sent yet. The
+ * socket reads that many packets ahead so that the channel has the next ones
+ * queued as soon as it can send. */
+#define L2CAP_MAX_WRITES_IN_FLIGHT 8
+
+/* Max bytes of MTU sized buffers allocated for one read of app packets. With
+ * a large MTU the socket reads fewer packets at a time. */
+#define L2CAP_READ_AHEAD_BYTES (16 * 1024)
+
 struct packet {
   struct packet *next, *prev;
   uint32_t len;
@@ -66,6 +76,7 @@ typedef struct l2cap_socket {
   unsigned connected : 1;         // is connected?
   unsigned outgoing_congest : 1;  // should we hold?
   unsigned server_psm_sent : 1;   // The server shall only send PSM once.
+  unsigned writes_in_flight;      // packets written and not sent yet
   bool is_le_coc;                 // is le connection oriented channel?
   uint16_t rx_mtu;
   uint16_t tx_mtu;
@@ -123,53 +134,29 @@ static char packet_get_head_l(l2cap_socket* sock, uint8_t** data,
   return true;
 }
 
-static struct packet* packet_alloc(const uint8_t* data, uint32_t len) {
+/* allocates a packet with room for len bytes, to be filled in by the caller */
+static struct packet* packet_alloc(uint32_t len) {
   struct packet* p = (struct packet*)osi_calloc(sizeof(*p));
-  uint8_t* buf = (uint8_t*)osi_malloc(len);
 
-  p->data = buf;
+  p->data = (uint8_t*)osi_malloc(len);
   p->len = len;
-  memcpy(p->data, data, len);
   return p;
 }
 
-/* makes a copy of the data, returns true on success */
-static char packet_put_head_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
-
-  /*
-   * We do not check size limits here since this is used to undo "getting" a
-   * packet that the user read incompletely. That is to say the packet was
-   * already in the queue. We do check thos elimits in packet_put_tail_l() since
-   * that function is used to put new data into the queue.
-   */
-
-  if (!p) return false;
-
-  p->prev = NULL;
-  p->next = sock->first_packet;
-  sock->first_packet = p;
-  if (p->next)
-    p->next->prev = p;
-  else
-    sock->last_packet = p;
-
-  sock->bytes_buffered += len;
-
-  return true;
+static void packet_free(struct packet* p) {
+  osi_free(p->data);
+  osi_free(p);
 }
 
-/* makes a copy of the data, returns true on success */
-static char packet_put_tail_l(l2cap_socket* sock, const void* data,
-                              uint32_t len) {
+/* takes ownership of p on success, the caller frees it otherwise */
+static char packet_put_tail_l(l2cap_socket* sock, struct packet* p) {
   if (sock->bytes_buffered >= L2CAP_MAX_RX_BUFFER) {
     LOG_ERROR("Unable to add to buffer due to buffer overflow socket_id:%u",
               sock->id);
     return false;
   }
 
-  struct packet* p = packet_alloc((const uint8_t*)data, len);
+  uint32_t len = p->len;
   p->next = NULL;
   p->prev = sock->last_packet;
   sock->last_packet = p;
@@ -559,6 +546,18 @@ static void on_l2cap_close(tBTA_JV_L2CAP_CLOSE* p_close, uint32_t id) {
   btsock_l2cap_free_l(sock);
 }
 
+/* Monitors the app socket for more data, unless the channel is congested or
+ * the socket has as many writes in flight as it may have. The tx done and
+ * uncongested events call it again. */
+static void monitor_app_data_l(l2cap_socket* sock) {
+  if (sock->outgoing_congest ||
+      sock->writes_in_flight >= L2CAP_MAX_WRITES_IN_FLIGHT) {
+    return;
+  }
+  btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD,
+                       sock->id);
+}
+
 static void on_l2cap_outgoing_congest(tBTA_JV_L2CAP_CONG* p, uint32_t id) {
   l2cap_socket* sock;
 
@@ -574,12 +573,11 @@ static void on_l2cap_outgoing_congest(tBTA_JV_L2CAP_CONG* p, uint32_t id) {
   if (!sock->outgoing_congest) {
     LOG_VERBOSE("Monitoring l2cap socket for outgoing data socket_id:%u",
                 sock->id);
-    btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD,
-                         sock->id);
+    monitor_app_data_l(sock);
   }
 }
 
-static void on_l2cap_write_done(uint16_t len, uint32_t id) {
+static void on_l2cap_write_done(tBTA_JV_L2CAP_WRITE* p, uint32_t id) {
   std::unique_lock<std::mutex> lock(state_lock);
   l2cap_socket* sock = btsock_l2cap_find_by_id_l(id);
   if (!sock) {
@@ -588,15 +586,34 @@ static void on_l2cap_write_done(uint16_t len, uint32_t id) {
   }
 
   int app_uid = sock->app_uid;
+  /* A packet the stack dropped won't be sent, the tx done event counts the
+   * others. */
+  if (p->status != BTA_JV_SUCCESS && sock->writes_in_flight)
+    sock->writes_in_flight--;
   if (!sock->outgoing_congest) {
-    btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_RD,
-                         sock->id);
+    monitor_app_data_l(sock);
   } else {
     LOG_INFO("Socket congestion on socket_id:%u", sock->id);
   }
 
-  sock->tx_bytes += len;
-  uid_set_add_tx(uid_set, app_uid, len);
+  sock->tx_bytes += p->len;
+  uid_set_add_tx(uid_set, app_uid, p->len);
+}
+
+static void on_l2cap_tx_done(tBTA_JV_L2CAP_TX_DONE* p, uint32_t id) {
+  std::unique_lock<std::mutex> lock(state_lock);
+  l2cap_socket* sock = btsock_l2cap_find_by_id_l(id);
+  if (!sock) {
+    LOG_ERROR("Unable to find l2cap socket with socket_id:%u", id);
+    return;
+  }
+
+  if (p->sdus_sent == 0xFFFF || p->sdus_sent >= sock->writes_in_flight) {
+    sock->writes_in_flight = 0;
+  } else {
+    sock->writes_in_flight -= p->sdus_sent;
+  }
+  monitor_app_data_l(sock);
 }
 
 static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
@@ -617,20 +634,24 @@ static void on_l2cap_data_ind(tBTA_JV* evt, uint32_t id) {
   uint32_t count;
 
   if (BTA_JvL2capReady(sock->handle, &count) == BTA_JV_SUCCESS) {
-    std::vector<uint8_t> buffer(count);
-    if (BTA_JvL2capRead(sock->handle, sock->id, buffer.data(), count) ==
+    // Read straight into the packet that is queued for the app
+    struct packet* p = packet_alloc(count);
+    if (BTA_JvL2capRead(sock->handle, sock->id, p->data, count) ==
         BTA_JV_SUCCESS) {
-      if (packet_put_tail_l(sock, buffer.data(), count)) {
+      if (packet_put_tail_l(sock, p)) {
         bytes_read = count;
         btsock_thread_add_fd(pth, sock->our_fd, BTSOCK_L2CAP, SOCK_THREAD_FD_WR,
                              sock->id);
       } else {  // connection must be dropped
         LOG_WARN("Closing socket as unable to push data to socket socket_id:%u",
                  sock->id);
+        packet_free(p);
         BTA_JvL2capClose(sock->handle);
         btsock_l2cap_free_l(sock);
         return;
       }
+    } else {
+      packet_free(p);
     }
   }
 
@@ -667,7 +688,11 @@ static void btsock_l2cap_cbk(tBTA_JV_EVT event, tBTA_JV* p_data,
       break;
 
     case BTA_JV_L2CAP_WRITE_EVT:
-      on_l2cap_write_done(p_data->l2c_write.len, l2cap_socket_id);
+      on_l2cap_write_done(&p_data->l2c_write, l2cap_socket_id);
+      break;
+
+    case BTA_JV_L2CAP_TX_DONE_EVT:
+      on_l2cap_tx_done(&p_data->l2c_tx_done, l2cap_socket_id);
       break;
 
     case BTA_JV_L2CAP_CONG_EVT:
@@ -809,25 +834,37 @@ bt_status_t btsock_l2cap_connect(const RawAddress* bd_addr, int channel,
  * (for example: unrecoverable error or no data)
  */
 static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
+  struct iovec iov[SOCK_MAX_PACKET_BATCH];
+  size_t sent_lens[SOCK_MAX_PACKET_BATCH];
   uint8_t* buf;
   uint32_t len;
 
-  while (packet_get_head_l(sock, &buf, &len)) {
-    ssize_t sent;
-    OSI_NO_INTR(sent = send(sock->our_fd, buf, len, MSG_DONTWAIT));
-    int saved_errno = errno;
+  while (sock->first_packet) {
+    /* The app socket is SOCK_SEQPACKET, so every packet is its own message */
+    int count = 0;
+    for (struct packet* p = sock->first_packet;
+         p && count < SOCK_MAX_PACKET_BATCH; p = p->next, count++) {
+      iov[count].iov_base = p->data;
+      iov[count].iov_len = p->len;
+    }
 
-    if (sent == (signed)len)
-      osi_free(buf);
-    else if (sent >= 0) {
-      packet_put_head_l(sock, buf + sent, len - sent);
-      osi_free(buf);
-      if (!sent) /* special case if other end not keeping up */
-        return true;
-    } else {
-      packet_put_head_l(sock, buf, len);
+    int sent = sock_send_packets(sock->our_fd, iov, count, sent_lens);
+    if (sent < 0) return errno == EWOULDBLOCK || errno == EAGAIN;
+    if (sent == 0) return true;
+
+    for (int i = 0; i < sent; i++) {
+      if (sent_lens[i] < iov[i].iov_len) {
+        /* keep the unsent tail of the packet at the head of the queue */
+        struct packet* p = sock->first_packet;
+        p->len -= sent_lens[i];
+        memmove(p->data, p->data + sent_lens[i], p->len);
+        sock->bytes_buffered -= sent_lens[i];
+        /* special case if other end not keeping up */
+        if (!sent_lens[i]) return true;
+        break;
+      }
+      packet_get_head_l(sock, &buf, &len);
       osi_free(buf);
-      return saved_errno == EWOULDBLOCK || saved_errno == EAGAIN;
     }
   }
 
@@ -836,8 +873,9 @@ static bool flush_incoming_que_on_wr_signal_l(l2cap_socket* sock) {
 
 inline BT_HDR* malloc_l2cap_buf(uint16_t len) {
   // We need FCS only for L2CAP_FCR_ERTM_MODE, but it's just 2 bytes so it's ok
-  BT_HDR* msg = (BT_HDR*)osi_malloc(BT_HDR_SIZE + L2CAP_MIN_OFFSET + len +
-                                    L2CAP_FCS_LENGTH);
+  // MTU sized buffers are recycled by the buffer pool rather than the heap
+  BT_HDR* msg = (BT_HDR*)osi_pool_malloc(BT_HDR_SIZE + L2CAP_MIN_OFFSET + len +
+                                         L2CAP_FCS_LENGTH);
   msg->offset = L2CAP_MIN_OFFSET;
   msg->len = len;
   return msg;
@@ -847,6 +885,55 @@ inline uint8_t* get_l2cap_sdu_start_ptr(BT_HDR* msg) {
   return (uint8_t*)(msg) + BT_HDR_SIZE + msg->offset;
 }
 
+/* Reads the packets the app wrote, as many as the socket may still have in
+ * flight and L2CAP_READ_AHEAD_BYTES allows, with a single recvmmsg() into
+ * buffers of the MTU, and hands them to the stack. */
+static void read_app_packets_l(l2cap_socket* sock, uint32_t user_id) {
+  BT_HDR* buffers[L2CAP_MAX_WRITES_IN_FLIGHT];
+  struct iovec iov[L2CAP_MAX_WRITES_IN_FLIGHT];
+  size_t lens[L2CAP_MAX_WRITES_IN_FLIGHT];
+  int room = L2CAP_MAX_WRITES_IN_FLIGHT - (int)sock->writes_in_flight;
+  int mtu = std::max(1, (int)sock->tx_mtu);
+  room = std::min(room, std::max(1, L2CAP_READ_AHEAD_BYTES / mtu));
+  if (room <= 0) return;
+
+  /* BluetoothSocket.write(...) guarantees that any packet send to this socket
+     is broken into pieces no bigger than MTU bytes (as requested by BT spec). */
+  for (int i = 0; i < room; i++) {
+    buffers[i] = malloc_l2cap_buf(sock->tx_mtu);
+    iov[i].iov_base = get_l2cap_sdu_start_ptr(buffers[i]);
+    iov[i].iov_len = sock->tx_mtu;
+  }
+
+  /* The socket is created with SOCK_SEQPACKET, hence every buffer gets one
+   * packet. */
+  int count = sock_recv_packets(sock->our_fd, iov, room, lens);
+  int saved_errno = errno;
+  for (int i = 0; i < count; i++) {
+    if (lens[i] > sock->tx_mtu) {
+      /* This can't happen thanks to check in BluetoothSocket.java but leave
+       * this in case this socket is ever used anywhere else*/
+      LOG(ERROR) << "recv more than MTU. Data will be lost: " << lens[i];
+      lens[i] = sock->tx_mtu;
+    }
+    buffers[i]->len = lens[i];
+    DVLOG(2) << __func__ << ": bytes received from socket: " << lens[i];
+
+    // will take care of freeing buffer
+    sock->writes_in_flight++;
+    BTA_JvL2capWrite(sock->handle, PTR_TO_UINT(buffers[i]), buffers[i],
+                     user_id);
+  }
+  for (int i = std::max(count, 0); i < room; i++) osi_free(buffers[i]);
+
+  if (count < 0 && saved_errno != EAGAIN && saved_errno != EWOULDBLOCK) {
+    LOG_ERROR("Unable to read from app socket_id:%u error:%s", sock->id,
+              strerror(saved_errno));
+    return;
+  }
+  monitor_app_data_l(sock);
+}
+
 void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id) {
   char drop_it = false;
 
@@ -862,36 +949,7 @@ void btsock_l2cap_signaled(int fd, int flags, uint32_t user_id) {
       int size = 0;
       bool ioctl_success = ioctl(sock->our_fd, FIONREAD, &size) == 0;
       if (!(flags & SOCK_THREAD_FD_EXCEPTION) || (ioctl_success && size)) {
-        /* FIONREAD return number of bytes that are immediately available for
-           reading, might be bigger than awaiting packet.
-
-           BluetoothSocket.write(...) guarantees that any packet send to this
-           socket is broken into pieces no bigger than MTU bytes (as requested
-           by BT spec). */
-        size = std::min(size, (int)sock->tx_mtu);
-
-        BT_HDR* buffer = malloc_l2cap_buf(size);
-        /* The socket is created with SOCK_SEQPACKET, hence we read one message
-         * at the time. */
-        ssize_t count;
-        OSI_NO_INTR(count = recv(fd, get_l2cap_sdu_start_ptr(buffer), size,
-                                 MSG_NOSIGNAL | MSG_DONTWAIT | MSG_TRUNC));
-        if (count > sock->tx_mtu) {
-          /* This can't happen thanks to check in BluetoothSocket.java but leave
-           * this in case this socket is ever used anywhere else*/
-          LOG(ERROR) << "recv more than MTU. Data will be lost: " << count;
-          count = sock->tx_mtu;
-        }
-
-        /* When multiple packets smaller than MTU are flushed to the socket, the
-           size of the single packet read could be smaller than the ioctl
-           reported total size of awaiting packets. Hence, we adjust the buffer
-           length. */
-        buffer->len = count;
-        DVLOG(2) << __func__ << ": bytes received from socket: " << count;
-
-        // will take care of freeing buffer
-        BTA_JvL2capWrite(sock->handle, PTR_TO_UINT(buffer), buffer, user_id);
+        read_app_packets_l(sock, user_id);
       }
     } else
       drop_it = true;
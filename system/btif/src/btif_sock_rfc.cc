@@ -22,6 +22,7 @@
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 #include <cstdint>
 #include <mutex>
 
@@ -801,10 +802,62 @@ static sent_status_t send_data_to_app(int fd, BT_HDR* p_buf) {
   return SENT_PARTIAL;
 }
 
+// Max number of queued buffers handed to the app in a single sendmsg()
+#define RFC_MAX_SEND_IOV 16
+
+// Sends as many queued buffers as fit in one sendmsg() and frees the ones
+// fully written. SENT_ALL means every gathered buffer went out, more may remain
+// queued.
+static sent_status_t send_queued_data_to_app(rfc_slot_t* slot) {
+  struct iovec iov[RFC_MAX_SEND_IOV];
+  int iov_count = 0;
+  size_t total = 0;
+
+  for (const list_node_t* node = list_begin(slot->incoming_queue);
+       node != list_end(slot->incoming_queue) && iov_count < RFC_MAX_SEND_IOV;
+       node = list_next(node)) {
+    BT_HDR* p_buf = (BT_HDR*)list_node(node);
+    iov[iov_count].iov_base = p_buf->data + p_buf->offset;
+    iov[iov_count].iov_len = p_buf->len;
+    total += p_buf->len;
+    iov_count++;
+  }
+
+  ssize_t sent = 0;
+  if (total) {
+    struct msghdr msg = {};
+    msg.msg_iov = iov;
+    msg.msg_iovlen = iov_count;
+    OSI_NO_INTR(sent = sendmsg(slot->fd, &msg, MSG_DONTWAIT));
+
+    if (sent == -1) {
+      if (errno == EAGAIN || errno == EWOULDBLOCK) return SENT_NONE;
+      LOG_ERROR("%s error writing RFCOMM data back to app: %s", __func__,
+                strerror(errno));
+      return SENT_FAILED;
+    }
+
+    if (sent == 0) return SENT_FAILED;
+  }
+
+  // Release what the app took, trimming the buffer written in part
+  size_t remaining = sent;
+  for (int i = 0; i < iov_count; i++) {
+    BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
+    if (p_buf->len > remaining) {
+      p_buf->offset += remaining;
+      p_buf->len -= remaining;
+      return SENT_PARTIAL;
+    }
+    remaining -= p_buf->len;
+    list_remove(slot->incoming_queue, p_buf);
+  }
+  return SENT_ALL;
+}
+
 static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
   while (!list_is_empty(slot->incoming_queue)) {
-    BT_HDR* p_buf = (BT_HDR*)list_front(slot->incoming_queue);
-    switch (send_data_to_app(slot->fd, p_buf)) {
+    switch (send_queued_data_to_app(slot)) {
       case SENT_NONE:
       case SENT_PARTIAL:
         // monitor the fd to get callback when app is ready to receive data
@@ -813,11 +866,9 @@ static bool flush_incoming_que_on_wr_signal(rfc_slot_t* slot) {
         return true;
 
       case SENT_ALL:
-        list_remove(slot->incoming_queue, p_buf);
         break;
 
       case SENT_FAILED:
-        list_remove(slot->incoming_queue, p_buf);
         return false;
     }
   }
@@ -947,3 +998,28 @@ int bta_co_rfc_data_outgoing(uint32_t id, uint8_t* buf, uint16_t size) {
 
   return true;
 }
+
+int bta_co_rfc_data_outgoing_iov(uint32_t id, struct iovec* iov, int count) {
+  std::unique_lock<std::recursive_mutex> lock(slot_lock);
+  rfc_slot_t* slot = find_rfc_slot_by_id(id);
+  if (!slot) return false;
+
+  size_t size = 0;
+  for (int i = 0; i < count; i++) size += iov[i].iov_len;
+
+  // One read for all the buffers of the batch
+  struct msghdr msg = {};
+  msg.msg_iov = iov;
+  msg.msg_iovlen = count;
+  ssize_t received;
+  OSI_NO_INTR(received = recvmsg(slot->fd, &msg, 0));
+
+  if (received != (ssize_t)size) {
+    LOG_ERROR("%s error receiving RFCOMM data from app: %s", __func__,
+              strerror(errno));
+    cleanup_rfc_slot(slot);
+    return false;
+  }
+
+  return true;
+}
@@ -33,13 +33,12 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <features.h>
-#include <poll.h>
 #include <pthread.h>
 #include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/select.h>
+#include <sys/epoll.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 #include <sys/un.h>
@@ -49,6 +48,8 @@
 #include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "bta_api.h"
 #include "btif_common.h"
@@ -65,11 +66,14 @@
   } while (0)
 
 #define MAX_THREAD 8
-#define MAX_POLL 64
-#define POLL_EXCEPTION_EVENTS (POLLHUP | POLLRDHUP | POLLERR | POLLNVAL)
+#define MAX_EPOLL_EVENTS 64
+/* epoll drops a closed fd without reporting it, where poll() reported
+ * POLLNVAL. The slots are checked for closed fds at most this often. */
+#define CLOSED_FD_CHECK_MS 1000
+#define POLL_EXCEPTION_EVENTS (EPOLLHUP | EPOLLRDHUP | EPOLLERR)
 #define IS_EXCEPTION(e) ((e)&POLL_EXCEPTION_EVENTS)
-#define IS_READ(e) ((e)&POLLIN)
-#define IS_WRITE(e) ((e)&POLLOUT)
+#define IS_READ(e) ((e)&EPOLLIN)
+#define IS_WRITE(e) ((e)&EPOLLOUT)
 /*cmd executes in socket poll thread */
 #define CMD_WAKEUP 1
 #define CMD_EXIT 2
@@ -77,21 +81,25 @@
 #define CMD_REMOVE_FD 4
 #define CMD_USER_PRIVATE 5
 
+/* Data sockets are registered edge-triggered and one-shot: once an event is
+ * reported for a fd, epoll disarms it until add_poll() or remove_poll() arms
+ * it again with the monitor flags still outstanding. */
 struct poll_slot_t {
-  struct pollfd pfd;
   uint32_t user_id;
   int type;
   int flags;
 };
 struct thread_slot_t {
   int cmd_fdr, cmd_fdw;
-  int poll_count;
-  poll_slot_t ps[MAX_POLL];
-  int psi[MAX_POLL];  // index of poll slot
+  int epoll_fd;
+  // Only accessed from the socket poll thread, keyed by data socket fd
+  std::unordered_map<int, poll_slot_t> ps;
   std::optional<pthread_t> thread_id;
   btsock_signaled_cb callback;
   btsock_cmd_cb cmd_callback;
   int used;
+  // Only accessed from the socket poll thread
+  struct timespec last_closed_fd_check;
 };
 static thread_slot_t ts[MAX_THREAD];
 
@@ -145,6 +153,11 @@ static int alloc_thread_slot() {
 static void free_thread_slot(int h) {
   if (0 <= h && h < MAX_THREAD) {
     close_cmd_fd(h);
+    if (ts[h].epoll_fd != -1) {
+      close(ts[h].epoll_fd);
+      ts[h].epoll_fd = -1;
+    }
+    ts[h].ps.clear();
     ts[h].used = 0;
   } else
     APPL_TRACE_ERROR("invalid thread handle:%d", h);
@@ -156,9 +169,9 @@ void btsock_thread_init() {
     int h;
     for (h = 0; h < MAX_THREAD; h++) {
       ts[h].cmd_fdr = ts[h].cmd_fdw = -1;
+      ts[h].epoll_fd = -1;
       ts[h].used = 0;
       ts[h].thread_id = std::nullopt;
-      ts[h].poll_count = 0;
       ts[h].callback = NULL;
       ts[h].cmd_callback = NULL;
     }
@@ -192,8 +205,12 @@ static inline void init_cmd_fd(int h) {
     APPL_TRACE_ERROR("socketpair failed: %s", strerror(errno));
     return;
   }
-  // add the cmd fd for read & write
-  add_poll(h, ts[h].cmd_fdr, 0, SOCK_THREAD_FD_RD, 0);
+  // the cmd fd stays level-triggered so queued commands are never missed
+  struct epoll_event event = {};
+  event.events = EPOLLIN;
+  event.data.fd = ts[h].cmd_fdr;
+  if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, ts[h].cmd_fdr, &event) == -1)
+    APPL_TRACE_ERROR("epoll_ctl for cmd fd failed: %s", strerror(errno));
 }
 static inline void close_cmd_fd(int h) {
   if (ts[h].cmd_fdr != -1) {
@@ -332,73 +349,109 @@ int btsock_thread_exit(int h) {
   return false;
 }
 static void init_poll(int h) {
-  int i;
-  ts[h].poll_count = 0;
+  ts[h].ps.clear();
   ts[h].thread_id = std::nullopt;
   ts[h].callback = NULL;
   ts[h].cmd_callback = NULL;
-  for (i = 0; i < MAX_POLL; i++) {
-    ts[h].ps[i].pfd.fd = -1;
-    ts[h].psi[i] = -1;
+  clock_gettime(CLOCK_MONOTONIC, &ts[h].last_closed_fd_check);
+  ts[h].epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (ts[h].epoll_fd == -1) {
+    APPL_TRACE_ERROR("epoll_create1 failed: %s", strerror(errno));
+    return;
   }
   init_cmd_fd(h);
 }
-static inline unsigned int flags2pevents(int flags) {
-  unsigned int pevents = 0;
-  if (flags & SOCK_THREAD_FD_WR) pevents |= POLLOUT;
-  if (flags & SOCK_THREAD_FD_RD) pevents |= POLLIN;
+static inline uint32_t flags2pevents(int flags) {
+  uint32_t pevents = EPOLLET | EPOLLONESHOT;
+  if (flags & SOCK_THREAD_FD_WR) pevents |= EPOLLOUT;
+  if (flags & SOCK_THREAD_FD_RD) pevents |= EPOLLIN;
   pevents |= POLL_EXCEPTION_EVENTS;
   return pevents;
 }
 
-static inline void set_poll(poll_slot_t* ps, int fd, int type, int flags,
-                            uint32_t user_id) {
-  ps->pfd.fd = fd;
-  ps->user_id = user_id;
-  if (ps->type != 0 && ps->type != type)
-    APPL_TRACE_ERROR(
-        "poll socket type should not changed! type was:%d, type now:%d",
-        ps->type, type);
-  ps->type = type;
-  ps->flags = flags;
-  ps->pfd.events = flags2pevents(flags);
-  ps->pfd.revents = 0;
+/* remove the slot of a closed fd and signal it as an exception, as poll()
+ * did with POLLNVAL, so that its owner cleans up */
+static void signal_closed_fd(int h, int fd) {
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) return;
+  uint32_t user_id = it->second.user_id;
+  int type = it->second.type;
+  ts[h].ps.erase(it);
+  LOG_WARN("fd:%d closed while monitored, user_id:%u", fd, user_id);
+  ts[h].callback(fd, type, SOCK_THREAD_FD_EXCEPTION, user_id);
+}
+
+/* (re)arm fd in the epoll set of thread h for the given monitor flags */
+static inline void arm_poll(int h, int fd, int flags) {
+  struct epoll_event event = {};
+  event.events = flags2pevents(flags);
+  event.data.fd = fd;
+  // a disarmed fd stays registered until it is closed, so try MOD first
+  if (epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_MOD, fd, &event) == 0) return;
+  if (errno == ENOENT &&
+      epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0)
+    return;
+  if (errno == EBADF) {
+    // signaled by the next check, rather than from within the owner's call
+    ts[h].last_closed_fd_check = {};
+    return;
+  }
+  APPL_TRACE_ERROR("epoll_ctl failed for fd:%d, err:%s", fd, strerror(errno));
 }
+
+static inline int64_t elapsed_ms(const struct timespec& from,
+                                 const struct timespec& to) {
+  return (to.tv_sec - from.tv_sec) * 1000 +
+         (to.tv_nsec - from.tv_nsec) / 1000000;
+}
+
+/* signal the slots whose fd was closed without being removed. Bounded to one
+ * pass every CLOSED_FD_CHECK_MS, as it costs a system call per slot. */
+static void check_closed_fds(int h) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  if (elapsed_ms(ts[h].last_closed_fd_check, now) < CLOSED_FD_CHECK_MS) return;
+  ts[h].last_closed_fd_check = now;
+  std::vector<int> closed_fds;
+  for (const auto& slot : ts[h].ps) {
+    if (fcntl(slot.first, F_GETFD) == -1 && errno == EBADF)
+      closed_fds.push_back(slot.first);
+  }
+  for (int fd : closed_fds) signal_closed_fd(h, fd);
+}
+
 static inline void add_poll(int h, int fd, int type, int flags,
                             uint32_t user_id) {
   asrt(fd != -1);
-  int i;
-  int empty = -1;
-  poll_slot_t* ps = ts[h].ps;
-
-  for (i = 0; i < MAX_POLL; i++) {
-    if (ps[i].pfd.fd == fd) {
-      asrt(ts[h].poll_count < MAX_POLL);
-
-      set_poll(&ps[i], fd, type, flags | ps[i].flags, user_id);
-      return;
-    } else if (empty < 0 && ps[i].pfd.fd == -1)
-      empty = i;
-  }
-  if (empty >= 0) {
-    asrt(ts[h].poll_count < MAX_POLL);
-    set_poll(&ps[empty], fd, type, flags, user_id);
-    ++ts[h].poll_count;
-    return;
+  flags &= ~SOCK_THREAD_ADD_FD_SYNC;
+
+  auto it = ts[h].ps.find(fd);
+  if (it != ts[h].ps.end()) {
+    if (it->second.type != 0 && it->second.type != type)
+      APPL_TRACE_ERROR(
+          "poll socket type should not changed! type was:%d, type now:%d",
+          it->second.type, type);
+    flags |= it->second.flags;
   }
-  APPL_TRACE_ERROR("exceeded max poll slot:%d!", MAX_POLL);
+  poll_slot_t& slot = ts[h].ps[fd];
+  slot.user_id = user_id;
+  slot.type = type;
+  slot.flags = flags;
+  arm_poll(h, fd, flags);
 }
-static inline void remove_poll(int h, poll_slot_t* ps, int flags) {
-  if (flags == ps->flags) {
-    // all monitored events signaled. To remove it, just clear the slot
-    --ts[h].poll_count;
-    memset(ps, 0, sizeof(*ps));
-    ps->pfd.fd = -1;
+static inline void remove_poll(int h, int fd, int flags) {
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) return;
+
+  if (flags == it->second.flags) {
+    // all monitored events signaled. To remove it, just clear the slot; the
+    // fd is left disarmed in the epoll set
+    ts[h].ps.erase(it);
   } else {
     // one read or one write monitor event signaled, removed the accordding bit
-    ps->flags &= ~flags;
-    // update the poll events mask
-    ps->pfd.events = flags2pevents(ps->flags);
+    it->second.flags &= ~flags;
+    // rearm with the remaining monitor flags
+    arm_poll(h, fd, it->second.flags);
   }
 }
 static int process_cmd_sock(int h) {
@@ -417,13 +470,8 @@ static int process_cmd_sock(int h) {
       add_poll(h, cmd.fd, cmd.type, cmd.flags, cmd.user_id);
       break;
     case CMD_REMOVE_FD:
-      for (int i = 1; i < MAX_POLL; ++i) {
-        poll_slot_t* poll_slot = &ts[h].ps[i];
-        if (poll_slot->pfd.fd == cmd.fd) {
-          remove_poll(h, poll_slot, poll_slot->flags);
-          break;
-        }
-      }
+      ts[h].ps.erase(cmd.fd);
+      epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, cmd.fd, NULL);
       close(cmd.fd);
       break;
     case CMD_WAKEUP:
@@ -442,94 +490,67 @@ static int process_cmd_sock(int h) {
   return true;
 }
 
-static void process_data_sock(int h, struct pollfd* pfds, int pfds_count,
-                              int event_count) {
-  asrt(event_count <= pfds_count);
-  int i;
-  for (i = 1; i < pfds_count; i++) {
-    if (pfds[i].revents) {
-      int ps_i = ts[h].psi[i];
-      if (ts[h].ps[ps_i].pfd.fd == -1) {
-        LOG_INFO("Socket has been removed from poll set");
-        continue;
-      }
-      asrt(pfds[i].fd == ts[h].ps[ps_i].pfd.fd);
-      uint32_t user_id = ts[h].ps[ps_i].user_id;
-      int type = ts[h].ps[ps_i].type;
-      int flags = 0;
-      if (IS_READ(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_RD;
-      }
-      if (IS_WRITE(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_WR;
-      }
-      if (IS_EXCEPTION(pfds[i].revents)) {
-        flags |= SOCK_THREAD_FD_EXCEPTION;
-        // remove the whole slot not flags
-        remove_poll(h, &ts[h].ps[ps_i], ts[h].ps[ps_i].flags);
-      } else if (flags)
-        remove_poll(h, &ts[h].ps[ps_i],
-                    flags);  // remove the monitor flags that already processed
-      if (flags) ts[h].callback(pfds[i].fd, type, flags, user_id);
-    }
+static void process_data_sock(int h, int fd, uint32_t events) {
+  auto it = ts[h].ps.find(fd);
+  if (it == ts[h].ps.end()) {
+    LOG_INFO("Socket has been removed from poll set");
+    return;
   }
-}
-
-static void prepare_poll_fds(int h, struct pollfd* pfds) {
-  int count = 0;
-  int ps_i = 0;
-  int pfd_i = 0;
-  asrt(ts[h].poll_count <= MAX_POLL);
-  memset(pfds, 0, sizeof(pfds[0]) * ts[h].poll_count);
-  while (count < ts[h].poll_count) {
-    if (ps_i >= MAX_POLL) {
-      APPL_TRACE_ERROR(
-          "exceed max poll range, ps_i:%d, MAX_POLL:%d, count:%d, "
-          "ts[h].poll_count:%d",
-          ps_i, MAX_POLL, count, ts[h].poll_count);
-      return;
-    }
-    if (ts[h].ps[ps_i].pfd.fd >= 0) {
-      pfds[pfd_i] = ts[h].ps[ps_i].pfd;
-      ts[h].psi[pfd_i] = ps_i;
-      count++;
-      pfd_i++;
-    }
-    ps_i++;
+  uint32_t user_id = it->second.user_id;
+  int type = it->second.type;
+  int flags = 0;
+  if (IS_READ(events)) {
+    flags |= SOCK_THREAD_FD_RD;
+  }
+  if (IS_WRITE(events)) {
+    flags |= SOCK_THREAD_FD_WR;
   }
+  if (IS_EXCEPTION(events)) {
+    flags |= SOCK_THREAD_FD_EXCEPTION;
+    // remove the whole slot not flags
+    ts[h].ps.erase(it);
+    epoll_ctl(ts[h].epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+  } else if (flags)
+    remove_poll(h, fd, flags);  // remove the monitor flags already processed
+  if (flags) ts[h].callback(fd, type, flags, user_id);
 }
+
 static void* sock_poll_thread(void* arg) {
-  struct pollfd pfds[MAX_POLL];
-  memset(pfds, 0, sizeof(pfds));
+  struct epoll_event events[MAX_EPOLL_EVENTS];
   int h = (intptr_t)arg;
   for (;;) {
-    prepare_poll_fds(h, pfds);
     int ret;
-    OSI_NO_INTR(ret = poll(pfds, ts[h].poll_count, -1));
+    // wake up to check for closed fds only while some are monitored
+    int timeout = ts[h].ps.empty() ? -1 : CLOSED_FD_CHECK_MS;
+    OSI_NO_INTR(ret = epoll_wait(ts[h].epoll_fd, events, MAX_EPOLL_EVENTS,
+                                 timeout));
     if (ret == -1) {
-      APPL_TRACE_ERROR("poll ret -1, exit the thread, errno:%d, err:%s", errno,
-                       strerror(errno));
+      APPL_TRACE_ERROR("epoll_wait ret -1, exit the thread, errno:%d, err:%s",
+                       errno, strerror(errno));
       break;
     }
-    if (ret != 0) {
-      int need_process_data_fd = true;
-      int pfds_count = ts[h].poll_count;
-      if (pfds[0].revents)  // cmd fd always is the first one
-      {
-        asrt(pfds[0].fd == ts[h].cmd_fdr);
-        if (!process_cmd_sock(h)) {
-          LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
-          break;
-        }
-        if (ret == 1)
-          need_process_data_fd = false;
-        else
-          ret--;  // exclude the cmd fd
+    if (ret == 0) {
+      check_closed_fds(h);
+      continue;
+    }
+    // handle one command ahead of the data sockets, as it may remove some of
+    // them. The cmd fd stays readable until every queued command is consumed.
+    bool exit_thread = false;
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd != ts[h].cmd_fdr) continue;
+      if (!process_cmd_sock(h)) {
+        LOG_INFO("h:%d, process_cmd_sock return false, exit...", h);
+        exit_thread = true;
       }
-      if (need_process_data_fd) process_data_sock(h, pfds, pfds_count, ret);
-    } else {
-      LOG_INFO("no data, select ret: %d", ret);
-    };
+      break;
+    }
+    if (exit_thread) break;
+
+    for (int i = 0; i < ret; i++) {
+      if (events[i].data.fd == ts[h].cmd_fdr) continue;
+      process_data_sock(h, events[i].data.fd, events[i].events);
+    }
+    check_closed_fds(h);
   }
   LOG_INFO("socket poll thread exiting, h:%d", h);
   return 0;
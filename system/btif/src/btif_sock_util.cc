@@ -78,6 +78,39 @@ int sock_recv_all(int sock_fd, uint8_t* buf, int len) {
   return len;
 }
 
+int sock_send_packets(int sock_fd, struct iovec* iov, int count,
+                      size_t* sent_lens) {
+  struct mmsghdr msgs[SOCK_MAX_PACKET_BATCH];
+  if (count > SOCK_MAX_PACKET_BATCH) count = SOCK_MAX_PACKET_BATCH;
+  memset(msgs, 0, count * sizeof(msgs[0]));
+  for (int i = 0; i < count; i++) {
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int sent;
+  OSI_NO_INTR(sent = sendmmsg(sock_fd, msgs, count, MSG_DONTWAIT));
+  for (int i = 0; i < sent; i++) sent_lens[i] = msgs[i].msg_len;
+  return sent;
+}
+
+int sock_recv_packets(int sock_fd, struct iovec* iov, int count, size_t* lens) {
+  struct mmsghdr msgs[SOCK_MAX_PACKET_BATCH];
+  if (count > SOCK_MAX_PACKET_BATCH) count = SOCK_MAX_PACKET_BATCH;
+  memset(msgs, 0, count * sizeof(msgs[0]));
+  for (int i = 0; i < count; i++) {
+    msgs[i].msg_hdr.msg_iov = &iov[i];
+    msgs[i].msg_hdr.msg_iovlen = 1;
+  }
+
+  int received;
+  OSI_NO_INTR(received = recvmmsg(sock_fd, msgs, count,
+                                  MSG_NOSIGNAL | MSG_DONTWAIT | MSG_TRUNC,
+                                  NULL));
+  for (int i = 0; i < received; i++) lens[i] = msgs[i].msg_len;
+  return received;
+}
+
 int sock_send_fd(int sock_fd, const uint8_t* buf, int len, int send_fd) {
   struct msghdr msg;
   unsigned char* buffer = (unsigned char*)buf;
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_sock_thread.h"
+
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <vector>
+
+#include "internal_include/bt_trace.h"
+
+uint8_t appl_trace_level = BT_TRACE_LEVEL_WARNING;
+
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+// Well above the 64 poll slots per thread the poll() based loop allowed
+constexpr int kNumSockets = 256;
+constexpr auto kTimeout = std::chrono::seconds(5);
+
+std::mutex signaled_mutex;
+std::condition_variable signaled_cv;
+std::map<uint32_t, int> signaled_flags;
+int signaled_count = 0;
+
+void signaled_cb(int fd, int type, int flags, uint32_t user_id) {
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  signaled_flags[user_id] |= flags;
+  signaled_count++;
+  signaled_cv.notify_all();
+}
+
+bool WaitForSignals(int count) {
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  return signaled_cv.wait_for(lock, kTimeout,
+                              [count] { return signaled_count >= count; });
+}
+
+}  // namespace
+
+class BtifSockThreadTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    signaled_flags.clear();
+    signaled_count = 0;
+
+    btsock_thread_init();
+    handle_ = btsock_thread_create(signaled_cb, NULL);
+    ASSERT_GE(handle_, 0);
+
+    for (int i = 0; i < kNumSockets; i++) {
+      int fds[2];
+      ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+      our_fds_.push_back(fds[0]);
+      app_fds_.push_back(fds[1]);
+    }
+  }
+
+  void TearDown() override {
+    btsock_thread_exit(handle_);
+    for (int fd : our_fds_) close(fd);
+    for (int fd : app_fds_) close(fd);
+  }
+
+  int handle_ = -1;
+  std::vector<int> our_fds_;
+  std::vector<int> app_fds_;
+};
+
+TEST_F(BtifSockThreadTest, read_signaled_on_every_socket) {
+  // Every socket is idle while being added, so all of them have to be
+  // monitored at the same time
+  for (int i = 1; i < kNumSockets; i++) {
+    ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[i], BTSOCK_RFCOMM,
+                                     SOCK_THREAD_FD_RD, i));
+  }
+  // Commands run in order, once this one fires the others are all monitored
+  ASSERT_EQ(1, write(app_fds_[0], "x", 1));
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[0], BTSOCK_RFCOMM,
+                                   SOCK_THREAD_FD_RD, 0));
+  ASSERT_TRUE(WaitForSignals(1));
+
+  for (int i = 1; i < kNumSockets; i++) {
+    ASSERT_EQ(1, write(app_fds_[i], "x", 1));
+  }
+
+  ASSERT_TRUE(WaitForSignals(kNumSockets));
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  ASSERT_EQ(kNumSockets, signaled_count);
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_EQ(SOCK_THREAD_FD_RD, signaled_flags[i]);
+  }
+}
+
+TEST_F(BtifSockThreadTest, rearm_signals_pending_data) {
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_EQ(1, write(app_fds_[i], "x", 1));
+    ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[i], BTSOCK_RFCOMM,
+                                     SOCK_THREAD_FD_RD, i));
+  }
+  ASSERT_TRUE(WaitForSignals(kNumSockets));
+
+  // Nothing was read, so adding the fds again reports the same data again
+  for (int i = 0; i < kNumSockets; i++) {
+    ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[i], BTSOCK_RFCOMM,
+                                     SOCK_THREAD_FD_RD, i));
+  }
+  ASSERT_TRUE(WaitForSignals(2 * kNumSockets));
+}
+
+TEST_F(BtifSockThreadTest, exception_signaled_on_peer_close) {
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[0], BTSOCK_L2CAP,
+                                   SOCK_THREAD_FD_RD | SOCK_THREAD_FD_WR, 7));
+  ASSERT_TRUE(WaitForSignals(1));
+  {
+    // The socket is writable right away, read stays armed
+    std::unique_lock<std::mutex> lock(signaled_mutex);
+    ASSERT_EQ(SOCK_THREAD_FD_WR, signaled_flags[7]);
+  }
+
+  close(app_fds_[0]);
+  app_fds_[0] = -1;
+  ASSERT_TRUE(WaitForSignals(2));
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  ASSERT_TRUE(signaled_flags[7] & SOCK_THREAD_FD_EXCEPTION);
+}
+
+TEST_F(BtifSockThreadTest, remove_fd_and_close) {
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[0], BTSOCK_RFCOMM,
+                                   SOCK_THREAD_FD_RD, 0));
+  ASSERT_TRUE(btsock_thread_remove_fd_and_close(handle_, our_fds_[0]));
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[1], BTSOCK_RFCOMM,
+                                   SOCK_THREAD_FD_RD, 1));
+  ASSERT_EQ(1, write(app_fds_[1], "x", 1));
+
+  // Commands run in order, so the first socket is gone once the second fires
+  ASSERT_TRUE(WaitForSignals(1));
+  ASSERT_EQ(-1, fcntl(our_fds_[0], F_GETFD));
+  our_fds_[0] = -1;
+
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  ASSERT_EQ(1, signaled_count);
+  ASSERT_EQ(SOCK_THREAD_FD_RD, signaled_flags[1]);
+}
+
+TEST_F(BtifSockThreadTest, exception_signaled_on_close_while_monitored) {
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[0], BTSOCK_RFCOMM,
+                                   SOCK_THREAD_FD_RD, 3));
+  ASSERT_TRUE(btsock_thread_add_fd(handle_, our_fds_[1], BTSOCK_RFCOMM,
+                                   SOCK_THREAD_FD_RD, 4));
+  // Closed by its owner without being removed, which epoll does not report
+  close(our_fds_[0]);
+  our_fds_[0] = -1;
+
+  ASSERT_TRUE(WaitForSignals(1));
+  std::unique_lock<std::mutex> lock(signaled_mutex);
+  ASSERT_EQ(1, signaled_count);
+  ASSERT_EQ(SOCK_THREAD_FD_EXCEPTION, signaled_flags[3]);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btif/include/btif_sock_util.h"
+
+#include <errno.h>
+#include <gtest/gtest.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "internal_include/bt_trace.h"
+
+uint8_t btif_trace_level = BT_TRACE_LEVEL_WARNING;
+
+void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+constexpr size_t kPacketSize = 1000;
+
+std::vector<uint8_t> MakePacket(uint8_t tag, size_t size = kPacketSize) {
+  return std::vector<uint8_t>(size, tag);
+}
+
+}  // namespace
+
+class BtifSockUtilTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    int fds[2];
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_SEQPACKET, 0, fds));
+    our_fd_ = fds[0];
+    app_fd_ = fds[1];
+  }
+
+  void TearDown() override {
+    close(our_fd_);
+    close(app_fd_);
+  }
+
+  int our_fd_ = -1;
+  int app_fd_ = -1;
+};
+
+TEST_F(BtifSockUtilTest, send_packets_keeps_boundaries) {
+  std::vector<std::vector<uint8_t>> packets = {MakePacket(1, 10),
+                                               MakePacket(2, 20),
+                                               MakePacket(3, 30)};
+  struct iovec iov[3];
+  size_t sent_lens[3];
+  for (int i = 0; i < 3; i++) {
+    iov[i].iov_base = packets[i].data();
+    iov[i].iov_len = packets[i].size();
+  }
+  ASSERT_EQ(3, sock_send_packets(our_fd_, iov, 3, sent_lens));
+
+  for (int i = 0; i < 3; i++) {
+    uint8_t buf[100];
+    ASSERT_EQ((ssize_t)packets[i].size(), recv(app_fd_, buf, sizeof(buf), 0));
+    ASSERT_EQ(i + 1, buf[0]);
+  }
+}
+
+TEST_F(BtifSockUtilTest, send_packets_partial_batch_then_eagain) {
+  int sndbuf = 4 * kPacketSize;
+  ASSERT_EQ(0, setsockopt(our_fd_, SOL_SOCKET, SO_SNDBUF, &sndbuf,
+                          sizeof(sndbuf)));
+
+  std::vector<std::vector<uint8_t>> packets;
+  for (int i = 0; i < SOCK_MAX_PACKET_BATCH; i++) packets.push_back(MakePacket(i));
+  struct iovec iov[SOCK_MAX_PACKET_BATCH];
+  size_t sent_lens[SOCK_MAX_PACKET_BATCH];
+  for (int i = 0; i < SOCK_MAX_PACKET_BATCH; i++) {
+    iov[i].iov_base = packets[i].data();
+    iov[i].iov_len = packets[i].size();
+  }
+
+  // The socket takes part of the batch
+  int sent = sock_send_packets(our_fd_, iov, SOCK_MAX_PACKET_BATCH, sent_lens);
+  ASSERT_GT(sent, 0);
+  ASSERT_LT(sent, SOCK_MAX_PACKET_BATCH);
+  for (int i = 0; i < sent; i++) ASSERT_EQ(kPacketSize, sent_lens[i]);
+
+  // Then none of the rest, without blocking
+  ASSERT_EQ(-1, sock_send_packets(our_fd_, &iov[sent],
+                                  SOCK_MAX_PACKET_BATCH - sent, sent_lens));
+  ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+
+  // Once the app reads, the rest goes out, in order
+  uint8_t buf[kPacketSize];
+  ASSERT_EQ((ssize_t)kPacketSize, recv(app_fd_, buf, sizeof(buf), 0));
+  ASSERT_EQ(0, buf[0]);
+  ASSERT_GT(sock_send_packets(our_fd_, &iov[sent],
+                              SOCK_MAX_PACKET_BATCH - sent, sent_lens),
+            0);
+  for (int i = 1; i <= sent; i++) {
+    ASSERT_EQ((ssize_t)kPacketSize, recv(app_fd_, buf, sizeof(buf), 0));
+    ASSERT_EQ(i, buf[0]);
+  }
+}
+
+TEST_F(BtifSockUtilTest, recv_packets_eagain_when_empty) {
+  uint8_t buf[kPacketSize];
+  struct iovec iov = {buf, sizeof(buf)};
+  size_t len;
+  ASSERT_EQ(-1, sock_recv_packets(our_fd_, &iov, 1, &len));
+  ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+TEST_F(BtifSockUtilTest, recv_packets_one_per_buffer) {
+  for (uint8_t i = 0; i < 3; i++) {
+    std::vector<uint8_t> packet = MakePacket(i, 100 + i);
+    ASSERT_EQ((ssize_t)packet.size(),
+              send(app_fd_, packet.data(), packet.size(), 0));
+  }
+
+  std::vector<std::vector<uint8_t>> bufs(4, std::vector<uint8_t>(kPacketSize));
+  struct iovec iov[4];
+  size_t lens[4];
+  for (int i = 0; i < 4; i++) {
+    iov[i].iov_base = bufs[i].data();
+    iov[i].iov_len = bufs[i].size();
+  }
+
+  // Returns what is there rather than waiting for the fourth packet
+  ASSERT_EQ(3, sock_recv_packets(our_fd_, iov, 4, lens));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ(100u + i, lens[i]);
+    ASSERT_EQ(i, bufs[i][0]);
+  }
+}
+
+TEST_F(BtifSockUtilTest, recv_packets_reports_truncated_length) {
+  std::vector<uint8_t> packet = MakePacket(7, 2 * kPacketSize);
+  ASSERT_EQ((ssize_t)packet.size(),
+            send(app_fd_, packet.data(), packet.size(), 0));
+
+  uint8_t buf[kPacketSize];
+  struct iovec iov = {buf, sizeof(buf)};
+  size_t len;
+  ASSERT_EQ(1, sock_recv_packets(our_fd_, &iov, 1, &len));
+  ASSERT_EQ(2 * kPacketSize, len);
+  ASSERT_EQ(7, buf[0]);
+}
@@ -22,6 +22,7 @@
 #include <future>
 #include <memory>
 #include <thread>
+#include <vector>
 
 #include "abstract_message_loop.h"
 #include "common/message_loop_thread.h"
@@ -32,6 +33,7 @@ using ::benchmark::State;
 using bluetooth::common::MessageLoopThread;
 
 #define NUM_MESSAGES_TO_SEND 100000
+#define NUM_PRODUCER_THREADS 4
 
 volatile static int g_counter = 0;
 static std::unique_ptr<std::promise<void>> g_counter_promise = nullptr;
@@ -307,6 +309,28 @@ BENCHMARK_F(BM_OsiReactorThread, batch_enque_dequeue_using_reactor)
   }
 };
 
+BENCHMARK_F(BM_OsiReactorThread,
+            batch_enque_dequeue_from_producers_using_reactor)
+(State& state) {
+  fixed_queue_register_dequeue(bt_msg_queue_, thread_get_reactor(thread_),
+                               callback_batch, nullptr);
+  for (auto _ : state) {
+    g_counter = 0;
+    g_counter_promise = std::make_unique<std::promise<void>>();
+    std::future<void> counter_future = g_counter_promise->get_future();
+    std::vector<std::thread> producers;
+    for (int i = 0; i < NUM_PRODUCER_THREADS; i++) {
+      producers.emplace_back([this]() {
+        for (int j = 0; j < NUM_MESSAGES_TO_SEND / NUM_PRODUCER_THREADS; j++) {
+          fixed_queue_enqueue(bt_msg_queue_, (void*)&g_counter);
+        }
+      });
+    }
+    for (auto& producer : producers) producer.join();
+    counter_future.wait();
+  }
+};
+
 BENCHMARK_F(BM_OsiReactorThread, sequential_execution_using_reactor)
 (State& state) {
   fixed_queue_register_dequeue(bt_msg_queue_, thread_get_reactor(thread_),
@@ -321,6 +345,22 @@ BENCHMARK_F(BM_OsiReactorThread, sequential_execution_using_reactor)
   }
 };
 
+// Queue operations alone, without any thread hop
+void BM_FixedQueueEnqueueDequeue(State& state) {
+  fixed_queue_t* queue = fixed_queue_new(SIZE_MAX);
+  for (auto _ : state) {
+    for (int i = 0; i < state.range(0); i++) {
+      fixed_queue_enqueue(queue, (void*)&g_counter);
+    }
+    for (int i = 0; i < state.range(0); i++) {
+      benchmark::DoNotOptimize(fixed_queue_try_dequeue(queue));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  fixed_queue_free(queue, nullptr);
+}
+BENCHMARK(BM_FixedQueueEnqueueDequeue)->Arg(1)->Arg(64);
+
 class BM_MessageLooopThread : public BM_ThreadPerformance {
  protected:
   void SetUp(State& st) override {
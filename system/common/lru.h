@@ -86,6 +86,22 @@ class LegacyLruCache {
     return &(map_iterator->second->second);
   }
 
+  /**
+   * Same as Find, but leave the key where it is in the cache
+   *
+   * @param key
+   * @return pointer to the underlying value to allow in-place modification
+   * nullptr when not found, will be invalidated when the key is evicted
+   */
+  V* Peek(const K& key) {
+    std::lock_guard<std::recursive_mutex> lock(lru_mutex_);
+    auto map_iterator = lru_map_.find(key);
+    if (map_iterator == lru_map_.end()) {
+      return nullptr;
+    }
+    return &(map_iterator->second->second);
+  }
+
   /**
    * Get the value of a key, and move the key to the head of cache, if there is
    * one
@@ -143,6 +143,20 @@ TEST(BluetoothLegacyLruCacheTest, LegacyLruCacheFindTest) {
   EXPECT_EQ(cache.Find(10), nullptr);
 }
 
+TEST(BluetoothLegacyLruCacheTest, LegacyLruCachePeekTest) {
+  LegacyLruCache<int, int> cache(2, "testing");
+  cache.Put(1, 10);
+  cache.Put(2, 20);
+  auto value_ptr = cache.Peek(1);
+  EXPECT_NE(value_ptr, nullptr);
+  EXPECT_EQ(*value_ptr, 10);
+  EXPECT_EQ(cache.Peek(3), nullptr);
+  // Peek does not warm up the key, so it is still the one evicted
+  auto evicted = cache.Put(3, 30);
+  EXPECT_TRUE(evicted.has_value());
+  EXPECT_EQ(evicted->first, 1);
+}
+
 TEST(BluetoothLegacyLruCacheTest, LegacyLruCacheGetTest) {
   LegacyLruCache<int, int> cache(10, "testing");
   cache.Put(1, 10);
@@ -19,16 +19,20 @@
 #include "btaa/activity_attribution.h"
 #include "activity_attribution_generated.h"
 
+#include <algorithm>
+#include <atomic>
 #include <aidl/android/system/suspend/BnSuspendCallback.h>
 #include <aidl/android/system/suspend/BnWakelockCallback.h>
 #include <aidl/android/system/suspend/ISuspendControlService.h>
 #include <android/binder_manager.h>
 
 #include "btaa/attribution_processor.h"
+#include "btaa/hci_capture_buffer.h"
 #include "btaa/hci_processor.h"
 #include "btaa/wakelock_processor.h"
 #include "module.h"
 #include "os/log.h"
+#include "os/alarm.h"
 
 using aidl::android::system::suspend::BnSuspendCallback;
 using aidl::android::system::suspend::BnWakelockCallback;
@@ -45,6 +49,10 @@ const ModuleFactory ActivityAttribution::Factory = ModuleFactory([]() { return n
 static const std::string kBtWakelockName("hal_bluetooth_lock");
 static const std::string kBtWakeupReason("hs_uart_wakeup");
 static const size_t kHciAclHeaderSize = 4;
+// Packets are captured on the HAL threads and attributed on the module handler in batches, at most this delay after
+// the first packet of a batch. The ring covers several delays of a busy link.
+static const size_t kHciCaptureBufferSize = 1024;
+static constexpr std::chrono::milliseconds kHciCaptureDrainDelay = std::chrono::milliseconds(100);
 
 static std::mutex g_module_mutex;
 static ActivityAttribution* g_module = nullptr;
@@ -92,7 +100,7 @@ struct wakeup_callback : public BnSuspendCallback {
 static std::shared_ptr<wakeup_callback> g_wakeup_callback = nullptr;
 
 struct ActivityAttribution::impl {
-  impl(ActivityAttribution* module) {
+  impl(ActivityAttribution* module) : drain_alarm_(module->GetHandler()) {
     std::lock_guard<std::mutex> guard(g_module_mutex);
     g_module = module;
     if (is_wakeup_callback_registered && is_wakelock_callback_registered) {
@@ -136,8 +144,34 @@ struct ActivityAttribution::impl {
     g_module = nullptr;
   }
 
-  void on_hci_packet(hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length) {
-    attribution_processor_.OnBtaaPackets(std::move(hci_processor_.OnHciPacket(std::move(packet), type, length)));
+  // Called on the HAL threads for every packet, must not block. Only the first packet of a batch arms the alarm, so
+  // an idle link keeps the handler asleep.
+  void on_hci_packet(const hal::HciPacket& packet, hal::SnoopLogger::PacketType type, size_t capture_length) {
+    hci_capture_buffer_.Push(type, packet.data(), capture_length, packet.size());
+    if (!drain_scheduled_.exchange(true)) {
+      drain_alarm_.Schedule(common::BindOnce(&impl::on_drain_alarm, common::Unretained(this)), kHciCaptureDrainDelay);
+    }
+  }
+
+  void on_drain_alarm() {
+    // Cleared first, so that a packet pushed while draining arms the alarm again
+    drain_scheduled_ = false;
+    drain_hci_captures();
+  }
+
+  void drain_hci_captures() {
+    for (const HciCapture* capture = hci_capture_buffer_.Front(); capture != nullptr;
+         capture = hci_capture_buffer_.Front()) {
+      btaa_hci_packets_.clear();
+      hci_processor_.OnHciPacket(btaa_hci_packets_, *capture);
+      hci_capture_buffer_.Pop();
+      attribution_processor_.OnBtaaPackets(btaa_hci_packets_);
+    }
+
+    uint32_t dropped_count = hci_capture_buffer_.TakeDroppedCount();
+    if (dropped_count != 0) {
+      LOG_WARN("Dropped %u HCI packets, the capture buffer is full", dropped_count);
+    }
   }
 
   void on_wakelock_acquired() {
@@ -147,6 +181,8 @@ struct ActivityAttribution::impl {
   void on_wakelock_released() {
     uint32_t wakelock_duration_ms = 0;
 
+    // The packets exchanged while the wakelock was held share its duration
+    drain_hci_captures();
     wakelock_duration_ms = wakelock_processor_.OnWakelockReleased();
     if (wakelock_duration_ms != 0) {
       attribution_processor_.OnWakelockReleased(wakelock_duration_ms);
@@ -154,6 +190,8 @@ struct ActivityAttribution::impl {
   }
 
   void on_wakeup() {
+    // The wakeup is attributed to the packets captured after it
+    drain_hci_captures();
     attribution_processor_.OnWakeup();
   }
 
@@ -172,13 +210,17 @@ struct ActivityAttribution::impl {
 
   ActivityAttributionCallback* callback_;
   AttributionProcessor attribution_processor_;
+  HciCaptureBuffer hci_capture_buffer_{kHciCaptureBufferSize};
   HciProcessor hci_processor_;
+  std::vector<BtaaHciPacket> btaa_hci_packets_;
   WakelockProcessor wakelock_processor_;
+  os::Alarm drain_alarm_;
+  std::atomic_bool drain_scheduled_{false};
 };
 
 void ActivityAttribution::Capture(const hal::HciPacket& packet, hal::SnoopLogger::PacketType type) {
   uint16_t original_length = packet.size();
-  uint16_t truncate_length;
+  uint16_t truncate_length = 0;
 
   switch (type) {
     case hal::SnoopLogger::PacketType::CMD:
@@ -196,8 +238,7 @@ void ActivityAttribution::Capture(const hal::HciPacket& packet, hal::SnoopLogger
     return;
   }
 
-  hal::HciPacket truncate_packet(packet.begin(), packet.begin() + truncate_length);
-  CallOn(pimpl_.get(), &impl::on_hci_packet, truncate_packet, type, original_length);
+  pimpl_->on_hci_packet(packet, type, std::min<size_t>(truncate_length, original_length));
 }
 
 void ActivityAttribution::OnWakelockAcquired() {
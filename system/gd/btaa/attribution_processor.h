@@ -37,9 +37,11 @@ struct AddressActivityKey {
 
 struct AddressActivityKeyHasher {
   std::size_t operator()(const AddressActivityKey& key) const {
-    return (
-        (std::hash<std::string>()(key.address.ToString()) ^
-         (std::hash<unsigned char>()(static_cast<unsigned char>(key.activity)))));
+    // Combines the hashes the way boost::hash_combine does, which does not depend on the width of size_t
+    std::size_t seed = std::hash<hci::Address>()(key.address);
+    seed ^= std::hash<unsigned char>()(static_cast<unsigned char>(key.activity)) + 0x9e3779b9 + (seed << 6) +
+            (seed >> 2);
+    return seed;
   }
 };
 
@@ -75,7 +77,7 @@ struct AppWakeupDescriptor {
 
 class AttributionProcessor {
  public:
-  void OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets);
+  void OnBtaaPackets(const std::vector<BtaaHciPacket>& btaa_packets);
   void OnWakelockReleased(uint32_t duration_ms);
   void OnWakeup();
   void NotifyActivityAttributionInfo(int uid, const std::string& package_name, const std::string& device_address);
@@ -86,12 +88,13 @@ class AttributionProcessor {
   bool wakeup_ = false;
   std::unordered_map<AddressActivityKey, BtaaAggregationEntry, AddressActivityKeyHasher> btaa_aggregator_;
   std::unordered_map<AddressActivityKey, BtaaAggregationEntry, AddressActivityKeyHasher> wakelock_duration_aggregator_;
-  std::unordered_map<std::string, std::string> address_app_map_;
+  std::unordered_map<hci::Address, std::string> address_app_map_;
   std::unordered_map<AppActivityKey, BtaaAggregationEntry, AppActivityKeyHasher> app_activity_aggregator_;
   common::TimestampedCircularBuffer<DeviceWakeupDescriptor> device_wakeup_aggregator_ =
       common::TimestampedCircularBuffer<DeviceWakeupDescriptor>(kWakeupAggregatorSize);
   common::TimestampedCircularBuffer<AppWakeupDescriptor> app_wakeup_aggregator_ =
       common::TimestampedCircularBuffer<AppWakeupDescriptor>(kWakeupAggregatorSize);
+  const std::string& PackageInfo(const hci::Address& address) const;
   const char* ActivityToString(Activity activity);
 };
 
@@ -0,0 +1,73 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "hal/snoop_logger.h"
+
+namespace bluetooth {
+namespace activity_attribution {
+
+// Commands are at most 3 + 255 bytes and events 2 + 255 bytes, data packets are captured up to their header
+static constexpr size_t kMaxHciCaptureSize = 258;
+
+struct HciCapture {
+  hal::SnoopLogger::PacketType type;
+  // Length of the packet before it was truncated for capture
+  uint16_t length;
+  uint16_t size;
+  uint8_t data[kMaxHciCaptureSize];
+};
+
+// Fixed-size ring of captured HCI packets, filled from the HAL threads and drained by the attribution module. Push
+// never blocks nor allocates; when the ring is full the packet is dropped and counted. Only one thread may pop.
+class HciCaptureBuffer {
+ public:
+  // |capacity| must be a power of two
+  explicit HciCaptureBuffer(size_t capacity);
+  HciCaptureBuffer(const HciCaptureBuffer&) = delete;
+  HciCaptureBuffer& operator=(const HciCaptureBuffer&) = delete;
+
+  // Copies at most kMaxHciCaptureSize bytes of |data|. Returns false if the packet was dropped.
+  bool Push(hal::SnoopLogger::PacketType type, const uint8_t* data, size_t size, uint16_t length);
+
+  // Returns the oldest captured packet, or nullptr if the ring is empty. The entry stays valid until Pop().
+  const HciCapture* Front();
+  void Pop();
+
+  // Returns the number of packets dropped since the previous call
+  uint32_t TakeDroppedCount();
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence;
+    HciCapture capture;
+  };
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+  std::atomic<size_t> push_position_ = 0;
+  size_t pop_position_ = 0;
+  std::atomic<uint32_t> dropped_count_ = 0;
+};
+
+}  // namespace activity_attribution
+}  // namespace bluetooth
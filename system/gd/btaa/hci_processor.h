@@ -16,8 +16,13 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "btaa/activity_attribution.h"
 #include "btaa/cmd_evt_classification.h"
+#include "btaa/hci_capture_buffer.h"
 #include "hal/snoop_logger.h"
 #include "hci/address.h"
 
@@ -39,7 +44,7 @@ class DeviceParser {
   void match_handle_with_address(uint16_t connection_handle, hci::Address& address);
 
  private:
-  std::map<uint16_t, hci::Address> connection_lookup_table_;
+  std::unordered_map<uint16_t, hci::Address> connection_lookup_table_;
 };
 
 struct PendingCommand {
@@ -49,7 +54,8 @@ struct PendingCommand {
 
 class HciProcessor {
  public:
-  std::vector<BtaaHciPacket> OnHciPacket(hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length);
+  // Appends the activities of one captured packet to |btaa_hci_packets|
+  void OnHciPacket(std::vector<BtaaHciPacket>& btaa_hci_packets, const HciCapture& capture);
 
  private:
   void process_le_event(std::vector<BtaaHciPacket>& btaa_hci_packets, int16_t byte_count, hci::EventView& event);
@@ -81,6 +87,8 @@ class HciProcessor {
 
   DeviceParser device_parser_;
   PendingCommand pending_command_;
+  // Reused for every packet, no view outlives OnHciPacket()
+  std::shared_ptr<std::vector<uint8_t>> packet_bytes_ = std::make_shared<std::vector<uint8_t>>();
 };
 
 }  // namespace activity_attribution
@@ -32,27 +32,21 @@ static const int kByteCountTransientDeviceActivityEntry = 200;
 static const int kDurationTransientDeviceActivityEntrySecs = 900;
 static const int kMapSizeTrimDownAggregationEntry = 200;
 
-void AttributionProcessor::OnBtaaPackets(std::vector<BtaaHciPacket> btaa_packets) {
+void AttributionProcessor::OnBtaaPackets(const std::vector<BtaaHciPacket>& btaa_packets) {
   AddressActivityKey key;
 
   for (auto& btaa_packet : btaa_packets) {
     key.address = btaa_packet.address;
     key.activity = btaa_packet.activity;
 
-    if (wakelock_duration_aggregator_.find(key) == wakelock_duration_aggregator_.end()) {
-      wakelock_duration_aggregator_[key] = {};
-    }
-    wakelock_duration_aggregator_[key].byte_count += btaa_packet.byte_count;
+    BtaaAggregationEntry& entry = wakelock_duration_aggregator_[key];
+    entry.byte_count += btaa_packet.byte_count;
 
     if (wakeup_) {
-      wakelock_duration_aggregator_[key].wakeup_count += 1;
+      entry.wakeup_count += 1;
       device_wakeup_aggregator_.Push(std::move(DeviceWakeupDescriptor(btaa_packet.activity, btaa_packet.address)));
-      std::string package_info = kUnknownPackageInfo;
-      std::string address = btaa_packet.address.ToString();
-      if (address_app_map_.find(address) != address_app_map_.end()) {
-        package_info = address_app_map_[address];
-      }
-      app_wakeup_aggregator_.Push(std::move(AppWakeupDescriptor(btaa_packet.activity, package_info)));
+      app_wakeup_aggregator_.Push(
+          std::move(AppWakeupDescriptor(btaa_packet.activity, PackageInfo(btaa_packet.address))));
     }
   }
   wakeup_ = false;
@@ -90,13 +84,8 @@ void AttributionProcessor::OnWakelockReleased(uint32_t duration_ms) {
     btaa_aggregator_[it.first].byte_count += it.second.byte_count;
     btaa_aggregator_[it.first].wakelock_duration_ms += it.second.wakelock_duration_ms;
 
-    std::string address = it.first.address.ToString();
-    std::string package_info = kUnknownPackageInfo;
-    if (address_app_map_.find(address) != address_app_map_.end()) {
-      package_info = address_app_map_[address];
-    }
     AppActivityKey key;
-    key.app = package_info;
+    key.app = PackageInfo(it.first.address);
     key.activity = it.first.activity;
 
     if (app_activity_aggregator_.find(key) == app_activity_aggregator_.end()) {
@@ -161,7 +150,20 @@ void AttributionProcessor::NotifyActivityAttributionInfo(
     LOG_INFO("The map from device address and app info overflows.");
     return;
   }
-  address_app_map_[device_address] = package_name + "/" + std::to_string(uid);
+  auto address = hci::Address::FromString(device_address);
+  if (!address) {
+    LOG_WARN("Invalid device address");
+    return;
+  }
+  address_app_map_[*address] = package_name + "/" + std::to_string(uid);
+}
+
+const std::string& AttributionProcessor::PackageInfo(const hci::Address& address) const {
+  auto it = address_app_map_.find(address);
+  if (it == address_app_map_.end()) {
+    return kUnknownPackageInfo;
+  }
+  return it->second;
 }
 
 void AttributionProcessor::Dump(
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btaa/hci_capture_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace activity_attribution {
+
+// Every slot carries a sequence number: a slot is free for the push at position p when its sequence is p, and holds
+// the packet pushed at p when its sequence is p + 1.
+HciCaptureBuffer::HciCaptureBuffer(size_t capacity) : mask_(capacity - 1), slots_(new Slot[capacity]) {
+  ASSERT(capacity != 0 && (capacity & mask_) == 0);
+  for (size_t i = 0; i < capacity; i++) {
+    slots_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+}
+
+bool HciCaptureBuffer::Push(hal::SnoopLogger::PacketType type, const uint8_t* data, size_t size, uint16_t length) {
+  size_t position = push_position_.load(std::memory_order_relaxed);
+  Slot* slot;
+  while (true) {
+    slot = &slots_[position & mask_];
+    size_t sequence = slot->sequence.load(std::memory_order_acquire);
+    intptr_t diff = (intptr_t)sequence - (intptr_t)position;
+    if (diff == 0) {
+      if (push_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (diff < 0) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    } else {
+      position = push_position_.load(std::memory_order_relaxed);
+    }
+  }
+
+  slot->capture.type = type;
+  slot->capture.length = length;
+  slot->capture.size = std::min(size, kMaxHciCaptureSize);
+  memcpy(slot->capture.data, data, slot->capture.size);
+  slot->sequence.store(position + 1, std::memory_order_release);
+  return true;
+}
+
+const HciCapture* HciCaptureBuffer::Front() {
+  Slot* slot = &slots_[pop_position_ & mask_];
+  if (slot->sequence.load(std::memory_order_acquire) != pop_position_ + 1) {
+    return nullptr;
+  }
+  return &slot->capture;
+}
+
+void HciCaptureBuffer::Pop() {
+  Slot* slot = &slots_[pop_position_ & mask_];
+  slot->sequence.store(pop_position_ + mask_ + 1, std::memory_order_release);
+  pop_position_++;
+}
+
+uint32_t HciCaptureBuffer::TakeDroppedCount() {
+  return dropped_count_.exchange(0, std::memory_order_relaxed);
+}
+
+}  // namespace activity_attribution
+}  // namespace bluetooth
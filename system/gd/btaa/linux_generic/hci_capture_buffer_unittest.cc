@@ -0,0 +1,122 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "btaa/hci_capture_buffer.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bluetooth {
+namespace activity_attribution {
+namespace {
+
+using hal::SnoopLogger;
+
+constexpr size_t kBufferSize = 8;
+
+TEST(HciCaptureBufferTest, empty) {
+  HciCaptureBuffer buffer(kBufferSize);
+  ASSERT_EQ(nullptr, buffer.Front());
+}
+
+TEST(HciCaptureBufferTest, pop_in_push_order) {
+  HciCaptureBuffer buffer(kBufferSize);
+  for (uint8_t i = 0; i < 3 * kBufferSize; i++) {
+    uint8_t data[] = {i, 0x00, 0x00, 0x00};
+    ASSERT_TRUE(buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), 100 + i));
+    const HciCapture* capture = buffer.Front();
+    ASSERT_NE(nullptr, capture);
+    ASSERT_EQ(SnoopLogger::PacketType::ACL, capture->type);
+    ASSERT_EQ(100 + i, capture->length);
+    ASSERT_EQ(sizeof(data), capture->size);
+    ASSERT_EQ(i, capture->data[0]);
+    buffer.Pop();
+  }
+  ASSERT_EQ(nullptr, buffer.Front());
+}
+
+TEST(HciCaptureBufferTest, full_buffer_drops_packets) {
+  HciCaptureBuffer buffer(kBufferSize);
+  uint8_t data[] = {0x01, 0x00, 0x00, 0x00};
+  for (size_t i = 0; i < kBufferSize; i++) {
+    ASSERT_TRUE(buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), sizeof(data)));
+  }
+  ASSERT_FALSE(buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), sizeof(data)));
+  ASSERT_FALSE(buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), sizeof(data)));
+  ASSERT_EQ(2u, buffer.TakeDroppedCount());
+  ASSERT_EQ(0u, buffer.TakeDroppedCount());
+
+  buffer.Pop();
+  ASSERT_TRUE(buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), sizeof(data)));
+}
+
+TEST(HciCaptureBufferTest, long_packet_is_truncated) {
+  HciCaptureBuffer buffer(kBufferSize);
+  std::vector<uint8_t> data(kMaxHciCaptureSize + 10, 0xab);
+  ASSERT_TRUE(buffer.Push(SnoopLogger::PacketType::EVT, data.data(), data.size(), data.size()));
+  const HciCapture* capture = buffer.Front();
+  ASSERT_NE(nullptr, capture);
+  ASSERT_EQ(kMaxHciCaptureSize, capture->size);
+  ASSERT_EQ(data.size(), capture->length);
+}
+
+TEST(HciCaptureBufferTest, concurrent_producers) {
+  constexpr int kNumProducers = 4;
+  constexpr int kPacketsPerProducer = 10000;
+  HciCaptureBuffer buffer(64);
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < kNumProducers; producer++) {
+    producers.emplace_back([&buffer, producer]() {
+      for (int i = 0; i < kPacketsPerProducer;) {
+        uint8_t data[] = {(uint8_t)producer, (uint8_t)(i & 0xff), (uint8_t)(i >> 8), 0x00};
+        if (buffer.Push(SnoopLogger::PacketType::ACL, data, sizeof(data), sizeof(data))) {
+          i++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  // Every producer's packets come out in the order it pushed them
+  std::vector<int> next(kNumProducers, 0);
+  int received = 0;
+  while (received < kNumProducers * kPacketsPerProducer) {
+    const HciCapture* capture = buffer.Front();
+    if (capture == nullptr) {
+      std::this_thread::yield();
+      continue;
+    }
+    int producer = capture->data[0];
+    int i = capture->data[1] | (capture->data[2] << 8);
+    EXPECT_EQ(next[producer], i);
+    next[producer]++;
+    buffer.Pop();
+    received++;
+  }
+
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  ASSERT_EQ(nullptr, buffer.Front());
+}
+
+}  // namespace
+}  // namespace activity_attribution
+}  // namespace bluetooth
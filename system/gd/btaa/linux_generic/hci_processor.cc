@@ -25,8 +25,9 @@ void DeviceParser::match_handle_with_address(uint16_t connection_handle, hci::Ad
   if (connection_handle && !address.IsEmpty()) {
     connection_lookup_table_[connection_handle] = address;
   } else if (connection_handle) {
-    if (connection_lookup_table_.find(connection_handle) != connection_lookup_table_.end()) {
-      address = connection_lookup_table_[connection_handle];
+    auto it = connection_lookup_table_.find(connection_handle);
+    if (it != connection_lookup_table_.end()) {
+      address = it->second;
     }
   }
 }
@@ -240,11 +241,11 @@ void HciProcessor::process_iso(
   btaa_hci_packets.push_back(BtaaHciPacket(Activity::ISO, address_value, byte_count));
 }
 
-std::vector<BtaaHciPacket> HciProcessor::OnHciPacket(
-    hal::HciPacket packet, hal::SnoopLogger::PacketType type, uint16_t length) {
-  std::vector<BtaaHciPacket> btaa_hci_packets;
-  auto packet_view = packet::PacketView<packet::kLittleEndian>(std::make_shared<std::vector<uint8_t>>(packet));
-  switch (type) {
+void HciProcessor::OnHciPacket(std::vector<BtaaHciPacket>& btaa_hci_packets, const HciCapture& capture) {
+  packet_bytes_->assign(capture.data, capture.data + capture.size);
+  auto packet_view = packet::PacketView<packet::kLittleEndian>(packet_bytes_);
+  uint16_t length = capture.length;
+  switch (capture.type) {
     case hal::SnoopLogger::PacketType::CMD:
       process_command(btaa_hci_packets, packet_view, length);
       break;
@@ -261,7 +262,6 @@ std::vector<BtaaHciPacket> HciProcessor::OnHciPacket(
       process_iso(btaa_hci_packets, packet_view, length);
       break;
   }
-  return btaa_hci_packets;
 }
 
 }  // namespace activity_attribution
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "btaa/attribution_processor.h"
+#include "btaa/hci_capture_buffer.h"
+#include "btaa/hci_processor.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace activity_attribution {
+namespace {
+
+constexpr size_t kCaptureBufferSize = 1024;
+constexpr uint16_t kAclHandle = 0x0001;
+// 2-DH5 A2DP media packet
+constexpr uint16_t kAclLength = 679 + 4;
+constexpr size_t kAclHeaderSize = 4;
+
+struct SnoopRecord {
+  hal::SnoopLogger::PacketType type;
+  std::vector<uint8_t> data;
+  uint16_t length;
+};
+
+SnoopRecord Event(std::vector<uint8_t> data) {
+  uint16_t length = data.size();
+  return {hal::SnoopLogger::PacketType::EVT, std::move(data), length};
+}
+
+// The records of an A2DP streaming snoop log as the HAL hands them over: a connection, then media packets each
+// acknowledged with Number Of Completed Packets, with a Read RSSI command every 50 packets.
+std::vector<SnoopRecord> MakeA2dpStreamingCapture(size_t num_acl_packets) {
+  uint8_t handle_lo = kAclHandle & 0xff;
+  uint8_t handle_hi = kAclHandle >> 8;
+  std::vector<SnoopRecord> records;
+  records.push_back(Event({0x03, 11, 0x00, handle_lo, handle_hi, 0x66, 0x55, 0x44, 0x33, 0x22, 0x11, 0x01, 0x00}));
+  for (size_t i = 0; i < num_acl_packets; i++) {
+    uint8_t length_lo = (kAclLength - kAclHeaderSize) & 0xff;
+    uint8_t length_hi = (kAclLength - kAclHeaderSize) >> 8;
+    records.push_back({hal::SnoopLogger::PacketType::ACL, {handle_lo, handle_hi, length_lo, length_hi}, kAclLength});
+    records.push_back(Event({0x13, 5, 0x01, handle_lo, handle_hi, 0x01, 0x00}));
+    if (i % 50 == 0) {
+      records.push_back({hal::SnoopLogger::PacketType::CMD, {0x05, 0x14, 2, handle_lo, handle_hi}, 5});
+      records.push_back(Event({0x0e, 7, 0x01, 0x05, 0x14, 0x00, handle_lo, handle_hi, 0xc4}));
+    }
+  }
+  return records;
+}
+
+// Capture() runs on the HAL threads for every HCI packet. Its budget is a bounded copy into the capture ring: no
+// allocation, no lock and no parsing. The ring is drained outside of the measurement when it fills up.
+void BM_CaptureHotPath(State& state) {
+  std::vector<SnoopRecord> records = MakeA2dpStreamingCapture(400);
+  HciCaptureBuffer buffer(kCaptureBufferSize);
+  size_t next = 0;
+  size_t captured = 0;
+  for (auto _ : state) {
+    const SnoopRecord& record = records[next];
+    buffer.Push(record.type, record.data.data(), record.data.size(), record.length);
+    next = (next + 1) % records.size();
+    if (++captured == kCaptureBufferSize) {
+      state.PauseTiming();
+      while (buffer.Front() != nullptr) buffer.Pop();
+      captured = 0;
+      state.ResumeTiming();
+    }
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CaptureHotPath);
+
+// Replays a snoop capture through the whole pipeline: capture on the HAL side, then classification by the
+// HciProcessor and aggregation as done when the module drains the ring.
+void BM_ReplaySnoopCapture(State& state) {
+  std::vector<SnoopRecord> records = MakeA2dpStreamingCapture(state.range(0));
+  HciCaptureBuffer buffer(kCaptureBufferSize);
+  HciProcessor hci_processor;
+  AttributionProcessor attribution_processor;
+  std::vector<BtaaHciPacket> btaa_hci_packets;
+  for (auto _ : state) {
+    for (const SnoopRecord& record : records) {
+      buffer.Push(record.type, record.data.data(), record.data.size(), record.length);
+    }
+    for (const HciCapture* capture = buffer.Front(); capture != nullptr; capture = buffer.Front()) {
+      btaa_hci_packets.clear();
+      hci_processor.OnHciPacket(btaa_hci_packets, *capture);
+      buffer.Pop();
+      attribution_processor.OnBtaaPackets(btaa_hci_packets);
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * records.size());
+}
+BENCHMARK(BM_ReplaySnoopCapture)->Arg(100)->Arg(400);
+
+}  // namespace
+}  // namespace activity_attribution
+}  // namespace bluetooth
@@ -17,12 +17,20 @@
 #include "hci/controller.h"
 
 #include <future>
+#include <list>
+#include <map>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "common/init_flags.h"
+#include "common/strings.h"
 #include "hci/hci_layer.h"
+#include "packet/raw_builder.h"
+#include "storage/storage_module.h"
 
 namespace bluetooth {
 namespace hci {
@@ -32,8 +40,9 @@ using os::Handler;
 struct Controller::impl {
   impl(Controller& module) : module_(module) {}
 
-  void Start(hci::HciLayer* hci) {
+  void Start(hci::HciLayer* hci, storage::StorageModule* storage) {
     hci_ = hci;
+    storage_ = storage;
     Handler* handler = module_.GetHandler();
     hci_->RegisterEventHandler(
         EventCode::NUMBER_OF_COMPLETED_PACKETS, handler->BindOn(this, &Controller::impl::NumberOfCompletedPackets));
@@ -43,56 +52,81 @@ struct Controller::impl {
     write_le_host_support(Enable::ENABLED, Enable::DISABLED);
     hci_->EnqueueCommand(ReadLocalNameBuilder::Create(),
                          handler->BindOnceOn(this, &Controller::impl::read_local_name_complete_handler));
-    hci_->EnqueueCommand(ReadLocalVersionInformationBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_version_information_complete_handler));
-    hci_->EnqueueCommand(ReadLocalSupportedCommandsBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_supported_commands_complete_handler));
 
+    // The version and the address identify the controller the capability snapshot was taken from
+    std::promise<void> version_promise;
+    auto version_future = version_promise.get_future();
     hci_->EnqueueCommand(
-        LeReadLocalSupportedFeaturesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_local_supported_features_handler));
-
+        ReadLocalVersionInformationBuilder::Create(),
+        handler->BindOnceOn(
+            this, &Controller::impl::read_local_version_information_complete_handler, std::move(version_promise)));
+    std::promise<void> address_promise;
+    auto address_future = address_promise.get_future();
     hci_->EnqueueCommand(
+        ReadBdAddrBuilder::Create(),
+        handler->BindOnceOn(this, &Controller::impl::read_controller_mac_address_handler, std::move(address_promise)));
+    version_future.wait();
+    address_future.wait();
+    load_capability_snapshot();
+
+    // The supported commands decide which of the reads below are sent
+    std::promise<void> commands_promise;
+    auto commands_future = commands_promise.get_future();
+    read_capability(
+        OpCode::READ_LOCAL_SUPPORTED_COMMANDS,
+        ReadLocalSupportedCommandsBuilder::Create(),
+        &Controller::impl::read_local_supported_commands_complete_handler,
+        std::move(commands_promise));
+    read_capability(
+        OpCode::LE_READ_LOCAL_SUPPORTED_FEATURES,
+        LeReadLocalSupportedFeaturesBuilder::Create(),
+        &Controller::impl::le_read_local_supported_features_handler);
+    read_capability(
+        OpCode::LE_READ_SUPPORTED_STATES,
         LeReadSupportedStatesBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_supported_states_handler));
+        &Controller::impl::le_read_supported_states_handler);
+    read_capability(
+        OpCode::READ_BUFFER_SIZE, ReadBufferSizeBuilder::Create(), &Controller::impl::read_buffer_size_complete_handler);
 
     // Wait for all extended features read
     std::promise<void> features_promise;
     auto features_future = features_promise.get_future();
-    hci_->EnqueueCommand(ReadLocalExtendedFeaturesBuilder::Create(0x00),
-                         handler->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                             std::move(features_promise)));
+    read_local_extended_features(0x00, std::move(features_promise));
     features_future.wait();
-
-    hci_->EnqueueCommand(ReadBufferSizeBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::read_buffer_size_complete_handler));
+    commands_future.wait();
 
     if (is_supported(OpCode::LE_READ_BUFFER_SIZE_V2)) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_BUFFER_SIZE_V2,
           LeReadBufferSizeV2Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_v2_handler));
+          &Controller::impl::le_read_buffer_size_v2_handler);
     } else {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_BUFFER_SIZE_V1,
           LeReadBufferSizeV1Builder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_buffer_size_handler));
+          &Controller::impl::le_read_buffer_size_handler);
     }
 
-    hci_->EnqueueCommand(
+    read_capability(
+        OpCode::LE_READ_FILTER_ACCEPT_LIST_SIZE,
         LeReadFilterAcceptListSizeBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::le_read_connect_list_size_handler));
+        &Controller::impl::le_read_connect_list_size_handler);
 
     if (is_supported(OpCode::LE_READ_RESOLVING_LIST_SIZE) && module_.SupportsBlePrivacy()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_RESOLVING_LIST_SIZE,
           LeReadResolvingListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_resolving_list_size_handler));
+          &Controller::impl::le_read_resolving_list_size_handler);
     } else {
       LOG_INFO("LE_READ_RESOLVING_LIST_SIZE not supported, defaulting to 0");
       le_resolving_list_size_ = 0;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(LeReadMaximumDataLengthBuilder::Create(),
-                           handler->BindOnceOn(this, &Controller::impl::le_read_maximum_data_length_handler));
+      read_capability(
+          OpCode::LE_READ_MAXIMUM_DATA_LENGTH,
+          LeReadMaximumDataLengthBuilder::Create(),
+          &Controller::impl::le_read_maximum_data_length_handler);
     } else {
       LOG_INFO("LE_READ_MAXIMUM_DATA_LENGTH not supported, defaulting to 0");
       le_maximum_data_length_.supported_max_rx_octets_ = 0;
@@ -111,18 +145,20 @@ struct Controller::impl {
       }
     }
     if (is_supported(OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH) && module_.SupportsBleDataPacketLengthExtension()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH,
           LeReadSuggestedDefaultDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_suggested_default_data_length_handler));
+          &Controller::impl::le_read_suggested_default_data_length_handler);
     } else {
       LOG_INFO("LE_READ_SUGGESTED_DEFAULT_DATA_LENGTH not supported, defaulting to 27 (0x1B)");
       le_suggested_default_data_length_ = 27;
     }
 
     if (is_supported(OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH) && module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH,
           LeReadMaximumAdvertisingDataLengthBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_maximum_advertising_data_length_handler));
+          &Controller::impl::le_read_maximum_advertising_data_length_handler);
     } else {
       LOG_INFO("LE_READ_MAXIMUM_ADVERTISING_DATA_LENGTH not supported, defaulting to 31 (0x1F)");
       le_maximum_advertising_data_length_ = 31;
@@ -130,18 +166,20 @@ struct Controller::impl {
 
     if (is_supported(OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS) &&
         module_.SupportsBleExtendedAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS,
           LeReadNumberOfSupportedAdvertisingSetsBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_number_of_supported_advertising_sets_handler));
+          &Controller::impl::le_read_number_of_supported_advertising_sets_handler);
     } else {
       LOG_INFO("LE_READ_NUMBER_OF_SUPPORTED_ADVERTISING_SETS not supported, defaulting to 1");
       le_number_supported_advertising_sets_ = 1;
     }
 
     if (is_supported(OpCode::LE_READ_PERIODIC_ADVERTISING_LIST_SIZE) && module_.SupportsBlePeriodicAdvertising()) {
-      hci_->EnqueueCommand(
+      read_capability(
+          OpCode::LE_READ_PERIODIC_ADVERTISING_LIST_SIZE,
           LeReadPeriodicAdvertiserListSizeBuilder::Create(),
-          handler->BindOnceOn(this, &Controller::impl::le_read_periodic_advertiser_list_size_handler));
+          &Controller::impl::le_read_periodic_advertiser_list_size_handler);
     } else {
       LOG_INFO("LE_READ_PERIODIC_ADVERTISING_LIST_SIZE not supported, defaulting to 0");
       le_periodic_advertiser_list_size_ = 0;
@@ -152,16 +190,171 @@ struct Controller::impl {
           handler->BindOnceOn(this, &Controller::impl::le_set_host_feature_handler));
     }
 
-    hci_->EnqueueCommand(LeGetVendorCapabilitiesBuilder::Create(),
-                         handler->BindOnceOn(this, &Controller::impl::le_get_vendor_capabilities_handler));
-
-    // We only need to synchronize the last read. Make BD_ADDR to be the last one.
+    // We only need to synchronize the last read. Make vendor capabilities the last one.
     std::promise<void> promise;
     auto future = promise.get_future();
-    hci_->EnqueueCommand(
-        ReadBdAddrBuilder::Create(),
-        handler->BindOnceOn(this, &Controller::impl::read_controller_mac_address_handler, std::move(promise)));
+    read_capability(
+        OpCode::LE_GET_VENDOR_CAPABILITIES,
+        LeGetVendorCapabilitiesBuilder::Create(),
+        &Controller::impl::le_get_vendor_capabilities_handler,
+        std::move(promise));
     future.wait();
+
+    store_capability_snapshot();
+  }
+
+  using CapabilityHandler = void (Controller::impl::*)(CommandCompleteView);
+
+  // Reads a capability of the controller, or replays the response recorded in the capability snapshot if there is one.
+  // |promise| is set once |handler| has run.
+  void read_capability(
+      OpCode op_code,
+      std::unique_ptr<CommandBuilder> command,
+      CapabilityHandler handler,
+      std::promise<void> promise = std::promise<void>()) {
+    auto cached = take_cached_capability(op_code);
+    if (cached) {
+      capability_complete_handler(handler, std::move(promise), *cached);
+      return;
+    }
+    hci_->EnqueueCommand(
+        std::move(command),
+        module_.GetHandler()->BindOnceOn(
+            this, &Controller::impl::capability_complete_handler, handler, std::move(promise)));
+  }
+
+  void capability_complete_handler(CapabilityHandler handler, std::promise<void> promise, CommandCompleteView view) {
+    record_capability(view);
+    (this->*handler)(view);
+    promise.set_value();
+  }
+
+  void read_local_extended_features(uint8_t page_number, std::promise<void> promise) {
+    auto cached = take_cached_capability(OpCode::READ_LOCAL_EXTENDED_FEATURES);
+    if (cached) {
+      auto cached_view = ReadLocalExtendedFeaturesCompleteView::Create(*cached);
+      if (cached_view.IsValid() && cached_view.GetPageNumber() == page_number) {
+        read_local_extended_features_complete_handler(std::move(promise), *cached);
+        return;
+      }
+      LOG_WARN("Capability snapshot is missing extended features page %hhu", page_number);
+      std::lock_guard<std::mutex> lock(capability_mutex_);
+      capability_snapshot_stale_ = true;
+    }
+    hci_->EnqueueCommand(
+        ReadLocalExtendedFeaturesBuilder::Create(page_number),
+        module_.GetHandler()->BindOnceOn(
+            this, &Controller::impl::read_local_extended_features_complete_handler, std::move(promise)));
+  }
+
+  // Returns the next response recorded for |op_code| in the capability snapshot. The snapshot is written again at the
+  // end of Start() when any capability had to be read from the controller.
+  std::optional<CommandCompleteView> take_cached_capability(OpCode op_code) {
+    std::lock_guard<std::mutex> lock(capability_mutex_);
+    auto responses = cached_capabilities_.find(op_code);
+    if (responses == cached_capabilities_.end() || responses->second.empty()) {
+      capability_snapshot_stale_ = true;
+      return std::nullopt;
+    }
+    CommandCompleteView view = responses->second.front();
+    responses->second.pop_front();
+    return view;
+  }
+
+  void record_capability(CommandCompleteView view) {
+    std::vector<uint8_t> bytes(view.size());
+    for (size_t i = 0; i < view.size(); i++) {
+      bytes[i] = view[i];
+    }
+    std::lock_guard<std::mutex> lock(capability_mutex_);
+    recorded_capabilities_.push_back(std::move(bytes));
+  }
+
+  // Loads the capability snapshot of the last start, as long as it was taken from the same controller. The snapshot is
+  // the version information and the address of the controller followed by the Command Complete event of every read.
+  void load_capability_snapshot() {
+    auto snapshot = storage_->GetAdapterConfig().GetControllerCapabilities();
+    if (!snapshot) {
+      return;
+    }
+    auto bytes = common::FromHexString(*snapshot);
+    if (!bytes || bytes->size() < kCapabilitySnapshotHeaderSize) {
+      LOG_WARN("Ignoring malformed controller capability snapshot");
+      return;
+    }
+    packet::PacketView<packet::kLittleEndian> packet(std::make_shared<std::vector<uint8_t>>(std::move(*bytes)));
+    auto it = packet.begin();
+    uint8_t format = it.extract<uint8_t>();
+    Address address = it.extract<Address>();
+    auto hci_version = static_cast<HciVersion>(it.extract<uint8_t>());
+    uint16_t hci_revision = it.extract<uint16_t>();
+    auto lmp_version = static_cast<LmpVersion>(it.extract<uint8_t>());
+    uint16_t manufacturer_name = it.extract<uint16_t>();
+    uint16_t lmp_subversion = it.extract<uint16_t>();
+    if (format != kCapabilitySnapshotFormat || address != mac_address_ ||
+        hci_version != local_version_information_.hci_version_ ||
+        hci_revision != local_version_information_.hci_revision_ ||
+        lmp_version != local_version_information_.lmp_version_ ||
+        manufacturer_name != local_version_information_.manufacturer_name_ ||
+        lmp_subversion != local_version_information_.lmp_subversion_) {
+      LOG_INFO("Controller changed since the capability snapshot was taken");
+      return;
+    }
+
+    std::map<OpCode, std::list<CommandCompleteView>> cached_capabilities;
+    while (it.NumBytesRemaining() > 0) {
+      uint16_t length = it.NumBytesRemaining() >= sizeof(uint16_t) ? it.extract<uint16_t>() : 0;
+      if (length == 0 || it.NumBytesRemaining() < length) {
+        LOG_WARN("Ignoring truncated controller capability snapshot");
+        return;
+      }
+      auto record = std::make_shared<std::vector<uint8_t>>();
+      for (uint16_t i = 0; i < length; i++) {
+        record->push_back(*it);
+        ++it;
+      }
+      auto view = CommandCompleteView::Create(EventView::Create(packet::PacketView<packet::kLittleEndian>(record)));
+      if (!view.IsValid()) {
+        LOG_WARN("Ignoring controller capability snapshot with an invalid event");
+        return;
+      }
+      cached_capabilities[view.GetCommandOpCode()].push_back(view);
+    }
+
+    std::lock_guard<std::mutex> lock(capability_mutex_);
+    cached_capabilities_ = std::move(cached_capabilities);
+  }
+
+  // Replaces the capability snapshot if any capability had to be read from the controller
+  void store_capability_snapshot() {
+    std::lock_guard<std::mutex> lock(capability_mutex_);
+    cached_capabilities_.clear();
+    std::vector<std::vector<uint8_t>> records = std::move(recorded_capabilities_);
+    recorded_capabilities_.clear();
+    if (!capability_snapshot_stale_) {
+      return;
+    }
+
+    packet::RawBuilder builder;
+    builder.AddOctets1(kCapabilitySnapshotFormat);
+    builder.AddAddress(mac_address_);
+    builder.AddOctets1(static_cast<uint8_t>(local_version_information_.hci_version_));
+    builder.AddOctets2(local_version_information_.hci_revision_);
+    builder.AddOctets1(static_cast<uint8_t>(local_version_information_.lmp_version_));
+    builder.AddOctets2(local_version_information_.manufacturer_name_);
+    builder.AddOctets2(local_version_information_.lmp_subversion_);
+    for (const auto& record : records) {
+      builder.AddOctets2(static_cast<uint16_t>(record.size()));
+      builder.AddOctets(record);
+    }
+    std::vector<uint8_t> bytes;
+    packet::BitInserter inserter(bytes);
+    builder.Serialize(inserter);
+
+    auto mutation = storage_->Modify();
+    mutation.Add(storage_->GetAdapterConfig().SetControllerCapabilities(common::ToHexString(bytes)));
+    mutation.Commit();
+    LOG_INFO("Stored controller capability snapshot of %zu reads", records.size());
   }
 
   void Stop() {
@@ -237,13 +430,14 @@ struct Controller::impl {
     local_name_.erase(std::find(local_name_.begin(), local_name_.end(), '\0'), local_name_.end());
   }
 
-  void read_local_version_information_complete_handler(CommandCompleteView view) {
+  void read_local_version_information_complete_handler(std::promise<void> promise, CommandCompleteView view) {
     auto complete_view = ReadLocalVersionInformationCompleteView::Create(view);
     ASSERT(complete_view.IsValid());
     ErrorCode status = complete_view.GetStatus();
     ASSERT_LOG(status == ErrorCode::SUCCESS, "Status 0x%02hhx, %s", status, ErrorCodeText(status).c_str());
 
     local_version_information_ = complete_view.GetLocalVersionInformation();
+    promise.set_value();
   }
 
   void read_local_supported_commands_complete_handler(CommandCompleteView view) {
@@ -261,14 +455,11 @@ struct Controller::impl {
     ASSERT_LOG(status == ErrorCode::SUCCESS, "Status 0x%02hhx, %s", status, ErrorCodeText(status).c_str());
     uint8_t page_number = complete_view.GetPageNumber();
     extended_lmp_features_array_.push_back(complete_view.GetExtendedLmpFeatures());
+    record_capability(view);
 
     // Query all extended features
     if (page_number < complete_view.GetMaximumPageNumber()) {
-      page_number++;
-      hci_->EnqueueCommand(
-          ReadLocalExtendedFeaturesBuilder::Create(page_number),
-          module_.GetHandler()->BindOnceOn(this, &Controller::impl::read_local_extended_features_complete_handler,
-                                           std::move(promise)));
+      read_local_extended_features(page_number + 1, std::move(promise));
     } else {
       promise.set_value();
     }
@@ -861,6 +1052,7 @@ struct Controller::impl {
   Controller& module_;
 
   HciLayer* hci_;
+  storage::StorageModule* storage_;
 
   CompletedAclPacketsCallback acl_credits_callback_{};
   CompletedAclPacketsCallback acl_monitor_credits_callback_{};
@@ -885,6 +1077,16 @@ struct Controller::impl {
   uint8_t le_number_supported_advertising_sets_;
   uint8_t le_periodic_advertiser_list_size_;
   VendorCapabilities vendor_capabilities_;
+
+  // Format version and size of the header of the capability snapshot
+  static constexpr uint8_t kCapabilitySnapshotFormat = 1;
+  static constexpr size_t kCapabilitySnapshotHeaderSize = 15;
+  std::mutex capability_mutex_;
+  // Responses of the capability snapshot not replayed yet, guarded by |capability_mutex_|
+  std::map<OpCode, std::list<CommandCompleteView>> cached_capabilities_;
+  // Responses for the next capability snapshot, guarded by |capability_mutex_|
+  std::vector<std::vector<uint8_t>> recorded_capabilities_;
+  bool capability_snapshot_stale_ = false;
 };  // namespace hci
 
 Controller::Controller() : impl_(std::make_unique<impl>(*this)) {}
@@ -1155,10 +1357,11 @@ const ModuleFactory Controller::Factory = ModuleFactory([]() { return new Contro
 
 void Controller::ListDependencies(ModuleList* list) const {
   list->add<hci::HciLayer>();
+  list->add<storage::StorageModule>();
 }
 
 void Controller::Start() {
-  impl_->Start(GetDependency<hci::HciLayer>());
+  impl_->Start(GetDependency<hci::HciLayer>(), GetDependency<storage::StorageModule>());
 }
 
 void Controller::Stop() {
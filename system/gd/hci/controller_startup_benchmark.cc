@@ -0,0 +1,122 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <memory>
+
+#include "benchmark/benchmark.h"
+#include "hal/hci_hal_host.h"
+#include "hci/controller.h"
+#include "hci/hci_layer.h"
+#include "module.h"
+#include "os/parameter_provider.h"
+#include "os/thread.h"
+
+using ::benchmark::State;
+using ::bluetooth::ModuleRegistry;
+using ::bluetooth::hal::HciHalHostRootcanalConfig;
+using ::bluetooth::hci::Controller;
+using ::bluetooth::hci::HciLayer;
+using ::bluetooth::os::ParameterProvider;
+using ::bluetooth::os::Thread;
+
+namespace {
+
+bool RootcanalIsListening() {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return false;
+  }
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(HciHalHostRootcanalConfig::Get()->GetPort());
+  inet_pton(AF_INET, HciHalHostRootcanalConfig::Get()->GetServerAddress().c_str(), &addr.sin_addr);
+  bool listening = connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0;
+  close(fd);
+  return listening;
+}
+
+}  // namespace
+
+// Measures Controller::Start() against RootCanal, either reading every capability from the controller or replaying
+// them from the capability snapshot stored by the previous start. Start RootCanal on the default HCI port first.
+class BM_ControllerStartup : public ::benchmark::Fixture {
+ protected:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    config_path_ = std::filesystem::temp_directory_path() / "controller_startup_benchmark.conf";
+    ParameterProvider::OverrideConfigFilePath(config_path_.string());
+    RemoveConfig();
+    thread_ = std::make_unique<Thread>("controller_benchmark", Thread::Priority::NORMAL);
+  }
+
+  void TearDown(State& st) override {
+    thread_->Stop();
+    thread_ = nullptr;
+    RemoveConfig();
+    ::benchmark::Fixture::TearDown(st);
+  }
+
+  void RemoveConfig() {
+    std::filesystem::remove(config_path_);
+    std::filesystem::remove(config_path_.string() + ".bak");
+  }
+
+  std::filesystem::path config_path_;
+  std::unique_ptr<Thread> thread_;
+};
+
+BENCHMARK_DEFINE_F(BM_ControllerStartup, start_controller)(State& state) {
+  if (!RootcanalIsListening()) {
+    state.SkipWithError("RootCanal is not listening");
+    return;
+  }
+  bool use_snapshot = state.range(0) != 0;
+  if (use_snapshot) {
+    ModuleRegistry registry;
+    registry.Start<Controller>(thread_.get());
+    registry.StopAll();
+  }
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    if (!use_snapshot) {
+      RemoveConfig();
+    }
+    // The HCI layer resets the controller when it starts, leave that out of the measurement
+    ModuleRegistry registry;
+    registry.Start<HciLayer>(thread_.get());
+    state.ResumeTiming();
+
+    registry.Start<Controller>(thread_.get());
+
+    state.PauseTiming();
+    registry.StopAll();
+    state.ResumeTiming();
+  }
+}
+
+BENCHMARK_REGISTER_F(BM_ControllerStartup, start_controller)
+    ->ArgName("snapshot")
+    ->Arg(0)
+    ->Arg(1)
+    ->Unit(::benchmark::kMillisecond)
+    ->UseRealTime();
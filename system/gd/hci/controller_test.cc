@@ -18,8 +18,10 @@
 
 #include <algorithm>
 #include <chrono>
+#include <filesystem>
 #include <future>
 #include <map>
+#include <set>
 
 #include <gtest/gtest.h>
 
@@ -30,6 +32,7 @@
 #include "hci/hci_layer.h"
 #include "os/thread.h"
 #include "packet/raw_builder.h"
+#include "storage/storage_module.h"
 
 namespace bluetooth {
 namespace hci {
@@ -76,6 +79,10 @@ class TestHciLayer : public HciLayer {
     auto packet_view = GetPacketView(std::move(command_builder));
     CommandView command = CommandView::Create(packet_view);
     ASSERT_TRUE(command.IsValid());
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      received_op_codes_.insert(command.GetOpCode());
+    }
 
     uint8_t num_packets = 1;
     std::unique_ptr<packet::BasePacketBuilder> event_builder;
@@ -249,6 +256,11 @@ class TestHciLayer : public HciLayer {
     return command;
   }
 
+  bool Received(OpCode op_code) const {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return received_op_codes_.count(op_code) != 0;
+  }
+
   void ListDependencies(ModuleList* list) const {}
   void Start() override {}
   void Stop() override {}
@@ -263,16 +275,27 @@ class TestHciLayer : public HciLayer {
  private:
   common::ContextualCallback<void(EventView)> number_of_completed_packets_callback_;
   std::queue<CommandView> command_queue_;
+  std::set<OpCode> received_op_codes_;
   mutable std::mutex mutex_;
   std::condition_variable not_empty_;
 };
 
+class TestStorageModule : public storage::StorageModule {
+ public:
+  explicit TestStorageModule(std::string config_file_path)
+      : storage::StorageModule(std::move(config_file_path), std::chrono::milliseconds(100), 10, false, false) {}
+};
+
 class ControllerTest : public ::testing::Test {
  protected:
   void SetUp() override {
     bluetooth::common::InitFlags::SetAllForTesting();
+    temp_config_ = std::filesystem::temp_directory_path() / "controller_test_config.txt";
+    RemoveConfig();
     test_hci_layer_ = new TestHciLayer;
     fake_registry_.InjectTestModule(&HciLayer::Factory, test_hci_layer_);
+    test_storage_ = new TestStorageModule(temp_config_.string());
+    fake_registry_.InjectTestModule(&storage::StorageModule::Factory, test_storage_);
     client_handler_ = fake_registry_.GetTestModuleHandler(&HciLayer::Factory);
     fake_registry_.Start<Controller>(&thread_);
     controller_ = static_cast<Controller*>(fake_registry_.GetModuleUnderTest(&Controller::Factory));
@@ -280,10 +303,18 @@ class ControllerTest : public ::testing::Test {
 
   void TearDown() override {
     fake_registry_.StopAll();
+    RemoveConfig();
+  }
+
+  void RemoveConfig() {
+    std::filesystem::remove(temp_config_);
+    std::filesystem::remove(temp_config_.string() + ".bak");
   }
 
   TestModuleRegistry fake_registry_;
   TestHciLayer* test_hci_layer_ = nullptr;
+  TestStorageModule* test_storage_ = nullptr;
+  std::filesystem::path temp_config_;
   os::Thread& thread_ = fake_registry_.GetTestThread();
   Controller* controller_ = nullptr;
   os::Handler* client_handler_ = nullptr;
@@ -314,6 +345,35 @@ TEST_F(ControllerTest, read_controller_info) {
   ASSERT_EQ(controller_->GetLeNumberOfSupportedAdverisingSets(), 0xF0);
 }
 
+TEST_F(ControllerTest, capabilities_replayed_from_snapshot) {
+  ASSERT_TRUE(test_storage_->GetAdapterConfig().GetControllerCapabilities());
+  ASSERT_TRUE(test_hci_layer_->Received(OpCode::READ_LOCAL_SUPPORTED_COMMANDS));
+  fake_registry_.StopAll();
+
+  // Restart on the same config, the capabilities are read only for the version and the address
+  TestModuleRegistry registry;
+  auto hci_layer = new TestHciLayer;
+  registry.InjectTestModule(&HciLayer::Factory, hci_layer);
+  registry.InjectTestModule(&storage::StorageModule::Factory, new TestStorageModule(temp_config_.string()));
+  auto controller = registry.Start<Controller>();
+
+  ASSERT_TRUE(hci_layer->Received(OpCode::READ_LOCAL_VERSION_INFORMATION));
+  ASSERT_TRUE(hci_layer->Received(OpCode::READ_BD_ADDR));
+  ASSERT_FALSE(hci_layer->Received(OpCode::READ_LOCAL_SUPPORTED_COMMANDS));
+  ASSERT_FALSE(hci_layer->Received(OpCode::READ_LOCAL_EXTENDED_FEATURES));
+  ASSERT_FALSE(hci_layer->Received(OpCode::READ_BUFFER_SIZE));
+  ASSERT_FALSE(hci_layer->Received(OpCode::LE_GET_VENDOR_CAPABILITIES));
+
+  ASSERT_EQ(controller->GetAclPacketLength(), hci_layer->acl_data_packet_length);
+  ASSERT_EQ(controller->GetNumAclPacketBuffers(), hci_layer->total_num_acl_data_packets);
+  ASSERT_EQ(controller->GetLeBufferSize().le_data_packet_length_, 0x16);
+  ASSERT_EQ(controller->GetLeSupportedStates(), 0x001f123456789abe);
+  ASSERT_EQ(controller->GetLocalFeatures(2), 0x012345678abcdef + 2);
+  ASSERT_EQ(controller->GetVendorCapabilities().version_supported_, 55);
+  ASSERT_TRUE(controller->IsSupported(OpCode::INQUIRY));
+  registry.StopAll();
+}
+
 TEST_F(ControllerTest, read_write_local_name) {
   ASSERT_EQ(controller_->GetLocalName(), "DUT");
   controller_->WriteLocalName("New name");
@@ -16,10 +16,16 @@
 
 #include "hci/hci_layer.h"
 
+#include <algorithm>
+#include <array>
+#include <future>
+#include <mutex>
+
 #include "common/bind.h"
 #include "common/init_flags.h"
 #include "common/stop_watch.h"
 #include "hci/hci_metrics_logging.h"
+#include "hci_layer_generated.h"
 #include "os/alarm.h"
 #include "os/metrics.h"
 #include "os/queue.h"
@@ -47,6 +53,21 @@ using os::Handler;
 using std::move;
 using std::unique_ptr;
 
+// Upper limits of the command latency histogram buckets, the last bucket
+// collects everything slower
+static constexpr std::array<std::chrono::microseconds, 10> kCommandLatencyBucketLimits = {
+    std::chrono::microseconds(250),
+    std::chrono::microseconds(500),
+    std::chrono::milliseconds(1),
+    std::chrono::milliseconds(2),
+    std::chrono::milliseconds(5),
+    std::chrono::milliseconds(10),
+    std::chrono::milliseconds(20),
+    std::chrono::milliseconds(50),
+    std::chrono::milliseconds(100),
+    std::chrono::milliseconds(500),
+};
+
 static void fail_if_reset_complete_not_success(CommandCompleteView complete) {
   auto reset_complete = ResetCompleteView::Create(complete);
   ASSERT(reset_complete.IsValid());
@@ -58,6 +79,13 @@ static void abort_after_time_out(OpCode op_code) {
   ASSERT_LOG(false, "Done waiting for debug information after HCI timeout (%s)", OpCodeText(op_code).c_str());
 }
 
+struct CommandLatency {
+  uint32_t count{0};
+  std::chrono::microseconds total{0};
+  std::chrono::microseconds max{0};
+  std::array<uint32_t, kCommandLatencyBucketLimits.size() + 1> buckets{};
+};
+
 class CommandQueueEntry {
  public:
   CommandQueueEntry(
@@ -69,7 +97,9 @@ class CommandQueueEntry {
       : command(move(command_packet)), waiting_for_status_(true), on_status(move(on_status_function)) {}
 
   unique_ptr<CommandBuilder> command;
+  std::shared_ptr<std::vector<uint8_t>> command_bytes;
   unique_ptr<CommandView> command_view;
+  std::chrono::steady_clock::time_point send_time;
 
   bool waiting_for_status_;
   ContextualOnceCallback<void(CommandStatusView)> on_status;
@@ -107,6 +137,7 @@ struct HciLayer::impl {
       delete hci_abort_alarm_;
     }
     command_queue_.clear();
+    commands_in_flight_.clear();
   }
 
   void drop(EventView event) {
@@ -174,18 +205,22 @@ struct HciLayer::impl {
     }
     bool is_status = logging_id == "status";
 
-    ASSERT_LOG(!command_queue_.empty(), "Unexpected %s event with OpCode 0x%02hx (%s)", logging_id.c_str(), op_code,
-               OpCodeText(op_code).c_str());
-    if (waiting_command_ == OpCode::CONTROLLER_DEBUG_INFO && op_code != OpCode::CONTROLLER_DEBUG_INFO) {
+    ASSERT_LOG(!commands_in_flight_.empty(), "Unexpected %s event with OpCode 0x%02hx (%s)", logging_id.c_str(),
+               op_code, OpCodeText(op_code).c_str());
+    auto entry = find_command_in_flight(op_code);
+    if (entry == commands_in_flight_.end() &&
+        find_command_in_flight(OpCode::CONTROLLER_DEBUG_INFO) != commands_in_flight_.end()) {
       LOG_ERROR("Discarding event that came after timeout 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
       return;
     }
-    ASSERT_LOG(waiting_command_ == op_code, "Waiting for 0x%02hx (%s), got 0x%02hx (%s)", waiting_command_,
-               OpCodeText(waiting_command_).c_str(), op_code, OpCodeText(op_code).c_str());
+    OpCode oldest_op_code = commands_in_flight_.front().command_view->GetOpCode();
+    ASSERT_LOG(entry != commands_in_flight_.end(), "Waiting for 0x%02hx (%s), got 0x%02hx (%s)", oldest_op_code,
+               OpCodeText(oldest_op_code).c_str(), op_code, OpCodeText(op_code).c_str());
+    record_command_latency(op_code, std::chrono::steady_clock::now() - entry->send_time);
 
     bool is_vendor_specific = static_cast<int>(op_code) & (0x3f << 10);
     CommandStatusView status_view = CommandStatusView::Create(event);
-    if (is_vendor_specific && (is_status && !command_queue_.front().waiting_for_status_) &&
+    if (is_vendor_specific && (is_status && !entry->waiting_for_status_) &&
         (status_view.IsValid() && status_view.GetStatus() == ErrorCode::UNKNOWN_HCI_COMMAND)) {
       // If this is a command status of a vendor specific command, and command complete is expected, we can't treat
       // this as hard failure since we have no way of probing this lack of support at earlier time. Instead we let
@@ -193,35 +228,72 @@ struct HciLayer::impl {
       // response.
       CommandCompleteView command_complete_view = CommandCompleteView::Create(
           EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-      command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
+      entry->GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
     } else {
-      if (command_queue_.front().waiting_for_status_ == is_status) {
-        command_queue_.front().GetCallback<TResponse>()->Invoke(move(response_view));
+      if (entry->waiting_for_status_ == is_status) {
+        entry->GetCallback<TResponse>()->Invoke(move(response_view));
       } else {
         CommandCompleteView command_complete_view = CommandCompleteView::Create(
             EventView::Create(PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>()))));
-        command_queue_.front().GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
+        entry->GetCallback<CommandCompleteView>()->Invoke(move(command_complete_view));
       }
     }
 
-    command_queue_.pop_front();
-    waiting_command_ = OpCode::NONE;
+    bool was_oldest = entry == commands_in_flight_.begin();
+    commands_in_flight_.erase(entry);
     if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Cancel();
+      if (commands_in_flight_.empty()) {
+        hci_timeout_alarm_->Cancel();
+      } else if (was_oldest) {
+        schedule_hci_timeout();
+      }
       send_next_command();
     }
   }
 
+  // Returns the oldest command in flight with |op_code|. Controllers may complete commands out of order, but
+  // commands with the same op code are answered in the order they were sent.
+  std::list<CommandQueueEntry>::iterator find_command_in_flight(OpCode op_code) {
+    return std::find_if(commands_in_flight_.begin(), commands_in_flight_.end(), [op_code](const CommandQueueEntry& e) {
+      return e.command_view->GetOpCode() == op_code;
+    });
+  }
+
+  // Arms the timeout for the oldest command in flight. Every command gets kHciTimeoutMs from the time it was sent.
+  void schedule_hci_timeout() {
+    const CommandQueueEntry& oldest = commands_in_flight_.front();
+    auto elapsed =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - oldest.send_time);
+    // A zero delay would disarm the alarm
+    auto delay = std::max(kHciTimeoutMs - elapsed, std::chrono::milliseconds(1));
+    hci_timeout_alarm_->Schedule(
+        BindOnce(&impl::on_hci_timeout, common::Unretained(this), oldest.command_view->GetOpCode()), delay);
+  }
+
+  void record_command_latency(OpCode op_code, std::chrono::steady_clock::duration latency) {
+    auto latency_us = std::chrono::duration_cast<std::chrono::microseconds>(latency);
+    size_t bucket = 0;
+    while (bucket < kCommandLatencyBucketLimits.size() && latency_us > kCommandLatencyBucketLimits[bucket]) {
+      bucket++;
+    }
+    std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+    CommandLatency& command_latency = command_latency_[op_code];
+    command_latency.count++;
+    command_latency.total += latency_us;
+    command_latency.max = std::max(command_latency.max, latency_us);
+    command_latency.buckets[bucket]++;
+  }
+
   void on_hci_timeout(OpCode op_code) {
     common::StopWatch::DumpStopWatchLog();
     LOG_ERROR("Timed out waiting for 0x%02hx (%s)", op_code, OpCodeText(op_code).c_str());
     // TODO: LogMetricHciTimeoutEvent(static_cast<uint32_t>(op_code));
 
-    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size());
+    LOG_ERROR("Flushing %zd waiting commands", command_queue_.size() + commands_in_flight_.size());
     // Clear any waiting commands (there is an abort coming anyway)
     command_queue_.clear();
+    commands_in_flight_.clear();
     command_credits_ = 1;
-    waiting_command_ = OpCode::NONE;
     enqueue_command(
         ControllerDebugInfoBuilder::Create(), module_.GetHandler()->BindOnce(&fail_if_reset_complete_not_success));
     // Don't time out for this one;
@@ -238,33 +310,61 @@ struct HciLayer::impl {
     }
   }
 
-  void send_next_command() {
-    if (command_credits_ == 0) {
-      return;
-    }
-    if (waiting_command_ != OpCode::NONE) {
+  // Reset changes the number of credits and CONTROLLER_DEBUG_INFO is only sent once a command timed out, so both
+  // are always sent alone even when commands are pipelined
+  static bool is_command_barrier(const CommandQueueEntry& entry) {
+    OpCode op_code = entry.command_view->GetOpCode();
+    return op_code == OpCode::RESET || op_code == OpCode::CONTROLLER_DEBUG_INFO;
+  }
+
+  void prepare_command(CommandQueueEntry& entry) {
+    if (entry.command_view != nullptr) {
       return;
     }
-    if (command_queue_.size() == 0) {
-      return;
+    entry.command_bytes = std::make_shared<std::vector<uint8_t>>();
+    BitInserter bi(*entry.command_bytes);
+    entry.command->Serialize(bi);
+    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(entry.command_bytes));
+    ASSERT(cmd_view.IsValid());
+    entry.command_view = std::make_unique<CommandView>(std::move(cmd_view));
+  }
+
+  void send_next_command() {
+    while (command_credits_ > 0 && !command_queue_.empty()) {
+      if (!commands_in_flight_.empty()) {
+        if (!pipelined_ || is_command_barrier(commands_in_flight_.back())) {
+          return;
+        }
+        prepare_command(command_queue_.front());
+        if (is_command_barrier(command_queue_.front())) {
+          return;
+        }
+      }
+      send_command();
     }
-    std::shared_ptr<std::vector<uint8_t>> bytes = std::make_shared<std::vector<uint8_t>>();
-    BitInserter bi(*bytes);
-    command_queue_.front().command->Serialize(bi);
-    hal_->sendHciCommand(*bytes);
+  }
 
-    auto cmd_view = CommandView::Create(PacketView<kLittleEndian>(bytes));
-    ASSERT(cmd_view.IsValid());
-    OpCode op_code = cmd_view.GetOpCode();
-    command_queue_.front().command_view = std::make_unique<CommandView>(std::move(cmd_view));
-    log_link_layer_connection_command(command_queue_.front().command_view);
-    log_classic_pairing_command_status(command_queue_.front().command_view, ErrorCode::STATUS_UNKNOWN);
-    waiting_command_ = op_code;
-    command_credits_ = 0;  // Only allow one outstanding command
-    if (hci_timeout_alarm_ != nullptr) {
-      hci_timeout_alarm_->Schedule(BindOnce(&impl::on_hci_timeout, common::Unretained(this), op_code), kHciTimeoutMs);
+  void send_command() {
+    commands_in_flight_.splice(commands_in_flight_.end(), command_queue_, command_queue_.begin());
+    CommandQueueEntry& entry = commands_in_flight_.back();
+    prepare_command(entry);
+    hal_->sendHciCommand(*entry.command_bytes);
+    entry.send_time = std::chrono::steady_clock::now();
+
+    OpCode op_code = entry.command_view->GetOpCode();
+    log_link_layer_connection_command(entry.command_view);
+    log_classic_pairing_command_status(entry.command_view, ErrorCode::STATUS_UNKNOWN);
+    if (pipelined_) {
+      command_credits_--;
+      std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+      max_commands_in_flight_ = std::max(max_commands_in_flight_, commands_in_flight_.size());
     } else {
+      command_credits_ = 0;  // Only allow one outstanding command
+    }
+    if (hci_timeout_alarm_ == nullptr) {
       LOG_WARN("%s sent without an hci-timeout timer", OpCodeText(op_code).c_str());
+    } else if (commands_in_flight_.size() == 1) {
+      schedule_hci_timeout();
     }
   }
 
@@ -330,7 +430,7 @@ struct HciLayer::impl {
 
   void on_hci_event(EventView event) {
     ASSERT(event.IsValid());
-    if (command_queue_.empty()) {
+    if (commands_in_flight_.empty()) {
       auto event_code = event.GetEventCode();
       // BT Core spec 5.2 (Volume 4, Part E section 4.4) allows anytime
       // COMMAND_COMPLETE and COMMAND_STATUS with opcode 0x0 for flow control
@@ -355,7 +455,7 @@ struct HciLayer::impl {
       std::unique_ptr<CommandView> no_waiting_command{nullptr};
       log_hci_event(no_waiting_command, event, module_.GetDependency<storage::StorageModule>());
     } else {
-      log_hci_event(command_queue_.front().command_view, event, module_.GetDependency<storage::StorageModule>());
+      log_hci_event(command_view_for_event(event), event, module_.GetDependency<storage::StorageModule>());
     }
     EventCode event_code = event.GetEventCode();
     // Root Inflamation is a special case, since it aborts here
@@ -378,6 +478,61 @@ struct HciLayer::impl {
     event_handlers_[event_code].Invoke(event);
   }
 
+  // Returns the command a Command Complete or Command Status event answers, or the oldest command in flight
+  unique_ptr<CommandView>& command_view_for_event(EventView event) {
+    OpCode op_code = OpCode::NONE;
+    if (event.GetEventCode() == EventCode::COMMAND_COMPLETE) {
+      auto view = CommandCompleteView::Create(event);
+      if (view.IsValid()) op_code = view.GetCommandOpCode();
+    } else if (event.GetEventCode() == EventCode::COMMAND_STATUS) {
+      auto view = CommandStatusView::Create(event);
+      if (view.IsValid()) op_code = view.GetCommandOpCode();
+    }
+    auto entry = find_command_in_flight(op_code);
+    if (entry == commands_in_flight_.end()) {
+      entry = commands_in_flight_.begin();
+    }
+    return entry->command_view;
+  }
+
+  void Dump(
+      std::promise<flatbuffers::Offset<HciLayerData>> promise, flatbuffers::FlatBufferBuilder* fb_builder) const {
+    const std::lock_guard<std::mutex> lock(dumpsys_mutex_);
+    auto title = fb_builder->CreateString("----- Hci Layer Dumpsys -----");
+
+    std::vector<int> bucket_limits;
+    for (const auto& limit : kCommandLatencyBucketLimits) {
+      bucket_limits.push_back(limit.count());
+    }
+    auto bucket_limits_offset = fb_builder->CreateVector(bucket_limits);
+
+    std::vector<flatbuffers::Offset<CommandLatencyData>> latency_offsets;
+    for (const auto& it : command_latency_) {
+      auto op_code = fb_builder->CreateString(OpCodeText(it.first));
+      std::vector<int> buckets(it.second.buckets.begin(), it.second.buckets.end());
+      auto buckets_offset = fb_builder->CreateVector(buckets);
+
+      CommandLatencyDataBuilder latency_builder(*fb_builder);
+      latency_builder.add_op_code(op_code);
+      latency_builder.add_count(it.second.count);
+      latency_builder.add_mean_us(it.second.total.count() / it.second.count);
+      latency_builder.add_max_us(it.second.max.count());
+      latency_builder.add_buckets(buckets_offset);
+      latency_offsets.push_back(latency_builder.Finish());
+    }
+    auto latency_offset = fb_builder->CreateVector(latency_offsets);
+
+    HciLayerDataBuilder builder(*fb_builder);
+    builder.add_title(title);
+    builder.add_pipelined_commands(pipelined_);
+    builder.add_max_commands_in_flight(max_commands_in_flight_);
+    builder.add_latency_bucket_limits_us(bucket_limits_offset);
+    builder.add_command_latency(latency_offset);
+
+    flatbuffers::Offset<HciLayerData> dumpsys_data = builder.Finish();
+    promise.set_value(dumpsys_data);
+  }
+
   void on_le_meta_event(EventView event) {
     LeMetaEventView meta_event_view = LeMetaEventView::Create(event);
     ASSERT(meta_event_view.IsValid());
@@ -394,14 +549,20 @@ struct HciLayer::impl {
 
   // Command Handling
   std::list<CommandQueueEntry> command_queue_;
+  std::list<CommandQueueEntry> commands_in_flight_;
+  // Honor the Num_HCI_Command_Packets reported by the controller instead of sending one command at a time
+  const bool pipelined_{common::init_flags::gd_hci_pipelined_commands_is_enabled()};
 
   std::map<EventCode, ContextualCallback<void(EventView)>> event_handlers_;
   std::map<SubeventCode, ContextualCallback<void(LeMetaEventView)>> subevent_handlers_;
-  OpCode waiting_command_{OpCode::NONE};
   uint8_t command_credits_{1};  // Send reset first
   Alarm* hci_timeout_alarm_{nullptr};
   Alarm* hci_abort_alarm_{nullptr};
 
+  mutable std::mutex dumpsys_mutex_;
+  std::map<OpCode, CommandLatency> command_latency_;  // Guarded by dumpsys_mutex_
+  size_t max_commands_in_flight_{0};                  // Guarded by dumpsys_mutex_
+
   // Acl packets
   BidiQueue<AclView, AclBuilder> acl_queue_{3 /* TODO: Set queue depth */};
   os::EnqueueBuffer<AclView> incoming_acl_buffer_{acl_queue_.GetDownEnd()};
@@ -653,6 +814,23 @@ void HciLayer::Start() {
   EnqueueCommand(ResetBuilder::Create(), handler->BindOnce(&fail_if_reset_complete_not_success));
 }
 
+DumpsysDataFinisher HciLayer::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  ASSERT(fb_builder != nullptr);
+  if (impl_ == nullptr) {
+    return Module::GetDumpsysData(fb_builder);
+  }
+
+  std::promise<flatbuffers::Offset<HciLayerData>> promise;
+  auto future = promise.get_future();
+  impl_->Dump(std::move(promise), fb_builder);
+
+  auto dumpsys_data = future.get();
+
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_hci_layer_dumpsys_data(dumpsys_data);
+  };
+}
+
 void HciLayer::Stop() {
   auto hal = GetDependency<hal::HciHal>();
   hal->unregisterIncomingPacketCallback();
@@ -20,6 +20,7 @@
 #include <list>
 #include <memory>
 
+#include "common/init_flags.h"
 #include "hal/hci_hal.h"
 #include "hci/hci_packets.h"
 #include "module.h"
@@ -232,6 +233,11 @@ class DependsOnHci : public Module {
     return event_promise_->get_future();
   }
 
+  size_t GetNumReceivedEvents() {
+    std::lock_guard<std::mutex> lock(list_protector_);
+    return incoming_events_.size();
+  }
+
   EventView GetReceivedEvent() {
     std::lock_guard<std::mutex> lock(list_protector_);
     EventView packetview = incoming_events_.front();
@@ -423,6 +429,32 @@ class HciTest : public ::testing::Test {
   TestModuleRegistry fake_registry_;
 };
 
+class HciPipelinedTest : public HciTest {
+ public:
+  void SetUp() override {
+    const char* flags[] = {"INIT_gd_hci_pipelined_commands=true", nullptr};
+    common::InitFlags::Load(flags);
+    HciTest::SetUp();
+  }
+
+  void TearDown() override {
+    HciTest::TearDown();
+    common::InitFlags::Load(nullptr);
+  }
+
+  // Events take two hops on the HCI handler before the response reaches the upper module
+  void SyncHandlers() {
+    ASSERT_TRUE(fake_registry_.SynchronizeModuleHandler(&HciLayer::Factory, kTimeout));
+    ASSERT_TRUE(fake_registry_.SynchronizeModuleHandler(&HciLayer::Factory, kTimeout));
+    ASSERT_TRUE(fake_registry_.SynchronizeModuleHandler(&DependsOnHci::Factory, kTimeout));
+  }
+
+  void SendCredits(uint8_t num_packets) {
+    hal->callbacks->hciEventReceived(GetPacketBytes(NoCommandCompleteBuilder::Create(num_packets)));
+    SyncHandlers();
+  }
+};
+
 TEST_F(HciTest, initAndClose) {}
 
 TEST_F(HciTest, leMetaEvent) {
@@ -904,5 +936,85 @@ TEST_F(HciTest, receiveMultipleIsoPackets) {
   ASSERT_EQ(handle, itr.extract<uint16_t>());
   ASSERT_EQ(received_packets, itr.extract<uint16_t>());
 }
+
+TEST_F(HciPipelinedTest, commandsSentWhileCreditsLast) {
+  SendCredits(3);
+  upper->SendHciCommandExpectingComplete(ReadLocalVersionInformationBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedCommandsBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedFeaturesBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadBdAddrBuilder::Create());
+  SyncHandlers();
+
+  // Three are in flight, the last one waits for a credit
+  ASSERT_EQ(3, hal->GetNumSentCommands());
+  ASSERT_EQ(OpCode::READ_LOCAL_VERSION_INFORMATION, hal->GetSentCommand().GetOpCode());
+  ASSERT_EQ(OpCode::READ_LOCAL_SUPPORTED_COMMANDS, hal->GetSentCommand().GetOpCode());
+  ASSERT_EQ(OpCode::READ_LOCAL_SUPPORTED_FEATURES, hal->GetSentCommand().GetOpCode());
+
+  // Complete the second one first
+  uint8_t num_packets = 1;
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  std::array<uint8_t, 64> supported_commands{};
+  hal->callbacks->hciEventReceived(
+      GetPacketBytes(ReadLocalSupportedCommandsCompleteBuilder::Create(num_packets, error_code, supported_commands)));
+  SyncHandlers();
+
+  ASSERT_EQ(1, upper->GetNumReceivedEvents());
+  ASSERT_TRUE(ReadLocalSupportedCommandsCompleteView::Create(CommandCompleteView::Create(upper->GetReceivedEvent()))
+                  .IsValid());
+  ASSERT_EQ(1, hal->GetNumSentCommands());
+  ASSERT_EQ(OpCode::READ_BD_ADDR, hal->GetSentCommand().GetOpCode());
+
+  LocalVersionInformation local_version_information;
+  local_version_information.hci_version_ = HciVersion::V_5_0;
+  local_version_information.hci_revision_ = 0x1234;
+  local_version_information.lmp_version_ = LmpVersion::V_4_2;
+  local_version_information.manufacturer_name_ = 0xBAD;
+  local_version_information.lmp_subversion_ = 0x5678;
+  hal->callbacks->hciEventReceived(GetPacketBytes(
+      ReadLocalVersionInformationCompleteBuilder::Create(num_packets, error_code, local_version_information)));
+  hal->callbacks->hciEventReceived(
+      GetPacketBytes(ReadBdAddrCompleteBuilder::Create(num_packets, error_code, Address::kAny)));
+  hal->callbacks->hciEventReceived(
+      GetPacketBytes(ReadLocalSupportedFeaturesCompleteBuilder::Create(num_packets, error_code, 0x012345678abcdef)));
+  SyncHandlers();
+
+  // Every response reaches the command it belongs to
+  ASSERT_EQ(3, upper->GetNumReceivedEvents());
+  ASSERT_TRUE(ReadLocalVersionInformationCompleteView::Create(CommandCompleteView::Create(upper->GetReceivedEvent()))
+                  .IsValid());
+  ASSERT_TRUE(ReadBdAddrCompleteView::Create(CommandCompleteView::Create(upper->GetReceivedEvent())).IsValid());
+  ASSERT_TRUE(ReadLocalSupportedFeaturesCompleteView::Create(CommandCompleteView::Create(upper->GetReceivedEvent()))
+                  .IsValid());
+  ASSERT_EQ(0, hal->GetNumSentCommands());
+}
+
+TEST_F(HciPipelinedTest, resetIsSentAlone) {
+  SendCredits(3);
+  upper->SendHciCommandExpectingComplete(ReadBdAddrBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ResetBuilder::Create());
+  upper->SendHciCommandExpectingComplete(ReadLocalSupportedFeaturesBuilder::Create());
+  SyncHandlers();
+
+  ASSERT_EQ(1, hal->GetNumSentCommands());
+  ASSERT_EQ(OpCode::READ_BD_ADDR, hal->GetSentCommand().GetOpCode());
+
+  uint8_t num_packets = 2;
+  ErrorCode error_code = ErrorCode::SUCCESS;
+  hal->callbacks->hciEventReceived(
+      GetPacketBytes(ReadBdAddrCompleteBuilder::Create(num_packets, error_code, Address::kAny)));
+  SyncHandlers();
+
+  ASSERT_EQ(1, hal->GetNumSentCommands());
+  ASSERT_EQ(OpCode::RESET, hal->GetSentCommand().GetOpCode());
+
+  hal->callbacks->hciEventReceived(GetPacketBytes(ResetCompleteBuilder::Create(num_packets, error_code)));
+  SyncHandlers();
+
+  ASSERT_EQ(1, hal->GetNumSentCommands());
+  ASSERT_EQ(OpCode::READ_LOCAL_SUPPORTED_FEATURES, hal->GetSentCommand().GetOpCode());
+  ASSERT_EQ(2, upper->GetNumReceivedEvents());
+}
+
 }  // namespace hci
 }  // namespace bluetooth
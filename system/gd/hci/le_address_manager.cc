@@ -221,8 +221,21 @@ AddressWithType LeAddressManager::GetAnotherAddress() {
   return random_address;
 }
 
+// Every command pauses all the clients, except a rotation of the random address which only pauses the clients
+// using it
+bool LeAddressManager::needs_pause(LeAddressManagerCallback* callback) {
+  if (!cached_commands_.empty() &&
+      std::holds_alternative<RotateRandomAddressCommand>(cached_commands_.front().contents)) {
+    return callback->UsesInitiatorAddress();
+  }
+  return true;
+}
+
 void LeAddressManager::pause_registered_clients() {
   for (auto& client : registered_clients_) {
+    if (!needs_pause(client.first)) {
+      continue;
+    }
     if (client.second != ClientState::PAUSED && client.second != ClientState::WAITING_FOR_PAUSE) {
       client.second = ClientState::WAITING_FOR_PAUSE;
       client.first->OnPause();
@@ -231,8 +244,8 @@ void LeAddressManager::pause_registered_clients() {
 }
 
 void LeAddressManager::push_command(Command command) {
-  pause_registered_clients();
   cached_commands_.push(std::move(command));
+  pause_registered_clients();
 }
 
 void LeAddressManager::ack_pause(LeAddressManagerCallback* callback) {
@@ -241,7 +254,7 @@ void LeAddressManager::ack_pause(LeAddressManagerCallback* callback) {
   }
   registered_clients_.find(callback)->second = ClientState::PAUSED;
   for (auto client : registered_clients_) {
-    if (client.second != ClientState::PAUSED) {
+    if (client.second != ClientState::PAUSED && needs_pause(client.first)) {
       // make sure all client paused
       if (client.second != ClientState::WAITING_FOR_PAUSE) {
         LOG_DEBUG("Trigger OnPause for client that not paused and not waiting for pause");
@@ -264,7 +277,11 @@ void LeAddressManager::resume_registered_clients() {
     return;
   }
 
+  // Clients left running while the random address rotated have nothing to resume
   for (auto& client : registered_clients_) {
+    if (client.second != ClientState::PAUSED && client.second != ClientState::WAITING_FOR_PAUSE) {
+      continue;
+    }
     client.second = ClientState::WAITING_FOR_RESUME;
     client.first->OnResume();
   }
@@ -280,6 +297,10 @@ void LeAddressManager::prepare_to_rotate() {
   Command command = {CommandType::ROTATE_RANDOM_ADDRESS, RotateRandomAddressCommand{}};
   cached_commands_.push(std::move(command));
   pause_registered_clients();
+  // No ack_pause will come if none of the clients uses the random address
+  if (cached_commands_.size() == 1) {
+    check_cached_commands();
+  }
 }
 
 void LeAddressManager::schedule_rotate_random_address() {
@@ -406,7 +427,7 @@ uint8_t LeAddressManager::GetResolvingListSize() {
 
 void LeAddressManager::handle_next_command() {
   for (auto client : registered_clients_) {
-    if (client.second != ClientState::PAUSED) {
+    if (client.second != ClientState::PAUSED && needs_pause(client.first)) {
       // make sure all client paused, if not, this function will be trigger again by ack_pause
       LOG_INFO("waiting for ack_pause, return");
       return;
@@ -422,8 +443,10 @@ void LeAddressManager::handle_next_command() {
         using T = std::decay_t<decltype(command)>;
         if constexpr (std::is_same_v<T, UpdateIRKCommand>) {
           update_irk(command);
+          check_cached_commands();
         } else if constexpr (std::is_same_v<T, RotateRandomAddressCommand>) {
           rotate_random_address();
+          check_cached_commands();
         } else if constexpr (std::is_same_v<T, HCICommand>) {
           enqueue_command_.Run(std::move(command.command));
         } else {
@@ -576,7 +599,10 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
           le_address_ = cached_address_;
         }
       }
-    } break;
+      // The HCI layer keeps the commands in order, so the next cached command and the commands of the resumed
+      // clients were sent right after LE Set Random Address without waiting for it to complete
+      return;
+    }
 
     case OpCode::LE_SET_PRIVACY_MODE:
       on_command_complete<LeSetPrivacyModeCompleteView>(view);
@@ -620,7 +646,7 @@ void LeAddressManager::OnCommandComplete(bluetooth::hci::CommandCompleteView vie
 
 void LeAddressManager::check_cached_commands() {
   for (auto client : registered_clients_) {
-    if (client.second != ClientState::PAUSED && !cached_commands_.empty()) {
+    if (client.second != ClientState::PAUSED && !cached_commands_.empty() && needs_pause(client.first)) {
       pause_registered_clients();
       return;
     }
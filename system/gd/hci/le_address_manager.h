@@ -36,6 +36,10 @@ class LeAddressManagerCallback {
   virtual void OnPause() = 0;
   virtual void OnResume() = 0;
   virtual void NotifyOnIRKChange(){};
+  // Clients that never use the address set by LE Set Random Address keep running while it rotates
+  virtual bool UsesInitiatorAddress() {
+    return true;
+  }
 };
 
 class LeAddressManager {
@@ -134,6 +138,7 @@ class LeAddressManager {
     std::variant<RotateRandomAddressCommand, UpdateIRKCommand, HCICommand> contents;
   };
 
+  bool needs_pause(LeAddressManagerCallback* callback);
   void pause_registered_clients();
   void push_command(Command command);
   void ack_pause(LeAddressManagerCallback* callback);
@@ -149,6 +149,22 @@ class RotatorClient : public LeAddressManagerCallback {
   std::unique_ptr<std::promise<void>> resume_promise_;
 };
 
+class AdvertisingSetClient : public RotatorClient {
+ public:
+  AdvertisingSetClient(LeAddressManager* le_address_manager, size_t id) : RotatorClient(le_address_manager, id){};
+
+  void OnPause() override {
+    pause_count++;
+    RotatorClient::OnPause();
+  }
+
+  bool UsesInitiatorAddress() override {
+    return false;
+  }
+
+  size_t pause_count{0};
+};
+
 class LeAddressManagerTest : public ::testing::Test {
  public:
   void SetUp() override {
@@ -275,6 +291,67 @@ TEST_F(LeAddressManagerTest, DISABLED_rotator_address_for_multiple_clients) {
   sync_handler(handler_);
 }
 
+TEST_F(LeAddressManagerTest, rotation_pauses_only_clients_using_random_address) {
+  AdvertisingSetClient advertising_set_client(le_address_manager_, 1);
+  Octet16 irk = {0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05, 0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b};
+  auto minimum_rotation_time = std::chrono::milliseconds(100);
+  auto maximum_rotation_time = std::chrono::milliseconds(200);
+  AddressWithType remote_address(Address::kEmpty, AddressType::RANDOM_DEVICE_ADDRESS);
+  le_address_manager_->SetPrivacyPolicyForInitiatorAddressForTest(
+      LeAddressManager::AddressPolicy::USE_RESOLVABLE_ADDRESS,
+      remote_address,
+      irk,
+      minimum_rotation_time,
+      maximum_rotation_time);
+
+  test_hci_layer_->SetCommandFuture();
+  le_address_manager_->Register(clients[0].get());
+  le_address_manager_->Register(&advertising_set_client);
+  sync_handler(handler_);
+  test_hci_layer_->GetCommand(OpCode::LE_SET_RANDOM_ADDRESS);
+  test_hci_layer_->IncomingEvent(LeSetRandomAddressCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+
+  // Wait for the first rotation
+  test_hci_layer_->SetCommandFuture();
+  test_hci_layer_->GetCommand(OpCode::LE_SET_RANDOM_ADDRESS);
+  sync_handler(handler_);
+
+  // The client using the random address is resumed without waiting for the command to complete
+  EXPECT_FALSE(clients[0]->paused);
+  EXPECT_EQ(0u, advertising_set_client.pause_count);
+
+  test_hci_layer_->IncomingEvent(LeSetRandomAddressCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  sync_handler(handler_);
+  EXPECT_FALSE(clients[0]->paused);
+  le_address_manager_->Unregister(clients[0].get());
+  le_address_manager_->Unregister(&advertising_set_client);
+  sync_handler(handler_);
+}
+
+TEST_F(LeAddressManagerTest, clients_not_using_random_address_pause_for_other_commands) {
+  AdvertisingSetClient advertising_set_client(le_address_manager_, 1);
+  le_address_manager_->SetPrivacyPolicyForInitiatorAddressForTest(
+      LeAddressManager::AddressPolicy::USE_PUBLIC_ADDRESS,
+      AddressWithType(Address({0x01, 0x02, 0x03, 0x04, 0x05, 0x06}), AddressType::PUBLIC_DEVICE_ADDRESS),
+      {},
+      std::chrono::milliseconds(1000),
+      std::chrono::milliseconds(3000));
+  le_address_manager_->Register(&advertising_set_client);
+  sync_handler(handler_);
+
+  Address address;
+  Address::FromString("01:02:03:04:05:06", address);
+  test_hci_layer_->SetCommandFuture();
+  le_address_manager_->AddDeviceToFilterAcceptList(FilterAcceptListAddressType::RANDOM, address);
+  test_hci_layer_->GetCommand(OpCode::LE_ADD_DEVICE_TO_FILTER_ACCEPT_LIST);
+  EXPECT_EQ(1u, advertising_set_client.pause_count);
+
+  test_hci_layer_->IncomingEvent(LeAddDeviceToFilterAcceptListCompleteBuilder::Create(0x01, ErrorCode::SUCCESS));
+  advertising_set_client.WaitForResume();
+  le_address_manager_->Unregister(&advertising_set_client);
+  sync_handler(handler_);
+}
+
 class LeAddressManagerWithSingleClientTest : public LeAddressManagerTest {
  public:
   void SetUp() override {
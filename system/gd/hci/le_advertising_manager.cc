@@ -15,8 +15,10 @@
  */
 #include "hci/le_advertising_manager.h"
 
+#include <algorithm>
 #include <memory>
 #include <mutex>
+#include <optional>
 
 #include "common/init_flags.h"
 #include "hci/acl_manager.h"
@@ -65,8 +67,21 @@ struct Advertiser {
   bool directed = false;
   bool in_use = false;
   std::unique_ptr<os::Alarm> address_rotation_alarm;
+  // Payloads the controller holds for this set, used to skip updates that would not change them
+  std::optional<std::vector<uint8_t>> advertising_data;
+  std::optional<std::vector<uint8_t>> scan_response_data;
+  std::optional<std::vector<uint8_t>> periodic_data;
 };
 
+static std::vector<uint8_t> serialize_gap_data(const std::vector<GapData>& data) {
+  std::vector<uint8_t> bytes;
+  BitInserter inserter(bytes);
+  for (const auto& gap_data : data) {
+    gap_data.Serialize(inserter);
+  }
+  return bytes;
+}
+
 ExtendedAdvertisingConfig::ExtendedAdvertisingConfig(const AdvertisingConfig& config) : AdvertisingConfig(config) {
   switch (config.advertising_type) {
     case AdvertisingType::ADV_IND:
@@ -460,6 +475,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       LOG_INFO("Unknown advertising set %u", advertiser_id);
       return;
     }
+    send_pending_extended_enable_for(advertiser_id);
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
     std::vector<EnabledSet> enabled_vector{curr_set};
@@ -495,6 +511,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void rotate_advertiser_address(AdvertiserId advertiser_id) {
     if (advertising_api_type_ == AdvertisingApiType::EXTENDED) {
+      send_pending_extended_enable_for(advertiser_id);
       AddressWithType address_with_type = le_address_manager_->GetAnotherAddress();
       le_advertising_interface_->EnqueueCommand(
           hci::LeSetAdvertisingSetRandomAddressBuilder::Create(advertiser_id, address_with_type.GetAddress()),
@@ -516,6 +533,8 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    send_pending_extended_enable_for(advertiser_id);
+
     // TODO handle duration and max_extended_advertising_events_
     EnabledSet curr_set;
     curr_set.advertising_handle_ = advertiser_id;
@@ -558,9 +577,14 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   }
 
   void set_parameters(AdvertiserId advertiser_id, ExtendedAdvertisingConfig config) {
+    send_pending_extended_enable_for(advertiser_id);
     advertising_sets_[advertiser_id].connectable = config.connectable;
     advertising_sets_[advertiser_id].tx_power = config.tx_power;
     advertising_sets_[advertiser_id].directed = config.directed;
+    // The new advertising event properties may not keep the data, so always send the next payloads
+    advertising_sets_[advertiser_id].advertising_data.reset();
+    advertising_sets_[advertiser_id].scan_response_data.reset();
+    advertising_sets_[advertiser_id].periodic_data.reset();
 
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
@@ -764,6 +788,24 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    std::optional<std::vector<uint8_t>>& sent_data = set_scan_rsp ? advertising_sets_[advertiser_id].scan_response_data
+                                                                  : advertising_sets_[advertiser_id].advertising_data;
+    std::vector<uint8_t> bytes = serialize_gap_data(data);
+    if (sent_data == bytes) {
+      LOG_DEBUG(
+          "%s of advertising set %u unchanged", set_scan_rsp ? "Scan response" : "Advertising data", advertiser_id);
+      if (advertising_callbacks_ != nullptr && advertising_sets_[advertiser_id].started &&
+          id_map_[advertiser_id] != kIdLocal) {
+        if (set_scan_rsp) {
+          advertising_callbacks_->OnScanResponseDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        } else {
+          advertising_callbacks_->OnAdvertisingDataSet(advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+        }
+      }
+      return;
+    }
+    send_pending_extended_enable_for(advertiser_id);
+
     switch (advertising_api_type_) {
       case (AdvertisingApiType::LEGACY): {
         if (set_scan_rsp) {
@@ -846,6 +888,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
         }
       } break;
     }
+    sent_data = std::move(bytes);
   }
 
   void send_data_fragment(
@@ -867,11 +910,13 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       if (set_scan_rsp) {
         le_advertising_interface_->EnqueueCommand(
             hci::LeSetExtendedScanResponseDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnce(impl::check_status<LeSetExtendedScanResponseDataCompleteView>));
+            module_handler_->BindOnceOn(
+                this, &impl::check_fragment_status<LeSetExtendedScanResponseDataCompleteView>, advertiser_id));
       } else {
         le_advertising_interface_->EnqueueCommand(
             hci::LeSetExtendedAdvertisingDataBuilder::Create(advertiser_id, operation, kFragment_preference, data),
-            module_handler_->BindOnce(impl::check_status<LeSetExtendedAdvertisingDataCompleteView>));
+            module_handler_->BindOnceOn(
+                this, &impl::check_fragment_status<LeSetExtendedAdvertisingDataCompleteView>, advertiser_id));
       }
     }
   }
@@ -902,13 +947,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
                 this, &impl::on_set_advertising_enable_complete<LeMultiAdvtCompleteView>, enable, enabled_sets));
       } break;
       case (AdvertisingApiType::EXTENDED): {
-        le_advertising_interface_->EnqueueCommand(
-            hci::LeSetExtendedAdvertisingEnableBuilder::Create(enable_value, enabled_sets),
-            module_handler_->BindOnceOn(
-                this,
-                &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
-                enable,
-                enabled_sets));
+        queue_extended_enable(enable, curr_set);
       } break;
     }
 
@@ -925,8 +964,73 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // Enabling or disabling several extended advertising sets in a row, e.g. when a batch of sets is started, is
+  // coalesced into a single LE Set Extended Advertising Enable command carrying all of them. The command is sent once
+  // the handler has run the requests already posted to it, or earlier when another command for one of the queued sets
+  // has to follow it.
+  void queue_extended_enable(bool enable, EnabledSet enabled_set) {
+    if (!pending_extended_enable_sets_.empty() && pending_extended_enable_ != enable) {
+      send_pending_extended_enable();
+    }
+    pending_extended_enable_sets_.erase(
+        std::remove_if(
+            pending_extended_enable_sets_.begin(),
+            pending_extended_enable_sets_.end(),
+            [&enabled_set](const EnabledSet& set) {
+              return set.advertising_handle_ == enabled_set.advertising_handle_;
+            }),
+        pending_extended_enable_sets_.end());
+    pending_extended_enable_ = enable;
+    pending_extended_enable_sets_.push_back(enabled_set);
+    if (!pending_extended_enable_scheduled_) {
+      pending_extended_enable_scheduled_ = true;
+      module_handler_->CallOn(this, &impl::on_pending_extended_enable_scheduled);
+    }
+  }
+
+  void on_pending_extended_enable_scheduled() {
+    pending_extended_enable_scheduled_ = false;
+    send_pending_extended_enable();
+  }
+
+  void send_pending_extended_enable() {
+    if (pending_extended_enable_sets_.empty()) {
+      return;
+    }
+    std::vector<EnabledSet> enabled_sets;
+    enabled_sets.swap(pending_extended_enable_sets_);
+    send_extended_enable(pending_extended_enable_, enabled_sets);
+  }
+
+  bool is_extended_enable_pending(AdvertiserId advertiser_id) {
+    for (const auto& enabled_set : pending_extended_enable_sets_) {
+      if (enabled_set.advertising_handle_ == advertiser_id) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void send_pending_extended_enable_for(AdvertiserId advertiser_id) {
+    if (is_extended_enable_pending(advertiser_id)) {
+      send_pending_extended_enable();
+    }
+  }
+
+  void send_extended_enable(bool enable, std::vector<EnabledSet> enabled_sets) {
+    Enable enable_value = enable ? Enable::ENABLED : Enable::DISABLED;
+    le_advertising_interface_->EnqueueCommand(
+        hci::LeSetExtendedAdvertisingEnableBuilder::Create(enable_value, enabled_sets),
+        module_handler_->BindOnceOn(
+            this,
+            &impl::on_set_extended_advertising_enable_complete<LeSetExtendedAdvertisingEnableCompleteView>,
+            enable,
+            enabled_sets));
+  }
+
   void set_periodic_parameter(
       AdvertiserId advertiser_id, PeriodicAdvertisingParameters periodic_advertising_parameters) {
+    send_pending_extended_enable_for(advertiser_id);
     uint8_t include_tx_power = periodic_advertising_parameters.properties >>
                                PeriodicAdvertisingParameters::AdvertisingProperty::INCLUDE_TX_POWER;
 
@@ -965,6 +1069,18 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       return;
     }
 
+    std::vector<uint8_t> bytes = serialize_gap_data(data);
+    if (advertising_sets_[advertiser_id].periodic_data == bytes) {
+      LOG_DEBUG("Periodic data of advertising set %u unchanged", advertiser_id);
+      if (advertising_callbacks_ != nullptr && advertising_sets_[advertiser_id].started &&
+          id_map_[advertiser_id] != kIdLocal) {
+        advertising_callbacks_->OnPeriodicAdvertisingDataSet(
+            advertiser_id, AdvertisingCallback::AdvertisingStatus::SUCCESS);
+      }
+      return;
+    }
+    send_pending_extended_enable_for(advertiser_id);
+
     if (data_len <= kLeMaximumFragmentLength) {
       send_periodic_data_fragment(advertiser_id, data, Operation::COMPLETE_ADVERTISEMENT);
     } else {
@@ -984,6 +1100,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       }
       send_periodic_data_fragment(advertiser_id, sub_data, Operation::LAST_FRAGMENT);
     }
+    advertising_sets_[advertiser_id].periodic_data = std::move(bytes);
   }
 
   void send_periodic_data_fragment(AdvertiserId advertiser_id, std::vector<GapData> data, Operation operation) {
@@ -996,11 +1113,13 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
       // For first and intermediate fragment, do not trigger advertising_callbacks_.
       le_advertising_interface_->EnqueueCommand(
           hci::LeSetPeriodicAdvertisingDataBuilder::Create(advertiser_id, operation, data),
-          module_handler_->BindOnce(impl::check_status<LeSetPeriodicAdvertisingDataCompleteView>));
+          module_handler_->BindOnceOn(
+              this, &impl::check_fragment_status<LeSetPeriodicAdvertisingDataCompleteView>, advertiser_id));
     }
   }
 
   void enable_periodic_advertising(AdvertiserId advertiser_id, bool enable) {
+    send_pending_extended_enable_for(advertiser_id);
     Enable enable_value = enable ? Enable::ENABLED : Enable::DISABLED;
 
     le_advertising_interface_->EnqueueCommand(
@@ -1014,6 +1133,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void OnPause() override {
     paused = true;
+    send_pending_extended_enable();
     if (!advertising_sets_.empty()) {
       std::vector<EnabledSet> enabled_sets = {};
       for (size_t i = 0; i < enabled_sets_.size(); i++) {
@@ -1053,6 +1173,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
 
   void OnResume() override {
     paused = false;
+    send_pending_extended_enable();
     if (!advertising_sets_.empty()) {
       std::vector<EnabledSet> enabled_sets = {};
       for (size_t i = 0; i < enabled_sets_.size(); i++) {
@@ -1090,6 +1211,11 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     le_address_manager_->AckResume(this);
   }
 
+  // Extended advertising sets get their own address with LE Set Advertising Set Random Address
+  bool UsesInitiatorAddress() override {
+    return advertising_api_type_ != AdvertisingApiType::EXTENDED;
+  }
+
   // Note: this needs to be synchronous (i.e. NOT on a handler) for two reasons:
   // 1. For parity with OnPause() and OnResume()
   // 2. If we don't enqueue our HCI commands SYNCHRONOUSLY, then it is possible that we OnResume() in addressManager
@@ -1126,6 +1252,9 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
   std::mutex id_mutex_;
   size_t num_instances_;
   std::vector<hci::EnabledSet> enabled_sets_;
+  std::vector<hci::EnabledSet> pending_extended_enable_sets_;
+  bool pending_extended_enable_ = false;
+  bool pending_extended_enable_scheduled_ = false;
   // map to mapping the id from java layer and advertier id
   std::map<uint8_t, int> id_map_;
 
@@ -1196,6 +1325,22 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (complete_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(complete_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      // The controller rejects the whole command if any of the sets fails, retry them one by one so that only the
+      // failing sets are reported. A set whose requested state changed since the batch was sent, or that has another
+      // request waiting to be coalesced, is not retried: the later request stands, and the batch fails for the set.
+      if (enabled_sets.size() > 1) {
+        std::vector<EnabledSet> not_retried;
+        for (const auto& enabled_set : enabled_sets) {
+          uint8_t id = enabled_set.advertising_handle_;
+          bool requested = id != kInvalidHandle && (enabled_sets_[id].advertising_handle_ != kInvalidHandle) == enable;
+          if (requested && !is_extended_enable_pending(id)) {
+            send_extended_enable(enable, {enabled_set});
+          } else {
+            not_retried.push_back(enabled_set);
+          }
+        }
+        enabled_sets.swap(not_retried);
+      }
     }
 
     if (advertising_callbacks_ == nullptr) {
@@ -1295,6 +1440,7 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     if (status_view.GetStatus() != ErrorCode::SUCCESS) {
       LOG_INFO("Got a command complete with status %s", ErrorCodeText(status_view.GetStatus()).c_str());
       advertising_status = AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR;
+      forget_sent_data(id);
     }
 
     // Do not trigger callback if the advertiser not stated yet, or the advertiser is not register
@@ -1347,6 +1493,28 @@ struct LeAdvertisingManager::impl : public bluetooth::hci::LeAddressManagerCallb
     }
   }
 
+  // For the first and intermediate fragments of a payload, which do not trigger advertising_callbacks_
+  template <class View>
+  void check_fragment_status(AdvertiserId id, CommandCompleteView view) {
+    ASSERT(view.IsValid());
+    auto status_view = View::Create(view);
+    ASSERT(status_view.IsValid());
+    if (status_view.GetStatus() != ErrorCode::SUCCESS) {
+      LOG_INFO(
+          "Got a Command complete %s, status %s",
+          OpCodeText(view.GetCommandOpCode()).c_str(),
+          ErrorCodeText(status_view.GetStatus()).c_str());
+      forget_sent_data(id);
+    }
+  }
+
+  // The controller may hold any payload after a failed command, do not skip the next update
+  void forget_sent_data(AdvertiserId id) {
+    advertising_sets_[id].advertising_data.reset();
+    advertising_sets_[id].scan_response_data.reset();
+    advertising_sets_[id].periodic_data.reset();
+  }
+
   template <class View>
   static void check_status(CommandCompleteView view) {
     ASSERT(view.IsValid());
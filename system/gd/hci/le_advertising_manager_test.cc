@@ -587,6 +587,75 @@ class LeExtendedAdvertisingAPITest : public LeExtendedAdvertisingManagerTest {
   AdvertiserId advertiser_id_;
 };
 
+class LeExtendedAdvertisingMultiSetTest : public LeExtendedAdvertisingManagerTest {
+ protected:
+  void SetUp() override {
+    num_instances_ = 0x03;
+    LeExtendedAdvertisingManagerTest::SetUp();
+
+    advertising_config_.advertising_type = AdvertisingType::ADV_IND;
+    advertising_config_.own_address_type = OwnAddressType::PUBLIC_DEVICE_ADDRESS;
+    GapData data_item{};
+    data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+    data_item.data_ = {'r', 'a', 'n', 'd', 'o', 'm', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+    advertising_config_.advertisement = {data_item};
+    advertising_config_.scan_response = {data_item};
+    advertising_config_.channel_map = 1;
+    advertising_config_.sid = 0x01;
+  }
+
+  // Blocks the advertising manager handler until ReleaseHandler(), so that the requests made in between are all
+  // pending when it runs again, as if they had been posted in a burst.
+  void HoldHandler() {
+    std::promise<void> handler_held;
+    auto held = handler_held.get_future();
+    release_handler_ = std::promise<void>();
+    handler_released_ = release_handler_.get_future();
+    fake_registry_.GetTestModuleHandler(&LeAdvertisingManager::Factory)
+        ->Post(common::BindOnce(
+            [](std::promise<void>* held, std::future<void>* released) {
+              held->set_value();
+              released->wait();
+            },
+            common::Unretained(&handler_held),
+            common::Unretained(&handler_released_)));
+    held.wait();
+  }
+
+  void ReleaseHandler() {
+    release_handler_.set_value();
+  }
+
+  // Creates |num_sets| advertising sets in a burst and answers their parameters and data commands.
+  std::vector<AdvertiserId> CreateAdvertisers(size_t num_sets) {
+    HoldHandler();
+    std::vector<AdvertiserId> ids;
+    for (size_t i = 0; i < num_sets; i++) {
+      ids.push_back(le_advertising_manager_->ExtendedCreateAdvertiser(
+          i, advertising_config_, scan_callback, set_terminated_callback, 0, 0, client_handler_));
+    }
+    test_hci_layer_->SetCommandFuture(3 * num_sets + 1);
+    ReleaseHandler();
+
+    std::vector<uint8_t> success_vector{static_cast<uint8_t>(ErrorCode::SUCCESS)};
+    for (size_t i = 0; i < num_sets; i++) {
+      EXPECT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_PARAMETERS, test_hci_layer_->GetCommand().GetOpCode());
+      test_hci_layer_->IncomingEvent(
+          LeSetExtendedAdvertisingParametersCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS, 0x00));
+      for (auto op_code : {OpCode::LE_SET_EXTENDED_SCAN_RESPONSE_DATA, OpCode::LE_SET_EXTENDED_ADVERTISING_DATA}) {
+        EXPECT_EQ(op_code, test_hci_layer_->GetCommand().GetOpCode());
+        test_hci_layer_->IncomingEvent(
+            CommandCompleteBuilder::Create(uint8_t{1}, op_code, std::make_unique<RawBuilder>(success_vector)));
+      }
+    }
+    return ids;
+  }
+
+  ExtendedAdvertisingConfig advertising_config_{};
+  std::promise<void> release_handler_;
+  std::future<void> handler_released_;
+};
+
 TEST_F(LeAdvertisingManagerTest, startup_teardown) {}
 
 TEST_F(LeAndroidHciAdvertisingManagerTest, startup_teardown) {}
@@ -1218,6 +1287,203 @@ TEST_F(LeExtendedAdvertisingAPITest, disable_enable_periodic_advertiser_test) {
   sync_client_handler();
 }
 
+TEST_F(LeExtendedAdvertisingAPITest, set_unchanged_data_test) {
+  std::vector<GapData> advertising_data{};
+  GapData data_item{};
+  data_item.data_type_ = GapDataType::COMPLETE_LOCAL_NAME;
+  data_item.data_ = {'t', 'e', 's', 't', ' ', 'd', 'e', 'v', 'i', 'c', 'e'};
+  advertising_data.push_back(data_item);
+  test_hci_layer_->SetCommandFuture(1);
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(2);
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+
+  // The same payload again completes without any command
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  ASSERT_EQ(OpCode::NONE, test_hci_layer_->GetCommand().GetOpCode());
+
+  // A different payload is sent
+  advertising_data[0].data_.push_back('2');
+  test_hci_layer_->SetCommandFuture(1);
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, set_unchanged_periodic_data_fragments_test) {
+  std::vector<GapData> advertising_data{};
+  for (uint8_t i = 0; i < 3; i++) {
+    GapData data_item{};
+    data_item.data_.push_back(0xfa);
+    data_item.data_type_ = GapDataType::SERVICE_DATA_128_BIT_UUIDS;
+    uint8_t uuid[16] = {0xf0, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, i};
+    std::copy_n(uuid, 16, std::back_inserter(data_item.data_));
+    std::vector<uint8_t> service_data(232, i);
+    std::copy(service_data.begin(), service_data.end(), std::back_inserter(data_item.data_));
+    advertising_data.push_back(data_item);
+  }
+  test_hci_layer_->SetCommandFuture(3);
+  le_advertising_manager_->SetPeriodicData(advertiser_id_, advertising_data);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(OpCode::LE_SET_PERIODIC_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  }
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnPeriodicAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS))
+      .Times(2);
+  for (size_t i = 0; i < 3; i++) {
+    test_hci_layer_->IncomingEvent(LeSetPeriodicAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  }
+
+  // None of the three fragments is sent again
+  le_advertising_manager_->SetPeriodicData(advertiser_id_, advertising_data);
+  fake_registry_.SynchronizeModuleHandler(&LeAdvertisingManager::Factory, std::chrono::milliseconds(20));
+  ASSERT_EQ(OpCode::NONE, test_hci_layer_->GetCommand().GetOpCode());
+}
+
+TEST_F(LeExtendedAdvertisingAPITest, set_data_again_after_failed_fragment_test) {
+  std::vector<GapData> advertising_data{};
+  for (uint8_t i = 0; i < 3; i++) {
+    GapData data_item{};
+    data_item.data_.push_back(0xda);
+    data_item.data_type_ = GapDataType::SERVICE_DATA_128_BIT_UUIDS;
+    uint8_t uuid[16] = {0xf0, 0x34, 0x9b, 0x5f, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x00, i};
+    std::copy_n(uuid, 16, std::back_inserter(data_item.data_));
+    std::vector<uint8_t> service_data(200, i);
+    std::copy(service_data.begin(), service_data.end(), std::back_inserter(data_item.data_));
+    advertising_data.push_back(data_item);
+  }
+  test_hci_layer_->SetCommandFuture(3);
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  }
+
+  // The intermediate fragment fails, the controller may not hold the payload
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingDataSet(advertiser_id_, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingDataCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+
+  // So the same payload is sent again
+  test_hci_layer_->SetCommandFuture(3);
+  le_advertising_manager_->SetData(advertiser_id_, false, advertising_data);
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_DATA, test_hci_layer_->GetCommand().GetOpCode());
+  }
+}
+
+TEST_F(LeExtendedAdvertisingMultiSetTest, enable_sets_in_one_command) {
+  std::vector<AdvertiserId> ids = CreateAdvertisers(3);
+
+  auto enable_command = LeSetExtendedAdvertisingEnableView::Create(
+      LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(enable_command.IsValid());
+  ASSERT_EQ(Enable::ENABLED, enable_command.GetEnable());
+  auto enabled_sets = enable_command.GetEnabledSets();
+  ASSERT_EQ(ids.size(), enabled_sets.size());
+  for (size_t i = 0; i < ids.size(); i++) {
+    ASSERT_EQ(ids[i], enabled_sets[i].advertising_handle_);
+    EXPECT_CALL(
+        mock_advertising_callback_,
+        OnAdvertisingSetStarted(static_cast<int>(i), ids[i], 0, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  }
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingMultiSetTest, enable_sets_one_by_one_after_failure) {
+  std::vector<AdvertiserId> ids = CreateAdvertisers(2);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+
+  // The controller rejected the batch, each set is retried on its own
+  test_hci_layer_->SetCommandFuture(2);
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  for (auto id : ids) {
+    auto enable_command = LeSetExtendedAdvertisingEnableView::Create(
+        LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+    ASSERT_TRUE(enable_command.IsValid());
+    ASSERT_EQ(1u, enable_command.GetEnabledSets().size());
+    ASSERT_EQ(id, enable_command.GetEnabledSets()[0].advertising_handle_);
+  }
+
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(0, ids[0], 0, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(1, ids[1], 0, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingMultiSetTest, set_disabled_after_failed_batch_not_retried) {
+  std::vector<AdvertiserId> ids = CreateAdvertisers(2);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+
+  // The second set is disabled while the batch is in flight
+  test_hci_layer_->SetCommandFuture(1);
+  le_advertising_manager_->EnableAdvertiser(ids[1], false, 0x00, 0x00);
+  auto disable_command = LeSetExtendedAdvertisingEnableView::Create(
+      LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(disable_command.IsValid());
+  ASSERT_EQ(Enable::DISABLED, disable_command.GetEnable());
+
+  // Only the first set is retried, the batch fails for the second one
+  EXPECT_CALL(
+      mock_advertising_callback_,
+      OnAdvertisingSetStarted(1, ids[1], 0, AdvertisingCallback::AdvertisingStatus::INTERNAL_ERROR));
+  test_hci_layer_->SetCommandFuture(1);
+  test_hci_layer_->IncomingEvent(
+      LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::MEMORY_CAPACITY_EXCEEDED));
+  auto enable_command = LeSetExtendedAdvertisingEnableView::Create(
+      LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(enable_command.IsValid());
+  ASSERT_EQ(Enable::ENABLED, enable_command.GetEnable());
+  ASSERT_EQ(1u, enable_command.GetEnabledSets().size());
+  ASSERT_EQ(ids[0], enable_command.GetEnabledSets()[0].advertising_handle_);
+  sync_client_handler();
+}
+
+TEST_F(LeExtendedAdvertisingMultiSetTest, disable_sets_in_one_command) {
+  std::vector<AdvertiserId> ids = CreateAdvertisers(3);
+  ASSERT_EQ(OpCode::LE_SET_EXTENDED_ADVERTISING_ENABLE, test_hci_layer_->GetCommand().GetOpCode());
+  EXPECT_CALL(mock_advertising_callback_, OnAdvertisingSetStarted(testing::_, testing::_, 0, testing::_)).Times(3);
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+
+  HoldHandler();
+  for (auto id : ids) {
+    le_advertising_manager_->EnableAdvertiser(id, false, 0x00, 0x00);
+  }
+  test_hci_layer_->SetCommandFuture(1);
+  ReleaseHandler();
+
+  auto disable_command = LeSetExtendedAdvertisingEnableView::Create(
+      LeAdvertisingCommandView::Create(test_hci_layer_->GetCommand()));
+  ASSERT_TRUE(disable_command.IsValid());
+  ASSERT_EQ(Enable::DISABLED, disable_command.GetEnable());
+  ASSERT_EQ(ids.size(), disable_command.GetEnabledSets().size());
+  for (auto id : ids) {
+    EXPECT_CALL(
+        mock_advertising_callback_,
+        OnAdvertisingEnabled(id, false, AdvertisingCallback::AdvertisingStatus::SUCCESS));
+  }
+  test_hci_layer_->IncomingEvent(LeSetExtendedAdvertisingEnableCompleteBuilder::Create(uint8_t{1}, ErrorCode::SUCCESS));
+  sync_client_handler();
+}
+
 }  // namespace
 }  // namespace hci
 }  // namespace bluetooth
@@ -1516,6 +1516,9 @@ struct LeScanningManager::impl : public bluetooth::hci::LeAddressManagerCallback
     scanning_callbacks_->OnTrackAdvFoundLost(on_found_on_lost_info);
   }
 
+  // LE Set Random Address is disallowed while scanning up to Core 5.2, and the scan only picks up a new address when it
+  // is enabled again, so a rotation pauses the scan. The scan disable is acked at once, the address manager pipelines
+  // LE Set Random Address behind it, and the scan enable follows: the scan stops only for those three commands.
   void OnPause() override {
     paused_ = true;
     scan_on_resume_ = is_scanning_;
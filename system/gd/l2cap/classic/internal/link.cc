@@ -45,7 +45,11 @@ Link::Link(
     LinkManager* link_manager)
     : l2cap_handler_(l2cap_handler),
       acl_connection_(std::move(acl_connection)),
-      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd()),
+      data_pipeline_manager_(
+          l2cap_handler,
+          this,
+          acl_connection_->GetAclQueueEnd(),
+          l2cap::internal::DataPipelineManager::SchedulerType::DEFICIT_ROUND_ROBIN),
       parameter_provider_(parameter_provider),
       dynamic_service_manager_(dynamic_service_manager),
       fixed_service_manager_(fixed_service_manager),
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <array>
+#include <cstddef>
 #include <cstdint>
 
 namespace bluetooth {
@@ -28,11 +30,57 @@ class Fcs {
 
   void AddByte(uint8_t byte);
 
+  void AddBytes(const uint8_t* data, size_t length);
+
   uint16_t GetChecksum() const;
 
+  // Returns |crc| updated with |length| bytes at |data|. Header only, so that the legacy stack can share it.
+  static uint16_t Update(uint16_t crc, const uint8_t* data, size_t length);
+
  private:
   uint16_t crc;
 };
 
+namespace fcs_internal {
+
+using Table = std::array<uint16_t, 256>;
+
+// kTables[0] is the byte-wise CRC-16 table (polynomial 0x8005, reflected). kTables[k] gives the CRC of a byte
+// followed by k zero bytes, which lets Fcs::Update() consume 8 bytes per step (slicing-by-8).
+constexpr std::array<Table, 8> MakeTables() {
+  std::array<Table, 8> tables{};
+  for (uint16_t byte = 0; byte < 256; byte++) {
+    uint16_t crc = byte;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xa001 : crc >> 1;
+    }
+    tables[0][byte] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); k++) {
+    for (uint16_t byte = 0; byte < 256; byte++) {
+      uint16_t crc = tables[k - 1][byte];
+      tables[k][byte] = (crc >> 8) ^ tables[0][crc & 0xff];
+    }
+  }
+  return tables;
+}
+
+inline constexpr std::array<Table, 8> kTables = MakeTables();
+
+}  // namespace fcs_internal
+
+inline uint16_t Fcs::Update(uint16_t crc, const uint8_t* data, size_t length) {
+  const auto& t = fcs_internal::kTables;
+  for (; length >= 8; data += 8, length -= 8) {
+    crc ^= data[0] | (data[1] << 8);
+    crc = t[7][crc & 0xff] ^ t[6][crc >> 8] ^ t[5][data[2]] ^ t[4][data[3]] ^ t[3][data[4]] ^ t[2][data[5]] ^
+          t[1][data[6]] ^ t[0][data[7]];
+  }
+  for (; length > 0; data++, length--) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *data) & 0xff];
+  }
+  return crc;
+}
+
 }  // namespace l2cap
 }  // namespace bluetooth
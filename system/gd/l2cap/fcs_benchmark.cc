@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/fcs.h"
+#include "l2cap/l2cap_packets.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+namespace bluetooth {
+namespace l2cap {
+namespace {
+
+// Payload sizes: a short control-sized frame, the default ERTM MPS (672) and a 3-DH5 sized frame.
+
+constexpr Cid kCid = 0x40;
+
+std::vector<uint8_t> MakePayload(size_t size) {
+  std::vector<uint8_t> payload(size);
+  for (size_t i = 0; i < size; i++) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  return payload;
+}
+
+void BM_FcsAddByte(State& state) {
+  auto payload = MakePayload(state.range(0));
+  for (auto _ : state) {
+    Fcs fcs;
+    fcs.Initialize();
+    for (uint8_t byte : payload) {
+      fcs.AddByte(byte);
+    }
+    benchmark::DoNotOptimize(fcs.GetChecksum());
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+BENCHMARK(BM_FcsAddByte)->Arg(16)->Arg(672)->Arg(1021);
+
+void BM_FcsAddBytes(State& state) {
+  auto payload = MakePayload(state.range(0));
+  for (auto _ : state) {
+    Fcs fcs;
+    fcs.Initialize();
+    fcs.AddBytes(payload.data(), payload.size());
+    benchmark::DoNotOptimize(fcs.GetChecksum());
+  }
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+BENCHMARK(BM_FcsAddBytes)->Arg(16)->Arg(672)->Arg(1021);
+
+std::unique_ptr<packet::BasePacketBuilder> MakeIFrame(const std::vector<uint8_t>& payload) {
+  return EnhancedInformationFrameWithFcsBuilder::Create(
+      kCid,
+      0 /* tx_seq */,
+      Final::NOT_SET,
+      0 /* req_seq */,
+      SegmentationAndReassembly::UNSEGMENTED,
+      std::make_unique<packet::RawBuilder>(payload));
+}
+
+void BM_ErtmIFrameWithFcsBuild(State& state) {
+  auto payload = MakePayload(state.range(0));
+  for (auto _ : state) {
+    auto builder = MakeIFrame(payload);
+    std::vector<uint8_t> bytes;
+    bytes.reserve(builder->size());
+    packet::BitInserter it(bytes);
+    builder->Serialize(it);
+    benchmark::DoNotOptimize(bytes.data());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * payload.size());
+}
+BENCHMARK(BM_ErtmIFrameWithFcsBuild)->Arg(16)->Arg(672)->Arg(1021);
+
+void BM_ErtmIFrameWithFcsParse(State& state) {
+  auto builder = MakeIFrame(MakePayload(state.range(0)));
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  packet::BitInserter it(*bytes);
+  builder->Serialize(it);
+  PacketView<kLittleEndian> packet(bytes);
+  for (auto _ : state) {
+    auto i_frame_view = EnhancedInformationFrameWithFcsView::Create(
+        StandardFrameWithFcsView::Create(BasicFrameWithFcsView::Create(packet)));
+    benchmark::DoNotOptimize(i_frame_view.IsValid());
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ErtmIFrameWithFcsParse)->Arg(16)->Arg(672)->Arg(1021);
+
+}  // namespace
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,70 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/fcs.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace bluetooth {
+namespace l2cap {
+
+// The I-frame of the FCS example in the L2CAP spec, without its FCS of 0x6138
+std::vector<uint8_t> i_frame = {0x0E, 0x00, 0x40, 0x00, 0x02, 0x00, 0x00, 0x01,
+                                0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09};
+
+TEST(L2capFcsTest, spec_example) {
+  Fcs fcs;
+  fcs.Initialize();
+  fcs.AddBytes(i_frame.data(), i_frame.size());
+  ASSERT_EQ(0x6138, fcs.GetChecksum());
+}
+
+TEST(L2capFcsTest, add_bytes_matches_add_byte) {
+  std::vector<uint8_t> data;
+  for (int i = 0; i < 100; i++) {
+    data.push_back(static_cast<uint8_t>(i * 37 + 11));
+  }
+  for (size_t length = 0; length <= data.size(); length++) {
+    Fcs by_byte;
+    by_byte.Initialize();
+    for (size_t i = 0; i < length; i++) {
+      by_byte.AddByte(data[i]);
+    }
+    Fcs by_span;
+    by_span.Initialize();
+    by_span.AddBytes(data.data(), length);
+    ASSERT_EQ(by_byte.GetChecksum(), by_span.GetChecksum()) << "length " << length;
+  }
+}
+
+TEST(L2capFcsTest, split_spans) {
+  Fcs whole;
+  whole.Initialize();
+  whole.AddBytes(i_frame.data(), i_frame.size());
+  for (size_t split = 0; split <= i_frame.size(); split++) {
+    Fcs fcs;
+    fcs.Initialize();
+    fcs.AddBytes(i_frame.data(), split);
+    fcs.AddBytes(i_frame.data() + split, i_frame.size() - split);
+    ASSERT_EQ(whole.GetChecksum(), fcs.GetChecksum()) << "split " << split;
+  }
+}
+
+}  // namespace l2cap
+}  // namespace bluetooth
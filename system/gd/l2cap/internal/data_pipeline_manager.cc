@@ -20,6 +20,8 @@
 #include "l2cap/internal/channel_impl.h"
 #include "l2cap/internal/data_controller.h"
 #include "l2cap/internal/data_pipeline_manager.h"
+#include "l2cap/internal/scheduler_deficit_round_robin.h"
+#include "l2cap/internal/scheduler_fifo.h"
 #include "l2cap/internal/sender.h"
 #include "os/log.h"
 
@@ -27,6 +29,18 @@ namespace bluetooth {
 namespace l2cap {
 namespace internal {
 
+std::unique_ptr<Scheduler> DataPipelineManager::CreateScheduler(
+    SchedulerType scheduler_type, LowerQueueUpEnd* link_queue_up_end) {
+  switch (scheduler_type) {
+    case SchedulerType::FIFO:
+      return std::make_unique<Fifo>(this, link_queue_up_end, handler_);
+    case SchedulerType::DEFICIT_ROUND_ROBIN:
+      return std::make_unique<DeficitRoundRobin>(this, link_queue_up_end, handler_);
+  }
+  LOG_ALWAYS_FATAL("Unknown scheduler type %d", static_cast<int>(scheduler_type));
+  return nullptr;
+}
+
 void DataPipelineManager::AttachChannel(Cid cid, std::shared_ptr<ChannelImpl> channel, ChannelMode mode) {
   ASSERT(sender_map_.find(cid) == sender_map_.end());
   sender_map_.emplace(std::piecewise_construct, std::forward_as_tuple(cid),
@@ -62,6 +76,11 @@ void DataPipelineManager::SetChannelTxPriority(Cid cid, bool high_priority) {
   scheduler_->SetChannelTxPriority(cid, high_priority);
 }
 
+void DataPipelineManager::SetChannelPsm(Cid cid, Psm psm) {
+  ASSERT(sender_map_.find(cid) != sender_map_.end());
+  scheduler_->SetChannelPsm(cid, psm);
+}
+
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
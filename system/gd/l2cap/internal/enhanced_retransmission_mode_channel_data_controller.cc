@@ -23,8 +23,7 @@
 #include "common/bind.h"
 #include "l2cap/internal/ilink.h"
 #include "os/alarm.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/slice_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -80,9 +79,9 @@ struct ErtmController::impl {
   int unacked_frames_ = 0;
   // TODO: Instead of having a map, we may consider about a better data structure
   // Map from TxSeq to (SAR, SDU size for START packet, information payload)
-  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, std::shared_ptr<packet::RawBuilder>>> unacked_list_;
+  std::map<uint8_t, std::tuple<SegmentationAndReassembly, uint16_t, packet::SliceBuilder>> unacked_list_;
   // Stores (SAR, SDU size for START packet, information payload)
-  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, std::unique_ptr<packet::RawBuilder>>> pending_frames_;
+  std::queue<std::tuple<SegmentationAndReassembly, uint16_t, packet::SliceBuilder>> pending_frames_;
   int retry_count_ = 0;
   std::map<uint8_t /* tx_seq, */, int /* count */> retry_i_frames_;
   bool rnr_sent_ = false;
@@ -97,7 +96,7 @@ struct ErtmController::impl {
 
   // Events (@see 8.6.5.4)
 
-  void data_request(SegmentationAndReassembly sar, std::unique_ptr<packet::RawBuilder> pdu, uint16_t sdu_size = 0) {
+  void data_request(SegmentationAndReassembly sar, packet::SliceBuilder pdu, uint16_t sdu_size = 0) {
     // Note: sdu_size only applies to START packet
     if (tx_state_ == TxState::XMIT && !remote_busy() && rem_window_not_full()) {
       send_data(sar, sdu_size, std::move(pdu));
@@ -574,7 +573,7 @@ struct ErtmController::impl {
 
   // Actions (@see 8.6.5.6)
 
-  void _send_i_frame(SegmentationAndReassembly sar, std::unique_ptr<CopyablePacketBuilder> segment, uint8_t req_seq,
+  void _send_i_frame(SegmentationAndReassembly sar, std::unique_ptr<packet::SliceBuilder> segment, uint8_t req_seq,
                      uint8_t tx_seq, uint16_t sdu_size = 0, Final f = Final::NOT_SET) {
     std::unique_ptr<packet::BasePacketBuilder> builder;
     if (sar == SegmentationAndReassembly::START) {
@@ -597,15 +596,13 @@ struct ErtmController::impl {
     controller_->send_pdu(std::move(builder));
   }
 
-  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> segment,
+  void send_data(SegmentationAndReassembly sar, uint16_t sdu_size, packet::SliceBuilder segment,
                  Final f = Final::NOT_SET) {
-    std::shared_ptr<packet::RawBuilder> shared_segment(segment.release());
+    // The copy kept for retransmission shares the SDU buffer
+    auto i_frame_payload = std::make_unique<packet::SliceBuilder>(segment);
     unacked_list_.emplace(std::piecewise_construct, std::forward_as_tuple(next_tx_seq_),
-                          std::forward_as_tuple(sar, sdu_size, shared_segment));
-
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(next_tx_seq_)->second));
-    _send_i_frame(sar, std::move(copyable_packet_builder), buffer_seq_, next_tx_seq_, sdu_size, f);
+                          std::forward_as_tuple(sar, sdu_size, std::move(segment)));
+    _send_i_frame(sar, std::move(i_frame_payload), buffer_seq_, next_tx_seq_, sdu_size, f);
     unacked_frames_++;
     frames_sent_++;
     retry_i_frames_[next_tx_seq_] = 1;
@@ -613,7 +610,7 @@ struct ErtmController::impl {
     start_retrans_timer();
   }
 
-  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, std::unique_ptr<packet::RawBuilder> data) {
+  void pend_data(SegmentationAndReassembly sar, uint16_t sdu_size, packet::SliceBuilder data) {
     pending_frames_.emplace(std::make_tuple(sar, sdu_size, std::move(data)));
   }
 
@@ -756,9 +753,8 @@ struct ErtmController::impl {
         CloseChannel();
         return;
       }
-      std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-          std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(i)->second));
-      _send_i_frame(std::get<0>(unacked_list_.find(i)->second), std::move(copyable_packet_builder), buffer_seq_, i,
+      auto i_frame_payload = std::make_unique<packet::SliceBuilder>(std::get<2>(unacked_list_.find(i)->second));
+      _send_i_frame(std::get<0>(unacked_list_.find(i)->second), std::move(i_frame_payload), buffer_seq_, i,
                     std::get<1>(unacked_list_.find(i)->second), f);
       retry_i_frames_[i]++;
       frames_sent_++;
@@ -776,9 +772,8 @@ struct ErtmController::impl {
       LOG_ERROR("Received invalid SREJ");
       return;
     }
-    std::unique_ptr<CopyablePacketBuilder> copyable_packet_builder =
-        std::make_unique<CopyablePacketBuilder>(std::get<2>(unacked_list_.find(req_seq)->second));
-    _send_i_frame(std::get<0>(unacked_list_.find(req_seq)->second), std::move(copyable_packet_builder), buffer_seq_,
+    auto i_frame_payload = std::make_unique<packet::SliceBuilder>(std::get<2>(unacked_list_.find(req_seq)->second));
+    _send_i_frame(std::get<0>(unacked_list_.find(req_seq)->second), std::move(i_frame_payload), buffer_seq_,
                   req_seq, std::get<1>(unacked_list_.find(req_seq)->second), f);
     retry_i_frames_[req_seq]++;
     start_retrans_timer();
@@ -811,22 +806,23 @@ struct ErtmController::impl {
 
 // Segmentation is handled here
 void ErtmController::OnSdu(std::unique_ptr<packet::BasePacketBuilder> sdu) {
-  auto sdu_size = sdu->size();
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
-  auto size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
-                           (fcs_enabled_ ? 2 : 0));
-  packet::FragmentingInserter fragmenting_inserter(size_each_packet, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
-  if (segments.size() == 1) {
-    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, std::move(segments[0]));
+  size_t sdu_size = sdu->size();
+  size_t size_each_packet = (remote_mps_ - 4 /* basic L2CAP header */ - 2 /* SDU length */ - 2 /* Enhanced control */ -
+                             (fcs_enabled_ ? 2 : 0));
+  // Serialize the SDU once, every I-frame builds a slice of it
+  auto sdu_bytes = packet::SliceBuilder::SerializeShared(*sdu);
+  if (sdu_size <= size_each_packet) {
+    pimpl_->data_request(SegmentationAndReassembly::UNSEGMENTED, packet::SliceBuilder(sdu_bytes, 0, sdu_size));
     return;
   }
-  pimpl_->data_request(SegmentationAndReassembly::START, std::move(segments[0]), sdu_size);
-  for (size_t i = 1; i < segments.size() - 1; i++) {
-    pimpl_->data_request(SegmentationAndReassembly::CONTINUATION, std::move(segments[i]));
+  pimpl_->data_request(
+      SegmentationAndReassembly::START, packet::SliceBuilder(sdu_bytes, 0, size_each_packet), sdu_size);
+  size_t begin = size_each_packet;
+  for (; sdu_size - begin > size_each_packet; begin += size_each_packet) {
+    pimpl_->data_request(
+        SegmentationAndReassembly::CONTINUATION, packet::SliceBuilder(sdu_bytes, begin, begin + size_each_packet));
   }
-  pimpl_->data_request(SegmentationAndReassembly::END, std::move(segments.back()));
+  pimpl_->data_request(SegmentationAndReassembly::END, packet::SliceBuilder(sdu_bytes, begin, sdu_size));
 }
 
 void ErtmController::OnPdu(packet::PacketView<true> pdu) {
@@ -1049,14 +1045,6 @@ void ErtmController::close_channel() {
   link_->SendDisconnectionRequest(cid_, remote_cid_);
 }
 
-size_t ErtmController::CopyablePacketBuilder::size() const {
-  return builder_->size();
-}
-
-void ErtmController::CopyablePacketBuilder::Serialize(BitInserter& it) const {
-  builder_->Serialize(it);
-}
-
 }  // namespace internal
 }  // namespace l2cap
 }  // namespace bluetooth
@@ -80,18 +80,6 @@ class ErtmController : public DataController {
     }
   };
 
-  class CopyablePacketBuilder : public packet::BasePacketBuilder {
-   public:
-    CopyablePacketBuilder(std::shared_ptr<packet::RawBuilder> builder) : builder_(std::move(builder)) {}
-
-    void Serialize(BitInserter& it) const override;
-
-    size_t size() const override;
-
-   private:
-    std::shared_ptr<packet::RawBuilder> builder_;
-  };
-
   PacketViewForReassembly reassembly_stage_{PacketView<kLittleEndian>(std::make_shared<std::vector<uint8_t>>())};
   SegmentationAndReassembly sar_state_ = SegmentationAndReassembly::END;
   uint16_t remaining_sdu_continuation_packet_size_ = 0;
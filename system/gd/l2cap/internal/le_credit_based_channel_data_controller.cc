@@ -16,10 +16,11 @@
 
 #include "l2cap/internal/le_credit_based_channel_data_controller.h"
 
+#include <algorithm>
+
 #include "l2cap/l2cap_packets.h"
 #include "l2cap/le/internal/link.h"
-#include "packet/fragmenting_inserter.h"
-#include "packet/raw_builder.h"
+#include "packet/slice_builder.h"
 
 namespace bluetooth {
 namespace l2cap {
@@ -40,27 +41,27 @@ void LeCreditBasedDataController::OnSdu(std::unique_ptr<packet::BasePacketBuilde
   if (sdu_size > mtu_) {
     LOG_WARN("Received sdu_size %d > mtu %d", static_cast<int>(sdu_size), mtu_);
   }
-  std::vector<std::unique_ptr<packet::RawBuilder>> segments;
-  // TODO: We don't need to waste 2 bytes for continuation segment.
-  packet::FragmentingInserter fragmenting_inserter(mps_ - 2, std::back_insert_iterator(segments));
-  sdu->Serialize(fragmenting_inserter);
-  fragmenting_inserter.finalize();
-  std::unique_ptr<BasicFrameBuilder> builder;
-  builder = FirstLeInformationFrameBuilder::Create(remote_cid_, sdu_size, std::move(segments[0]));
-  pdu_queue_.emplace(std::move(builder));
-  for (size_t i = 1; i < segments.size(); i++) {
-    builder = BasicFrameBuilder::Create(remote_cid_, std::move(segments[i]));
-    pdu_queue_.emplace(std::move(builder));
+  // Serialize the SDU once, every K-frame builds a slice of it. The first K-frame carries the SDU length.
+  auto sdu_bytes = packet::SliceBuilder::SerializeShared(*sdu);
+  size_t end = std::min<size_t>(mps_ - 2, sdu_size);
+  pdu_queue_.emplace(FirstLeInformationFrameBuilder::Create(
+      remote_cid_, sdu_size, std::make_unique<packet::SliceBuilder>(sdu_bytes, 0, end)));
+  size_t num_segments = 1;
+  for (size_t begin = end; begin < sdu_size; begin = end) {
+    end = std::min<size_t>(begin + mps_, sdu_size);
+    pdu_queue_.emplace(
+        BasicFrameBuilder::Create(remote_cid_, std::make_unique<packet::SliceBuilder>(sdu_bytes, begin, end)));
+    num_segments++;
   }
-  if (credits_ >= segments.size()) {
-    scheduler_->OnPacketsReady(cid_, segments.size());
-    credits_ -= segments.size();
+  if (credits_ >= num_segments) {
+    scheduler_->OnPacketsReady(cid_, num_segments);
+    credits_ -= num_segments;
   } else if (credits_ > 0) {
     scheduler_->OnPacketsReady(cid_, credits_);
-    pending_frames_count_ += (segments.size() - credits_);
+    pending_frames_count_ += (num_segments - credits_);
     credits_ = 0;
   } else {
-    pending_frames_count_ += segments.size();
+    pending_frames_count_ += num_segments;
   }
 }
 
@@ -70,8 +71,10 @@ void LeCreditBasedDataController::OnPdu(packet::PacketView<true> pdu) {
     LOG_WARN("Received invalid frame");
     return;
   }
-  if (basic_frame_view.size() > mps_) {
-    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(basic_frame_view.size()), mps_);
+  // The MPS bounds the K-frame payload, without the basic L2CAP header
+  auto frame_payload_size = basic_frame_view.GetPayload().size();
+  if (frame_payload_size > mps_) {
+    LOG_WARN("Received frame size %d > mps %d, dropping the packet", static_cast<int>(frame_payload_size), mps_);
     return;
   }
   if (remaining_sdu_continuation_packet_size_ == 0) {
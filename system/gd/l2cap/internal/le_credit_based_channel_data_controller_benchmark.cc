@@ -0,0 +1,229 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "l2cap/internal/ilink.h"
+#include "l2cap/internal/le_credit_based_channel_data_controller.h"
+#include "l2cap/internal/scheduler.h"
+#include "l2cap/l2cap_packets.h"
+#include "os/handler.h"
+#include "os/thread.h"
+#include "packet/fragmenting_inserter.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::State;
+
+// Counts heap allocations made by the whole benchmark binary, so that a benchmark can report allocations per MB of
+// SDU data by taking the difference around its loop. This replaces the global operator new, so the file is built as
+// its own benchmark binary rather than linked into bluetooth_benchmark_gd.
+namespace {
+std::atomic_size_t allocation_count = 0;
+}  // namespace
+
+void* operator new(size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* p = std::malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+  std::free(p);
+}
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+// Every iteration sends one SDU over a CoC from OnSdu() to the bytes handed to the ACL queue, as the scheduler and
+// the HCI layer would serialize each K-frame. SDUs are cut for an MPS of 247 (an LE data length extended PDU). The
+// loopback benchmark also hands the bytes of every K-frame to a receiving controller, up to the SDU dequeued by its
+// user.
+
+constexpr Cid kCid = 0x41;
+constexpr uint16_t kMps = 247;
+constexpr uint16_t kCredits = 0xff00;
+
+class FakeLink : public ILink {
+ public:
+  void SendDisconnectionRequest(Cid local_cid, Cid remote_cid) override {}
+  hci::AddressWithType GetDevice() const override {
+    return {};
+  }
+};
+
+class CountingScheduler : public Scheduler {
+ public:
+  void OnPacketsReady(Cid cid, int number_packets) override {
+    ready_packets_ += number_packets;
+  }
+
+  int ready_packets_ = 0;
+};
+
+// Returns the credits of the receiving controller to the sending one, as the LE Flow Control Credit signal would
+class LoopbackLink : public FakeLink {
+ public:
+  void SendLeCredit(Cid local_cid, uint16_t credit) override {
+    sender_->OnCredit(credit);
+  }
+
+  LeCreditBasedDataController* sender_ = nullptr;
+};
+
+std::shared_ptr<std::vector<uint8_t>> Serialize(std::unique_ptr<packet::BasePacketBuilder> pdu) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bytes->reserve(pdu->size());
+  packet::BitInserter it(*bytes);
+  pdu->Serialize(it);
+  return bytes;
+}
+
+void SendToLink(std::unique_ptr<packet::BasePacketBuilder> pdu) {
+  auto bytes = Serialize(std::move(pdu));
+  benchmark::DoNotOptimize(bytes->data());
+}
+
+bool SyncHandler(os::Handler* handler) {
+  std::promise<void> promise;
+  auto future = promise.get_future();
+  handler->Post(common::BindOnce(&std::promise<void>::set_value, common::Unretained(&promise)));
+  return future.wait_for(std::chrono::seconds(1)) == std::future_status::ready;
+}
+
+void SetCounters(State& state, size_t sdu_size, size_t allocations) {
+  size_t bytes = state.iterations() * sdu_size;
+  state.SetBytesProcessed(bytes);
+  state.counters["allocs_per_MB"] = benchmark::Counter(static_cast<double>(allocations) * (1 << 20) / bytes);
+}
+
+// How LeCreditBasedDataController::OnSdu() used to segment: a copy of every segment, continuations cut for the
+// first K-frame's payload size
+void BM_SegmentWithFragmentingInserter(State& state) {
+  size_t sdu_size = state.range(0);
+  std::vector<uint8_t> payload(sdu_size, 0xab);
+  size_t allocations = 0;
+  for (auto _ : state) {
+    size_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+    auto sdu = std::make_unique<packet::RawBuilder>(payload);
+    std::vector<std::unique_ptr<packet::RawBuilder>> segments;
+    packet::FragmentingInserter fragmenting_inserter(kMps - 2, std::back_insert_iterator(segments));
+    sdu->Serialize(fragmenting_inserter);
+    fragmenting_inserter.finalize();
+    SendToLink(FirstLeInformationFrameBuilder::Create(kCid, sdu_size, std::move(segments[0])));
+    for (size_t i = 1; i < segments.size(); i++) {
+      SendToLink(BasicFrameBuilder::Create(kCid, std::move(segments[i])));
+    }
+    allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+  }
+  SetCounters(state, sdu_size, allocations);
+}
+BENCHMARK(BM_SegmentWithFragmentingInserter)->Arg(512)->Arg(4096)->Arg(32768);
+
+void BM_LeCreditBasedDataControllerSend(State& state) {
+  size_t sdu_size = state.range(0);
+  std::vector<uint8_t> payload(sdu_size, 0xab);
+  os::Thread thread("benchmark_thread", os::Thread::Priority::NORMAL);
+  os::Handler handler(&thread);
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  FakeLink link;
+  CountingScheduler scheduler;
+  LeCreditBasedDataController controller{&link, kCid, kCid, channel_queue.GetDownEnd(), &handler, &scheduler};
+  controller.SetMtu(0xffff);
+  controller.SetMps(kMps);
+  controller.OnCredit(kCredits);
+  size_t allocations = 0;
+  for (auto _ : state) {
+    size_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+    controller.OnSdu(std::make_unique<packet::RawBuilder>(payload));
+    int sent = scheduler.ready_packets_;
+    for (; scheduler.ready_packets_ > 0; scheduler.ready_packets_--) {
+      SendToLink(controller.GetNextPacket());
+    }
+    allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+    // The remote gives the credits back
+    controller.OnCredit(sent);
+  }
+  SetCounters(state, sdu_size, allocations);
+  handler.Clear();
+}
+BENCHMARK(BM_LeCreditBasedDataControllerSend)->Arg(512)->Arg(4096)->Arg(32768);
+
+void BM_LeCreditBasedDataControllerLoopback(State& state) {
+  size_t sdu_size = state.range(0);
+  std::vector<uint8_t> payload(sdu_size, 0xab);
+  os::Thread thread("benchmark_thread", os::Thread::Priority::NORMAL);
+  os::Handler handler(&thread);
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> sender_queue{10};
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> receiver_queue{10};
+  FakeLink sender_link;
+  LoopbackLink receiver_link;
+  CountingScheduler sender_scheduler;
+  CountingScheduler receiver_scheduler;
+  LeCreditBasedDataController sender{&sender_link, kCid, kCid, sender_queue.GetDownEnd(), &handler, &sender_scheduler};
+  LeCreditBasedDataController receiver{
+      &receiver_link, kCid, kCid, receiver_queue.GetDownEnd(), &handler, &receiver_scheduler};
+  receiver_link.sender_ = &sender;
+  for (auto* controller : {&sender, &receiver}) {
+    controller->SetMtu(0xffff);
+    controller->SetMps(kMps);
+  }
+  sender.OnCredit(kCredits);
+  size_t allocations = 0;
+  for (auto _ : state) {
+    size_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+    sender.OnSdu(std::make_unique<packet::RawBuilder>(payload));
+    // The receiver returns a credit for every K-frame, from OnPdu()
+    for (; sender_scheduler.ready_packets_ > 0; sender_scheduler.ready_packets_--) {
+      receiver.OnPdu(packet::PacketView<true>(Serialize(sender.GetNextPacket())));
+    }
+    // The reassembled SDU reaches the channel queue on the handler
+    auto sdu = receiver_queue.GetUpEnd()->TryDequeue();
+    for (int retries = 0; sdu == nullptr && retries < 10 && SyncHandler(&handler); retries++) {
+      sdu = receiver_queue.GetUpEnd()->TryDequeue();
+    }
+    if (sdu == nullptr || sdu->size() != sdu_size) {
+      state.SkipWithError("SDU not received");
+      break;
+    }
+    allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+  }
+  SetCounters(state, sdu_size, allocations);
+  handler.Clear();
+}
+BENCHMARK(BM_LeCreditBasedDataControllerLoopback)->Arg(512)->Arg(4096)->Arg(32768)->UseRealTime();
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
+
+BENCHMARK_MAIN();
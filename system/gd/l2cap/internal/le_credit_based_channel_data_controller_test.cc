@@ -121,6 +121,40 @@ TEST_F(LeCreditBasedDataControllerTest, transmit_segmented) {
   EXPECT_EQ(data, "cd");
 }
 
+TEST_F(LeCreditBasedDataControllerTest, transmit_segmented_full_mps_continuation) {
+  common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
+  testing::MockScheduler scheduler;
+  testing::MockILink link;
+  LeCreditBasedDataController controller{&link, 0x41, 0x41, channel_queue.GetDownEnd(), queue_handler_, &scheduler};
+  controller.OnCredit(10);
+  controller.SetMps(4);
+  EXPECT_CALL(scheduler, OnPacketsReady(0x41, 3));
+  // Only the first K-frame carries the SDU length, so it should be divided into 'ab', 'cdef' and 'gh'
+  controller.OnSdu(CreateSdu({'a', 'b', 'c', 'd', 'e', 'f', 'g', 'h'}));
+  auto next_packet = controller.GetNextPacket();
+  EXPECT_NE(next_packet, nullptr);
+  auto view = GetPacketView(std::move(next_packet));
+  auto pdu_view = BasicFrameView::Create(view);
+  EXPECT_TRUE(pdu_view.IsValid());
+  auto first_le_info_view = FirstLeInformationFrameView::Create(pdu_view);
+  EXPECT_TRUE(first_le_info_view.IsValid());
+  auto payload = first_le_info_view.GetPayload();
+  std::string data = std::string(payload.begin(), payload.end());
+  EXPECT_EQ(data, "ab");
+  EXPECT_EQ(first_le_info_view.GetL2capSduLength(), 8);
+
+  for (auto expected : {"cdef", "gh"}) {
+    next_packet = controller.GetNextPacket();
+    EXPECT_NE(next_packet, nullptr);
+    view = GetPacketView(std::move(next_packet));
+    pdu_view = BasicFrameView::Create(view);
+    EXPECT_TRUE(pdu_view.IsValid());
+    payload = pdu_view.GetPayload();
+    data = std::string(payload.begin(), payload.end());
+    EXPECT_EQ(data, expected);
+  }
+}
+
 TEST_F(LeCreditBasedDataControllerTest, receive_unsegmented) {
   common::BidiQueue<Scheduler::UpperEnqueue, Scheduler::UpperDequeue> channel_queue{10};
   testing::MockScheduler scheduler;
@@ -25,6 +25,7 @@
 #include "l2cap/internal/data_controller.h"
 #include "l2cap/internal/sender.h"
 #include "l2cap/l2cap_packets.h"
+#include "l2cap/psm.h"
 #include "packet/base_packet_builder.h"
 #include "packet/packet_view.h"
 
@@ -60,6 +61,11 @@ class Scheduler {
    */
   virtual void SetChannelTxPriority(Cid cid, bool high_priority) {}
 
+  /**
+   * Tell the scheduler which service a dynamic channel carries, so that it can weigh the channel's share of the link.
+   */
+  virtual void SetChannelPsm(Cid cid, Psm psm) {}
+
   /**
    * Called by data controller to indicate that a channel is closed and packets should be dropped
    */
@@ -0,0 +1,186 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_deficit_round_robin.h"
+
+#include <algorithm>
+
+#include "common/bind.h"
+#include "l2cap/internal/data_pipeline_manager.h"
+#include "os/log.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+
+namespace {
+constexpr Psm kHidInterruptPsm = 0x0013;
+constexpr Psm kAvdtpPsm = 0x0019;
+constexpr Psm kEattPsm = 0x0027;
+}  // namespace
+
+uint16_t DeficitRoundRobin::GetPsmWeight(Psm psm) {
+  switch (psm) {
+    case kAvdtpPsm:
+      return 4;
+    case kHidInterruptPsm:
+    case kEattPsm:
+      return 2;
+    default:
+      return kDefaultWeight;
+  }
+}
+
+DeficitRoundRobin::DeficitRoundRobin(
+    DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler)
+    : data_pipeline_manager_(data_pipeline_manager), link_queue_up_end_(link_queue_up_end), handler_(handler) {
+  ASSERT(link_queue_up_end_ != nullptr && handler_ != nullptr);
+}
+
+// Invoked from some external Handler context
+DeficitRoundRobin::~DeficitRoundRobin() {
+  try_unregister_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void DeficitRoundRobin::OnPacketsReady(Cid cid, int number_packets) {
+  if (number_packets == 0) {
+    return;
+  }
+  auto& channel = channels_[cid];
+  channel.ready_packets += number_packets;
+  if (!channel.is_active) {
+    activate(cid, channel);
+  }
+  try_register_link_queue_enqueue();
+}
+
+// Invoked within L2CAP Handler context
+void DeficitRoundRobin::SetChannelTxPriority(Cid cid, bool high_priority) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    if (!high_priority) {
+      return;
+    }
+    it = channels_.emplace(cid, ChannelState{}).first;
+  }
+  auto& channel = it->second;
+  if (channel.high_priority == high_priority) {
+    return;
+  }
+  if (channel.is_active) {
+    deactivate(channel);
+    channel.high_priority = high_priority;
+    activate(cid, channel);
+  } else {
+    channel.high_priority = high_priority;
+  }
+}
+
+// Invoked within L2CAP Handler context
+void DeficitRoundRobin::SetChannelPsm(Cid cid, Psm psm) {
+  channels_[cid].quantum = kBaseQuantum * GetPsmWeight(psm);
+}
+
+// Invoked within L2CAP Handler context
+void DeficitRoundRobin::RemoveChannel(Cid cid) {
+  auto it = channels_.find(cid);
+  if (it == channels_.end()) {
+    return;
+  }
+  if (it->second.is_active) {
+    deactivate(it->second);
+  }
+  channels_.erase(it);
+  if (!has_active_channels()) {
+    try_unregister_link_queue_enqueue();
+  }
+}
+
+void DeficitRoundRobin::activate(Cid cid, ChannelState& channel) {
+  auto& active_channels = active_channels_[channel.high_priority];
+  channel.position = active_channels.insert(active_channels.end(), cid);
+  channel.is_active = true;
+}
+
+void DeficitRoundRobin::deactivate(ChannelState& channel) {
+  active_channels_[channel.high_priority].erase(channel.position);
+  channel.is_active = false;
+  channel.has_turn = false;
+}
+
+bool DeficitRoundRobin::has_active_channels() const {
+  return !active_channels_[true].empty() || !active_channels_[false].empty();
+}
+
+// Invoked from some external Queue Reactable context
+std::unique_ptr<DeficitRoundRobin::UpperDequeue> DeficitRoundRobin::link_queue_enqueue_callback() {
+  ASSERT(has_active_channels());
+  auto& active_channels = active_channels_[!active_channels_[true].empty()];
+
+  // Every pass over the list adds a quantum to each deficit, so some channel eventually has a positive one
+  Cid cid;
+  ChannelState* channel;
+  while (true) {
+    cid = active_channels.front();
+    channel = &channels_[cid];
+    if (!channel->has_turn) {
+      channel->deficit += channel->quantum;
+      channel->has_turn = true;
+    }
+    if (channel->deficit > 0) {
+      break;
+    }
+    channel->has_turn = false;
+    active_channels.splice(active_channels.end(), active_channels, active_channels.begin());
+  }
+
+  auto packet = data_pipeline_manager_->GetDataController(cid)->GetNextPacket();
+  channel->ready_packets--;
+  channel->deficit -= packet->size();
+  if (channel->ready_packets == 0) {
+    // An idle channel does not bank credit, but keeps its overdraft
+    deactivate(*channel);
+    channel->deficit = std::min<int64_t>(channel->deficit, 0);
+  } else if (channel->deficit <= 0) {
+    channel->has_turn = false;
+    active_channels.splice(active_channels.end(), active_channels, channel->position);
+  }
+
+  data_pipeline_manager_->OnPacketSent(cid);
+  if (!has_active_channels()) {
+    try_unregister_link_queue_enqueue();
+  }
+  return packet;
+}
+
+void DeficitRoundRobin::try_register_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(true)) {
+    return;
+  }
+  link_queue_up_end_->RegisterEnqueue(
+      handler_, common::Bind(&DeficitRoundRobin::link_queue_enqueue_callback, common::Unretained(this)));
+}
+
+void DeficitRoundRobin::try_unregister_link_queue_enqueue() {
+  if (link_queue_enqueue_registered_.exchange(false)) {
+    link_queue_up_end_->UnregisterEnqueue();
+  }
+}
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include "l2cap/cid.h"
+#include "l2cap/internal/scheduler.h"
+#include "l2cap/psm.h"
+#include "os/handler.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+class DataPipelineManager;
+
+/**
+ * Deficit round robin over the channels of a link, so that a channel submitting a large batch cannot hold the link
+ * until it is drained.
+ *
+ * Each channel with packets ready waits in a round robin list. On its turn, a channel earns its quantum in bytes and
+ * sends until the bytes sent exceed what it earned; the overdraft is taken from its next turn. The quantum of a
+ * channel is kBaseQuantum times the weight of its PSM. Channels set to high priority are served before all others.
+ *
+ * The data controllers only report packets the remote can take (LE credits, ERTM transmit window), so a channel
+ * waiting for credits leaves the list instead of stalling the link, and gives up what is left of its deficit.
+ *
+ * Adding, serving and removing a channel are O(1).
+ */
+class DeficitRoundRobin : public Scheduler {
+ public:
+  // About one 3-DH5 or LE data length extended PDU
+  static constexpr int64_t kBaseQuantum = 1024;
+  static constexpr uint16_t kDefaultWeight = 1;
+
+  static uint16_t GetPsmWeight(Psm psm);
+
+  DeficitRoundRobin(
+      DataPipelineManager* data_pipeline_manager, LowerQueueUpEnd* link_queue_up_end, os::Handler* handler);
+  ~DeficitRoundRobin();
+  void OnPacketsReady(Cid cid, int number_packets) override;
+  void SetChannelTxPriority(Cid cid, bool high_priority) override;
+  void SetChannelPsm(Cid cid, Psm psm) override;
+  void RemoveChannel(Cid cid) override;
+
+ private:
+  struct ChannelState {
+    int ready_packets = 0;
+    int64_t quantum = kBaseQuantum;
+    int64_t deficit = 0;
+    bool high_priority = false;
+    bool is_active = false;
+    bool has_turn = false;
+    std::list<Cid>::iterator position;
+  };
+
+  DataPipelineManager* data_pipeline_manager_;
+  LowerQueueUpEnd* link_queue_up_end_;
+  os::Handler* handler_;
+  std::unordered_map<Cid, ChannelState> channels_;
+  // Channels with packets ready, indexed by priority
+  std::list<Cid> active_channels_[2];
+  std::atomic_bool link_queue_enqueue_registered_ = false;
+
+  void activate(Cid cid, ChannelState& channel);
+  void deactivate(ChannelState& channel);
+  bool has_active_channels() const;
+  void try_register_link_queue_enqueue();
+  void try_unregister_link_queue_enqueue();
+  std::unique_ptr<LowerEnqueue> link_queue_enqueue_callback();
+};
+
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
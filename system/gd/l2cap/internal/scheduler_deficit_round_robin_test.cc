@@ -0,0 +1,242 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "l2cap/internal/scheduler_deficit_round_robin.h"
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <map>
+#include <vector>
+
+#include "l2cap/internal/data_controller_mock.h"
+#include "l2cap/internal/data_pipeline_manager_mock.h"
+#include "os/handler.h"
+#include "os/mock_queue.h"
+#include "os/thread.h"
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace l2cap {
+namespace internal {
+namespace {
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::Return;
+
+constexpr Cid kCid1 = 0x40;
+constexpr Cid kCid2 = 0x41;
+constexpr Cid kCid3 = 0x42;
+constexpr Psm kAvdtpPsm = 0x0019;
+constexpr Psm kRfcommPsm = 0x0003;
+
+// Hands out packets of a fixed size and records which channel each packet came from
+class FixedSizeDataController : public testing::MockDataController {
+ public:
+  FixedSizeDataController(Cid cid, size_t packet_size, std::vector<Cid>* sent)
+      : cid_(cid), packet_size_(packet_size), sent_(sent) {}
+
+  std::unique_ptr<BasePacketBuilder> GetNextPacket() override {
+    sent_->push_back(cid_);
+    auto packet = std::make_unique<packet::RawBuilder>();
+    packet->AddOctets(std::vector<uint8_t>(packet_size_, static_cast<uint8_t>(cid_)));
+    return packet;
+  }
+
+  const Cid cid_;
+  const size_t packet_size_;
+  std::vector<Cid>* sent_;
+};
+
+class L2capSchedulerDeficitRoundRobinTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    thread_ = new os::Thread("test_thread", os::Thread::Priority::NORMAL);
+    queue_handler_ = new os::Handler(thread_);
+    mock_data_pipeline_manager_ = new testing::MockDataPipelineManager(queue_handler_, &queue_end_);
+    EXPECT_CALL(*mock_data_pipeline_manager_, OnPacketSent(_)).Times(AnyNumber());
+    scheduler_ = new DeficitRoundRobin(mock_data_pipeline_manager_, &queue_end_, queue_handler_);
+  }
+
+  void TearDown() override {
+    delete scheduler_;
+    delete mock_data_pipeline_manager_;
+    for (auto& data_controller : data_controllers_) {
+      delete data_controller.second;
+    }
+    queue_handler_->Clear();
+    delete queue_handler_;
+    delete thread_;
+  }
+
+  void AddChannel(Cid cid, size_t packet_size) {
+    data_controllers_[cid] = new FixedSizeDataController(cid, packet_size, &sent_);
+    EXPECT_CALL(*mock_data_pipeline_manager_, GetDataController(cid))
+        .WillRepeatedly(Return(data_controllers_[cid]));
+  }
+
+  std::map<Cid, size_t> SentBytes() const {
+    std::map<Cid, size_t> sent_bytes;
+    for (Cid cid : sent_) {
+      sent_bytes[cid] += data_controllers_.at(cid)->packet_size_;
+    }
+    return sent_bytes;
+  }
+
+  os::Thread* thread_ = nullptr;
+  os::Handler* queue_handler_ = nullptr;
+  os::MockIQueueDequeue<Scheduler::LowerDequeue> dequeue_;
+  os::MockIQueueEnqueue<Scheduler::LowerEnqueue> enqueue_;
+  common::BidiQueueEnd<Scheduler::LowerEnqueue, Scheduler::LowerDequeue> queue_end_{&enqueue_, &dequeue_};
+  testing::MockDataPipelineManager* mock_data_pipeline_manager_ = nullptr;
+  std::map<Cid, FixedSizeDataController*> data_controllers_;
+  std::vector<Cid> sent_;
+  DeficitRoundRobin* scheduler_ = nullptr;
+};
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, send_packet) {
+  AddChannel(kCid1, 10);
+  EXPECT_CALL(*mock_data_pipeline_manager_, OnPacketSent(kCid1));
+  scheduler_->OnPacketsReady(kCid1, 1);
+  enqueue_.run_enqueue();
+  ASSERT_EQ(1u, enqueue_.enqueued.size());
+  ASSERT_EQ(10u, enqueue_.enqueued.front()->size());
+  ASSERT_EQ(nullptr, enqueue_.registered_handler);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, large_batch_does_not_block_other_channel) {
+  AddChannel(kCid1, 1000);
+  AddChannel(kCid2, 1000);
+  scheduler_->OnPacketsReady(kCid1, 10);
+  scheduler_->OnPacketsReady(kCid2, 1);
+  enqueue_.run_enqueue(11);
+  // The first channel overdraws its quantum with its second packet, then yields
+  std::vector<Cid> expected = {kCid1, kCid1, kCid2, kCid1, kCid1, kCid1, kCid1, kCid1, kCid1, kCid1, kCid1};
+  ASSERT_EQ(expected, sent_);
+  ASSERT_EQ(nullptr, enqueue_.registered_handler);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, equal_bytes_for_different_packet_sizes) {
+  AddChannel(kCid1, 100);
+  AddChannel(kCid2, 1000);
+  AddChannel(kCid3, 300);
+  scheduler_->OnPacketsReady(kCid1, 1000);
+  scheduler_->OnPacketsReady(kCid2, 1000);
+  scheduler_->OnPacketsReady(kCid3, 1000);
+  enqueue_.run_enqueue(600);
+
+  // Over any number of rounds, the bytes sent by channels differ by less than a quantum plus a packet
+  auto sent_bytes = SentBytes();
+  size_t max_bytes = std::max({sent_bytes[kCid1], sent_bytes[kCid2], sent_bytes[kCid3]});
+  size_t min_bytes = std::min({sent_bytes[kCid1], sent_bytes[kCid2], sent_bytes[kCid3]});
+  ASSERT_LT(max_bytes - min_bytes, DeficitRoundRobin::kBaseQuantum + 1000);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, psm_weight) {
+  AddChannel(kCid1, 500);
+  AddChannel(kCid2, 500);
+  scheduler_->SetChannelPsm(kCid1, kAvdtpPsm);
+  scheduler_->SetChannelPsm(kCid2, kRfcommPsm);
+  scheduler_->OnPacketsReady(kCid1, 10000);
+  scheduler_->OnPacketsReady(kCid2, 10000);
+  enqueue_.run_enqueue(5000);
+
+  auto sent_bytes = SentBytes();
+  double ratio = static_cast<double>(sent_bytes[kCid1]) / sent_bytes[kCid2];
+  double expected_ratio = static_cast<double>(DeficitRoundRobin::GetPsmWeight(kAvdtpPsm)) /
+                          DeficitRoundRobin::GetPsmWeight(kRfcommPsm);
+  ASSERT_NEAR(expected_ratio, ratio, 0.1);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, prioritize_channel) {
+  AddChannel(kCid1, 100);
+  AddChannel(kCid2, 100);
+  scheduler_->SetChannelTxPriority(kCid1, true);
+  scheduler_->OnPacketsReady(kCid2, 3);
+  scheduler_->OnPacketsReady(kCid1, 3);
+  enqueue_.run_enqueue(6);
+  std::vector<Cid> expected = {kCid1, kCid1, kCid1, kCid2, kCid2, kCid2};
+  ASSERT_EQ(expected, sent_);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, change_priority_of_active_channel) {
+  AddChannel(kCid1, 100);
+  AddChannel(kCid2, 100);
+  scheduler_->OnPacketsReady(kCid1, 2);
+  scheduler_->OnPacketsReady(kCid2, 2);
+  scheduler_->SetChannelTxPriority(kCid2, true);
+  enqueue_.run_enqueue(2);
+  scheduler_->SetChannelTxPriority(kCid2, false);
+  enqueue_.run_enqueue(2);
+  std::vector<Cid> expected = {kCid2, kCid2, kCid1, kCid1};
+  ASSERT_EQ(expected, sent_);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, remove_channel) {
+  AddChannel(kCid1, 100);
+  AddChannel(kCid2, 100);
+  scheduler_->OnPacketsReady(kCid1, 5);
+  scheduler_->OnPacketsReady(kCid2, 1);
+  scheduler_->RemoveChannel(kCid1);
+  enqueue_.run_enqueue(6);
+  std::vector<Cid> expected = {kCid2};
+  ASSERT_EQ(expected, sent_);
+  ASSERT_EQ(nullptr, enqueue_.registered_handler);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, remove_last_channel_unregisters) {
+  AddChannel(kCid1, 100);
+  scheduler_->OnPacketsReady(kCid1, 5);
+  ASSERT_NE(nullptr, enqueue_.registered_handler);
+  scheduler_->RemoveChannel(kCid1);
+  ASSERT_EQ(nullptr, enqueue_.registered_handler);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, channel_resumes_when_credits_return) {
+  AddChannel(kCid1, 1000);
+  AddChannel(kCid2, 1000);
+  // The first channel runs out of credits after one packet, the second keeps sending
+  scheduler_->OnPacketsReady(kCid1, 1);
+  scheduler_->OnPacketsReady(kCid2, 4);
+  enqueue_.run_enqueue(3);
+  scheduler_->OnPacketsReady(kCid1, 1);
+  enqueue_.run_enqueue(3);
+  std::vector<Cid> expected = {kCid1, kCid2, kCid2, kCid2, kCid1, kCid2};
+  ASSERT_EQ(expected, sent_);
+}
+
+TEST_F(L2capSchedulerDeficitRoundRobinTest, throughput) {
+  constexpr int kNumPackets = 10000;
+  AddChannel(kCid1, 1000);
+  AddChannel(kCid2, 27);
+  scheduler_->OnPacketsReady(kCid1, kNumPackets);
+  scheduler_->OnPacketsReady(kCid2, kNumPackets);
+  enqueue_.run_enqueue(2 * kNumPackets + 1);
+
+  // Every ready packet goes out and the link is released once both channels are drained
+  ASSERT_EQ(2u * kNumPackets, enqueue_.enqueued.size());
+  auto sent_bytes = SentBytes();
+  ASSERT_EQ(1000u * kNumPackets, sent_bytes[kCid1]);
+  ASSERT_EQ(27u * kNumPackets, sent_bytes[kCid2]);
+  ASSERT_EQ(nullptr, enqueue_.registered_handler);
+}
+
+}  // namespace
+}  // namespace internal
+}  // namespace l2cap
+}  // namespace bluetooth
@@ -40,7 +40,11 @@ Link::Link(os::Handler* l2cap_handler, std::unique_ptr<hci::acl_manager::LeAclCo
            DynamicChannelServiceManagerImpl* dynamic_service_manager,
            FixedChannelServiceManagerImpl* fixed_service_manager, LinkManager* link_manager)
     : l2cap_handler_(l2cap_handler), acl_connection_(std::move(acl_connection)),
-      data_pipeline_manager_(l2cap_handler, this, acl_connection_->GetAclQueueEnd()),
+      data_pipeline_manager_(
+          l2cap_handler,
+          this,
+          acl_connection_->GetAclQueueEnd(),
+          l2cap::internal::DataPipelineManager::SchedulerType::DEFICIT_ROUND_ROBIN),
       parameter_provider_(parameter_provider), dynamic_service_manager_(dynamic_service_manager),
       signalling_manager_(l2cap_handler_, this, &data_pipeline_manager_, dynamic_service_manager_,
                           &dynamic_channel_allocator_),
@@ -210,6 +214,7 @@ std::shared_ptr<l2cap::internal::DynamicChannelImpl> Link::AllocateDynamicChanne
   if (channel != nullptr) {
     data_pipeline_manager_.AttachChannel(channel->GetCid(), channel,
                                          l2cap::internal::DataPipelineManager::ChannelMode::LE_CREDIT_BASED);
+    data_pipeline_manager_.SetChannelPsm(channel->GetCid(), psm);
     RefreshRefCount();
     channel->local_initiated_ = false;
   }
@@ -222,6 +227,7 @@ std::shared_ptr<l2cap::internal::DynamicChannelImpl> Link::AllocateReservedDynam
   if (channel != nullptr) {
     data_pipeline_manager_.AttachChannel(channel->GetCid(), channel,
                                          l2cap::internal::DataPipelineManager::ChannelMode::LE_CREDIT_BASED);
+    data_pipeline_manager_.SetChannelPsm(channel->GetCid(), psm);
     RefreshRefCount();
     channel->local_initiated_ = true;
   }
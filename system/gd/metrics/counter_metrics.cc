@@ -18,6 +18,7 @@
 #include "metrics/counter_metrics.h"
 
 #include "common/bind.h"
+#include "counter_metrics_generated.h"
 #include "os/log.h"
 #include "os/metrics.h"
 
@@ -58,18 +59,16 @@ bool CounterMetrics::Count(int32_t key, int64_t count) {
     LOG_WARN("count is not larger than 0. count: %s, key: %d", std::to_string(count).c_str(), key);
     return false;
   }
-  int64_t total = 0;
-  std::lock_guard<std::mutex> lock(mutex_);
-  if (counters_.find(key) != counters_.end()) {
-    total = counters_[key];
-  }
+  CounterShard& shard = shards_[CurrentMetricsShard()];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  int64_t& total = shard.counters[key];
   if (LLONG_MAX - total < count) {
       LOG_WARN("Counter metric overflows. count %s current total: %s key: %d",
                std::to_string(count).c_str(), std::to_string(total).c_str(), key);
-      counters_[key] = LLONG_MAX;
+      total = LLONG_MAX;
       return false;
   }
-  counters_[key] = total + count;
+  total += count;
   return true;
 }
 
@@ -82,12 +81,54 @@ void CounterMetrics::DrainBufferedCounters() {
     LOG_WARN("Counter metrics isn't initialized");
     return ;
   }
-  std::lock_guard<std::mutex> lock(mutex_);
   LOG_INFO("Draining buffered counters");
-  for (auto const& pair : counters_) {
+  std::unordered_map<int32_t, int64_t> counters;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto const& pair : shard.counters) {
+      int64_t& total = counters[pair.first];
+      total = (LLONG_MAX - total < pair.second) ? LLONG_MAX : total + pair.second;
+    }
+    shard.counters.clear();
+  }
+  for (auto const& pair : counters) {
     WriteCounter(pair.first, pair.second);
   }
-  counters_.clear();
+}
+
+DumpsysDataFinisher CounterMetrics::GetDumpsysData(flatbuffers::FlatBufferBuilder* fb_builder) const {
+  MetricsSnapshot snapshot = TakeMetricsSnapshot();
+
+  std::vector<flatbuffers::Offset<MetricData>> counters;
+  for (auto const& counter : snapshot.counters) {
+    counters.push_back(CreateMetricDataDirect(*fb_builder, counter.first.c_str(), counter.second));
+  }
+  std::vector<flatbuffers::Offset<MetricData>> gauges;
+  for (auto const& gauge : snapshot.gauges) {
+    gauges.push_back(CreateMetricDataDirect(*fb_builder, gauge.first.c_str(), gauge.second));
+  }
+  std::vector<flatbuffers::Offset<HistogramData>> histograms;
+  for (auto const& histogram : snapshot.histograms) {
+    std::vector<int64_t> buckets(histogram.buckets.begin(), histogram.buckets.end());
+    histograms.push_back(
+        CreateHistogramDataDirect(*fb_builder, histogram.name.c_str(), histogram.count, histogram.sum, &buckets));
+  }
+
+  auto title = fb_builder->CreateString("----- Counter Metrics Dumpsys -----");
+  auto counters_offset = fb_builder->CreateVector(counters);
+  auto gauges_offset = fb_builder->CreateVector(gauges);
+  auto histograms_offset = fb_builder->CreateVector(histograms);
+
+  CounterMetricsDataBuilder builder(*fb_builder);
+  builder.add_title(title);
+  builder.add_counters(counters_offset);
+  builder.add_gauges(gauges_offset);
+  builder.add_histograms(histograms_offset);
+  flatbuffers::Offset<CounterMetricsData> dumpsys_data = builder.Finish();
+
+  return [dumpsys_data](DumpsysDataBuilder* dumpsys_builder) {
+    dumpsys_builder->add_counter_metrics_dumpsys_data(dumpsys_data);
+  };
 }
 
 }  // namespace metrics
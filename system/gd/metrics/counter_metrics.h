@@ -15,8 +15,11 @@
  */
 #pragma once
 
+#include <array>
+#include <mutex>
 #include <unordered_map>
 
+#include "metrics/sharded_metrics.h"
 #include "module.h"
 #include "os/repeating_alarm.h"
 
@@ -35,6 +38,7 @@ class CounterMetrics : public bluetooth::Module {
   std::string ToString() const override {
     return std::string("BluetoothCounterMetrics");
   }
+  DumpsysDataFinisher GetDumpsysData(flatbuffers::FlatBufferBuilder* builder) const override;  // Module
   void DrainBufferedCounters();
   virtual void WriteCounter(int32_t key, int64_t count);
   virtual bool IsInitialized() {
@@ -42,8 +46,12 @@ class CounterMetrics : public bluetooth::Module {
   }
 
  private:
-  std::unordered_map<int32_t, int64_t> counters_;
-  mutable std::mutex mutex_;
+  // Count() only locks the shard of the calling thread, so that threads do not contend
+  struct CounterShard {
+    std::mutex mutex;
+    std::unordered_map<int32_t, int64_t> counters;
+  };
+  std::array<CounterShard, kNumMetricsShards> shards_;
   std::unique_ptr<os::RepeatingAlarm> alarm_;
   bool initialized_ {false};
 };
@@ -0,0 +1,152 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#define LOG_TAG "BluetoothShardedMetrics"
+
+#include "metrics/sharded_metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace metrics {
+
+namespace {
+
+struct alignas(64) MetricsShard {
+  std::atomic<int64_t> counters[kMaxShardedCounters];
+  std::atomic<int64_t> histogram_sums[kMaxHistograms];
+  std::atomic<int64_t> histogram_buckets[kMaxHistograms][kNumHistogramBuckets];
+};
+
+// Zero initialized as static storage
+MetricsShard shards[kNumMetricsShards];
+std::atomic<int64_t> gauges[kMaxGauges];
+std::atomic<size_t> next_shard;
+
+// Names of the metrics, in the order they were declared. Only locked when a metric is declared or read.
+struct MetricsRegistry {
+  std::mutex mutex;
+  std::vector<std::string> counter_names;
+  std::vector<std::string> gauge_names;
+  std::vector<std::string> histogram_names;
+};
+
+// Metrics may be declared during static initialization of other files
+MetricsRegistry& GetRegistry() {
+  static MetricsRegistry* registry = new MetricsRegistry();
+  return *registry;
+}
+
+size_t Register(std::vector<std::string> MetricsRegistry::*names_member, const std::string& name, size_t max_metrics) {
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  std::vector<std::string>& names = registry.*names_member;
+  auto it = std::find(names.begin(), names.end(), name);
+  if (it != names.end()) {
+    return it - names.begin();
+  }
+  ASSERT_LOG(names.size() < max_metrics, "Too many metrics, cannot declare %s", name.c_str());
+  names.push_back(name);
+  return names.size() - 1;
+}
+
+MetricsShard& CurrentShard() {
+  thread_local MetricsShard& shard = shards[CurrentMetricsShard()];
+  return shard;
+}
+
+}  // namespace
+
+size_t CurrentMetricsShard() {
+  thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % kNumMetricsShards;
+  return shard;
+}
+
+ShardedCounter::ShardedCounter(const std::string& name)
+    : index_(Register(&MetricsRegistry::counter_names, name, kMaxShardedCounters)) {}
+
+void ShardedCounter::Add(int64_t value) {
+  CurrentShard().counters[index_].fetch_add(value, std::memory_order_relaxed);
+}
+
+Gauge::Gauge(const std::string& name) : index_(Register(&MetricsRegistry::gauge_names, name, kMaxGauges)) {}
+
+void Gauge::Set(int64_t value) {
+  gauges[index_].store(value, std::memory_order_relaxed);
+}
+
+void Gauge::Add(int64_t delta) {
+  gauges[index_].fetch_add(delta, std::memory_order_relaxed);
+}
+
+Histogram::Histogram(const std::string& name)
+    : index_(Register(&MetricsRegistry::histogram_names, name, kMaxHistograms)) {}
+
+void Histogram::Record(int64_t value) {
+  MetricsShard& shard = CurrentShard();
+  shard.histogram_buckets[index_][BucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  shard.histogram_sums[index_].fetch_add(value, std::memory_order_relaxed);
+}
+
+size_t Histogram::BucketOf(int64_t value) {
+  if (value < 1) {
+    return 0;
+  }
+  size_t bucket = 64 - __builtin_clzll(value);
+  return std::min(bucket, kNumHistogramBuckets - 1);
+}
+
+MetricsSnapshot TakeMetricsSnapshot() {
+  MetricsSnapshot snapshot;
+  MetricsRegistry& registry = GetRegistry();
+  std::lock_guard<std::mutex> lock(registry.mutex);
+  const std::vector<std::string>& counter_names = registry.counter_names;
+  const std::vector<std::string>& gauge_names = registry.gauge_names;
+  const std::vector<std::string>& histogram_names = registry.histogram_names;
+
+  for (size_t i = 0; i < counter_names.size(); i++) {
+    int64_t value = 0;
+    for (auto& shard : shards) {
+      value += shard.counters[i].load(std::memory_order_relaxed);
+    }
+    snapshot.counters.emplace_back(counter_names[i], value);
+  }
+
+  for (size_t i = 0; i < gauge_names.size(); i++) {
+    snapshot.gauges.emplace_back(gauge_names[i], gauges[i].load(std::memory_order_relaxed));
+  }
+
+  for (size_t i = 0; i < histogram_names.size(); i++) {
+    HistogramSnapshot histogram;
+    histogram.name = histogram_names[i];
+    for (auto& shard : shards) {
+      histogram.sum += shard.histogram_sums[i].load(std::memory_order_relaxed);
+      for (size_t bucket = 0; bucket < kNumHistogramBuckets; bucket++) {
+        int64_t count = shard.histogram_buckets[i][bucket].load(std::memory_order_relaxed);
+        histogram.buckets[bucket] += count;
+        histogram.count += count;
+      }
+    }
+    snapshot.histograms.push_back(std::move(histogram));
+  }
+  return snapshot;
+}
+
+}  // namespace metrics
+}  // namespace bluetooth
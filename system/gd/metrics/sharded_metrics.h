@@ -0,0 +1,106 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace bluetooth {
+namespace metrics {
+
+// Metrics meant for hot paths. Every metric is declared once, usually as a function local static, and updating it
+// is a relaxed atomic operation without lock nor allocation:
+//
+//   static metrics::ShardedCounter acl_credits("hci.acl_credits_returned");
+//   acl_credits.Add(credits);
+//
+// Counters and histograms are sharded per thread so that threads updating the same metric do not share cache lines.
+// The shards are only summed when the metrics are read.
+
+static constexpr size_t kNumMetricsShards = 16;
+static constexpr size_t kMaxShardedCounters = 64;
+static constexpr size_t kMaxGauges = 32;
+static constexpr size_t kMaxHistograms = 16;
+// Bucket 0 holds values below 1, bucket i values in [2^(i-1), 2^i), the last bucket everything above
+static constexpr size_t kNumHistogramBuckets = 32;
+
+// Index of the shard of the calling thread, threads are spread over the shards in turn
+size_t CurrentMetricsShard();
+
+class ShardedCounter {
+ public:
+  // Counters declared with the same name share their value
+  explicit ShardedCounter(const std::string& name);
+  ShardedCounter(const ShardedCounter&) = delete;
+  ShardedCounter& operator=(const ShardedCounter&) = delete;
+
+  void Add(int64_t value = 1);
+
+ private:
+  size_t index_;
+};
+
+// Gauges hold the last value set and are not sharded, they are meant to be updated by the owner of the value
+class Gauge {
+ public:
+  explicit Gauge(const std::string& name);
+  Gauge(const Gauge&) = delete;
+  Gauge& operator=(const Gauge&) = delete;
+
+  void Set(int64_t value);
+  void Add(int64_t delta);
+
+ private:
+  size_t index_;
+};
+
+// Fixed power of two buckets, suited to latencies and sizes
+class Histogram {
+ public:
+  explicit Histogram(const std::string& name);
+  Histogram(const Histogram&) = delete;
+  Histogram& operator=(const Histogram&) = delete;
+
+  void Record(int64_t value);
+
+  static size_t BucketOf(int64_t value);
+
+ private:
+  size_t index_;
+};
+
+struct HistogramSnapshot {
+  std::string name;
+  int64_t count = 0;
+  int64_t sum = 0;
+  std::array<int64_t, kNumHistogramBuckets> buckets = {};
+};
+
+struct MetricsSnapshot {
+  std::vector<std::pair<std::string, int64_t>> counters;
+  std::vector<std::pair<std::string, int64_t>> gauges;
+  std::vector<HistogramSnapshot> histograms;
+};
+
+// Sums the shards of every metric declared so far. Updates racing with the snapshot may or may not be included.
+MetricsSnapshot TakeMetricsSnapshot();
+
+}  // namespace metrics
+}  // namespace bluetooth
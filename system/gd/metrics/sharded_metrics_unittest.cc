@@ -0,0 +1,133 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "metrics/sharded_metrics.h"
+
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bluetooth {
+namespace metrics {
+namespace {
+
+// Metrics are process wide, every test declares its own names
+
+int64_t CounterValue(const std::string& name) {
+  for (auto const& counter : TakeMetricsSnapshot().counters) {
+    if (counter.first == name) {
+      return counter.second;
+    }
+  }
+  ADD_FAILURE() << "No counter " << name;
+  return 0;
+}
+
+int64_t GaugeValue(const std::string& name) {
+  for (auto const& gauge : TakeMetricsSnapshot().gauges) {
+    if (gauge.first == name) {
+      return gauge.second;
+    }
+  }
+  ADD_FAILURE() << "No gauge " << name;
+  return 0;
+}
+
+HistogramSnapshot HistogramValue(const std::string& name) {
+  for (auto const& histogram : TakeMetricsSnapshot().histograms) {
+    if (histogram.name == name) {
+      return histogram;
+    }
+  }
+  ADD_FAILURE() << "No histogram " << name;
+  return {};
+}
+
+TEST(ShardedMetricsTest, counter) {
+  ShardedCounter counter("test.counter");
+  ASSERT_EQ(0, CounterValue("test.counter"));
+  counter.Add();
+  counter.Add(41);
+  ASSERT_EQ(42, CounterValue("test.counter"));
+}
+
+TEST(ShardedMetricsTest, counters_with_same_name_share_value) {
+  ShardedCounter counter1("test.shared_counter");
+  ShardedCounter counter2("test.shared_counter");
+  counter1.Add(2);
+  counter2.Add(3);
+  ASSERT_EQ(5, CounterValue("test.shared_counter"));
+}
+
+TEST(ShardedMetricsTest, counter_sums_all_threads) {
+  constexpr int kNumThreads = 2 * kNumMetricsShards;
+  constexpr int kAddsPerThread = 10000;
+  ShardedCounter counter("test.threaded_counter");
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&counter]() {
+      for (int j = 0; j < kAddsPerThread; j++) {
+        counter.Add();
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(kNumThreads * kAddsPerThread, CounterValue("test.threaded_counter"));
+}
+
+TEST(ShardedMetricsTest, gauge) {
+  Gauge gauge("test.gauge");
+  gauge.Set(10);
+  ASSERT_EQ(10, GaugeValue("test.gauge"));
+  gauge.Add(-3);
+  ASSERT_EQ(7, GaugeValue("test.gauge"));
+  gauge.Set(1);
+  ASSERT_EQ(1, GaugeValue("test.gauge"));
+}
+
+TEST(ShardedMetricsTest, histogram_buckets) {
+  ASSERT_EQ(0u, Histogram::BucketOf(-5));
+  ASSERT_EQ(0u, Histogram::BucketOf(0));
+  ASSERT_EQ(1u, Histogram::BucketOf(1));
+  ASSERT_EQ(2u, Histogram::BucketOf(2));
+  ASSERT_EQ(2u, Histogram::BucketOf(3));
+  ASSERT_EQ(3u, Histogram::BucketOf(4));
+  ASSERT_EQ(11u, Histogram::BucketOf(1024));
+  ASSERT_EQ(kNumHistogramBuckets - 1, Histogram::BucketOf(INT64_MAX));
+}
+
+TEST(ShardedMetricsTest, histogram) {
+  Histogram histogram("test.histogram");
+  histogram.Record(1);
+  histogram.Record(3);
+  histogram.Record(3);
+  histogram.Record(1000);
+
+  HistogramSnapshot snapshot = HistogramValue("test.histogram");
+  ASSERT_EQ(4, snapshot.count);
+  ASSERT_EQ(1007, snapshot.sum);
+  ASSERT_EQ(1, snapshot.buckets[1]);
+  ASSERT_EQ(2, snapshot.buckets[2]);
+  ASSERT_EQ(1, snapshot.buckets[10]);
+}
+
+}  // namespace
+}  // namespace metrics
+}  // namespace bluetooth
@@ -16,6 +16,12 @@
 #define LOG_TAG "BtGdModule"
 
 #include "module.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <queue>
+#include <thread>
+
 #include "common/init_flags.h"
 #include "dumpsys/init_flags.h"
 #include "os/wakelock_manager.h"
@@ -27,6 +33,9 @@ using ::bluetooth::os::WakelockManager;
 namespace bluetooth {
 
 constexpr std::chrono::milliseconds kModuleStopTimeout = std::chrono::milliseconds(2000);
+// Threads calling Start() of independent modules. Most of the startup time is spent waiting for the controller, so
+// this only needs to cover the independent subtrees of the stack.
+constexpr int kModuleStartWorkers = 4;
 
 ModuleFactory::ModuleFactory(std::function<Module*()> ctor) : ctor_(ctor) {
 }
@@ -56,16 +65,22 @@ Module* Module::GetDependency(const ModuleFactory* module) const {
 }
 
 Module* ModuleRegistry::Get(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto instance = started_modules_.find(module);
   ASSERT_LOG(instance != started_modules_.end(), "Request for module not started up, maybe not in Start(ModuleList)?");
   return instance->second;
 }
 
 bool ModuleRegistry::IsStarted(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   return started_modules_.find(module) != started_modules_.end();
 }
 
 void ModuleRegistry::Start(ModuleList* modules, Thread* thread) {
+  if (common::init_flags::gd_parallel_module_start_is_enabled()) {
+    start_in_parallel(modules, thread);
+    return;
+  }
   for (auto it = modules->list_.begin(); it != modules->list_.end(); it++) {
     Start(*it, thread);
   }
@@ -77,27 +92,126 @@ void ModuleRegistry::set_registry_and_handler(Module* instance, Thread* thread)
 }
 
 Module* ModuleRegistry::Start(const ModuleFactory* module, Thread* thread) {
-  auto started_instance = started_modules_.find(module);
-  if (started_instance != started_modules_.end()) {
-    return started_instance->second;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto started_instance = started_modules_.find(module);
+    if (started_instance != started_modules_.end()) {
+      return started_instance->second;
+    }
   }
 
-  LOG_DEBUG("Constructing next module");
-  Module* instance = module->ctor_();
-  last_instance_ = "starting " + instance->ToString();
-  set_registry_and_handler(instance, thread);
+  Module* instance = construct(module, thread);
 
   LOG_DEBUG("Starting dependencies of %s", instance->ToString().c_str());
-  instance->ListDependencies(&instance->dependencies_);
-  Start(&instance->dependencies_, thread);
+  for (auto dependency : instance->dependencies_.list_) {
+    Start(dependency, thread);
+  }
 
   LOG_DEBUG("Finished starting dependencies and calling Start() of %s", instance->ToString().c_str());
+  start_instance(module, instance, 0);
+  return instance;
+}
 
+Module* ModuleRegistry::construct(const ModuleFactory* module, Thread* thread) {
+  LOG_DEBUG("Constructing next module");
+  Module* instance = module->ctor_();
+  set_registry_and_handler(instance, thread);
+  instance->ListDependencies(&instance->dependencies_);
+  return instance;
+}
+
+void ModuleRegistry::start_instance(const ModuleFactory* module, Module* instance, int worker) {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_instance_ = "starting " + instance->ToString();
+  }
+  auto begin = std::chrono::steady_clock::now();
   instance->Start();
+  auto end = std::chrono::steady_clock::now();
+
+  std::lock_guard<std::mutex> lock(mutex_);
   start_order_.push_back(module);
   started_modules_[module] = instance;
+  startup_timeline_.push_back({instance->ToString(), begin, end, worker});
   LOG_DEBUG("Started %s", instance->ToString().c_str());
-  return instance;
+}
+
+void ModuleRegistry::build_startup_graph(
+    const ModuleFactory* module,
+    Thread* thread,
+    std::map<const ModuleFactory*, StartupNode>* graph,
+    std::set<const ModuleFactory*>* visiting) {
+  if (IsStarted(module) || graph->find(module) != graph->end()) {
+    return;
+  }
+
+  Module* instance = construct(module, thread);
+  StartupNode& node = (*graph)[module];
+  node.instance = instance;
+  visiting->insert(module);
+  for (auto dependency : instance->dependencies_.list_) {
+    ASSERT_LOG(visiting->count(dependency) == 0, "Dependency cycle through %s", instance->ToString().c_str());
+    build_startup_graph(dependency, thread, graph, visiting);
+    auto dependency_node = graph->find(dependency);
+    if (dependency_node != graph->end()) {
+      node.pending_dependencies++;
+      dependency_node->second.dependents.push_back(module);
+    }
+  }
+  visiting->erase(module);
+}
+
+// Starts every module as soon as all of its dependencies are started. Modules are constructed and their dependencies
+// listed up front, on the calling thread, in the same order as the serial start.
+void ModuleRegistry::start_in_parallel(ModuleList* modules, Thread* thread) {
+  std::map<const ModuleFactory*, StartupNode> graph;
+  std::set<const ModuleFactory*> visiting;
+  for (auto module : modules->list_) {
+    build_startup_graph(module, thread, &graph, &visiting);
+  }
+
+  std::mutex ready_mutex;
+  std::condition_variable ready_cv;
+  std::queue<const ModuleFactory*> ready;
+  size_t remaining = graph.size();
+  for (auto& entry : graph) {
+    if (entry.second.pending_dependencies == 0) {
+      ready.push(entry.first);
+    }
+  }
+
+  auto start_ready_modules = [&](int worker) {
+    std::unique_lock<std::mutex> lock(ready_mutex);
+    while (true) {
+      ready_cv.wait(lock, [&] { return !ready.empty() || remaining == 0; });
+      if (ready.empty()) {
+        return;
+      }
+      const ModuleFactory* module = ready.front();
+      ready.pop();
+      StartupNode& node = graph.at(module);
+
+      lock.unlock();
+      start_instance(module, node.instance, worker);
+      lock.lock();
+
+      remaining--;
+      for (auto dependent : node.dependents) {
+        if (--graph.at(dependent).pending_dependencies == 0) {
+          ready.push(dependent);
+        }
+      }
+      ready_cv.notify_all();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int worker = 1; worker <= kModuleStartWorkers; worker++) {
+    workers.emplace_back(start_ready_modules, worker);
+  }
+  for (auto& worker : workers) {
+    worker.join();
+  }
 }
 
 void ModuleRegistry::StopAll() {
@@ -124,9 +238,11 @@ void ModuleRegistry::StopAll() {
 
   ASSERT(started_modules_.empty());
   start_order_.clear();
+  startup_timeline_.clear();
 }
 
 os::Handler* ModuleRegistry::GetModuleHandler(const ModuleFactory* module) const {
+  std::lock_guard<std::mutex> lock(mutex_);
   auto started_instance = started_modules_.find(module);
   if (started_instance != started_modules_.end()) {
     return started_instance->second->GetHandler();
@@ -142,6 +258,7 @@ void ModuleDumper::DumpState(std::string* output) const {
 
   auto init_flags_offset = dumpsys::InitFlags::Dump(&builder);
   auto wakelock_offset = WakelockManager::Get().GetDumpsysData(&builder);
+  auto module_registry_offset = DumpStartupTimeline(&builder);
 
   std::queue<DumpsysDataFinisher> queue;
   for (auto it = module_registry_.start_order_.rbegin(); it != module_registry_.start_order_.rend(); it++) {
@@ -154,6 +271,7 @@ void ModuleDumper::DumpState(std::string* output) const {
   data_builder.add_title(title);
   data_builder.add_init_flags(init_flags_offset);
   data_builder.add_wakelock_manager_data(wakelock_offset);
+  data_builder.add_module_registry_data(module_registry_offset);
 
   while (!queue.empty()) {
     queue.front()(&data_builder);
@@ -164,4 +282,44 @@ void ModuleDumper::DumpState(std::string* output) const {
   *output = std::string(builder.GetBufferPointer(), builder.GetBufferPointer() + builder.GetSize());
 }
 
+flatbuffers::Offset<ModuleRegistryData> ModuleDumper::DumpStartupTimeline(
+    flatbuffers::FlatBufferBuilder* builder) const {
+  std::lock_guard<std::mutex> lock(module_registry_.mutex_);
+  const auto& timeline = module_registry_.startup_timeline_;
+
+  std::chrono::steady_clock::time_point first_begin;
+  std::chrono::steady_clock::time_point last_end;
+  if (!timeline.empty()) {
+    first_begin = timeline.front().begin;
+    last_end = timeline.front().end;
+  }
+  for (const auto& record : timeline) {
+    first_begin = std::min(first_begin, record.begin);
+    last_end = std::max(last_end, record.end);
+  }
+
+  std::vector<flatbuffers::Offset<ModuleStartupData>> records;
+  for (const auto& record : timeline) {
+    auto name = builder->CreateString(record.name);
+    ModuleStartupDataBuilder record_builder(*builder);
+    record_builder.add_name(name);
+    record_builder.add_start_offset_us(
+        std::chrono::duration_cast<std::chrono::microseconds>(record.begin - first_begin).count());
+    record_builder.add_duration_us(
+        std::chrono::duration_cast<std::chrono::microseconds>(record.end - record.begin).count());
+    record_builder.add_worker(record.worker);
+    records.push_back(record_builder.Finish());
+  }
+  auto timeline_offset = builder->CreateVector(records);
+  auto title = builder->CreateString("----- Module Registry Dumpsys -----");
+
+  ModuleRegistryDataBuilder registry_builder(*builder);
+  registry_builder.add_title(title);
+  registry_builder.add_parallel_start(common::init_flags::gd_parallel_module_start_is_enabled());
+  registry_builder.add_startup_duration_us(
+      std::chrono::duration_cast<std::chrono::microseconds>(last_end - first_begin).count());
+  registry_builder.add_startup_timeline(timeline_offset);
+  return registry_builder.Finish();
+}
+
 }  // namespace bluetooth
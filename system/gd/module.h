@@ -17,9 +17,12 @@
 #pragma once
 
 #include <flatbuffers/flatbuffers.h>
+#include <chrono>
 #include <functional>
 #include <future>
 #include <map>
+#include <mutex>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -134,7 +137,9 @@ class ModuleRegistry {
   bool IsStarted(const ModuleFactory* factory) const;
 
   // Start all the modules on this list and their dependencies
-  // in dependency order
+  // in dependency order. With the gd_parallel_module_start init flag, modules
+  // that do not depend on each other are started concurrently; their handlers
+  // still all run on |thread|.
   void Start(ModuleList* modules, ::bluetooth::os::Thread* thread);
 
   template <class T>
@@ -157,6 +162,33 @@ class ModuleRegistry {
   std::map<const ModuleFactory*, Module*> started_modules_;
   std::vector<const ModuleFactory*> start_order_;
   std::string last_instance_;
+
+ private:
+  struct StartupNode {
+    Module* instance = nullptr;
+    size_t pending_dependencies = 0;
+    std::vector<const ModuleFactory*> dependents;
+  };
+
+  struct StartupRecord {
+    std::string name;
+    std::chrono::steady_clock::time_point begin;
+    std::chrono::steady_clock::time_point end;
+    int worker;
+  };
+
+  Module* construct(const ModuleFactory* module, ::bluetooth::os::Thread* thread);
+  void start_instance(const ModuleFactory* module, Module* instance, int worker);
+  void start_in_parallel(ModuleList* modules, ::bluetooth::os::Thread* thread);
+  void build_startup_graph(
+      const ModuleFactory* module,
+      ::bluetooth::os::Thread* thread,
+      std::map<const ModuleFactory*, StartupNode>* graph,
+      std::set<const ModuleFactory*>* visiting);
+
+  // Guards |started_modules_|, |start_order_|, |last_instance_| and |startup_timeline_| while modules start
+  mutable std::mutex mutex_;
+  std::vector<StartupRecord> startup_timeline_;
 };
 
 class ModuleDumper {
@@ -166,6 +198,8 @@ class ModuleDumper {
   void DumpState(std::string* output) const;
 
  private:
+  flatbuffers::Offset<ModuleRegistryData> DumpStartupTimeline(flatbuffers::FlatBufferBuilder* builder) const;
+
   const ModuleRegistry& module_registry_;
   const std::string title_;
 };
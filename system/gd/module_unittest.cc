@@ -15,6 +15,7 @@
  */
 
 #include "module.h"
+#include "common/init_flags.h"
 #include "module_unittest_generated.h"
 #include "os/handler.h"
 #include "os/thread.h"
@@ -271,6 +272,26 @@ TEST_F(ModuleTest, two_dependencies) {
   EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
 }
 
+TEST_F(ModuleTest, two_dependencies_parallel_start) {
+  const char* flags[] = {"INIT_gd_parallel_module_start=true", nullptr};
+  common::InitFlags::Load(flags);
+
+  ModuleList list;
+  list.add<TestModuleTwoDependencies>();
+  registry_->Start(&list, thread_);
+
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleOneDependency>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleNoDependencyTwo>());
+  EXPECT_TRUE(registry_->IsStarted<TestModuleTwoDependencies>());
+
+  registry_->StopAll();
+
+  EXPECT_FALSE(registry_->IsStarted<TestModuleNoDependency>());
+  EXPECT_FALSE(registry_->IsStarted<TestModuleTwoDependencies>());
+  common::InitFlags::Load(nullptr);
+}
+
 void post_to_module_one_handler() {
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
   test_module_one_dependency_handler->Post(common::BindOnce([] { FAIL(); }));
@@ -314,5 +335,30 @@ TEST_F(ModuleTest, dump_state) {
   registry_->StopAll();
 }
 
+TEST_F(ModuleTest, dump_startup_timeline) {
+  ModuleList list;
+  list.add<TestModuleTwoDependencies>();
+  registry_->Start(&list, thread_);
+
+  ModuleDumper dumper(*registry_, "Test Dump Title");
+  std::string output;
+  dumper.DumpState(&output);
+
+  auto data = flatbuffers::GetRoot<DumpsysData>(output.data());
+  auto registry_data = data->module_registry_data();
+  ASSERT_NE(nullptr, registry_data);
+  EXPECT_FALSE(registry_data->parallel_start());
+  auto timeline = registry_data->startup_timeline();
+  ASSERT_EQ(4u, timeline->size());
+  EXPECT_STREQ("TestModuleTwoDependencies", timeline->Get(3)->name()->c_str());
+  for (auto record : *timeline) {
+    EXPECT_GE(record->start_offset_us(), 0);
+    EXPECT_LE(record->start_offset_us() + record->duration_us(), registry_data->startup_duration_us());
+    EXPECT_EQ(0, record->worker());
+  }
+
+  registry_->StopAll();
+}
+
 }  // namespace
 }  // namespace bluetooth
@@ -49,6 +49,17 @@ class PacketView {
 
   size_t size() const;
 
+  // Copies the bytes of every fragment to |destination|, which must hold size() bytes
+  void CopyTo(uint8_t* destination) const;
+
+  // Calls |span_callback|(const uint8_t* data, size_t length) for each contiguous fragment, in order
+  template <typename F>
+  void ForEachSpan(F span_callback) const {
+    for (const auto& fragment : fragments_) {
+      span_callback(fragment.data(), fragment.size());
+    }
+  }
+
   PacketView<true> GetLittleEndianSubview(size_t begin, size_t end) const;
 
   PacketView<false> GetBigEndianSubview(size_t begin, size_t end) const;
@@ -552,6 +552,31 @@ TEST_F(PacketViewMultiViewTest, arrayOperatorTest) {
   ASSERT_DEATH(multi_view[single_view.size()], "");
 }
 
+TEST_F(PacketViewMultiViewTest, copyToTest) {
+  std::vector<uint8_t> bytes(multi_view.size());
+  multi_view.CopyTo(bytes.data());
+  ASSERT_EQ(count_all, bytes);
+
+  // Spans the three fragments
+  size_t begin = count_1.size() - 1;
+  size_t end = count_1.size() + count_2.size() + 1;
+  auto subview = multi_view.GetLittleEndianSubview(begin, end);
+  std::vector<uint8_t> subview_bytes(subview.size());
+  subview.CopyTo(subview_bytes.data());
+  ASSERT_EQ(vector<uint8_t>(count_all.begin() + begin, count_all.begin() + end), subview_bytes);
+}
+
+TEST_F(PacketViewMultiViewTest, forEachSpanTest) {
+  std::vector<uint8_t> bytes;
+  size_t span_count = 0;
+  multi_view.ForEachSpan([&bytes, &span_count](const uint8_t* data, size_t length) {
+    bytes.insert(bytes.end(), data, data + length);
+    span_count++;
+  });
+  ASSERT_EQ(count_all, bytes);
+  ASSERT_EQ(3u, span_count);
+}
+
 TEST_F(PacketViewMultiViewAppendTest, sizeTestAppend) {
   ASSERT_EQ(single_view.size(), multi_view.size());
 }
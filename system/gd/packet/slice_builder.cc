@@ -0,0 +1,51 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/slice_builder.h"
+
+#include <utility>
+
+#include "os/log.h"
+
+namespace bluetooth {
+namespace packet {
+
+SliceBuilder::SliceBuilder(std::shared_ptr<const std::vector<uint8_t>> data, size_t begin, size_t end)
+    : data_(std::move(data)), begin_(begin), end_(end) {
+  ASSERT(data_ != nullptr);
+  ASSERT_LOG(begin_ <= end_ && end_ <= data_->size(), "Invalid slice [%zu, %zu) of %zu", begin_, end_, data_->size());
+}
+
+std::shared_ptr<const std::vector<uint8_t>> SliceBuilder::SerializeShared(const BasePacketBuilder& packet) {
+  auto data = std::make_shared<std::vector<uint8_t>>();
+  data->reserve(packet.size());
+  BitInserter it(*data);
+  packet.Serialize(it);
+  return data;
+}
+
+size_t SliceBuilder::size() const {
+  return end_ - begin_;
+}
+
+void SliceBuilder::Serialize(BitInserter& it) const {
+  for (size_t i = begin_; i < end_; i++) {
+    it.insert_byte((*data_)[i]);
+  }
+}
+
+}  // namespace packet
+}  // namespace bluetooth
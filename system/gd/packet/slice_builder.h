@@ -0,0 +1,52 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "packet/base_packet_builder.h"
+#include "packet/bit_inserter.h"
+
+namespace bluetooth {
+namespace packet {
+
+// Builds bytes [begin, end) of a buffer shared with other slices. A packet serialized once with SerializeShared() can
+// be cut into segments without copying it, and a slice can be copied (e.g. kept for retransmission) without copying
+// the bytes.
+class SliceBuilder : public BasePacketBuilder {
+ public:
+  SliceBuilder(std::shared_ptr<const std::vector<uint8_t>> data, size_t begin, size_t end);
+  SliceBuilder(const SliceBuilder&) = default;
+  SliceBuilder& operator=(const SliceBuilder&) = default;
+  virtual ~SliceBuilder() = default;
+
+  static std::shared_ptr<const std::vector<uint8_t>> SerializeShared(const BasePacketBuilder& packet);
+
+  virtual size_t size() const override;
+
+  virtual void Serialize(BitInserter& it) const override;
+
+ private:
+  std::shared_ptr<const std::vector<uint8_t>> data_;
+  size_t begin_;
+  size_t end_;
+};
+
+}  // namespace packet
+}  // namespace bluetooth
@@ -0,0 +1,68 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "packet/slice_builder.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "packet/raw_builder.h"
+
+namespace bluetooth {
+namespace packet {
+namespace {
+
+std::vector<uint8_t> Serialize(const BasePacketBuilder& builder) {
+  std::vector<uint8_t> bytes;
+  BitInserter it(bytes);
+  builder.Serialize(it);
+  return bytes;
+}
+
+TEST(SliceBuilderTest, serialize_shared) {
+  RawBuilder raw_builder(std::vector<uint8_t>{1, 2, 3, 4, 5});
+  auto data = SliceBuilder::SerializeShared(raw_builder);
+  ASSERT_EQ(std::vector<uint8_t>({1, 2, 3, 4, 5}), *data);
+}
+
+TEST(SliceBuilderTest, slices_share_buffer) {
+  auto data = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{1, 2, 3, 4, 5});
+  SliceBuilder first(data, 0, 2);
+  SliceBuilder second(data, 2, 5);
+  SliceBuilder empty(data, 5, 5);
+  ASSERT_EQ(2u, first.size());
+  ASSERT_EQ(3u, second.size());
+  ASSERT_EQ(0u, empty.size());
+  ASSERT_EQ(std::vector<uint8_t>({1, 2}), Serialize(first));
+  ASSERT_EQ(std::vector<uint8_t>({3, 4, 5}), Serialize(second));
+  ASSERT_EQ(std::vector<uint8_t>(), Serialize(empty));
+  ASSERT_EQ(4, data.use_count());
+}
+
+TEST(SliceBuilderTest, copy_keeps_buffer) {
+  auto data = std::make_shared<const std::vector<uint8_t>>(std::vector<uint8_t>{1, 2, 3});
+  auto slice = std::make_unique<SliceBuilder>(data, 1, 3);
+  data.reset();
+  SliceBuilder copy(*slice);
+  slice.reset();
+  ASSERT_EQ(std::vector<uint8_t>({2, 3}), Serialize(copy));
+}
+
+}  // namespace
+}  // namespace packet
+}  // namespace bluetooth
@@ -16,6 +16,8 @@
 
 #include "packet/view.h"
 
+#include <cstring>
+
 #include "os/log.h"
 
 namespace bluetooth {
@@ -40,5 +42,13 @@ uint8_t View::operator[](size_t i) const {
 size_t View::size() const {
   return end_ - begin_;
 }
+
+void View::CopyTo(uint8_t* destination) const {
+  memcpy(destination, data_->data() + begin_, size());
+}
+
+const uint8_t* View::data() const {
+  return data_->data() + begin_;
+}
 }  // namespace packet
 }  // namespace bluetooth
@@ -35,6 +35,12 @@ class View {
 
   size_t size() const;
 
+  // Copies the bytes of the view to |destination|, which must hold size() bytes
+  void CopyTo(uint8_t* destination) const;
+
+  // The size() bytes of the view are contiguous from here
+  const uint8_t* data() const;
+
  private:
   std::shared_ptr<const std::vector<uint8_t>> data_;
   size_t begin_;
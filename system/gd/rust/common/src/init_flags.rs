@@ -83,7 +83,9 @@ init_flags!(
         gd_rust,
         gd_link_policy,
         irk_rotation,
-        pass_phy_update_callback
+        pass_phy_update_callback,
+        gd_hci_pipelined_commands,
+        gd_parallel_module_start
     },
     dependencies: {
         gd_core => gd_security
@@ -14,6 +14,8 @@ mod ffi {
         fn gd_link_policy_is_enabled() -> bool;
         fn irk_rotation_is_enabled() -> bool;
         fn pass_phy_update_callback_is_enabled() -> bool;
+        fn gd_hci_pipelined_commands_is_enabled() -> bool;
+        fn gd_parallel_module_start_is_enabled() -> bool;
     }
 }
 
@@ -16,6 +16,12 @@
 
 #include "stack_manager.h"
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "common/init_flags.h"
 #include "gtest/gtest.h"
 #include "os/thread.h"
 
@@ -55,5 +61,168 @@ TEST(StackManagerTest, get_module_instance) {
   stack_manager.ShutDown();
 }
 
+// Stands for a module waiting for the controller in Start()
+constexpr auto kSlowStartDuration = std::chrono::milliseconds(100);
+
+template <int N>
+class TestModuleSlowStart : public Module {
+ public:
+  static const ModuleFactory Factory;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {}
+  void Start() override {
+    std::this_thread::sleep_for(kSlowStartDuration);
+  }
+  void Stop() override {}
+  std::string ToString() const override {
+    return std::string("TestModuleSlowStart") + std::to_string(N);
+  }
+};
+
+template <int N>
+const ModuleFactory TestModuleSlowStart<N>::Factory = ModuleFactory([]() { return new TestModuleSlowStart<N>(); });
+
+class TestModuleThreeSlowDependencies : public Module {
+ public:
+  static const ModuleFactory Factory;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {
+    list->add<TestModuleSlowStart<0>>();
+    list->add<TestModuleSlowStart<1>>();
+    list->add<TestModuleSlowStart<2>>();
+  }
+  void Start() override {}
+  void Stop() override {}
+  std::string ToString() const override {
+    return std::string("TestModuleThreeSlowDependencies");
+  }
+};
+
+const ModuleFactory TestModuleThreeSlowDependencies::Factory =
+    ModuleFactory([]() { return new TestModuleThreeSlowDependencies(); });
+
+std::chrono::milliseconds MeasureStartUp() {
+  StackManager stack_manager;
+  ModuleList module_list;
+  module_list.add<TestModuleThreeSlowDependencies>();
+  os::Thread thread{"test_thread", os::Thread::Priority::NORMAL};
+
+  auto begin = std::chrono::steady_clock::now();
+  stack_manager.StartUp(&module_list, &thread);
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+
+  EXPECT_TRUE(stack_manager.IsStarted<TestModuleSlowStart<0>>());
+  EXPECT_TRUE(stack_manager.IsStarted<TestModuleSlowStart<1>>());
+  EXPECT_TRUE(stack_manager.IsStarted<TestModuleSlowStart<2>>());
+  EXPECT_TRUE(stack_manager.IsStarted<TestModuleThreeSlowDependencies>());
+  stack_manager.ShutDown();
+  return duration;
+}
+
+TEST(StackManagerTest, startup_time_serial) {
+  auto duration = MeasureStartUp();
+  ::testing::Test::RecordProperty("startup_time_ms", static_cast<int>(duration.count()));
+  EXPECT_GE(duration, 3 * kSlowStartDuration);
+}
+
+// Every module that starts waits for the others to start as well, and counts
+// whether they all did while it was waiting. That can only happen if the
+// modules start at the same time.
+class StartLatch {
+ public:
+  explicit StartLatch(int count) : count_(count) {}
+
+  void ArriveAndWait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    arrived_++;
+    all_arrived_.notify_all();
+    // Bounded, so that modules started one after the other fail the test
+    // rather than hang it
+    if (all_arrived_.wait_for(lock, std::chrono::seconds(5), [this]() { return arrived_ == count_; })) {
+      overlapped_++;
+    }
+  }
+
+  int overlapped() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return overlapped_;
+  }
+
+ private:
+  const int count_;
+  std::mutex mutex_;
+  std::condition_variable all_arrived_;
+  int arrived_ = 0;
+  int overlapped_ = 0;
+};
+
+StartLatch* start_latch = nullptr;
+
+template <int N>
+class TestModuleLatchedStart : public Module {
+ public:
+  static const ModuleFactory Factory;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {}
+  void Start() override {
+    start_latch->ArriveAndWait();
+  }
+  void Stop() override {}
+  std::string ToString() const override {
+    return std::string("TestModuleLatchedStart") + std::to_string(N);
+  }
+};
+
+template <int N>
+const ModuleFactory TestModuleLatchedStart<N>::Factory =
+    ModuleFactory([]() { return new TestModuleLatchedStart<N>(); });
+
+class TestModuleThreeLatchedDependencies : public Module {
+ public:
+  static const ModuleFactory Factory;
+
+ protected:
+  void ListDependencies(ModuleList* list) const {
+    list->add<TestModuleLatchedStart<0>>();
+    list->add<TestModuleLatchedStart<1>>();
+    list->add<TestModuleLatchedStart<2>>();
+  }
+  void Start() override {
+    // Only starts once its dependencies did
+    EXPECT_EQ(start_latch->overlapped(), 3);
+  }
+  void Stop() override {}
+  std::string ToString() const override {
+    return std::string("TestModuleThreeLatchedDependencies");
+  }
+};
+
+const ModuleFactory TestModuleThreeLatchedDependencies::Factory =
+    ModuleFactory([]() { return new TestModuleThreeLatchedDependencies(); });
+
+TEST(StackManagerTest, startup_parallel) {
+  const char* flags[] = {"INIT_gd_parallel_module_start=true", nullptr};
+  common::InitFlags::Load(flags);
+  StartLatch latch(3);
+  start_latch = &latch;
+
+  StackManager stack_manager;
+  ModuleList module_list;
+  module_list.add<TestModuleThreeLatchedDependencies>();
+  os::Thread thread{"test_thread", os::Thread::Priority::NORMAL};
+  stack_manager.StartUp(&module_list, &thread);
+
+  // The three independent modules were all in Start() at the same time
+  EXPECT_EQ(latch.overlapped(), 3);
+  EXPECT_TRUE(stack_manager.IsStarted<TestModuleThreeLatchedDependencies>());
+  stack_manager.ShutDown();
+
+  start_latch = nullptr;
+  common::InitFlags::Load(nullptr);
+}
+
 }  // namespace
 }  // namespace bluetooth
@@ -267,7 +267,12 @@
 #define BTM_SCO_DATA_SIZE_MAX 240
 #endif
 
-/* The size in bytes of the BTM inquiry database. */
+/* The size in bytes of the BTM inquiry database. It only has to hold the
+ * devices reported during the current discovery: the upper layers keep their
+ * own copy of every result, and a full database reuses the entry of the
+ * device heard least recently. A device still in range comes back with its
+ * next response. Each entry holds a full remote name, so a larger database
+ * costs about 350 bytes per entry in btm_cb. */
 #ifndef BTM_INQ_DB_SIZE
 #define BTM_INQ_DB_SIZE 40
 #endif
@@ -727,6 +732,11 @@
 #define PORT_TX_BUF_HIGH_WM 10
 #endif
 
+/* The most transmit buffers read from the application by a single call-out. */
+#ifndef PORT_TX_BUF_READ_BATCH
+#define PORT_TX_BUF_READ_BATCH 8
+#endif
+
 /* The port transmit queue high watermark level, in number of buffers. */
 #ifndef PORT_TX_BUF_CRITICAL_WM
 #define PORT_TX_BUF_CRITICAL_WM 15
@@ -0,0 +1,159 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "main/shim/helpers.h"
+#include "osi/include/allocator.h"
+#include "packet/packet_view.h"
+#include "stack/include/bt_hdr.h"
+#include "test/common/main_handler.h"
+
+using ::benchmark::State;
+using bluetooth::MakeLegacyBtHdrPacket;
+using bluetooth::packet::PacketView;
+
+// Per packet cost of handing an inbound ACL packet from the GD queue to the
+// legacy stack. Payloads are sized like a 3-DH5 A2DP sink media packet and an
+// OBEX transfer packet, either in one fragment or in three as reassembled by
+// L2CAP.
+
+namespace {
+
+constexpr size_t kA2dpSinkPayloadSize = 679;
+constexpr size_t kObexPayloadSize = 1021;
+constexpr size_t kPacketsPerBurst = 16;
+constexpr uint16_t kHandle = 0x0001;
+
+PacketView<true> MakePacket(size_t size, size_t fragments) {
+  size_t fragment_size = size / fragments;
+  PacketView<true> packet(std::make_shared<std::vector<uint8_t>>(
+      size - (fragments - 1) * fragment_size, 0xab));
+  for (size_t i = 1; i < fragments; i++) {
+    packet.Append(PacketView<true>(
+        std::make_shared<std::vector<uint8_t>>(fragment_size, 0xab)));
+  }
+  return packet;
+}
+
+// How the shim used to build the legacy packet
+BT_HDR* MakeLegacyBtHdrPacketViaVector(const PacketView<true>& packet) {
+  uint16_t length = packet.size();
+  std::vector<uint8_t> preamble;
+  preamble.push_back(kHandle & 0xff);
+  preamble.push_back(kHandle >> 8);
+  preamble.push_back(length & 0xff);
+  preamble.push_back(length >> 8);
+  std::vector<uint8_t> packet_vector(packet.begin(), packet.end());
+  BT_HDR* buffer = static_cast<BT_HDR*>(
+      osi_pool_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
+  std::copy(preamble.begin(), preamble.end(), buffer->data);
+  std::copy(packet_vector.begin(), packet_vector.end(),
+            buffer->data + preamble.size());
+  buffer->len = preamble.size() + packet_vector.size();
+  return buffer;
+}
+
+BT_HDR* MakeLegacyBtHdrPacketDirect(const PacketView<true>& packet) {
+  uint16_t length = packet.size();
+  BT_HDR* buffer = MakeLegacyBtHdrPacket(packet, 4);
+  uint8_t* p = buffer->data;
+  UINT16_TO_STREAM(p, kHandle);
+  UINT16_TO_STREAM(p, length);
+  return buffer;
+}
+
+void BM_LegacyBtHdrViaVector(State& state) {
+  auto packet = MakePacket(state.range(0), state.range(1));
+  for (auto _ : state) {
+    BT_HDR* buffer = MakeLegacyBtHdrPacketViaVector(packet);
+    benchmark::DoNotOptimize(buffer);
+    osi_free(buffer);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void BM_LegacyBtHdrDirect(State& state) {
+  auto packet = MakePacket(state.range(0), state.range(1));
+  for (auto _ : state) {
+    BT_HDR* buffer = MakeLegacyBtHdrPacketDirect(packet);
+    benchmark::DoNotOptimize(buffer);
+    osi_free(buffer);
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void PacketSizes(benchmark::internal::Benchmark* benchmark) {
+  for (size_t size : {kA2dpSinkPayloadSize, kObexPayloadSize}) {
+    benchmark->Args({static_cast<int64_t>(size), 1});
+    benchmark->Args({static_cast<int64_t>(size), 3});
+  }
+}
+
+BENCHMARK(BM_LegacyBtHdrViaVector)->Apply(PacketSizes);
+BENCHMARK(BM_LegacyBtHdrDirect)->Apply(PacketSizes);
+
+void ReceivePacket(BT_HDR* buffer) { osi_free(buffer); }
+
+void ReceiveBatch(std::vector<BT_HDR*> batch) {
+  for (BT_HDR* buffer : batch) ReceivePacket(buffer);
+}
+
+// A burst of packets posted to the main thread one at a time
+void BM_PostPerPacket(State& state) {
+  auto packet = MakePacket(state.range(0), 1);
+  main_thread_start_up();
+  for (auto _ : state) {
+    for (size_t i = 0; i < kPacketsPerBurst; i++) {
+      do_in_main_thread(FROM_HERE,
+                        base::BindOnce(&ReceivePacket,
+                                       MakeLegacyBtHdrPacketDirect(packet)));
+    }
+    sync_main_handler();
+  }
+  main_thread_shut_down();
+  state.SetItemsProcessed(state.iterations() * kPacketsPerBurst);
+}
+
+// The same burst posted as one batch
+void BM_PostBatched(State& state) {
+  auto packet = MakePacket(state.range(0), 1);
+  main_thread_start_up();
+  for (auto _ : state) {
+    std::vector<BT_HDR*> batch;
+    for (size_t i = 0; i < kPacketsPerBurst; i++) {
+      batch.push_back(MakeLegacyBtHdrPacketDirect(packet));
+    }
+    do_in_main_thread(FROM_HERE,
+                      base::BindOnce(&ReceiveBatch, std::move(batch)));
+    sync_main_handler();
+  }
+  main_thread_shut_down();
+  state.SetItemsProcessed(state.iterations() * kPacketsPerBurst);
+}
+
+BENCHMARK(BM_PostPerPacket)->Arg(kA2dpSinkPayloadSize)->Arg(kObexPayloadSize);
+BENCHMARK(BM_PostBatched)->Arg(kA2dpSinkPayloadSize)->Arg(kObexPayloadSize);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -127,6 +127,29 @@ using TeardownTime = std::chrono::time_point<std::chrono::system_clock>;
 constexpr char kBtmLogTag[] = "ACL";
 
 using SendDataUpwards = void (*const)(BT_HDR*);
+
+constexpr size_t kAclPreambleSize = 4;
+constexpr size_t kMaxAclPacketsPerPost = 16;
+
+// Inbound ACL packets of one connection, handed to the main thread in a single
+// post. Packets not delivered, e.g. if the post fails, are freed with the batch.
+struct AclDataBatch {
+  BT_HDR* packets[kMaxAclPacketsPerPost];
+  size_t size{0};
+
+  ~AclDataBatch() {
+    for (size_t i = 0; i < size; i++) osi_free(packets[i]);
+  }
+
+  static void SendUpwards(SendDataUpwards send_data_upwards,
+                          std::unique_ptr<AclDataBatch> batch) {
+    for (size_t i = 0; i < batch->size; i++) {
+      send_data_upwards(batch->packets[i]);
+    }
+    batch->size = 0;
+  }
+};
+
 using OnDisconnect = std::function<void(HciHandle, hci::ErrorCode reason)>;
 
 constexpr char kConnectionDescriptorTimeFormat[] = "%Y-%m-%d %H:%M:%S";
@@ -394,24 +417,33 @@ class ShimAclConnection {
   }
 
   void data_ready_callback() {
-    auto packet = queue_up_end_->TryDequeue();
-    uint16_t length = packet->size();
-    std::vector<uint8_t> preamble;
-    preamble.push_back(LowByte(handle_));
-    preamble.push_back(HighByte(handle_));
-    preamble.push_back(LowByte(length));
-    preamble.push_back(HighByte(length));
-    BT_HDR* p_buf = MakeLegacyBtHdrPacket(std::move(packet), preamble);
-    ASSERT_LOG(p_buf != nullptr,
-               "Unable to allocate BT_HDR legacy packet handle:%04x", handle_);
     if (send_data_upwards_ == nullptr) {
       LOG_WARN("Dropping ACL data with no callback");
-      osi_free(p_buf);
-    } else if (do_in_main_thread(FROM_HERE,
-                                 base::Bind(send_data_upwards_, p_buf)) !=
-               BT_STATUS_SUCCESS) {
-      osi_free(p_buf);
+      queue_up_end_->TryDequeue();
+      return;
     }
+
+    // Drain what is already queued so a burst costs one main thread post
+    // rather than one per packet
+    auto batch = std::make_unique<AclDataBatch>();
+    while (batch->size < kMaxAclPacketsPerPost) {
+      auto packet = queue_up_end_->TryDequeue();
+      if (packet == nullptr) break;
+      uint16_t length = packet->size();
+      BT_HDR* p_buf = MakeLegacyBtHdrPacket(*packet, kAclPreambleSize);
+      ASSERT_LOG(p_buf != nullptr,
+                 "Unable to allocate BT_HDR legacy packet handle:%04x",
+                 handle_);
+      uint8_t* p = p_buf->data;
+      UINT16_TO_STREAM(p, handle_);
+      UINT16_TO_STREAM(p, length);
+      batch->packets[batch->size++] = p_buf;
+    }
+    if (batch->size == 0) return;
+
+    do_in_main_thread(FROM_HERE, base::BindOnce(&AclDataBatch::SendUpwards,
+                                                send_data_upwards_,
+                                                std::move(batch)));
   }
 
   virtual void InitiateDisconnect(hci::DisconnectReason reason) = 0;
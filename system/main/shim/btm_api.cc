@@ -22,6 +22,7 @@
 #include <base/logging.h>
 
 #include <mutex>
+#include <string_view>
 
 #include "common/metric_id_allocator.h"
 #include "common/time_util.h"
@@ -64,6 +65,7 @@ std::mutex btm_cb_mutex_;
 extern bool btm_inq_find_bdaddr(const RawAddress& p_bda);
 extern tINQ_DB_ENT* btm_inq_db_find(const RawAddress& raw_address);
 extern tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda);
+extern void btm_inq_db_heard(tINQ_DB_ENT* p_ent);
 
 /**
  * Legacy bluetooth btm stack entry points
@@ -94,8 +96,10 @@ void btm_api_process_inquiry_result(const RawAddress& raw_address,
     CHECK(p_i != nullptr);
   } else if (p_i->inq_count == btm_cb.btm_inq_vars.inq_counter &&
              is_classic_device(p_i->inq_info.results.device_type)) {
+    btm_inq_db_heard(p_i);
     return;
   }
+  btm_inq_db_heard(p_i);
 
   p_i->inq_info.results.page_scan_rep_mode = page_scan_rep_mode;
   p_i->inq_info.results.page_scan_per_mode = 0;  // RESERVED
@@ -151,6 +155,7 @@ void btm_api_process_inquiry_result_with_rssi(RawAddress raw_address,
     is_new = false;
   }
 
+  btm_inq_db_heard(p_i);
   p_i->inq_info.results.rssi = rssi;
 
   if (is_new) {
@@ -191,9 +196,13 @@ void btm_api_process_extended_inquiry_result(RawAddress raw_address,
                                              const uint8_t* eir_data,
                                              size_t eir_len) {
   tINQ_DB_ENT* p_i = btm_inq_db_find(raw_address);
+  size_t eir_hash = std::hash<std::string_view>{}(
+      std::string_view(reinterpret_cast<const char*>(eir_data), eir_len));
 
+  // Repeated results mostly carry the EIR already reported
   bool update = false;
-  if (btm_inq_find_bdaddr(raw_address) && p_i != nullptr) {
+  if (btm_inq_find_bdaddr(raw_address) && p_i != nullptr &&
+      p_i->eir_hash != eir_hash) {
     update = true;
   }
 
@@ -205,6 +214,7 @@ void btm_api_process_extended_inquiry_result(RawAddress raw_address,
     is_new = false;
   }
 
+  btm_inq_db_heard(p_i);
   p_i->inq_info.results.rssi = rssi;
 
   if (is_new) {
@@ -238,6 +248,7 @@ void btm_api_process_extended_inquiry_result(RawAddress raw_address,
     memset(p_i->inq_info.results.eir_uuid, 0,
            BTM_EIR_SERVICE_ARRAY_SIZE * (BTM_EIR_ARRAY_BITS / 8));
     btm_set_eir_uuid(const_cast<uint8_t*>(eir_data), &p_i->inq_info.results);
+    p_i->eir_hash = eir_hash;
     uint8_t* p_eir_data = const_cast<uint8_t*>(eir_data);
     (btm_cb.btm_inq_vars.p_inq_results_cb)(&p_i->inq_info.results, p_eir_data,
                                            eir_len);
@@ -294,7 +294,7 @@ static BT_HDR* WrapPacketAndCopy(
     uint16_t event,
     bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>* data) {
   size_t packet_size = data->size() + kBtHdrSize;
-  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_malloc(packet_size));
+  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_pool_malloc(packet_size));
   packet->offset = 0;
   packet->len = data->size();
   packet->layer_specific = 0;
@@ -572,7 +572,7 @@ using bluetooth::shim::rust::u8SliceOnceCallback;
 static BT_HDR* WrapRustPacketAndCopy(uint16_t event,
                                      ::rust::Slice<const uint8_t>* data) {
   size_t packet_size = data->length() + kBtHdrSize;
-  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_malloc(packet_size));
+  BT_HDR* packet = reinterpret_cast<BT_HDR*>(osi_pool_malloc(packet_size));
   packet->offset = 0;
   packet->len = data->length();
   packet->layer_specific = 0;
@@ -115,17 +115,20 @@ inline std::unique_ptr<bluetooth::packet::RawBuilder> MakeUniquePacket(
   return payload;
 }
 
+// Copies |packet| into a new BT_HDR, leaving |headroom| bytes in front of the
+// payload for the caller to fill (e.g. the HCI ACL preamble). Each fragment of
+// the packet is copied exactly once, straight into the pool buffer.
 inline BT_HDR* MakeLegacyBtHdrPacket(
-    std::unique_ptr<bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>>
-        packet,
-    const std::vector<uint8_t>& preamble) {
-  std::vector<uint8_t> packet_vector(packet->begin(), packet->end());
-  BT_HDR* buffer = static_cast<BT_HDR*>(
-      osi_calloc(packet_vector.size() + preamble.size() + sizeof(BT_HDR)));
-  std::copy(preamble.begin(), preamble.end(), buffer->data);
-  std::copy(packet_vector.begin(), packet_vector.end(),
-            buffer->data + preamble.size());
-  buffer->len = preamble.size() + packet_vector.size();
+    const bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>& packet,
+    size_t headroom) {
+  size_t size = packet.size();
+  BT_HDR* buffer =
+      static_cast<BT_HDR*>(osi_pool_malloc(sizeof(BT_HDR) + headroom + size));
+  buffer->event = 0;
+  buffer->len = headroom + size;
+  buffer->offset = 0;
+  buffer->layer_specific = 0;
+  packet.CopyTo(buffer->data + headroom);
   return buffer;
 }
 
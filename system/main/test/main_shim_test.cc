@@ -492,6 +492,23 @@ TEST_F(MainShimTest, helpers) {
   } while (++reason != 0);
 }
 
+TEST_F(MainShimTest, make_legacy_bt_hdr_packet) {
+  packet::PacketView<hci::kLittleEndian> packet(
+      std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>{1, 2, 3}));
+  packet.Append(packet::PacketView<hci::kLittleEndian>(
+      std::make_shared<std::vector<uint8_t>>(std::vector<uint8_t>{4, 5})));
+
+  const size_t headroom = 4;
+  BT_HDR* bt_hdr = MakeLegacyBtHdrPacket(packet, headroom);
+  ASSERT_EQ(headroom + 5, bt_hdr->len);
+  ASSERT_EQ(0, bt_hdr->offset);
+  ASSERT_EQ(0, bt_hdr->layer_specific);
+  for (uint8_t i = 0; i < 5; i++) {
+    ASSERT_EQ(i + 1, bt_hdr->data[headroom + i]);
+  }
+  osi_free(bt_hdr);
+}
+
 TEST_F(MainShimTest, connect_and_disconnect) {
   hci::Address address({0x11, 0x22, 0x33, 0x44, 0x55, 0x66});
 
@@ -54,6 +54,10 @@ void* allocation_tracker_notify_alloc(allocator_id_t allocator_id, void* ptr,
 // space.
 void* allocation_tracker_notify_free(allocator_id_t allocator_id, void* ptr);
 
+// Number of canary bytes added around every allocation when the tracker is
+// enabled.
+#define ALLOCATION_TRACKER_CANARY_OVERHEAD 16
+
 // Get the full size for an allocation, taking into account the size of
 // canaries.
 size_t allocation_tracker_resize_for_canary(size_t size);
@@ -41,6 +41,13 @@ void* osi_malloc(size_t size);
 void* osi_calloc(size_t size);
 void osi_free(void* ptr);
 
+// Allocate short-lived packet buffers (BT_HDR) from the size-class buffer
+// pool. Requests larger than the biggest pool class, or made while the
+// matching class is exhausted, are served by |osi_malloc| and |osi_calloc|
+// instead. The memory is released with |osi_free| like any other allocation.
+void* osi_pool_malloc(size_t size);
+void* osi_pool_calloc(size_t size);
+
 // Free a buffer that was previously allocated with function |osi_malloc|
 // or |osi_calloc| and reset the pointer to that buffer to NULL.
 // |p_ptr| is a pointer to the buffer pointer to be reset.
@@ -0,0 +1,81 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "internal_include/bt_target.h"
+#include "osi/include/allocation_tracker.h"
+
+// Size-class slab allocator backing |osi_pool_malloc| and |osi_pool_calloc|.
+// Blocks are carved from a single reserved arena, one region per size class,
+// and recycled through a small per-thread cache in front of a locked free
+// list per class. Memory handed out by the pool is never returned to the
+// system; the arena only grows up to its reserved size.
+//
+// Callers should use the osi_pool_* functions in allocator.h rather than
+// this interface directly.
+
+// Number of size classes and the largest block size served by the pool.
+// The largest class holds a BT_DEFAULT_BUFFER_SIZE buffer together with the
+// allocation tracker canaries.
+#define BUFFER_POOL_NUM_CLASSES 4
+#define BUFFER_POOL_MAX_BLOCK_SIZE \
+  (BT_DEFAULT_BUFFER_SIZE + ALLOCATION_TRACKER_CANARY_OVERHEAD)
+
+// Under AddressSanitizer and HWASan the pool hands out no blocks, so that
+// every buffer is a heap allocation the sanitizer checks on its own.
+#if defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(hwaddress_sanitizer)
+#define BUFFER_POOL_BYPASSED
+#endif
+#endif
+#if !defined(BUFFER_POOL_BYPASSED) && \
+    (defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_HWADDRESS__))
+#define BUFFER_POOL_BYPASSED
+#endif
+
+typedef struct {
+  size_t block_size;  // Size of every block in the class
+  size_t capacity;    // Maximum number of blocks in the class
+  size_t allocated;   // Total number of blocks handed out
+  size_t in_use;      // Number of blocks currently handed out
+  size_t high_water;  // Largest value |in_use| has reached
+  size_t fallbacks;   // Requests refused because the class was exhausted
+} buffer_pool_stats_t;
+
+// Allocates a block of at least |size| bytes from the smallest size class
+// that fits. Returns NULL if |size| is larger than any class, the class is
+// exhausted, the calling thread is exiting or the pool is bypassed; the
+// caller is then expected to fall back to the system allocator. The contents
+// of the block are undefined.
+void* buffer_pool_alloc(size_t size);
+
+// Returns |ptr| to the pool if it was allocated by |buffer_pool_alloc|.
+// Returns false and does nothing otherwise, so any pointer may be passed.
+bool buffer_pool_free(void* ptr);
+
+// Fills |stats| with the statistics of the size class |class_index|.
+// Returns false if |class_index| is not smaller than
+// BUFFER_POOL_NUM_CLASSES.
+bool buffer_pool_get_stats(size_t class_index, buffer_pool_stats_t* stats);
+
+// Dumps the per-class statistics to the |fd| file descriptor.
+void buffer_pool_debug_dump(int fd);
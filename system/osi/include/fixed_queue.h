@@ -91,6 +91,11 @@ void* fixed_queue_try_peek_first(fixed_queue_t* queue);
 // elements in the queue or |queue| is NULL.
 void* fixed_queue_try_peek_last(fixed_queue_t* queue);
 
+// Returns the element at position |index| from the front of |queue| without
+// dequeuing it. This function will never block the caller. Returns NULL if
+// |index| is not smaller than the length of the queue or |queue| is NULL.
+void* fixed_queue_try_peek_at(fixed_queue_t* queue, size_t index);
+
 // Tries to remove a |data| element from the middle of the |queue|. This
 // function will never block the caller. If the queue is empty or NULL, this
 // function returns NULL immediately. |data| may not be NULL. If the |data|
@@ -98,15 +103,6 @@ void* fixed_queue_try_peek_last(fixed_queue_t* queue);
 // otherwise NULL.
 void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data);
 
-// Returns the iterateable list with all entries in the |queue|. This function
-// will never block the caller. |queue| may not be NULL.
-//
-// NOTE: The return result of this function is not thread safe: the list could
-// be modified by another thread, and the result would be unpredictable.
-// TODO: The usage of this function should be refactored, and the function
-// itself should be removed.
-list_t* fixed_queue_get_list(fixed_queue_t* queue);
-
 // This function returns a valid file descriptor. Callers may perform one
 // operation on the fd: select(2). If |select| indicates that the file
 // descriptor is readable, the caller may call |fixed_queue_enqueue| without
@@ -122,7 +118,9 @@ int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue);
 int fixed_queue_get_dequeue_fd(const fixed_queue_t* queue);
 
 // Registers |queue| with |reactor| for dequeue operations. When there is an
-// element in the queue, ready_cb will be called. The |context| parameter is
+// element in the queue, ready_cb will be called. It is called again in the
+// same reactor iteration, up to a bounded batch, as long as each call
+// dequeues an element and the queue is not empty. The |context| parameter is
 // passed, untouched, to the callback routine. Neither |queue|, nor |reactor|,
 // nor |read_cb| may be NULL. |context| may be NULL.
 void fixed_queue_register_dequeue(fixed_queue_t* queue, reactor_t* reactor,
@@ -28,6 +28,7 @@
 
 #include "check.h"
 #include "osi/include/allocator.h"
+#include "osi/include/buffer_pool.h"
 #include "osi/include/log.h"
 #include "osi/include/osi.h"
 
@@ -38,7 +39,7 @@ typedef struct {
   bool freed;
 } allocation_t;
 
-static const size_t canary_size = 8;
+static const size_t canary_size = ALLOCATION_TRACKER_CANARY_OVERHEAD / 2;
 static char canary[canary_size];
 static std::unordered_map<void*, allocation_t*> allocations;
 static std::mutex tracker_lock;
@@ -184,4 +185,7 @@ void osi_allocator_debug_dump(int fd) {
   dprintf(fd, "  Total allocated/free/used octets : %zu / %zu / %zu\n",
           alloc_total_size, free_total_size,
           alloc_total_size - free_total_size);
+  lock.unlock();
+
+  buffer_pool_debug_dump(fd);
 }
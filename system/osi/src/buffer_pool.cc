@@ -0,0 +1,246 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+#define LOG_TAG "bt_osi_buffer_pool"
+
+#include "osi/include/buffer_pool.h"
+
+#include <base/logging.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <mutex>
+
+#include "check.h"
+#include "osi/include/log.h"
+
+#if defined(BUFFER_POOL_BYPASSED)
+static const bool pool_bypassed = true;
+#else
+static const bool pool_bypassed = false;
+#endif
+
+// Every size class gets a region of this size in the arena
+static const size_t class_region_size = 2 * 1024 * 1024;
+
+// Blocks kept per size class in each thread cache, and the number of blocks
+// moved between a thread cache and the shared free list at once
+static const size_t cache_max_blocks = 32;
+static const size_t cache_batch_blocks = cache_max_blocks / 2;
+
+static const size_t block_sizes[BUFFER_POOL_NUM_CLASSES] = {
+    64, 256, 1024, BUFFER_POOL_MAX_BLOCK_SIZE};
+
+typedef struct free_block_t {
+  struct free_block_t* next;
+} free_block_t;
+
+typedef struct {
+  uint8_t* base;
+  size_t block_size;
+  size_t capacity;
+
+  std::mutex lock;
+  free_block_t* free_list;  // Guarded by |lock|
+  size_t carved;            // Guarded by |lock|
+
+  std::atomic<size_t> allocated;
+  std::atomic<size_t> in_use;
+  std::atomic<size_t> high_water;
+  std::atomic<size_t> fallbacks;
+} size_class_t;
+
+static std::atomic<uint8_t*> arena(nullptr);
+static size_class_t classes[BUFFER_POOL_NUM_CLASSES];
+
+static void release_blocks(size_class_t* size_class, free_block_t* head,
+                           free_block_t* tail) {
+  std::unique_lock<std::mutex> lock(size_class->lock);
+  tail->next = size_class->free_list;
+  size_class->free_list = head;
+}
+
+// Set once the calling thread's cache is destroyed. Thread local destructors
+// that run after it still allocate and free buffers, without the cache.
+static thread_local bool thread_cache_destroyed = false;
+
+typedef struct thread_cache_t {
+  free_block_t* head[BUFFER_POOL_NUM_CLASSES] = {};
+  size_t count[BUFFER_POOL_NUM_CLASSES] = {};
+
+  // Hand the cached blocks back so that they are not lost with the thread
+  ~thread_cache_t() {
+    thread_cache_destroyed = true;
+    for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++) {
+      if (head[i] == NULL) continue;
+      free_block_t* tail = head[i];
+      while (tail->next != NULL) tail = tail->next;
+      release_blocks(&classes[i], head[i], tail);
+    }
+  }
+} thread_cache_t;
+
+static thread_local thread_cache_t thread_cache;
+
+static bool arena_init(void) {
+  void* ptr = mmap(NULL, BUFFER_POOL_NUM_CLASSES * class_region_size,
+                   PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (ptr == MAP_FAILED) {
+    LOG_ERROR("%s unable to reserve buffer pool arena", __func__);
+    return false;
+  }
+
+  uint8_t* base = static_cast<uint8_t*>(ptr);
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++) {
+    classes[i].base = base + i * class_region_size;
+    classes[i].block_size = block_sizes[i];
+    classes[i].capacity = class_region_size / block_sizes[i];
+  }
+  arena.store(base);
+  return true;
+}
+
+static size_t size_to_class(size_t size) {
+  size_t i = 0;
+  while (i < BUFFER_POOL_NUM_CLASSES && block_sizes[i] < size) i++;
+  return i;
+}
+
+// Moves up to |cache_batch_blocks| blocks of |class_index| into the calling
+// thread's cache, taking recycled blocks first and carving new ones from the
+// class region after that. Returns false if the class is exhausted.
+static bool refill_cache(thread_cache_t* cache, size_t class_index) {
+  size_class_t* size_class = &classes[class_index];
+  size_t count = 0;
+
+  std::unique_lock<std::mutex> lock(size_class->lock);
+  while (count < cache_batch_blocks && size_class->free_list != NULL) {
+    free_block_t* block = size_class->free_list;
+    size_class->free_list = block->next;
+    block->next = cache->head[class_index];
+    cache->head[class_index] = block;
+    count++;
+  }
+  while (count < cache_batch_blocks &&
+         size_class->carved < size_class->capacity) {
+    free_block_t* block = reinterpret_cast<free_block_t*>(
+        size_class->base + size_class->carved * size_class->block_size);
+    size_class->carved++;
+    block->next = cache->head[class_index];
+    cache->head[class_index] = block;
+    count++;
+  }
+
+  cache->count[class_index] += count;
+  return count != 0;
+}
+
+void* buffer_pool_alloc(size_t size) {
+  if (pool_bypassed || thread_cache_destroyed) return NULL;
+
+  static const bool initialized = arena_init();
+  if (!initialized) return NULL;
+
+  size_t class_index = size_to_class(size);
+  if (class_index == BUFFER_POOL_NUM_CLASSES) return NULL;
+
+  size_class_t* size_class = &classes[class_index];
+  thread_cache_t* cache = &thread_cache;
+  if (cache->count[class_index] == 0 && !refill_cache(cache, class_index)) {
+    size_class->fallbacks.fetch_add(1, std::memory_order_relaxed);
+    return NULL;
+  }
+
+  free_block_t* block = cache->head[class_index];
+  cache->head[class_index] = block->next;
+  cache->count[class_index]--;
+
+  size_class->allocated.fetch_add(1, std::memory_order_relaxed);
+  size_t in_use =
+      size_class->in_use.fetch_add(1, std::memory_order_relaxed) + 1;
+  size_t high_water = size_class->high_water.load(std::memory_order_relaxed);
+  while (in_use > high_water &&
+         !size_class->high_water.compare_exchange_weak(
+             high_water, in_use, std::memory_order_relaxed)) {
+  }
+
+  return block;
+}
+
+bool buffer_pool_free(void* ptr) {
+  uint8_t* p = static_cast<uint8_t*>(ptr);
+  uint8_t* base = arena.load(std::memory_order_relaxed);
+  if (base == NULL || p < base ||
+      p >= base + BUFFER_POOL_NUM_CLASSES * class_region_size)
+    return false;
+
+  size_t class_index = (p - base) / class_region_size;
+  size_class_t* size_class = &classes[class_index];
+  CHECK((p - size_class->base) % size_class->block_size == 0);
+  size_class->in_use.fetch_sub(1, std::memory_order_relaxed);
+
+  free_block_t* block = reinterpret_cast<free_block_t*>(p);
+  if (thread_cache_destroyed) {
+    release_blocks(size_class, block, block);
+    return true;
+  }
+
+  thread_cache_t* cache = &thread_cache;
+  block->next = cache->head[class_index];
+  cache->head[class_index] = block;
+  if (++cache->count[class_index] <= cache_max_blocks) return true;
+
+  // Blocks freed on a thread that does not allocate them would pile up in
+  // its cache, so hand a batch back to the shared free list
+  free_block_t* head = cache->head[class_index];
+  free_block_t* tail = head;
+  for (size_t i = 1; i < cache_batch_blocks; i++) tail = tail->next;
+  cache->head[class_index] = tail->next;
+  cache->count[class_index] -= cache_batch_blocks;
+  release_blocks(size_class, head, tail);
+  return true;
+}
+
+bool buffer_pool_get_stats(size_t class_index, buffer_pool_stats_t* stats) {
+  CHECK(stats != NULL);
+  if (class_index >= BUFFER_POOL_NUM_CLASSES) return false;
+
+  const size_class_t* size_class = &classes[class_index];
+  stats->block_size = block_sizes[class_index];
+  stats->capacity = class_region_size / block_sizes[class_index];
+  stats->allocated = size_class->allocated.load(std::memory_order_relaxed);
+  stats->in_use = size_class->in_use.load(std::memory_order_relaxed);
+  stats->high_water = size_class->high_water.load(std::memory_order_relaxed);
+  stats->fallbacks = size_class->fallbacks.load(std::memory_order_relaxed);
+  return true;
+}
+
+void buffer_pool_debug_dump(int fd) {
+  dprintf(fd, "  Buffer pool (allocated / in use / high water / capacity / "
+              "fallbacks):\n");
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++) {
+    buffer_pool_stats_t stats;
+    buffer_pool_get_stats(i, &stats);
+    dprintf(fd, "    %4zu octets : %zu / %zu / %zu / %zu / %zu\n",
+            stats.block_size, stats.allocated, stats.in_use, stats.high_water,
+            stats.capacity, stats.fallbacks);
+  }
+}
@@ -17,30 +17,57 @@
  ******************************************************************************/
 
 #include <base/logging.h>
+#include <errno.h>
 #include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
+#include <condition_variable>
 #include <mutex>
 
 #include "check.h"
 #include "osi/include/allocator.h"
 #include "osi/include/fixed_queue.h"
-#include "osi/include/list.h"
+#include "osi/include/log.h"
 #include "osi/include/osi.h"
 #include "osi/include/reactor.h"
-#include "osi/include/semaphore.h"
+
+// Number of slots of a new queue. The ring doubles in size whenever it is
+// full and the capacity of the queue allows more elements.
+static const size_t initial_slots = 16;
+
+// Maximum number of times the dequeue callback runs for one wakeup of the
+// reactor, so that a busy queue does not starve other reactor objects.
+static const size_t dequeue_batch_max = 32;
 
 typedef struct fixed_queue_t {
-  list_t* list;
-  semaphore_t* enqueue_sem;
-  semaphore_t* dequeue_sem;
-  std::mutex* mutex;
+  void** items;  // Ring of |slots| elements, |slots| is a power of two
+  size_t slots;
+  size_t head;
+  size_t length;
   size_t capacity;
 
+  std::mutex* mutex;
+  std::condition_variable* not_empty;
+  std::condition_variable* not_full;
+  size_t dequeue_waiters;
+  size_t enqueue_waiters;
+
+  // Readable while the queue has elements (dequeue_fd) or room for more
+  // elements (enqueue_fd). They are only written when the queue changes
+  // between those states, not for every element.
+  int dequeue_fd;
+  int enqueue_fd;
+
   reactor_object_t* dequeue_object;
   fixed_queue_cb dequeue_ready;
   void* dequeue_context;
 } fixed_queue_t;
 
+// Queue whose dequeue callback is running on this thread. Reset when the
+// callback unregisters or frees the queue, which ends the batch.
+static thread_local fixed_queue_t* dispatching_queue = NULL;
+
 static void internal_dequeue_ready(void* context);
 
 fixed_queue_t* fixed_queue_new(size_t capacity) {
@@ -48,20 +75,23 @@ fixed_queue_t* fixed_queue_new(size_t capacity) {
       static_cast<fixed_queue_t*>(osi_calloc(sizeof(fixed_queue_t)));
 
   ret->mutex = new std::mutex;
+  ret->not_empty = new std::condition_variable;
+  ret->not_full = new std::condition_variable;
   ret->capacity = capacity;
+  ret->slots = initial_slots;
+  ret->items = static_cast<void**>(osi_malloc(ret->slots * sizeof(void*)));
+  ret->enqueue_fd = ret->dequeue_fd = INVALID_FD;
 
-  ret->list = list_new(NULL);
-  if (!ret->list) goto error;
+  ret->dequeue_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ret->dequeue_fd == INVALID_FD) goto error;
 
-  ret->enqueue_sem = semaphore_new(capacity);
-  if (!ret->enqueue_sem) goto error;
-
-  ret->dequeue_sem = semaphore_new(0);
-  if (!ret->dequeue_sem) goto error;
+  ret->enqueue_fd = eventfd(capacity > 0 ? 1 : 0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (ret->enqueue_fd == INVALID_FD) goto error;
 
   return ret;
 
 error:
+  LOG_ERROR("%s unable to allocate eventfd: %s", __func__, strerror(errno));
   fixed_queue_free(ret, NULL);
   return NULL;
 }
@@ -72,13 +102,14 @@ void fixed_queue_free(fixed_queue_t* queue, fixed_queue_free_cb free_cb) {
   fixed_queue_unregister_dequeue(queue);
 
   if (free_cb)
-    for (const list_node_t* node = list_begin(queue->list);
-         node != list_end(queue->list); node = list_next(node))
-      free_cb(list_node(node));
-
-  list_free(queue->list);
-  semaphore_free(queue->enqueue_sem);
-  semaphore_free(queue->dequeue_sem);
+    for (size_t i = 0; i < queue->length; i++)
+      free_cb(queue->items[(queue->head + i) & (queue->slots - 1)]);
+
+  if (queue->dequeue_fd != INVALID_FD) close(queue->dequeue_fd);
+  if (queue->enqueue_fd != INVALID_FD) close(queue->enqueue_fd);
+  osi_free(queue->items);
+  delete queue->not_full;
+  delete queue->not_empty;
   delete queue->mutex;
   osi_free(queue);
 }
@@ -98,14 +129,14 @@ bool fixed_queue_is_empty(fixed_queue_t* queue) {
   if (queue == NULL) return true;
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
-  return list_is_empty(queue->list);
+  return queue->length == 0;
 }
 
 size_t fixed_queue_length(fixed_queue_t* queue) {
   if (queue == NULL) return 0;
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
-  return list_length(queue->list);
+  return queue->length;
 }
 
 size_t fixed_queue_capacity(fixed_queue_t* queue) {
@@ -114,120 +145,135 @@ size_t fixed_queue_capacity(fixed_queue_t* queue) {
   return queue->capacity;
 }
 
-void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
-  CHECK(queue != NULL);
-  CHECK(data != NULL);
+static void* item_at_locked(fixed_queue_t* queue, size_t index) {
+  return queue->items[(queue->head + index) & (queue->slots - 1)];
+}
 
-  semaphore_wait(queue->enqueue_sem);
+static void push_locked(fixed_queue_t* queue, void* data) {
+  if (queue->length == queue->slots) {
+    void** items =
+        static_cast<void**>(osi_malloc(2 * queue->slots * sizeof(void*)));
+    for (size_t i = 0; i < queue->length; i++)
+      items[i] = item_at_locked(queue, i);
+    osi_free(queue->items);
+    queue->items = items;
+    queue->slots *= 2;
+    queue->head = 0;
+  }
+
+  queue->items[(queue->head + queue->length) & (queue->slots - 1)] = data;
+  queue->length++;
 
-  {
-    std::lock_guard<std::mutex> lock(*queue->mutex);
-    list_append(queue->list, data);
+  if (queue->length == 1) eventfd_write(queue->dequeue_fd, 1);
+  if (queue->length == queue->capacity) {
+    eventfd_t value;
+    eventfd_read(queue->enqueue_fd, &value);
   }
+  if (queue->dequeue_waiters > 0) queue->not_empty->notify_one();
+}
 
-  semaphore_post(queue->dequeue_sem);
+// Removes the element at |index|, moving the elements after it forward.
+static void* remove_locked(fixed_queue_t* queue, size_t index) {
+  void* data = item_at_locked(queue, index);
+  if (index == 0) {
+    queue->head = (queue->head + 1) & (queue->slots - 1);
+  } else {
+    for (size_t i = index; i + 1 < queue->length; i++)
+      queue->items[(queue->head + i) & (queue->slots - 1)] =
+          item_at_locked(queue, i + 1);
+  }
+  queue->length--;
+
+  if (queue->length == 0) {
+    eventfd_t value;
+    eventfd_read(queue->dequeue_fd, &value);
+  }
+  if (queue->length + 1 == queue->capacity) eventfd_write(queue->enqueue_fd, 1);
+  if (queue->enqueue_waiters > 0) queue->not_full->notify_one();
+  return data;
 }
 
-void* fixed_queue_dequeue(fixed_queue_t* queue) {
+void fixed_queue_enqueue(fixed_queue_t* queue, void* data) {
   CHECK(queue != NULL);
+  CHECK(data != NULL);
 
-  semaphore_wait(queue->dequeue_sem);
-
-  void* ret = NULL;
-  {
-    std::lock_guard<std::mutex> lock(*queue->mutex);
-    ret = list_front(queue->list);
-    list_remove(queue->list, ret);
-  }
+  std::unique_lock<std::mutex> lock(*queue->mutex);
+  queue->enqueue_waiters++;
+  queue->not_full->wait(lock,
+                        [queue] { return queue->length < queue->capacity; });
+  queue->enqueue_waiters--;
+  push_locked(queue, data);
+}
 
-  semaphore_post(queue->enqueue_sem);
+void* fixed_queue_dequeue(fixed_queue_t* queue) {
+  CHECK(queue != NULL);
 
-  return ret;
+  std::unique_lock<std::mutex> lock(*queue->mutex);
+  queue->dequeue_waiters++;
+  queue->not_empty->wait(lock, [queue] { return queue->length > 0; });
+  queue->dequeue_waiters--;
+  return remove_locked(queue, 0);
 }
 
 bool fixed_queue_try_enqueue(fixed_queue_t* queue, void* data) {
   CHECK(queue != NULL);
   CHECK(data != NULL);
 
-  if (!semaphore_try_wait(queue->enqueue_sem)) return false;
-
-  {
-    std::lock_guard<std::mutex> lock(*queue->mutex);
-    list_append(queue->list, data);
-  }
+  std::lock_guard<std::mutex> lock(*queue->mutex);
+  if (queue->length >= queue->capacity) return false;
 
-  semaphore_post(queue->dequeue_sem);
+  push_locked(queue, data);
   return true;
 }
 
 void* fixed_queue_try_dequeue(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
-  if (!semaphore_try_wait(queue->dequeue_sem)) return NULL;
-
-  void* ret = NULL;
-  {
-    std::lock_guard<std::mutex> lock(*queue->mutex);
-    ret = list_front(queue->list);
-    list_remove(queue->list, ret);
-  }
-
-  semaphore_post(queue->enqueue_sem);
+  std::lock_guard<std::mutex> lock(*queue->mutex);
+  if (queue->length == 0) return NULL;
 
-  return ret;
+  return remove_locked(queue, 0);
 }
 
 void* fixed_queue_try_peek_first(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
-  return list_is_empty(queue->list) ? NULL : list_front(queue->list);
+  return queue->length == 0 ? NULL : item_at_locked(queue, 0);
 }
 
 void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
   if (queue == NULL) return NULL;
 
   std::lock_guard<std::mutex> lock(*queue->mutex);
-  return list_is_empty(queue->list) ? NULL : list_back(queue->list);
+  return queue->length == 0 ? NULL : item_at_locked(queue, queue->length - 1);
 }
 
-void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
+void* fixed_queue_try_peek_at(fixed_queue_t* queue, size_t index) {
   if (queue == NULL) return NULL;
 
-  bool removed = false;
-  {
-    std::lock_guard<std::mutex> lock(*queue->mutex);
-    if (list_contains(queue->list, data) &&
-        semaphore_try_wait(queue->dequeue_sem)) {
-      removed = list_remove(queue->list, data);
-      CHECK(removed);
-    }
-  }
-
-  if (removed) {
-    semaphore_post(queue->enqueue_sem);
-    return data;
-  }
-  return NULL;
+  std::lock_guard<std::mutex> lock(*queue->mutex);
+  return index >= queue->length ? NULL : item_at_locked(queue, index);
 }
 
-list_t* fixed_queue_get_list(fixed_queue_t* queue) {
-  CHECK(queue != NULL);
+void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
+  if (queue == NULL) return NULL;
 
-  // NOTE: Using the list in this way is not thread-safe.
-  // Using this list in any context where threads can call other functions
-  // to the queue can break our assumptions and the queue in general.
-  return queue->list;
+  std::lock_guard<std::mutex> lock(*queue->mutex);
+  for (size_t i = 0; i < queue->length; i++) {
+    if (item_at_locked(queue, i) == data) return remove_locked(queue, i);
+  }
+  return NULL;
 }
 
 int fixed_queue_get_dequeue_fd(const fixed_queue_t* queue) {
   CHECK(queue != NULL);
-  return semaphore_get_fd(queue->dequeue_sem);
+  return queue->dequeue_fd;
 }
 
 int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue) {
   CHECK(queue != NULL);
-  return semaphore_get_fd(queue->enqueue_sem);
+  return queue->enqueue_fd;
 }
 
 void fixed_queue_register_dequeue(fixed_queue_t* queue, reactor_t* reactor,
@@ -249,6 +295,8 @@ void fixed_queue_register_dequeue(fixed_queue_t* queue, reactor_t* reactor,
 void fixed_queue_unregister_dequeue(fixed_queue_t* queue) {
   CHECK(queue != NULL);
 
+  if (dispatching_queue == queue) dispatching_queue = NULL;
+
   if (queue->dequeue_object) {
     reactor_unregister(queue->dequeue_object);
     queue->dequeue_object = NULL;
@@ -259,5 +307,20 @@ static void internal_dequeue_ready(void* context) {
   CHECK(context != NULL);
 
   fixed_queue_t* queue = static_cast<fixed_queue_t*>(context);
-  queue->dequeue_ready(queue, queue->dequeue_context);
+  fixed_queue_t* outer_queue = dispatching_queue;
+  dispatching_queue = queue;
+
+  // The fd stays readable until the queue is empty, so a batch may stop
+  // early and the reactor calls back for the rest. Stop as well when the
+  // callback leaves its element in the queue, it would not make progress.
+  for (size_t i = 0; i < dequeue_batch_max; i++) {
+    size_t length = fixed_queue_length(queue);
+    queue->dequeue_ready(queue, queue->dequeue_context);
+    if (dispatching_queue != queue) break;
+
+    size_t remaining = fixed_queue_length(queue);
+    if (remaining == 0 || remaining >= length) break;
+  }
+
+  dispatching_queue = outer_queue;
 }
@@ -61,7 +61,7 @@ typedef struct {
 } work_item_t;
 
 static void* run_thread(void* start_arg);
-static void work_queue_read_cb(void* context);
+static void work_queue_read_cb(fixed_queue_t* queue, void* context);
 
 static const size_t DEFAULT_WORK_QUEUE_CAPACITY = 128;
 
@@ -211,13 +211,10 @@ static void* run_thread(void* start_arg) {
 
   semaphore_post(start->start_sem);
 
-  int fd = fixed_queue_get_dequeue_fd(thread->work_queue);
-  void* context = thread->work_queue;
-
-  reactor_object_t* work_queue_object =
-      reactor_register(thread->reactor, fd, context, work_queue_read_cb, NULL);
+  fixed_queue_register_dequeue(thread->work_queue, thread->reactor,
+                               work_queue_read_cb, NULL);
   reactor_start(thread->reactor);
-  reactor_unregister(work_queue_object);
+  fixed_queue_unregister_dequeue(thread->work_queue);
 
   // Make sure we dispatch all queued work items before exiting the thread.
   // This allows a caller to safely tear down by enqueuing a teardown
@@ -241,10 +238,9 @@ static void* run_thread(void* start_arg) {
   return NULL;
 }
 
-static void work_queue_read_cb(void* context) {
-  CHECK(context != NULL);
+static void work_queue_read_cb(fixed_queue_t* queue, void* context) {
+  CHECK(queue != NULL);
 
-  fixed_queue_t* queue = (fixed_queue_t*)context;
   work_item_t* item = static_cast<work_item_t*>(fixed_queue_dequeue(queue));
   item->func(item->context);
   osi_free(item);
@@ -0,0 +1,107 @@
+#include "osi/include/buffer_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "AllocationTestHarness.h"
+#include "osi/include/allocator.h"
+
+class BufferPoolTest : public AllocationTestHarness {
+ protected:
+  void SetUp() override {
+    AllocationTestHarness::SetUp();
+#if defined(BUFFER_POOL_BYPASSED)
+    GTEST_SKIP() << "The buffer pool is bypassed under the sanitizer";
+#endif
+  }
+};
+
+static buffer_pool_stats_t get_stats(size_t class_index) {
+  buffer_pool_stats_t stats;
+  EXPECT_TRUE(buffer_pool_get_stats(class_index, &stats));
+  return stats;
+}
+
+TEST_F(BufferPoolTest, test_class_sizes) {
+  buffer_pool_stats_t stats;
+  size_t last_size = 0;
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++) {
+    ASSERT_TRUE(buffer_pool_get_stats(i, &stats));
+    EXPECT_GT(stats.block_size, last_size);
+    EXPECT_GT(stats.capacity, 0U);
+    last_size = stats.block_size;
+  }
+  EXPECT_EQ((size_t)BUFFER_POOL_MAX_BLOCK_SIZE, last_size);
+  EXPECT_FALSE(buffer_pool_get_stats(BUFFER_POOL_NUM_CLASSES, &stats));
+}
+
+TEST_F(BufferPoolTest, test_pool_malloc_free) {
+  buffer_pool_stats_t before = get_stats(1);
+
+  void* ptr = osi_pool_malloc(100);
+  ASSERT_TRUE(ptr != NULL);
+  memset(ptr, 0x5a, 100);
+
+  buffer_pool_stats_t during = get_stats(1);
+  EXPECT_EQ(before.allocated + 1, during.allocated);
+  EXPECT_EQ(before.in_use + 1, during.in_use);
+  EXPECT_GE(during.high_water, during.in_use);
+
+  osi_free(ptr);
+  EXPECT_EQ(before.in_use, get_stats(1).in_use);
+}
+
+TEST_F(BufferPoolTest, test_freed_block_is_reused) {
+  void* ptr = osi_pool_malloc(500);
+  osi_free(ptr);
+  void* again = osi_pool_malloc(500);
+  EXPECT_EQ(ptr, again);
+  osi_free(again);
+}
+
+TEST_F(BufferPoolTest, test_pool_calloc_clears_reused_block) {
+  uint8_t* ptr = static_cast<uint8_t*>(osi_pool_malloc(48));
+  memset(ptr, 0xff, 48);
+  osi_free(ptr);
+
+  uint8_t* zeroed = static_cast<uint8_t*>(osi_pool_calloc(48));
+  ASSERT_EQ(ptr, zeroed);
+  for (size_t i = 0; i < 48; i++) EXPECT_EQ(0, zeroed[i]);
+  osi_free(zeroed);
+}
+
+TEST_F(BufferPoolTest, test_large_allocation_uses_malloc) {
+  std::vector<buffer_pool_stats_t> before;
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++)
+    before.push_back(get_stats(i));
+
+  void* ptr = osi_pool_malloc(BUFFER_POOL_MAX_BLOCK_SIZE + 1);
+  ASSERT_TRUE(ptr != NULL);
+  EXPECT_FALSE(buffer_pool_free(ptr));
+
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++)
+    EXPECT_EQ(before[i].allocated, get_stats(i).allocated);
+  osi_free(ptr);
+}
+
+TEST_F(BufferPoolTest, test_free_on_other_thread) {
+  static const size_t num_buffers = 200;
+  buffer_pool_stats_t before = get_stats(3);
+
+  std::vector<void*> buffers;
+  std::thread producer([&buffers]() {
+    for (size_t i = 0; i < num_buffers; i++)
+      buffers.push_back(osi_pool_malloc(4096));
+  });
+  producer.join();
+  EXPECT_EQ(before.in_use + num_buffers, get_stats(3).in_use);
+
+  for (void* ptr : buffers) osi_free(ptr);
+  buffer_pool_stats_t after = get_stats(3);
+  EXPECT_EQ(before.in_use, after.in_use);
+  EXPECT_EQ(before.allocated + num_buffers, after.allocated);
+  EXPECT_GE(after.high_water, before.in_use + num_buffers);
+}
@@ -1,6 +1,8 @@
 #include <gtest/gtest.h>
 
 #include <climits>
+#include <thread>
+#include <vector>
 
 #include "AllocationTestHarness.h"
 
@@ -18,6 +20,8 @@ static const char* DUMMY_DATA_STRING3 = "Dummy data string3";
 static future_t* received_message_future = NULL;
 
 static int test_queue_entry_free_counter = 0;
+static size_t batch_message_count = 0;
+static const size_t BATCH_MESSAGES = 100;
 
 // Test whether a file descriptor |fd| is readable.
 // Return true if the file descriptor is readable, otherwise false.
@@ -43,6 +47,15 @@ static void fixed_queue_ready(fixed_queue_t* queue, UNUSED_ATTR void* context) {
   future_ready(received_message_future, msg);
 }
 
+// Function dequeueing a single message per call, signaling once all
+// BATCH_MESSAGES have been received
+static void fixed_queue_batch_ready(fixed_queue_t* queue,
+                                    UNUSED_ATTR void* context) {
+  EXPECT_TRUE(fixed_queue_try_dequeue(queue) != NULL);
+  if (++batch_message_count == BATCH_MESSAGES)
+    future_ready(received_message_future, NULL);
+}
+
 static void test_queue_entry_free_cb(void* data) {
   // Don't free the data, because we are testing only whether the callback
   // is called.
@@ -230,6 +243,63 @@ TEST_F(FixedQueueTest, test_fixed_queue_enqueue_dequeue) {
   fixed_queue_free(queue, NULL);
 }
 
+TEST_F(FixedQueueTest, test_fixed_queue_order_after_growing) {
+  fixed_queue_t* queue = fixed_queue_new(SIZE_MAX);
+  ASSERT_TRUE(queue != NULL);
+
+  // Interleave enqueues and dequeues, so that the ring wraps around before
+  // it has to grow
+  static int data[1000];
+  size_t next_dequeue = 0;
+  for (size_t i = 0; i < 1000; i++) {
+    fixed_queue_enqueue(queue, &data[i]);
+    if (i % 3 == 0) {
+      EXPECT_EQ(&data[next_dequeue], fixed_queue_dequeue(queue));
+      next_dequeue++;
+    }
+  }
+  EXPECT_EQ(1000 - next_dequeue, fixed_queue_length(queue));
+  while (next_dequeue < 1000) {
+    EXPECT_EQ(&data[next_dequeue], fixed_queue_try_dequeue(queue));
+    next_dequeue++;
+  }
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  fixed_queue_free(queue, NULL);
+}
+
+TEST_F(FixedQueueTest, test_fixed_queue_blocking_producers) {
+  static const size_t NUM_PRODUCERS = 4;
+  static const size_t MESSAGES_PER_PRODUCER = 1000;
+  fixed_queue_t* queue = fixed_queue_new(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  // The queue is much smaller than the number of messages, so producers
+  // block on a full queue until the consumer makes room
+  static int data[NUM_PRODUCERS][MESSAGES_PER_PRODUCER];
+  std::vector<std::thread> producers;
+  for (size_t i = 0; i < NUM_PRODUCERS; i++) {
+    producers.emplace_back([queue, i]() {
+      for (size_t j = 0; j < MESSAGES_PER_PRODUCER; j++)
+        fixed_queue_enqueue(queue, &data[i][j]);
+    });
+  }
+
+  // Messages of every producer arrive in the order they were sent
+  size_t next[NUM_PRODUCERS] = {};
+  for (size_t n = 0; n < NUM_PRODUCERS * MESSAGES_PER_PRODUCER; n++) {
+    int* msg = static_cast<int*>(fixed_queue_dequeue(queue));
+    size_t producer = (msg - &data[0][0]) / MESSAGES_PER_PRODUCER;
+    ASSERT_LT(producer, NUM_PRODUCERS);
+    EXPECT_EQ(&data[producer][next[producer]], msg);
+    next[producer]++;
+  }
+  for (auto& producer : producers) producer.join();
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  fixed_queue_free(queue, NULL);
+}
+
 TEST_F(FixedQueueTest, test_fixed_queue_try_peek_first_last) {
   fixed_queue_t* queue = fixed_queue_new(TEST_QUEUE_SIZE);
   ASSERT_TRUE(queue != NULL);
@@ -260,6 +330,32 @@ TEST_F(FixedQueueTest, test_fixed_queue_try_peek_first_last) {
   fixed_queue_free(queue, NULL);
 }
 
+TEST_F(FixedQueueTest, test_fixed_queue_try_peek_at) {
+  fixed_queue_t* queue = fixed_queue_new(TEST_QUEUE_SIZE);
+  ASSERT_TRUE(queue != NULL);
+
+  // Test peek at from a NULL queue and an empty queue
+  EXPECT_EQ(NULL, fixed_queue_try_peek_at(NULL, 0));
+  EXPECT_EQ(NULL, fixed_queue_try_peek_at(queue, 0));
+
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING1);
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING2);
+  fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING3);
+  EXPECT_EQ(DUMMY_DATA_STRING1, fixed_queue_try_peek_at(queue, 0));
+  EXPECT_EQ(DUMMY_DATA_STRING2, fixed_queue_try_peek_at(queue, 1));
+  EXPECT_EQ(DUMMY_DATA_STRING3, fixed_queue_try_peek_at(queue, 2));
+  EXPECT_EQ(NULL, fixed_queue_try_peek_at(queue, 3));
+
+  // Removing from the middle keeps the order of the other elements
+  EXPECT_EQ(DUMMY_DATA_STRING2, fixed_queue_try_remove_from_queue(
+                                    queue, (void*)DUMMY_DATA_STRING2));
+  EXPECT_EQ(DUMMY_DATA_STRING1, fixed_queue_try_peek_at(queue, 0));
+  EXPECT_EQ(DUMMY_DATA_STRING3, fixed_queue_try_peek_at(queue, 1));
+  EXPECT_EQ(NULL, fixed_queue_try_peek_at(queue, 2));
+
+  fixed_queue_free(queue, NULL);
+}
+
 TEST_F(FixedQueueTest, test_fixed_queue_try_remove_from_queue) {
   fixed_queue_t* queue = fixed_queue_new(TEST_QUEUE_SIZE);
   ASSERT_TRUE(queue != NULL);
@@ -348,3 +444,30 @@ TEST_F(FixedQueueTest, test_fixed_queue_register_dequeue) {
   thread_free(worker_thread);
   fixed_queue_free(queue, NULL);
 }
+
+TEST_F(FixedQueueTest, test_fixed_queue_register_dequeue_batch) {
+  fixed_queue_t* queue = fixed_queue_new(SIZE_MAX);
+  ASSERT_TRUE(queue != NULL);
+
+  // Queue the messages before registering, so that they are all pending
+  // when the reactor wakes up
+  for (size_t i = 0; i < BATCH_MESSAGES; i++)
+    fixed_queue_enqueue(queue, (void*)DUMMY_DATA_STRING);
+
+  batch_message_count = 0;
+  received_message_future = future_new();
+  ASSERT_TRUE(received_message_future != NULL);
+
+  thread_t* worker_thread = thread_new("test_fixed_queue_worker_thread");
+  ASSERT_TRUE(worker_thread != NULL);
+
+  fixed_queue_register_dequeue(queue, thread_get_reactor(worker_thread),
+                               fixed_queue_batch_ready, NULL);
+  future_await(received_message_future);
+  EXPECT_EQ(BATCH_MESSAGES, batch_message_count);
+  EXPECT_TRUE(fixed_queue_is_empty(queue));
+
+  fixed_queue_unregister_dequeue(queue);
+  thread_free(worker_thread);
+  fixed_queue_free(queue, NULL);
+}
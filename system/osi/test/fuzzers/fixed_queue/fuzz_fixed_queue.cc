@@ -163,11 +163,10 @@ void callArbitraryFunction(fixed_queue_t* fixed_queue,
         fixed_queue_try_remove_from_queue(fixed_queue, buf_ptr);
       }
       return;
-    // Convert the queue to a list (Cannot be null)
+    // Peek at an element in the middle of the queue (NULL is OK)
     case 13:
-      if (fixed_queue) {
-        fixed_queue_get_list(fixed_queue);
-      }
+      fixed_queue_try_peek_at(fixed_queue,
+                              dataProvider->ConsumeIntegral<size_t>());
       return;
     // Check if enqueue is blocking
     case 14:
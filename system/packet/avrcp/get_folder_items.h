@@ -43,6 +43,9 @@ class GetFolderItemsResponseBuilder : public BrowsePacketBuilder {
  protected:
   Scope scope_;
   std::vector<MediaListItem> items_;
+  // Sum of the sizes of |items_|, so that checking the MTU for every added
+  // item does not walk all the items added before
+  size_t items_size_ = 0;
   Status status_;
   uint16_t uid_counter_;
   size_t mtu_;
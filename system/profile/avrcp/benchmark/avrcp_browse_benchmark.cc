@@ -0,0 +1,157 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/bind.h>
+#include <benchmark/benchmark.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "device.h"
+#include "stack_config.h"
+#include "tests/packet_test_helper.h"
+#include "types/raw_address.h"
+
+using ::benchmark::State;
+using ::bluetooth::TestPacketType;
+using ::bluetooth::avrcp::A2dpInterface;
+using ::bluetooth::avrcp::Attribute;
+using ::bluetooth::avrcp::AttributeEntry;
+using ::bluetooth::avrcp::BrowsePacket;
+using ::bluetooth::avrcp::Device;
+using ::bluetooth::avrcp::GetFolderItemsRequestBuilder;
+using ::bluetooth::avrcp::KeyState;
+using ::bluetooth::avrcp::ListItem;
+using ::bluetooth::avrcp::MediaCallbacks;
+using ::bluetooth::avrcp::MediaInterface;
+using ::bluetooth::avrcp::Scope;
+using ::bluetooth::avrcp::SongInfo;
+
+namespace {
+
+bool get_pts_avrcp_test(void) { return false; }
+
+const stack_config_t interface = {nullptr, get_pts_avrcp_test,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr,
+                                  nullptr, nullptr};
+
+// Browse MTU of a typical car head unit
+constexpr uint16_t kBrowseMtu = 1017;
+// Items a head unit asks for in one Get Folder Items request
+constexpr uint32_t kItemsPerPage = 10;
+
+// Answers every request synchronously with a fresh copy of the listing, as
+// the JNI layer builds a new one for every call.
+class FakeMediaInterface : public MediaInterface {
+ public:
+  explicit FakeMediaInterface(size_t num_items) {
+    for (size_t i = 0; i < num_items; i++) {
+      std::string id = std::to_string(i);
+      SongInfo song = {"song_" + id,
+                       {AttributeEntry(Attribute::TITLE, "Song " + id),
+                        AttributeEntry(Attribute::ARTIST_NAME, "Artist " + id),
+                        AttributeEntry(Attribute::ALBUM_NAME, "Album " + id)}};
+      folder_.push_back({ListItem::SONG, {}, song});
+    }
+  }
+
+  void SendKeyEvent(uint8_t key, KeyState state) override {}
+  void GetSongInfo(SongInfoCallback info_cb) override {}
+  void GetPlayStatus(PlayStatusCallback status_cb) override {}
+  void GetNowPlayingList(NowPlayingCallback now_playing_cb) override {}
+  void GetMediaPlayerList(MediaListCallback list_cb) override {}
+  void GetFolderItems(uint16_t player_id, std::string media_id,
+                      FolderItemsCallback folder_cb) override {
+    folder_cb.Run(folder_);
+  }
+  void SetBrowsedPlayer(uint16_t player_id,
+                        SetBrowsedPlayerCallback browse_cb) override {}
+  void PlayItem(uint16_t player_id, bool now_playing,
+                std::string media_id) override {}
+  void SetActiveDevice(const RawAddress& address) override {}
+  void RegisterUpdateCallback(MediaCallbacks* callback) override {}
+  void UnregisterUpdateCallback(MediaCallbacks* callback) override {}
+
+ private:
+  std::vector<ListItem> folder_;
+};
+
+class FakeA2dpInterface : public A2dpInterface {
+ public:
+  RawAddress active_peer() override { return RawAddress::kAny; }
+  bool is_peer_in_silence_mode(const RawAddress& peer_address) override {
+    return false;
+  }
+};
+
+void SendResponse(uint8_t label, bool browse,
+                  std::unique_ptr<::bluetooth::PacketBuilder> message) {
+  auto pkt = TestPacketType<BrowsePacket>::Make();
+  message->Serialize(pkt);
+  benchmark::DoNotOptimize(pkt);
+}
+
+// A head unit paging through a folder of |range(0)| songs, one Get Folder
+// Items request per iteration. With |range(1)| set to 0 the listing is
+// invalidated before every page, which is what every page cost before the
+// device cached the listing. A folder of 50000 of these songs is over the
+// per device cache budget, so it is fetched for every page either way.
+void BM_BrowseFolderPage(State& state) {
+  size_t num_items = state.range(0);
+  bool cached = state.range(1) != 0;
+  FakeMediaInterface media_interface(num_items);
+  FakeA2dpInterface a2dp_interface;
+  Device device(RawAddress::kAny, false, base::Bind(&SendResponse), 0xFFFF,
+                kBrowseMtu);
+  device.RegisterInterfaces(&media_interface, &a2dp_interface, nullptr);
+
+  uint32_t start = 0;
+  for (auto _ : state) {
+    if (!cached) {
+      device.SendFolderUpdate(false, false, true);
+    }
+    auto request_builder = GetFolderItemsRequestBuilder::MakeBuilder(
+        Scope::VFS, start, start + kItemsPerPage - 1, {});
+    auto request = TestPacketType<BrowsePacket>::Make();
+    request_builder->Serialize(request);
+    device.BrowseMessageReceived(1, request);
+
+    start += kItemsPerPage;
+    if (start >= num_items) start = 0;
+  }
+  state.SetItemsProcessed(state.iterations() * kItemsPerPage);
+}
+BENCHMARK(BM_BrowseFolderPage)
+    ->ArgNames({"items", "cached"})
+    ->Args({5000, 0})
+    ->Args({5000, 1})
+    ->Args({50000, 0})
+    ->Args({50000, 1});
+
+}  // namespace
+
+const stack_config_t* stack_config_get_interface(void) { return &interface; }
+
+BENCHMARK_MAIN();
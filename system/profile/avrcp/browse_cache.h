@@ -0,0 +1,158 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "hardware/avrcp/avrcp.h"
+
+namespace bluetooth {
+namespace avrcp {
+
+// Holds the listing of the browsed folder and the now playing list last
+// fetched from the media interface for one device. Remotes page through a
+// folder with many small Get Folder Items requests, and every page used to
+// fetch the whole listing again.
+//
+// The media layer is database unaware, so the UID counter sent to remotes
+// stays 0x0000. Instead, the cache keeps its own generation which is bumped
+// every time the media layer reports a change that invalidates UIDs. A fetch
+// started before the change must not fill the cache once it completes.
+//
+// Both listings together are held to kMaxBytes per device. A listing that
+// doesn't fit on its own is answered but not kept, and the other listing is
+// dropped when both don't fit together.
+class BrowseCache {
+ public:
+  static constexpr size_t kMaxBytes = 4 * 1024 * 1024;
+
+  uint32_t generation() const { return generation_; }
+
+  // Returns the cached listing of |folder_id| on |player_id|, or nullptr if
+  // it is not cached.
+  const std::vector<ListItem>* GetFolder(int player_id,
+                                         const std::string& folder_id) const {
+    if (!has_folder_ || folder_player_id_ != player_id ||
+        folder_id_ != folder_id) {
+      return nullptr;
+    }
+    return &folder_items_;
+  }
+
+  // Replaces the cached folder listing and returns the cached copy, or
+  // returns nullptr and leaves |items| untouched if it is too large to cache.
+  const std::vector<ListItem>* PutFolder(int player_id, std::string folder_id,
+                                         std::vector<ListItem>&& items) {
+    size_t bytes = 0;
+    for (const auto& item : items) bytes += EstimateSize(item);
+    if (bytes > kMaxBytes) return nullptr;
+    if (bytes + now_playing_bytes_ > kMaxBytes) DropNowPlaying();
+
+    has_folder_ = true;
+    folder_player_id_ = player_id;
+    folder_id_ = std::move(folder_id);
+    folder_items_ = std::move(items);
+    folder_bytes_ = bytes;
+    return &folder_items_;
+  }
+
+  bool HasNowPlaying() const { return has_now_playing_; }
+  const std::string& now_playing_song_id() const { return curr_song_id_; }
+  const std::vector<SongInfo>& now_playing_list() const {
+    return now_playing_list_;
+  }
+
+  // Replaces the cached now playing list. Returns false and leaves |songs|
+  // untouched if it is too large to cache.
+  bool PutNowPlaying(std::string curr_song_id, std::vector<SongInfo>&& songs) {
+    size_t bytes = 0;
+    for (const auto& song : songs) bytes += EstimateSize(song);
+    if (bytes > kMaxBytes) return false;
+    if (bytes + folder_bytes_ > kMaxBytes) DropFolder();
+
+    has_now_playing_ = true;
+    curr_song_id_ = std::move(curr_song_id);
+    now_playing_list_ = std::move(songs);
+    now_playing_bytes_ = bytes;
+    return true;
+  }
+
+  // The folder contents or the UIDs changed
+  void InvalidateFolder() {
+    generation_++;
+    DropFolder();
+  }
+
+  // The queue or the current song changed
+  void InvalidateNowPlaying() {
+    generation_++;
+    DropNowPlaying();
+  }
+
+ private:
+  // Roughly what an item costs in memory: the item itself, its strings, and
+  // a node of the attribute set per attribute.
+  static size_t EstimateSize(const SongInfo& song) {
+    return sizeof(SongInfo) + EstimateHeapSize(song);
+  }
+
+  static size_t EstimateSize(const ListItem& item) {
+    return sizeof(ListItem) + item.folder.media_id.size() +
+           item.folder.name.size() + EstimateHeapSize(item.song);
+  }
+
+  static size_t EstimateHeapSize(const SongInfo& song) {
+    size_t bytes = song.media_id.size();
+    for (const auto& attribute : song.attributes) {
+      bytes += sizeof(AttributeEntry) + 4 * sizeof(void*) + attribute.size();
+    }
+    return bytes;
+  }
+
+  void DropFolder() {
+    has_folder_ = false;
+    folder_id_.clear();
+    std::vector<ListItem>().swap(folder_items_);
+    folder_bytes_ = 0;
+  }
+
+  void DropNowPlaying() {
+    has_now_playing_ = false;
+    curr_song_id_.clear();
+    std::vector<SongInfo>().swap(now_playing_list_);
+    now_playing_bytes_ = 0;
+  }
+
+  uint32_t generation_ = 0;
+
+  bool has_folder_ = false;
+  int folder_player_id_ = -1;
+  std::string folder_id_;
+  std::vector<ListItem> folder_items_;
+  size_t folder_bytes_ = 0;
+
+  bool has_now_playing_ = false;
+  std::string curr_song_id_;
+  std::vector<SongInfo> now_playing_list_;
+  size_t now_playing_bytes_ = 0;
+};
+
+}  // namespace avrcp
+}  // namespace bluetooth
@@ -851,15 +851,14 @@ void Device::HandleGetFolderItems(uint8_t label,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
-          base::Bind(&Device::GetVFSListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetCurrentFolderItems(base::Bind(&Device::GetVFSListResponse,
+                                       weak_ptr_factory_.GetWeakPtr(), label,
+                                       pkt));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
-          base::Bind(&Device::GetNowPlayingListResponse,
-                     weak_ptr_factory_.GetWeakPtr(), label, pkt));
+      GetNowPlayingItems(base::Bind(&Device::GetNowPlayingListResponse,
+                                    weak_ptr_factory_.GetWeakPtr(), label,
+                                    pkt));
       break;
     default:
       DEVICE_LOG(ERROR) << __func__ << ": " << pkt->GetScope();
@@ -888,13 +887,12 @@ void Device::HandleGetTotalNumberOfItems(
       break;
     }
     case Scope::VFS:
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetCurrentFolderItems(
           base::Bind(&Device::GetTotalNumberOfItemsVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
     case Scope::NOW_PLAYING:
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingItems(
           base::Bind(&Device::GetTotalNumberOfItemsNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label));
       break;
@@ -913,8 +911,8 @@ void Device::GetTotalNumberOfItemsMediaPlayersResponse(
   send_message(label, true, std::move(builder));
 }
 
-void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                              std::vector<ListItem> list) {
+void Device::GetTotalNumberOfItemsVFSResponse(
+    uint8_t label, const std::vector<ListItem>& list) {
   DEVICE_VLOG(2) << __func__ << ": num_items=" << list.size();
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
@@ -923,7 +921,8 @@ void Device::GetTotalNumberOfItemsVFSResponse(uint8_t label,
 }
 
 void Device::GetTotalNumberOfItemsNowPlayingResponse(
-    uint8_t label, std::string curr_song_id, std::vector<SongInfo> list) {
+    uint8_t label, const std::string& curr_song_id,
+    const std::vector<SongInfo>& list) {
   DEVICE_VLOG(2) << __func__ << ": num_items=" << list.size();
 
   auto builder = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
@@ -972,15 +971,14 @@ void Device::HandleChangePath(uint8_t label,
                    << "\"";
   }
 
-  media_interface_->GetFolderItems(
-      curr_browsed_player_id_, CurrentFolder(),
-      base::Bind(&Device::ChangePathResponse, weak_ptr_factory_.GetWeakPtr(),
-                 label, pkt));
+  GetCurrentFolderItems(base::Bind(&Device::ChangePathResponse,
+                                   weak_ptr_factory_.GetWeakPtr(), label,
+                                   pkt));
 }
 
 void Device::ChangePathResponse(uint8_t label,
                                 std::shared_ptr<ChangePathRequest> pkt,
-                                std::vector<ListItem> list) {
+                                const std::vector<ListItem>& list) {
   // TODO (apanicke): Reconstruct the VFS ID's here. Right now it gets
   // reconstructed in GetFolderItemsVFS
   auto builder =
@@ -1010,7 +1008,7 @@ void Device::HandleGetItemAttributes(
 
   switch (pkt->GetScope()) {
     case Scope::NOW_PLAYING: {
-      media_interface_->GetNowPlayingList(
+      GetNowPlayingItems(
           base::Bind(&Device::GetItemAttributesNowPlayingResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
     } break;
@@ -1019,8 +1017,7 @@ void Device::HandleGetItemAttributes(
       // then we can auto send the error without calling up. We do this check
       // later right now though in order to prevent race conditions with updates
       // on the media layer.
-      media_interface_->GetFolderItems(
-          curr_browsed_player_id_, CurrentFolder(),
+      GetCurrentFolderItems(
           base::Bind(&Device::GetItemAttributesVFSResponse,
                      weak_ptr_factory_.GetWeakPtr(), label, pkt));
       break;
@@ -1032,7 +1029,7 @@ void Device::HandleGetItemAttributes(
 
 void Device::GetItemAttributesNowPlayingResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::string curr_media_id, std::vector<SongInfo> song_list) {
+    const std::string& curr_media_id, const std::vector<SongInfo>& song_list) {
   DEVICE_VLOG(2) << __func__ << ": uid=" << loghex(pkt->GetUid());
   auto builder = GetItemAttributesResponseBuilder::MakeBuilder(Status::NO_ERROR,
                                                                browse_mtu_);
@@ -1083,7 +1080,7 @@ void Device::GetItemAttributesNowPlayingResponse(
 
 void Device::GetItemAttributesVFSResponse(
     uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-    std::vector<ListItem> item_list) {
+    const std::vector<ListItem>& item_list) {
   DEVICE_VLOG(2) << __func__ << ": uid=" << loghex(pkt->GetUid());
 
   auto media_id = vfs_ids_.get_media_id(pkt->GetUid());
@@ -1197,7 +1194,7 @@ std::set<AttributeEntry> filter_attributes_requested(
 
 void Device::GetVFSListResponse(uint8_t label,
                                 std::shared_ptr<GetFolderItemsRequest> pkt,
-                                std::vector<ListItem> items) {
+                                const std::vector<ListItem>& items) {
   DEVICE_VLOG(2) << __func__ << ": start_item=" << pkt->GetStartItem()
                  << " end_item=" << pkt->GetEndItem();
 
@@ -1205,21 +1202,10 @@ void Device::GetVFSListResponse(uint8_t label,
   auto builder = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, browse_mtu_);
 
-  // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
-  // an operation.
-  for (const auto& item : items) {
-    if (item.type == ListItem::FOLDER) {
-      vfs_ids_.insert(item.folder.media_id);
-    } else if (item.type == ListItem::SONG) {
-      vfs_ids_.insert(item.song.media_id);
-    }
-  }
-
-  // Add the elements retrieved in the last get folder items request and map
-  // them to UIDs The maps will be cleared every time a directory change
-  // happens. These items do not need to correspond with the now playing list as
-  // the UID's only need to be unique in the context of the current scope and
-  // the current folder
+  // The elements of the folder were mapped to UIDs when the listing was
+  // fetched. These items do not need to correspond with the now playing list
+  // as the UID's only need to be unique in the context of the current scope
+  // and the current folder
   for (auto i = pkt->GetStartItem(); i <= pkt->GetEndItem() && i < items.size();
        i++) {
     if (items[i].type == ListItem::FOLDER) {
@@ -1261,16 +1247,12 @@ void Device::GetVFSListResponse(uint8_t label,
 
 void Device::GetNowPlayingListResponse(
     uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
-    std::string /* unused curr_song_id */, std::vector<SongInfo> song_list) {
+    const std::string& /* unused curr_song_id */,
+    const std::vector<SongInfo>& song_list) {
   DEVICE_VLOG(2) << __func__;
   auto builder = GetFolderItemsResponseBuilder::MakeNowPlayingBuilder(
       Status::NO_ERROR, 0x0000, browse_mtu_);
 
-  now_playing_ids_.clear();
-  for (const SongInfo& song : song_list) {
-    now_playing_ids_.insert(song.media_id);
-  }
-
   for (size_t i = pkt->GetStartItem();
        i <= pkt->GetEndItem() && i < song_list.size(); i++) {
     auto song = song_list[i];
@@ -1300,6 +1282,83 @@ void Device::GetNowPlayingListResponse(
   send_message(label, true, std::move(builder));
 }
 
+void Device::GetCurrentFolderItems(FolderItemsCallback cb) {
+  const auto* items =
+      browse_cache_.GetFolder(curr_browsed_player_id_, CurrentFolder());
+  if (items != nullptr) {
+    cb.Run(*items);
+    return;
+  }
+
+  media_interface_->GetFolderItems(
+      curr_browsed_player_id_, CurrentFolder(),
+      base::Bind(&Device::FolderItemsFetched, weak_ptr_factory_.GetWeakPtr(),
+                 browse_cache_.generation(), curr_browsed_player_id_,
+                 CurrentFolder(), cb));
+}
+
+void Device::FolderItemsFetched(uint32_t generation, int player_id,
+                                std::string folder_id, FolderItemsCallback cb,
+                                std::vector<ListItem> items) {
+  DEVICE_VLOG(2) << __func__ << ": folder_id=\"" << folder_id
+                 << "\" num_items=" << items.size();
+
+  // TODO (apanicke): Add test that checks if vfs_ids_ is the correct size after
+  // an operation.
+  for (const auto& item : items) {
+    if (item.type == ListItem::FOLDER) {
+      vfs_ids_.insert(item.folder.media_id);
+    } else if (item.type == ListItem::SONG) {
+      vfs_ids_.insert(item.song.media_id);
+    }
+  }
+
+  // The folder changed while the listing was fetched, answer with it but
+  // don't keep it for the next pages.
+  if (generation != browse_cache_.generation()) {
+    cb.Run(items);
+    return;
+  }
+
+  const auto* cached = browse_cache_.PutFolder(player_id, std::move(folder_id),
+                                               std::move(items));
+  cb.Run(cached != nullptr ? *cached : items);
+}
+
+void Device::GetNowPlayingItems(NowPlayingCallback cb) {
+  if (browse_cache_.HasNowPlaying()) {
+    cb.Run(browse_cache_.now_playing_song_id(),
+           browse_cache_.now_playing_list());
+    return;
+  }
+
+  media_interface_->GetNowPlayingList(base::Bind(
+      &Device::NowPlayingItemsFetched, weak_ptr_factory_.GetWeakPtr(),
+      browse_cache_.generation(), cb));
+}
+
+void Device::NowPlayingItemsFetched(uint32_t generation, NowPlayingCallback cb,
+                                    std::string curr_song_id,
+                                    std::vector<SongInfo> song_list) {
+  DEVICE_VLOG(2) << __func__ << ": num_items=" << song_list.size();
+
+  now_playing_ids_.clear();
+  for (const SongInfo& song : song_list) {
+    now_playing_ids_.insert(song.media_id);
+  }
+
+  if (generation != browse_cache_.generation()) {
+    cb.Run(curr_song_id, song_list);
+    return;
+  }
+
+  if (!browse_cache_.PutNowPlaying(curr_song_id, std::move(song_list))) {
+    cb.Run(curr_song_id, song_list);
+    return;
+  }
+  cb.Run(browse_cache_.now_playing_song_id(), browse_cache_.now_playing_list());
+}
+
 void Device::HandleSetBrowsedPlayer(
     uint8_t label, std::shared_ptr<SetBrowsedPlayerRequest> pkt) {
   if (!pkt->IsValid()) {
@@ -1338,6 +1397,7 @@ void Device::SetBrowsedPlayerResponse(
   }
 
   curr_browsed_player_id_ = pkt->GetPlayerId();
+  browse_cache_.InvalidateFolder();
 
   // Clear the path and push the new root.
   current_path_ = std::stack<std::string>();
@@ -1356,6 +1416,10 @@ void Device::SendMediaUpdate(bool metadata, bool play_status, bool queue) {
                  << " : play_status= " << play_status << " : queue=" << queue
                  << " ; is_silence=" << is_silence;
 
+  if (metadata || queue) {
+    browse_cache_.InvalidateNowPlaying();
+  }
+
   if (queue) {
     HandleNowPlayingUpdate();
   }
@@ -1375,6 +1439,11 @@ void Device::SendFolderUpdate(bool available_players, bool addressed_player,
   CHECK(media_interface_);
   DEVICE_VLOG(4) << __func__;
 
+  if (available_players || addressed_player || uids) {
+    browse_cache_.InvalidateFolder();
+    browse_cache_.InvalidateNowPlaying();
+  }
+
   if (available_players) {
     HandleAvailablePlayerUpdate();
   }
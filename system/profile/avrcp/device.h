@@ -38,6 +38,7 @@
 #include "packet/avrcp/set_addressed_player.h"
 #include "packet/avrcp/set_browsed_player.h"
 #include "packet/avrcp/vendor_packet.h"
+#include "profile/avrcp/browse_cache.h"
 #include "profile/avrcp/media_id_map.h"
 #include "raw_address.h"
 
@@ -210,30 +211,32 @@ class Device {
       uint16_t curr_player, std::vector<MediaPlayerInfo> players);
   virtual void GetVFSListResponse(uint8_t label,
                                   std::shared_ptr<GetFolderItemsRequest> pkt,
-                                  std::vector<ListItem> items);
+                                  const std::vector<ListItem>& items);
   virtual void GetNowPlayingListResponse(
       uint8_t label, std::shared_ptr<GetFolderItemsRequest> pkt,
-      std::string curr_song_id, std::vector<SongInfo> song_list);
+      const std::string& curr_song_id, const std::vector<SongInfo>& song_list);
 
   // GET TOTAL NUMBER OF ITEMS
   virtual void HandleGetTotalNumberOfItems(
       uint8_t label, std::shared_ptr<GetTotalNumberOfItemsRequest> pkt);
   virtual void GetTotalNumberOfItemsMediaPlayersResponse(
       uint8_t label, uint16_t curr_player, std::vector<MediaPlayerInfo> list);
-  virtual void GetTotalNumberOfItemsVFSResponse(uint8_t label,
-                                                std::vector<ListItem> items);
+  virtual void GetTotalNumberOfItemsVFSResponse(
+      uint8_t label, const std::vector<ListItem>& items);
   virtual void GetTotalNumberOfItemsNowPlayingResponse(
-      uint8_t label, std::string curr_song_id, std::vector<SongInfo> song_list);
+      uint8_t label, const std::string& curr_song_id,
+      const std::vector<SongInfo>& song_list);
 
   // GET ITEM ATTRIBUTES
   virtual void HandleGetItemAttributes(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> request);
   virtual void GetItemAttributesNowPlayingResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::string curr_media_id, std::vector<SongInfo> song_list);
+      const std::string& curr_media_id,
+      const std::vector<SongInfo>& song_list);
   virtual void GetItemAttributesVFSResponse(
       uint8_t label, std::shared_ptr<GetItemAttributesRequest> pkt,
-      std::vector<ListItem> item_list);
+      const std::vector<ListItem>& item_list);
 
   // SET BROWSED PLAYER
   virtual void HandleSetBrowsedPlayer(
@@ -247,7 +250,7 @@ class Device {
                                 std::shared_ptr<ChangePathRequest> request);
   virtual void ChangePathResponse(uint8_t label,
                                   std::shared_ptr<ChangePathRequest> request,
-                                  std::vector<ListItem> list);
+                                  const std::vector<ListItem>& list);
 
   // PLAY ITEM
   virtual void HandlePlayItem(uint8_t label,
@@ -291,6 +294,25 @@ class Device {
     return current_path_.top();
   }
 
+  using FolderItemsCallback =
+      base::Callback<void(const std::vector<ListItem>&)>;
+  using NowPlayingCallback = base::Callback<void(
+      const std::string& curr_song_id, const std::vector<SongInfo>&)>;
+
+  // Runs |cb| with the listing of the current folder, fetching it from the
+  // media interface only when it is not cached.
+  void GetCurrentFolderItems(FolderItemsCallback cb);
+  void FolderItemsFetched(uint32_t generation, int player_id,
+                          std::string folder_id, FolderItemsCallback cb,
+                          std::vector<ListItem> items);
+
+  // Runs |cb| with the now playing list, fetching it from the media interface
+  // only when it is not cached.
+  void GetNowPlayingItems(NowPlayingCallback cb);
+  void NowPlayingItemsFetched(uint32_t generation, NowPlayingCallback cb,
+                              std::string curr_song_id,
+                              std::vector<SongInfo> song_list);
+
   void send_message(uint8_t label, bool browse,
                     std::unique_ptr<::bluetooth::PacketBuilder> message) {
     active_labels_.erase(label);
@@ -327,6 +349,7 @@ class Device {
 
   MediaIdMap vfs_ids_;
   MediaIdMap now_playing_ids_;
+  BrowseCache browse_cache_;
 
   uint32_t play_pos_interval_ = 0;
 
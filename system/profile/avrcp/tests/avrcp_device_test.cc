@@ -925,6 +925,110 @@ TEST_F(AvrcpDeviceTest, getVFSFolderTest) {
   SendBrowseMessage(1, request);
 }
 
+TEST_F(AvrcpDeviceTest, getVFSFolderPagesFetchOnceTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  std::vector<ListItem> list;
+  for (int i = 0; i < 4; i++) {
+    FolderInfo info = {"test_id" + std::to_string(i), true,
+                       "Test Folder" + std::to_string(i)};
+    list.push_back({ListItem::FOLDER, info, SongInfo()});
+  }
+
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(1)
+      .WillOnce(InvokeCb<2>(list));
+
+  // Page through the folder two items at a time
+  for (uint32_t start = 0; start < list.size(); start += 2) {
+    auto expected_response = GetFolderItemsResponseBuilder::MakeVFSBuilder(
+        Status::NO_ERROR, 0x0000, 0xFFFF);
+    expected_response->AddFolder(FolderItem(
+        start + 1, 0, true, "Test Folder" + std::to_string(start)));
+    expected_response->AddFolder(FolderItem(
+        start + 2, 0, true, "Test Folder" + std::to_string(start + 1)));
+    EXPECT_CALL(response_cb,
+                Call(1, true, matchPacket(std::move(expected_response))))
+        .Times(1);
+
+    auto request_builder = GetFolderItemsRequestBuilder::MakeBuilder(
+        Scope::VFS, start, start + 1, {});
+    auto request = TestBrowsePacket::Make();
+    request_builder->Serialize(request);
+    SendBrowseMessage(1, request);
+  }
+
+  // The number of items comes from the cached listing too
+  auto total_response = GetTotalNumberOfItemsResponseBuilder::MakeBuilder(
+      Status::NO_ERROR, 0x0000, list.size());
+  EXPECT_CALL(response_cb,
+              Call(2, true, matchPacket(std::move(total_response))))
+      .Times(1);
+  SendBrowseMessage(
+      2, TestBrowsePacket::Make(get_total_number_of_items_request_vfs));
+}
+
+TEST_F(AvrcpDeviceTest, browseCacheSkipsOversizedListingTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  FolderInfo info = {"test_id", true,
+                     std::string(BrowseCache::kMaxBytes, 'a')};
+  ListItem item = {ListItem::FOLDER, info, SongInfo()};
+  std::vector<ListItem> list = {item};
+
+  // The listing is over the cache budget, so every page fetches it again
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<2>(list));
+  EXPECT_CALL(response_cb, Call(_, true, _)).Times(2);
+
+  auto request = TestBrowsePacket::Make(get_folder_items_request_vfs);
+  SendBrowseMessage(1, request);
+  SendBrowseMessage(2, request);
+}
+
+TEST_F(AvrcpDeviceTest, uidsChangedInvalidatesBrowseCacheTest) {
+  MockMediaInterface interface;
+  NiceMock<MockA2dpInterface> a2dp_interface;
+
+  test_device->RegisterInterfaces(&interface, &a2dp_interface, nullptr);
+
+  FolderInfo info = {"test_id", true, "Test Folder"};
+  ListItem item = {ListItem::FOLDER, info, SongInfo()};
+  std::vector<ListItem> list = {item};
+  SongInfo song = {"test_song",
+                   {AttributeEntry(Attribute::TITLE, "Test Song")}};
+  std::vector<SongInfo> song_list = {song};
+
+  EXPECT_CALL(interface, GetFolderItems(_, "", _))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<2>(list));
+  EXPECT_CALL(interface, GetNowPlayingList(_))
+      .Times(2)
+      .WillRepeatedly(InvokeCb<0>("test_song", song_list));
+  EXPECT_CALL(response_cb, Call(_, true, _)).Times(6);
+
+  auto vfs_request = TestBrowsePacket::Make(get_folder_items_request_vfs);
+  auto now_playing_request =
+      TestBrowsePacket::Make(get_folder_items_request_now_playing);
+
+  SendBrowseMessage(1, vfs_request);
+  SendBrowseMessage(2, now_playing_request);
+  SendBrowseMessage(3, vfs_request);
+  SendBrowseMessage(4, now_playing_request);
+
+  // Both listings are fetched again after the media layer changed the UIDs
+  test_device->SendFolderUpdate(false, false, true);
+  SendBrowseMessage(5, vfs_request);
+  SendBrowseMessage(6, now_playing_request);
+}
+
 TEST_F(AvrcpDeviceTest, getFolderItemsMtuTest) {
   auto truncated_packet = GetFolderItemsResponseBuilder::MakeVFSBuilder(
       Status::NO_ERROR, 0x0000, 0xFFFF);
@@ -987,8 +1091,9 @@ TEST_F(AvrcpDeviceTest, changePathTest) {
   ListItem item3 = {ListItem::FOLDER, info3, SongInfo()};
   ListItem item4 = {ListItem::FOLDER, info4, SongInfo()};
   std::vector<ListItem> list1 = {item2, item3, item4};
+  // Listing Test Folder1 after changing into it is served from the cache
   EXPECT_CALL(interface, GetFolderItems(_, "test_id1", _))
-      .Times(3)
+      .Times(2)
       .WillRepeatedly(InvokeCb<2>(list1));
 
   std::vector<ListItem> list2 = {};
@@ -383,7 +383,7 @@ static void a2dp_opus_encode_frames(uint8_t nb_frame) {
 
   uint32_t bytes_read = 0;
   while (nb_frame) {
-    BT_HDR* p_buf = (BT_HDR*)osi_malloc(BT_DEFAULT_BUFFER_SIZE);
+    BT_HDR* p_buf = (BT_HDR*)osi_pool_malloc(BT_DEFAULT_BUFFER_SIZE);
     p_buf->offset = A2DP_OPUS_OFFSET;
     p_buf->len = 0;
     p_buf->layer_specific = 0;
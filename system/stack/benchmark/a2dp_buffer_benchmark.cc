@@ -0,0 +1,97 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include <deque>
+
+#include "internal_include/bt_target.h"
+#include "osi/include/allocation_tracker.h"
+#include "osi/include/allocator.h"
+#include "osi/include/buffer_pool.h"
+#include "stack/include/bt_hdr.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace {
+
+// SBC high quality (328 kbit/s) sent on the 20 ms media timer tick
+constexpr int kMediaPacketsPerSecond = 50;
+constexpr uint16_t kMediaPayloadSize = 820;
+// Media packets waiting in the AVDTP and L2CAP queues
+constexpr size_t kPacketsInFlight = 4;
+// Number Of Completed Packets event handed to the stack for every packet
+constexpr size_t kCompletedPacketsEventSize = sizeof(BT_HDR) + 7;
+
+size_t pool_allocated() {
+  size_t allocated = 0;
+  for (size_t i = 0; i < BUFFER_POOL_NUM_CLASSES; i++) {
+    buffer_pool_stats_t stats;
+    buffer_pool_get_stats(i, &stats);
+    allocated += stats.allocated;
+  }
+  return allocated;
+}
+
+// Every iteration streams one second of A2DP audio: the encoder allocates a
+// BT_DEFAULT_BUFFER_SIZE media packet per tick, and the completion of each
+// packet is reported through a small HCI event buffer. The "mallocs"
+// counter is the number of those buffers not served by the buffer pool.
+template <void* (*alloc)(size_t)>
+void BM_A2dpStreamingSecond(State& state) {
+  // The tracker is enabled in the stack, so include its cost
+  allocation_tracker_init();
+
+  std::deque<BT_HDR*> in_flight;
+  size_t requests = 0;
+  size_t pooled_before = pool_allocated();
+
+  for (auto _ : state) {
+    for (int i = 0; i < kMediaPacketsPerSecond; i++) {
+      BT_HDR* p_buf = (BT_HDR*)alloc(BT_DEFAULT_BUFFER_SIZE);
+      p_buf->offset = 0;
+      p_buf->len = kMediaPayloadSize;
+      memset(p_buf->data, 0, kMediaPayloadSize);
+      in_flight.push_back(p_buf);
+      requests++;
+
+      if (in_flight.size() > kPacketsInFlight) {
+        BT_HDR* p_event = (BT_HDR*)alloc(kCompletedPacketsEventSize);
+        benchmark::DoNotOptimize(p_event);
+        requests++;
+        osi_free(p_event);
+        osi_free(in_flight.front());
+        in_flight.pop_front();
+      }
+    }
+  }
+
+  size_t mallocs = requests - (pool_allocated() - pooled_before);
+  state.counters["mallocs"] = Counter(mallocs, Counter::kAvgIterations);
+
+  while (!in_flight.empty()) {
+    osi_free(in_flight.front());
+    in_flight.pop_front();
+  }
+}
+BENCHMARK_TEMPLATE(BM_A2dpStreamingSecond, osi_malloc);
+BENCHMARK_TEMPLATE(BM_A2dpStreamingSecond, osi_pool_malloc);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "internal_include/bt_trace.h"
+#include "osi/include/allocator.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/btm_api.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/inq_hci_link_interface.h"
+#include "types/raw_address.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+tBTM_CB btm_cb;
+
+// Global trace level referred in the code under test
+uint8_t appl_trace_level = BT_TRACE_LEVEL_NONE;
+
+extern "C" void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+uint64_t g_reported = 0;
+
+void inq_results_cb(tBTM_INQ_RESULTS* p_inq_results, const uint8_t* p_eir,
+                    uint16_t eir_len) {
+  g_reported++;
+}
+
+RawAddress DeviceAddress(int device) {
+  return RawAddress({0xC0, 0x00, 0x00, (uint8_t)(device >> 16),
+                     (uint8_t)(device >> 8), (uint8_t)device});
+}
+
+// Extended Inquiry Result event parameters of a beacon advertising its name
+std::vector<uint8_t> MakeExtendedInquiryResult(int device) {
+  std::vector<uint8_t> event(1 + 14 + HCI_EXT_INQ_RESPONSE_LEN);
+  uint8_t* p = event.data();
+  UINT8_TO_STREAM(p, 1);
+  BDADDR_TO_STREAM(p, DeviceAddress(device));
+  p += 1 + 1 + DEV_CLASS_LEN + 2;
+  UINT8_TO_STREAM(p, 0xC0);
+  const uint8_t name[] = {0x07, 0x09, 'B', 'e', 'a', 'c', 'o', 'n'};
+  ARRAY_TO_STREAM(p, name, (int)sizeof(name));
+  return event;
+}
+
+void StartInquiry() {
+  tBTM_INQUIRY_VAR_ST* p_inq = &btm_cb.btm_inq_vars;
+  BTM_ClearInqDb(nullptr);
+  osi_free(p_inq->p_bd_db);
+  p_inq->p_bd_db = (tINQ_BDADDR*)osi_calloc(BT_DEFAULT_BUFFER_SIZE);
+  p_inq->max_bd_entries =
+      (uint16_t)(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR));
+  p_inq->num_bd_entries = 0;
+  p_inq->inq_counter++;
+  p_inq->inq_active = BTM_GENERAL_INQUIRY_ACTIVE;
+  p_inq->p_inq_results_cb = inq_results_cb;
+}
+
+void StopInquiry() {
+  tBTM_INQUIRY_VAR_ST* p_inq = &btm_cb.btm_inq_vars;
+  p_inq->inq_active = BTM_INQUIRY_INACTIVE;
+  osi_free_and_reset((void**)&p_inq->p_bd_db);
+  BTM_ClearInqDb(nullptr);
+}
+
+// A swarm of |range(0)| beacons answering the inquiry in turn, always with the
+// same EIR. Every iteration processes one result; the "reported" counter is
+// the share of results handed to the inquiry results callback.
+void BM_InquirySwarm(State& state) {
+  int num_devices = state.range(0);
+  std::vector<std::vector<uint8_t>> events;
+  for (int i = 0; i < num_devices; i++) {
+    events.push_back(MakeExtendedInquiryResult(i));
+  }
+
+  StartInquiry();
+  g_reported = 0;
+  size_t next = 0;
+  for (auto _ : state) {
+    const std::vector<uint8_t>& event = events[next % num_devices];
+    btm_process_inq_results(event.data(), (uint8_t)event.size(),
+                            BTM_INQ_RESULT_EXTENDED);
+    next++;
+  }
+  state.SetItemsProcessed(state.iterations());
+  state.counters["reported"] = Counter(g_reported, Counter::kAvgIterations);
+  StopInquiry();
+}
+BENCHMARK(BM_InquirySwarm)->Arg(BTM_INQ_DB_SIZE)->Arg(1000)->Arg(4000);
+
+// Lookup of a device that answered the inquiry, as done by the consumers of
+// the inquiry database, with the database full.
+void BM_InqDbRead(State& state) {
+  StartInquiry();
+  for (int i = 0; i < BTM_INQ_DB_SIZE; i++) {
+    std::vector<uint8_t> event = MakeExtendedInquiryResult(i);
+    btm_process_inq_results(event.data(), (uint8_t)event.size(),
+                            BTM_INQ_RESULT_EXTENDED);
+  }
+  RawAddress last = DeviceAddress(BTM_INQ_DB_SIZE - 1);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(BTM_InqDbRead(last));
+  }
+  state.SetItemsProcessed(state.iterations());
+  StopInquiry();
+}
+BENCHMARK(BM_InqDbRead);
+
+}  // namespace
+
+BENCHMARK_MAIN();
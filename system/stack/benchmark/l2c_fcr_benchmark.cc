@@ -0,0 +1,288 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include "internal_include/bt_trace.h"
+#include "osi/include/allocator.h"
+#include "osi/include/fixed_queue.h"
+#include "osi/include/list.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/include/avct_api.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/hcidefs.h"
+#include "stack/include/l2c_api.h"
+#include "stack/include/l2cdefs.h"
+#include "stack/l2cap/l2c_int.h"
+#include "test/mock/mock_device_controller.h"
+
+using ::benchmark::State;
+
+tBTM_CB btm_cb;
+extern tL2C_CB l2cb;
+
+// Global trace level referred in the code under test
+uint8_t appl_trace_level = BT_TRACE_LEVEL_NONE;
+
+extern "C" void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+constexpr uint16_t kLeMps = 251;
+constexpr uint8_t kErtmTxWindow = 10;
+constexpr uint8_t kErtmMaxTransmit = 20;
+constexpr uint16_t kAclDataSize = 1021;
+
+uint64_t g_delivered = 0;
+tL2C_RCB g_rcb;
+
+void data_ind_cb(uint16_t cid, BT_HDR* p_buf) {
+  g_delivered++;
+  osi_free(p_buf);
+}
+
+std::vector<BT_HDR*> MakeWindow(int window) {
+  std::vector<BT_HDR*> bufs;
+  for (int i = 0; i < window; i++)
+    bufs.push_back((BT_HDR*)osi_calloc(sizeof(BT_HDR)));
+  return bufs;
+}
+
+void FreeWindow(std::vector<BT_HDR*>& bufs) {
+  for (BT_HDR* p_buf : bufs) osi_free(p_buf);
+}
+
+// Baseline: a full eRTM transmit window pushed through a fixed_queue_t and
+// acknowledged, as waiting_for_ack_q used to be.
+void BM_FixedQueueErtmWindow(State& state) {
+  std::vector<BT_HDR*> bufs = MakeWindow(state.range(0));
+  fixed_queue_t* queue = fixed_queue_new(SIZE_MAX);
+
+  for (auto _ : state) {
+    for (BT_HDR* p_buf : bufs) fixed_queue_enqueue(queue, p_buf);
+    while (!fixed_queue_is_empty(queue))
+      benchmark::DoNotOptimize(fixed_queue_try_dequeue(queue));
+  }
+  state.SetItemsProcessed(state.iterations() * bufs.size());
+
+  fixed_queue_free(queue, NULL);
+  FreeWindow(bufs);
+}
+BENCHMARK(BM_FixedQueueErtmWindow)->Arg(8)->Arg(L2CAP_FCR_SEQ_MODULO);
+
+void BM_FcrBufQErtmWindow(State& state) {
+  std::vector<BT_HDR*> bufs = MakeWindow(state.range(0));
+  tL2C_FCR_BUF_Q q = {};
+
+  for (auto _ : state) {
+    for (BT_HDR* p_buf : bufs) l2c_fcr_buf_q_enqueue(&q, p_buf);
+    while (q.count != 0) benchmark::DoNotOptimize(l2c_fcr_buf_q_dequeue(&q));
+  }
+  state.SetItemsProcessed(state.iterations() * bufs.size());
+
+  l2c_fcr_buf_q_free(&q);
+  FreeWindow(bufs);
+}
+BENCHMARK(BM_FcrBufQErtmWindow)->Arg(8)->Arg(L2CAP_FCR_SEQ_MODULO);
+
+tL2C_CCB* SetUpLeCocChannel() {
+  l2cb = {};
+  g_rcb = {};
+  g_rcb.api.pL2CA_DataInd_Cb = data_ind_cb;
+
+  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  p_lcb->in_use = true;
+  p_lcb->link_state = LST_CONNECTED;
+  p_lcb->transport = BT_TRANSPORT_LE;
+
+  tL2C_CCB* p_ccb = &l2cb.ccb_pool[0];
+  p_ccb->in_use = true;
+  p_ccb->p_lcb = p_lcb;
+  p_ccb->p_rcb = &g_rcb;
+  p_ccb->local_cid = L2CAP_BASE_APPL_CID;
+  p_ccb->chnl_state = CST_OPEN;
+  p_ccb->is_first_seg = true;
+  p_ccb->local_conn_cfg.mps = kLeMps;
+  p_ccb->local_conn_cfg.mtu = L2CAP_SDU_LENGTH_LE_MAX;
+  return p_ccb;
+}
+
+// Two BR/EDR eRTM channels with FCS on one link, connected to each other.
+// Nothing reaches a controller: the window of the controller is closed, so
+// the S-frames sent by the stack stay in the link queue, where the benchmark
+// picks them up and hands them to the peer channel.
+struct ErtmLoopback {
+  tL2C_CCB* p_tx_ccb;
+  tL2C_CCB* p_rx_ccb;
+};
+
+void SetUpErtmCcb(tL2C_CCB* p_ccb, tL2C_LCB* p_lcb, uint16_t local_cid,
+                  uint16_t remote_cid) {
+  p_ccb->in_use = true;
+  p_ccb->p_lcb = p_lcb;
+  p_ccb->p_rcb = &g_rcb;
+  p_ccb->local_cid = local_cid;
+  p_ccb->remote_cid = remote_cid;
+  p_ccb->chnl_state = CST_OPEN;
+  p_ccb->max_rx_mtu = L2CAP_SDU_LENGTH_MAX;
+  p_ccb->tx_mps = L2CAP_MPS_OVER_BR_EDR;
+  p_ccb->our_cfg.fcr.mode = L2CAP_FCR_ERTM_MODE;
+  p_ccb->our_cfg.fcr.tx_win_sz = kErtmTxWindow;
+  p_ccb->our_cfg.fcr.rtrans_tout = L2CAP_MIN_RETRANS_TOUT;
+  p_ccb->our_cfg.fcr.mon_tout = L2CAP_MIN_MONITOR_TOUT;
+  p_ccb->peer_cfg.fcr = p_ccb->our_cfg.fcr;
+  p_ccb->peer_cfg.fcr.max_transmit = kErtmMaxTransmit;
+  /* Every I-frame is acked by an RR rather than by the ack timer */
+  p_ccb->fcrb.max_held_acks = 0;
+  p_ccb->fcrb.mon_retrans_timer = alarm_new("l2c_fcrb.mon_retrans_timer");
+  p_ccb->fcrb.ack_timer = alarm_new("l2c_fcrb.ack_timer");
+  p_ccb->xmit_hold_q = fixed_queue_new(SIZE_MAX);
+}
+
+ErtmLoopback SetUpErtmLoopback() {
+  l2cb = {};
+  g_rcb = {};
+  g_rcb.api.pL2CA_DataInd_Cb = data_ind_cb;
+  test::mock::device_controller::acl_data_size_classic = kAclDataSize;
+
+  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  p_lcb->in_use = true;
+  p_lcb->link_state = LST_CONNECTED;
+  p_lcb->transport = BT_TRANSPORT_BR_EDR;
+  p_lcb->link_xmit_data_q = list_new(NULL);
+
+  ErtmLoopback loopback = {&l2cb.ccb_pool[0], &l2cb.ccb_pool[1]};
+  SetUpErtmCcb(loopback.p_tx_ccb, p_lcb, L2CAP_BASE_APPL_CID,
+               L2CAP_BASE_APPL_CID + 1);
+  SetUpErtmCcb(loopback.p_rx_ccb, p_lcb, L2CAP_BASE_APPL_CID + 1,
+               L2CAP_BASE_APPL_CID);
+  return loopback;
+}
+
+void TearDownErtmLoopback(ErtmLoopback& loopback) {
+  for (tL2C_CCB* p_ccb : {loopback.p_tx_ccb, loopback.p_rx_ccb}) {
+    l2c_fcr_cleanup(p_ccb);
+    fixed_queue_free(p_ccb->xmit_hold_q, osi_free);
+  }
+  list_free(l2cb.lcb_pool[0].link_xmit_data_q);
+  l2cb = {};
+}
+
+// Hands a frame starting with the basic L2CAP header to the channel it is
+// addressed to.
+void DeliverFrame(ErtmLoopback& loopback, BT_HDR* p_buf) {
+  uint8_t* p = (uint8_t*)(p_buf + 1) + p_buf->offset + sizeof(uint16_t);
+  uint16_t cid;
+  STREAM_TO_UINT16(cid, p);
+  p_buf->offset += L2CAP_PKT_OVERHEAD;
+  p_buf->len -= L2CAP_PKT_OVERHEAD;
+  l2c_fcr_proc_pdu(cid == loopback.p_tx_ccb->local_cid ? loopback.p_tx_ccb
+                                                       : loopback.p_rx_ccb,
+                   p_buf);
+}
+
+// Hands the frames queued for the controller, with their HCI ACL header, to
+// their channel.
+void DeliverLinkQueue(ErtmLoopback& loopback) {
+  list_t* p_queue = l2cb.lcb_pool[0].link_xmit_data_q;
+  while (!list_is_empty(p_queue)) {
+    BT_HDR* p_buf = (BT_HDR*)list_front(p_queue);
+    list_remove(p_queue, p_buf);
+    p_buf->offset += HCI_DATA_PREAMBLE_SIZE;
+    p_buf->len -= HCI_DATA_PREAMBLE_SIZE;
+    DeliverFrame(loopback, p_buf);
+  }
+}
+
+// SDU as an L2CA_DataWrite client hands it over, with room for the headers
+// and the FCS.
+BT_HDR* MakeSdu(uint16_t sdu_len) {
+  BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET +
+                                      sdu_len + L2CAP_FCS_LEN);
+  p_buf->offset = L2CAP_MIN_OFFSET;
+  p_buf->len = sdu_len;
+  return p_buf;
+}
+
+// eRTM transfer of SDUs of state.range(0) octets from one channel to the
+// other: segmentation, FCS, reassembly, delivery and the RR acking every
+// I-frame. The sizes are those of AVRCP browsing, HID and OBEX.
+void BM_ErtmLoopback(State& state) {
+  uint16_t sdu_len = state.range(0);
+  ErtmLoopback loopback = SetUpErtmLoopback();
+
+  g_delivered = 0;
+  for (auto _ : state) {
+    fixed_queue_enqueue(loopback.p_tx_ccb->xmit_hold_q, MakeSdu(sdu_len));
+    while (!fixed_queue_is_empty(loopback.p_tx_ccb->xmit_hold_q)) {
+      BT_HDR* p_buf = l2c_fcr_get_next_xmit_sdu_seg(loopback.p_tx_ccb, 0);
+      CHECK(p_buf != NULL);
+      DeliverFrame(loopback, p_buf);
+      DeliverLinkQueue(loopback);
+    }
+  }
+  CHECK_EQ(g_delivered, (uint64_t)state.iterations());
+  CHECK_EQ(loopback.p_tx_ccb->fcrb.waiting_for_ack_q.count, 0);
+  state.SetBytesProcessed(state.iterations() * sdu_len);
+
+  TearDownErtmLoopback(loopback);
+}
+BENCHMARK(BM_ErtmLoopback)
+    ->Arg(AVCT_MIN_BROWSE_MTU)
+    ->Arg(HID_HOST_MTU)
+    ->Arg(L2CAP_SDU_LENGTH_MAX);
+
+// K-frame payload as l2c_rcv_acl_data hands it over, with the SDU length
+// prepended to the first frame of each SDU.
+BT_HDR* MakeKFrame(uint16_t payload_len, uint16_t sdu_len) {
+  uint16_t len = payload_len + (sdu_len ? sizeof(uint16_t) : 0);
+  BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + L2CAP_MIN_OFFSET + len);
+  p_buf->offset = L2CAP_MIN_OFFSET;
+  p_buf->len = len;
+  if (sdu_len) {
+    uint8_t* p = (uint8_t*)(p_buf + 1) + p_buf->offset;
+    UINT16_TO_STREAM(p, sdu_len);
+  }
+  return p_buf;
+}
+
+// LE CoC receive of SDUs spanning state.range(0) K-frames of maximum size. A
+// single K-frame SDU is delivered without copying.
+void BM_LccProcPdu(State& state) {
+  int num_frames = state.range(0);
+  uint16_t first_len = kLeMps - sizeof(uint16_t);
+  uint16_t sdu_len = first_len + (num_frames - 1) * kLeMps;
+  tL2C_CCB* p_ccb = SetUpLeCocChannel();
+
+  g_delivered = 0;
+  for (auto _ : state) {
+    l2c_lcc_proc_pdu(p_ccb, MakeKFrame(first_len, sdu_len));
+    for (int i = 1; i < num_frames; i++)
+      l2c_lcc_proc_pdu(p_ccb, MakeKFrame(kLeMps, 0));
+  }
+  CHECK_EQ(g_delivered, (uint64_t)state.iterations());
+  state.SetBytesProcessed(state.iterations() * sdu_len);
+
+  l2cb = {};
+}
+BENCHMARK(BM_LccProcPdu)->Arg(1)->Arg(4);
+
+}  // namespace
+
+BENCHMARK_MAIN();
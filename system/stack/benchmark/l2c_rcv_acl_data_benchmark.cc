@@ -0,0 +1,130 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <base/logging.h>
+#include <benchmark/benchmark.h>
+
+#include "internal_include/bt_trace.h"
+#include "osi/include/allocator.h"
+#include "stack/btm/btm_int_types.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/l2c_api.h"
+#include "stack/include/l2cdefs.h"
+#include "stack/l2cap/l2c_int.h"
+
+using ::benchmark::State;
+
+tBTM_CB btm_cb;
+extern tL2C_CB l2cb;
+
+// Global trace level referred in the code under test
+uint8_t appl_trace_level = BT_TRACE_LEVEL_NONE;
+
+extern "C" void LogMsg(uint32_t trace_set_mask, const char* fmt_str, ...) {}
+
+namespace {
+
+constexpr uint16_t kPayloadSize = 64;
+
+uint64_t g_delivered = 0;
+
+void fixed_data_cb(uint16_t cid, const RawAddress& bd_addr, BT_HDR* p_buf) {
+  g_delivered++;
+}
+
+// Brings up |num_links| connected BR/EDR links with the ATT fixed channel
+// open and spreads every remaining CCB across them as open dynamic channels.
+void SetUpLinks(int num_links) {
+  l2cb = {};
+  l2cb.fixed_reg[L2CAP_ATT_CID - L2CAP_FIRST_FIXED_CHNL].pL2CA_FixedData_Cb =
+      fixed_data_cb;
+
+  for (int i = 0; i < num_links; i++) {
+    tL2C_LCB* p_lcb = &l2cb.lcb_pool[i];
+    p_lcb->in_use = true;
+    p_lcb->link_state = LST_CONNECTED;
+    p_lcb->transport = BT_TRANSPORT_BR_EDR;
+    l2cu_set_lcb_handle(*p_lcb, i + 1);
+
+    tL2C_CCB* p_ccb = &l2cb.ccb_pool[i];
+    p_ccb->in_use = true;
+    p_ccb->p_lcb = p_lcb;
+    p_ccb->local_cid = L2CAP_ATT_CID;
+    p_ccb->chnl_state = CST_OPEN;
+    p_lcb->p_fixed_ccbs[L2CAP_ATT_CID - L2CAP_FIRST_FIXED_CHNL] = p_ccb;
+  }
+
+  for (int i = num_links; i < MAX_L2CAP_CHANNELS; i++) {
+    tL2C_CCB* p_ccb = &l2cb.ccb_pool[i];
+    p_ccb->in_use = true;
+    p_ccb->p_lcb = &l2cb.lcb_pool[i % num_links];
+    p_ccb->local_cid = L2CAP_BASE_APPL_CID + i;
+    p_ccb->chnl_state = CST_OPEN;
+    l2cu_set_ccb_remote_cid(p_ccb, L2CAP_BASE_APPL_CID + i);
+  }
+}
+
+BT_HDR* MakeAclPacket(uint16_t handle, uint16_t cid) {
+  BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR) + 8 + kPayloadSize);
+  uint8_t* p = (uint8_t*)(p_buf + 1);
+  UINT16_TO_STREAM(p, handle | (L2CAP_PKT_START << L2CAP_PKT_TYPE_SHIFT));
+  UINT16_TO_STREAM(p, L2CAP_PKT_OVERHEAD + kPayloadSize);
+  UINT16_TO_STREAM(p, kPayloadSize);
+  UINT16_TO_STREAM(p, cid);
+  return p_buf;
+}
+
+// Inbound ACL dispatch on the most recently connected link, the worst case
+// for a lookup that scans the LCB pool.
+void BM_L2cRcvAclDataFixedChannel(State& state) {
+  int num_links = state.range(0);
+  SetUpLinks(num_links);
+  BT_HDR* p_buf = MakeAclPacket(num_links, L2CAP_ATT_CID);
+
+  g_delivered = 0;
+  for (auto _ : state) {
+    p_buf->offset = 0;
+    p_buf->len = 8 + kPayloadSize;
+    l2c_rcv_acl_data(p_buf);
+  }
+  CHECK_EQ(g_delivered, (uint64_t)state.iterations());
+  state.SetItemsProcessed(state.iterations());
+
+  osi_free(p_buf);
+  l2cb = {};
+}
+BENCHMARK(BM_L2cRcvAclDataFixedChannel)->RangeMultiplier(2)->Range(
+    1, MAX_L2CAP_LINKS);
+
+// Signalling path lookup of a channel by the CID the peer assigned to it.
+void BM_L2cuFindCcbByRemoteCid(State& state) {
+  int num_links = state.range(0);
+  SetUpLinks(num_links);
+  tL2C_CCB* p_ccb = &l2cb.ccb_pool[MAX_L2CAP_CHANNELS - 1];
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        l2cu_find_ccb_by_remote_cid(p_ccb->p_lcb, p_ccb->remote_cid));
+  }
+  state.SetItemsProcessed(state.iterations());
+  l2cb = {};
+}
+BENCHMARK(BM_L2cuFindCcbByRemoteCid)->RangeMultiplier(2)->Range(
+    1, MAX_L2CAP_LINKS);
+
+}  // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <string.h>
+
+#include "stack/smp/p_256_ecc_pp.h"
+
+using ::benchmark::State;
+
+namespace {
+
+// Private key A from Core Specification Vol 2, Part G, 7.1.2 Sample 1
+const uint32_t kPrivateKey[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b,
+    0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+
+class P256EccBenchmark : public ::benchmark::Fixture {
+ public:
+  void SetUp(State& st) override {
+    ::benchmark::Fixture::SetUp(st);
+    p_256_init_curve();
+    // Any valid point works as a peer key, use 2G
+    uint32_t two[KEY_LENGTH_DWORDS_P256] = {2};
+    ECC_PointMultBase(&peer_key_, two);
+  }
+
+ protected:
+  Point peer_key_;
+};
+
+BENCHMARK_F(P256EccBenchmark, keygen_bin_naf)(State& state) {
+  for (auto _ : state) {
+    uint32_t private_key[KEY_LENGTH_DWORDS_P256];
+    Point base = curve_p256.G;
+    Point public_key;
+    memcpy(private_key, kPrivateKey, sizeof(private_key));
+    ECC_PointMult_Bin_NAF(&public_key, &base, private_key);
+    benchmark::DoNotOptimize(public_key);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_F(P256EccBenchmark, keygen_mont_comb)(State& state) {
+  for (auto _ : state) {
+    Point public_key;
+    ECC_PointMultBase(&public_key, kPrivateKey);
+    benchmark::DoNotOptimize(public_key);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_F(P256EccBenchmark, dhkey_bin_naf)(State& state) {
+  for (auto _ : state) {
+    uint32_t private_key[KEY_LENGTH_DWORDS_P256];
+    Point peer_key = peer_key_;
+    Point dhkey;
+    memcpy(private_key, kPrivateKey, sizeof(private_key));
+    ECC_PointMult_Bin_NAF(&dhkey, &peer_key, private_key);
+    benchmark::DoNotOptimize(dhkey);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+BENCHMARK_F(P256EccBenchmark, dhkey_mont_window)(State& state) {
+  for (auto _ : state) {
+    Point dhkey;
+    ECC_PointMult_Mont(&dhkey, &peer_key_, kPrivateKey);
+    benchmark::DoNotOptimize(dhkey);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK_MAIN();
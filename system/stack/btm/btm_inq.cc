@@ -32,7 +32,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <algorithm>
+#include <string_view>
+#include <vector>
+
 #include "advertise_data_parser.h"
+#include "common/lru.h"
 #include "common/time_util.h"
 #include "device/include/controller.h"
 #include "main/shim/btm_api.h"
@@ -86,6 +91,13 @@ using bluetooth::Uuid;
 static const LAP general_inq_lap = {0x9e, 0x8b, 0x33};
 static const LAP limited_inq_lap = {0x9e, 0x8b, 0x00};
 
+/* Slot in |inq_db| of every in-use entry by address, most recently heard
+ * first. Lookups leave the order alone, only a response from the device moves
+ * it to the front (btm_inq_db_heard). Entries released directly through
+ * |in_use| are dropped lazily. */
+static bluetooth::common::LegacyLruCache<RawAddress, uint16_t> inq_db_index(
+    BTM_INQ_DB_SIZE, "btm_inq_db");
+
 const uint16_t BTM_EIR_UUID_LKUP_TBL[BTM_EIR_MAX_SERVICES] = {
     UUID_SERVCLASS_SERVICE_DISCOVERY_SERVER,
     /*    UUID_SERVCLASS_BROWSE_GROUP_DESCRIPTOR,   */
@@ -140,6 +152,7 @@ const uint16_t BTM_EIR_UUID_LKUP_TBL[BTM_EIR_MAX_SERVICES] = {
 /*            L O C A L    F U N C T I O N     P R O T O T Y P E S            */
 /******************************************************************************/
 static void btm_clr_inq_db(const RawAddress* p_bda);
+static void btm_inq_db_rebuild_index(void);
 void btm_clr_inq_result_flt(void);
 static void btm_inq_rmt_name_failed_cancelled(void);
 static tBTM_STATUS btm_initiate_rem_name(const RawAddress& remote_bda,
@@ -901,6 +914,11 @@ void btm_clr_inq_db(const RawAddress* p_bda) {
       }
     }
   }
+  if (p_bda == NULL) {
+    inq_db_index.Clear();
+  } else {
+    inq_db_index.Remove(*p_bda);
+  }
 #if (BTM_INQ_DEBUG == TRUE)
   BTM_TRACE_DEBUG("inq_active:0x%x state:%d", btm_cb.btm_inq_vars.inq_active,
                   btm_cb.btm_inq_vars.state);
@@ -969,57 +987,109 @@ bool btm_inq_find_bdaddr(const RawAddress& p_bda) {
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda) {
-  uint16_t xx;
-  tINQ_DB_ENT* p_ent = btm_cb.btm_inq_vars.inq_db;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (p_ent->in_use && p_ent->inq_info.results.remote_bd_addr == p_bda)
-      return (p_ent);
+  uint16_t* p_index = inq_db_index.Peek(p_bda);
+  if (p_index == nullptr) return (NULL);
+
+  tINQ_DB_ENT* p_ent = &btm_cb.btm_inq_vars.inq_db[*p_index];
+  if (!p_ent->in_use || p_ent->inq_info.results.remote_bd_addr != p_bda) {
+    /* The entry was released without going through the index */
+    inq_db_index.Remove(p_bda);
+    return (NULL);
   }
+  return (p_ent);
+}
 
-  /* If here, not found */
-  return (NULL);
+/*******************************************************************************
+ *
+ * Function         btm_inq_db_heard
+ *
+ * Description      This function stamps an entry of the inquiry database with
+ *                  the time a response was received from the device, which
+ *                  makes it the last entry a full database reuses.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void btm_inq_db_heard(tINQ_DB_ENT* p_ent) {
+  p_ent->time_of_last_resp = bluetooth::common::time_get_os_boottime_ms();
+  /* Moves the device to the front of the index */
+  inq_db_index.HasKey(p_ent->inq_info.results.remote_bd_addr);
 }
 
 /*******************************************************************************
  *
  * Function         btm_inq_db_new
  *
- * Description      This function looks through the inquiry database for an
- *                  unused entry. If no entry is free, it allocates the oldest
+ * Description      This function takes an unused entry of the inquiry database.
+ *                  If no entry is free, it reuses the least recently heard
  *                  entry.
  *
  * Returns          pointer to entry
  *
  ******************************************************************************/
 tINQ_DB_ENT* btm_inq_db_new(const RawAddress& p_bda) {
-  uint16_t xx;
-  tINQ_DB_ENT* p_ent = btm_cb.btm_inq_vars.inq_db;
-  tINQ_DB_ENT* p_old = btm_cb.btm_inq_vars.inq_db;
-  uint64_t ot = UINT64_MAX;
-
-  for (xx = 0; xx < BTM_INQ_DB_SIZE; xx++, p_ent++) {
-    if (!p_ent->in_use) {
-      memset(p_ent, 0, sizeof(tINQ_DB_ENT));
-      p_ent->inq_info.results.remote_bd_addr = p_bda;
-      p_ent->in_use = true;
-
-      return (p_ent);
-    }
-
-    if (p_ent->time_of_resp < ot) {
-      p_old = p_ent;
-      ot = p_ent->time_of_resp;
+  tINQ_DB_ENT* p_ent = btm_inq_db_find(p_bda);
+  uint16_t xx = 0;
+
+  if (p_ent != NULL) {
+    xx = (uint16_t)(p_ent - btm_cb.btm_inq_vars.inq_db);
+  } else if (inq_db_index.Size() < BTM_INQ_DB_SIZE) {
+    /* Every in-use entry is indexed, so there is a free one */
+    while (btm_cb.btm_inq_vars.inq_db[xx].in_use) xx++;
+    CHECK(xx < BTM_INQ_DB_SIZE);
+    inq_db_index.Put(p_bda, xx);
+  } else {
+    /* If here, no free entry found. Reuse the least recently heard one. */
+    auto evicted = inq_db_index.Put(p_bda, 0);
+    CHECK(evicted.has_value());
+    xx = evicted->second;
+    tINQ_DB_ENT* p_old = &btm_cb.btm_inq_vars.inq_db[xx];
+    if (!p_old->in_use || p_old->inq_info.results.remote_bd_addr !=
+                              evicted->first) {
+      /* Stale index, the entry may belong to another device by now */
+      btm_inq_db_rebuild_index();
+      return btm_inq_db_new(p_bda);
     }
+    *inq_db_index.Peek(p_bda) = xx;
   }
 
-  /* If here, no free entry found. Return the oldest. */
+  p_ent = &btm_cb.btm_inq_vars.inq_db[xx];
+  memset(p_ent, 0, sizeof(tINQ_DB_ENT));
+  p_ent->inq_info.results.remote_bd_addr = p_bda;
+  p_ent->in_use = true;
 
-  memset(p_old, 0, sizeof(tINQ_DB_ENT));
-  p_old->inq_info.results.remote_bd_addr = p_bda;
-  p_old->in_use = true;
+  return (p_ent);
+}
+
+/*******************************************************************************
+ *
+ * Function         btm_inq_db_rebuild_index
+ *
+ * Description      This function indexes the in-use entries of the inquiry
+ *                  database again, after they moved or were released without
+ *                  going through the index. The entries seen last are the most
+ *                  recently used.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+static void btm_inq_db_rebuild_index(void) {
+  tINQ_DB_ENT* inq_db = btm_cb.btm_inq_vars.inq_db;
+  std::vector<uint16_t> in_use;
 
-  return (p_old);
+  for (uint16_t xx = 0; xx < BTM_INQ_DB_SIZE; xx++) {
+    if (inq_db[xx].in_use) in_use.push_back(xx);
+  }
+  std::stable_sort(in_use.begin(), in_use.end(),
+                   [inq_db](uint16_t a, uint16_t b) {
+                     return inq_db[a].time_of_last_resp <
+                            inq_db[b].time_of_last_resp;
+                   });
+
+  inq_db_index.Clear();
+  for (uint16_t xx : in_use) {
+    inq_db_index.Put(inq_db[xx].inq_info.results.remote_bd_addr, xx);
+  }
 }
 
 /*******************************************************************************
@@ -1055,6 +1125,7 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
   DEV_CLASS dc;
   uint16_t clock_offset;
   const uint8_t* p_eir_data = NULL;
+  size_t eir_hash = 0;
 
 #if (BTM_INQ_DEBUG == TRUE)
   BTM_TRACE_DEBUG("btm_process_inq_results inq_active:0x%x state:%d",
@@ -1107,7 +1178,15 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
       STREAM_TO_UINT8(rssi, p);
     }
 
+    if (inq_res_mode == BTM_INQ_RESULT_EXTENDED) {
+      eir_hash = std::hash<std::string_view>{}(std::string_view(
+          reinterpret_cast<const char*>(p), HCI_EXT_INQ_RESPONSE_LEN));
+    }
+
     p_i = btm_inq_db_find(bda);
+    if (p_i) {
+      btm_inq_db_heard(p_i);
+    }
 
     /* Check if this address has already been processed for this inquiry */
     if (btm_inq_find_bdaddr(bda)) {
@@ -1116,13 +1195,18 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
       /* By default suppose no update needed */
       i_rssi = (int8_t)rssi;
 
+      /* Repeated extended results mostly carry the EIR already reported */
+      bool same_eir = (inq_res_mode == BTM_INQ_RESULT_EXTENDED) && p_i &&
+                      p_i->eir_hash == eir_hash;
+
       /* If this new RSSI is higher than the last one */
       if ((rssi != 0) && p_i &&
           (i_rssi > p_i->inq_info.results.rssi ||
            p_i->inq_info.results.rssi == 0
            /* BR/EDR inquiry information update */
-           ||
-           (p_i->inq_info.results.device_type & BT_DEVICE_TYPE_BREDR) != 0)) {
+           || ((p_i->inq_info.results.device_type & BT_DEVICE_TYPE_BREDR) !=
+                   0 &&
+               !same_eir))) {
         p_cur = &p_i->inq_info.results;
         BTM_TRACE_DEBUG("update RSSI new:%d, old:%d", i_rssi, p_cur->rssi);
         p_cur->rssi = i_rssi;
@@ -1131,7 +1215,8 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
       /* If we received a second Extended Inq Event for an already */
       /* discovered device, this is because for the first one EIR was not
          received */
-      else if ((inq_res_mode == BTM_INQ_RESULT_EXTENDED) && (p_i)) {
+      else if ((inq_res_mode == BTM_INQ_RESULT_EXTENDED) && (p_i) &&
+               !same_eir) {
         p_cur = &p_i->inq_info.results;
         update = true;
       }
@@ -1144,6 +1229,7 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
      * oldest) */
     if (p_i == NULL) {
       p_i = btm_inq_db_new(bda);
+      btm_inq_db_heard(p_i);
       is_new = true;
     }
 
@@ -1198,6 +1284,7 @@ void btm_process_inq_results(const uint8_t* p, uint8_t hci_evt_len,
         /* set bit map of UUID list from received EIR */
         btm_set_eir_uuid(p, p_cur);
         p_eir_data = p;
+        p_i->eir_hash = eir_hash;
       } else
         p_eir_data = NULL;
 
@@ -1245,6 +1332,7 @@ void btm_sort_inq_result(void) {
   }
 
   osi_free(p_tmp);
+  btm_inq_db_rebuild_index();
 }
 
 /*******************************************************************************
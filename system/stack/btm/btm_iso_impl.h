@@ -409,7 +409,7 @@ struct iso_impl {
 
     /* Add 2 for handle, 2 for length */
     uint16_t iso_full_len = iso_data_load_len + 4;
-    BT_HDR* packet = (BT_HDR*)osi_malloc(iso_full_len + sizeof(BT_HDR));
+    BT_HDR* packet = (BT_HDR*)osi_pool_malloc(iso_full_len + sizeof(BT_HDR));
     packet->len = iso_full_len;
     packet->offset = 0;
     packet->event = MSG_STACK_TO_HC_HCI_ISO;
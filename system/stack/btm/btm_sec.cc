@@ -4877,10 +4877,9 @@ static void btm_sec_check_pending_enc_req(tBTM_SEC_DEV_REC* p_dev_rec,
   if (fixed_queue_is_empty(btm_cb.sec_pending_q)) return;
 
   const tBTM_STATUS res = encr_enable ? BTM_SUCCESS : BTM_ERR_PROCESSING;
-  list_t* list = fixed_queue_get_list(btm_cb.sec_pending_q);
-  for (const list_node_t* node = list_begin(list); node != list_end(list);) {
-    tBTM_SEC_QUEUE_ENTRY* p_e = (tBTM_SEC_QUEUE_ENTRY*)list_node(node);
-    node = list_next(node);
+  for (size_t i = 0; i < fixed_queue_length(btm_cb.sec_pending_q);) {
+    tBTM_SEC_QUEUE_ENTRY* p_e = (tBTM_SEC_QUEUE_ENTRY*)fixed_queue_try_peek_at(
+        btm_cb.sec_pending_q, i);
 
     if (p_e->bd_addr == p_dev_rec->bd_addr && p_e->psm == 0 &&
         p_e->transport == transport) {
@@ -4892,9 +4891,12 @@ static void btm_sec_check_pending_enc_req(tBTM_SEC_DEV_REC* p_dev_rec,
         if (p_e->p_callback)
           (*p_e->p_callback)(&p_dev_rec->bd_addr, transport, p_e->p_ref_data,
                              res);
+        /* The next entry has moved to index i */
         fixed_queue_try_remove_from_queue(btm_cb.sec_pending_q, (void*)p_e);
+        continue;
       }
     }
+    i++;
   }
 }
 
@@ -160,6 +160,8 @@ typedef struct {
 
 typedef struct {
   uint64_t time_of_resp;
+  uint64_t time_of_last_resp; /* Last time any response was received */
+  size_t eir_hash;            /* Hash of the EIR last reported to the caller */
   uint32_t
       inq_count; /* "timestamps" the entry with a particular inquiry count   */
                  /* Used for determining if a response has already been      */
@@ -258,3 +260,4 @@ typedef union /* contains the inquiry filter condition */
 
 extern bool btm_inq_find_bdaddr(const RawAddress& p_bda);
 extern tINQ_DB_ENT* btm_inq_db_find(const RawAddress& p_bda);
+extern void btm_inq_db_heard(tINQ_DB_ENT* p_ent);
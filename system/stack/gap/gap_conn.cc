@@ -573,7 +573,8 @@ uint16_t GAP_ConnGetL2CAPCid(uint16_t gap_handle) {
  *
  * Function         gap_tx_connect_ind
  *
- * Description      Sends out GAP_EVT_TX_EMPTY when transmission has been
+ * Description      Sends out GAP_EVT_TX_DONE with the number of SDUs sent,
+ *                  and GAP_EVT_TX_EMPTY when transmission has been
  *                  completed.
  *
  * Returns          void
@@ -583,7 +584,13 @@ void gap_tx_complete_ind(uint16_t l2cap_cid, uint16_t sdu_sent) {
   tGAP_CCB* p_ccb = gap_find_ccb_by_cid(l2cap_cid);
   if (p_ccb == NULL) return;
 
-  if ((p_ccb->con_state == GAP_CCB_STATE_CONNECTED) && (sdu_sent == 0xFFFF)) {
+  if (p_ccb->con_state != GAP_CCB_STATE_CONNECTED) return;
+
+  tGAP_CB_DATA cb_data;
+  cb_data.tx_done.sdus_sent = sdu_sent;
+  p_ccb->p_callback(p_ccb->gap_handle, GAP_EVT_TX_DONE, &cb_data);
+
+  if (sdu_sent == 0xFFFF) {
     DVLOG(1) << StringPrintf("%s: GAP_EVT_TX_EMPTY", __func__);
     p_ccb->p_callback(p_ccb->gap_handle, GAP_EVT_TX_EMPTY, nullptr);
   }
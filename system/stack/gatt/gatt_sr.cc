@@ -161,20 +161,9 @@ static void build_read_multi_rsp(tGATT_SR_CMD* p_cmd, uint16_t mtu) {
 
   /* Now walk through the buffers putting the data into the response in order
    */
-  list_t* list = NULL;
-  const list_node_t* node = NULL;
-  if (!fixed_queue_is_empty(p_cmd->multi_rsp_q))
-    list = fixed_queue_get_list(p_cmd->multi_rsp_q);
   for (ii = 0; ii < p_cmd->multi_req.num_handles; ii++) {
-    tGATTS_RSP* p_rsp = NULL;
-
-    if (list != NULL) {
-      if (ii == 0)
-        node = list_begin(list);
-      else
-        node = list_next(node);
-      if (node != list_end(list)) p_rsp = (tGATTS_RSP*)list_node(node);
-    }
+    tGATTS_RSP* p_rsp =
+        (tGATTS_RSP*)fixed_queue_try_peek_at(p_cmd->multi_rsp_q, ii);
 
     if (p_rsp != NULL) {
       total_len = (p_buf->len + p_rsp->attr_value.len);
@@ -147,12 +147,11 @@ void gatt_set_srv_chg(void) {
 
   if (fixed_queue_is_empty(gatt_cb.srv_chg_clt_q)) return;
 
-  list_t* list = fixed_queue_get_list(gatt_cb.srv_chg_clt_q);
-  for (const list_node_t* node = list_begin(list); node != list_end(list);
-       node = list_next(node)) {
+  for (size_t i = 0; i < fixed_queue_length(gatt_cb.srv_chg_clt_q); i++) {
     VLOG(1) << "found a srv_chg clt";
 
-    tGATTS_SRV_CHG* p_buf = (tGATTS_SRV_CHG*)list_node(node);
+    tGATTS_SRV_CHG* p_buf =
+        (tGATTS_SRV_CHG*)fixed_queue_try_peek_at(gatt_cb.srv_chg_clt_q, i);
     if (!p_buf->srv_changed) {
       VLOG(1) << "set srv_changed to true";
       p_buf->srv_changed = true;
@@ -297,10 +296,9 @@ bool gatt_is_srv_chg_ind_pending(tGATT_TCB* p_tcb) {
 
   if (fixed_queue_is_empty(p_tcb->pending_ind_q)) return false;
 
-  list_t* list = fixed_queue_get_list(p_tcb->pending_ind_q);
-  for (const list_node_t* node = list_begin(list); node != list_end(list);
-       node = list_next(node)) {
-    tGATT_VALUE* p_buf = (tGATT_VALUE*)list_node(node);
+  for (size_t i = 0; i < fixed_queue_length(p_tcb->pending_ind_q); i++) {
+    tGATT_VALUE* p_buf =
+        (tGATT_VALUE*)fixed_queue_try_peek_at(p_tcb->pending_ind_q, i);
     if (p_buf->handle == gatt_cb.handle_of_h_r) {
       return true;
     }
@@ -325,10 +323,9 @@ tGATTS_SRV_CHG* gatt_is_bda_in_the_srv_chg_clt_list(const RawAddress& bda) {
 
   if (fixed_queue_is_empty(gatt_cb.srv_chg_clt_q)) return NULL;
 
-  list_t* list = fixed_queue_get_list(gatt_cb.srv_chg_clt_q);
-  for (const list_node_t* node = list_begin(list); node != list_end(list);
-       node = list_next(node)) {
-    tGATTS_SRV_CHG* p_buf = (tGATTS_SRV_CHG*)list_node(node);
+  for (size_t i = 0; i < fixed_queue_length(gatt_cb.srv_chg_clt_q); i++) {
+    tGATTS_SRV_CHG* p_buf =
+        (tGATTS_SRV_CHG*)fixed_queue_try_peek_at(gatt_cb.srv_chg_clt_q, i);
     if (bda == p_buf->bda) {
       VLOG(1) << "bda is in the srv chg clt list";
       return p_buf;
@@ -47,6 +47,7 @@
 #define GAP_EVT_CONN_CONGESTED 0x0103
 #define GAP_EVT_CONN_UNCONGESTED 0x0104
 #define GAP_EVT_TX_EMPTY 0x0105
+#define GAP_EVT_TX_DONE 0x0106
 
 /*** used in connection variables and functions ***/
 #define GAP_INVALID_HANDLE 0xFFFF
@@ -72,8 +73,14 @@ struct tGAP_COC_CREDITS {
   uint16_t credit_count;
 };
 
+/* data associated with GAP_EVT_TX_DONE */
+struct tGAP_TX_DONE {
+  uint16_t sdus_sent; /* 0xFFFF if all SDUs written are sent */
+};
+
 union tGAP_CB_DATA {
   tGAP_COC_CREDITS coc_credits;
+  tGAP_TX_DONE tx_done;
 };
 
 /*****************************************************************************
@@ -634,7 +634,7 @@ void l2cble_process_sig_cmd(tL2C_LCB* p_lcb, uint8_t* p, uint16_t pkt_len) {
           temp_p_ccb->ecoc = true;
           temp_p_ccb->remote_id = id;
           temp_p_ccb->p_rcb = p_rcb;
-          temp_p_ccb->remote_cid = rcid;
+          l2cu_set_ccb_remote_cid(temp_p_ccb, rcid);
 
           temp_p_ccb->peer_conn_cfg.mtu = mtu;
           temp_p_ccb->peer_conn_cfg.mps = mps;
@@ -785,7 +785,7 @@ void l2cble_process_sig_cmd(tL2C_LCB* p_lcb, uint8_t* p, uint16_t pkt_len) {
         }
 
         temp_p_ccb = l2cu_find_ccb_by_cid(p_lcb, cid);
-        temp_p_ccb->remote_cid = rcid;
+        l2cu_set_ccb_remote_cid(temp_p_ccb, rcid);
 
         L2CAP_TRACE_DEBUG(
             "local cid = %d "
@@ -990,7 +990,7 @@ void l2cble_process_sig_cmd(tL2C_LCB* p_lcb, uint8_t* p, uint16_t pkt_len) {
 
       p_ccb->remote_id = id;
       p_ccb->p_rcb = p_rcb;
-      p_ccb->remote_cid = rcid;
+      l2cu_set_ccb_remote_cid(p_ccb, rcid);
 
       p_ccb->local_conn_cfg.mtu = L2CAP_SDU_LENGTH_LE_MAX;
       p_ccb->local_conn_cfg.mps =
@@ -29,6 +29,7 @@
 #include <string.h>
 
 #include "common/time_util.h"
+#include "gd/l2cap/fcs.h"
 #include "osi/include/allocator.h"
 #include "osi/include/log.h"
 #include "stack/include/bt_hdr.h"
@@ -48,39 +49,6 @@ static const char* SAR_types[] = {"Unsegmented", "Start", "End",
                                   "Continuation"};
 static const char* SUP_types[] = {"RR", "REJ", "RNR", "SREJ"};
 
-/* Look-up table for the CRC calculation */
-static const unsigned short crctab[256] = {
-    0x0000, 0xc0c1, 0xc181, 0x0140, 0xc301, 0x03c0, 0x0280, 0xc241, 0xc601,
-    0x06c0, 0x0780, 0xc741, 0x0500, 0xc5c1, 0xc481, 0x0440, 0xcc01, 0x0cc0,
-    0x0d80, 0xcd41, 0x0f00, 0xcfc1, 0xce81, 0x0e40, 0x0a00, 0xcac1, 0xcb81,
-    0x0b40, 0xc901, 0x09c0, 0x0880, 0xc841, 0xd801, 0x18c0, 0x1980, 0xd941,
-    0x1b00, 0xdbc1, 0xda81, 0x1a40, 0x1e00, 0xdec1, 0xdf81, 0x1f40, 0xdd01,
-    0x1dc0, 0x1c80, 0xdc41, 0x1400, 0xd4c1, 0xd581, 0x1540, 0xd701, 0x17c0,
-    0x1680, 0xd641, 0xd201, 0x12c0, 0x1380, 0xd341, 0x1100, 0xd1c1, 0xd081,
-    0x1040, 0xf001, 0x30c0, 0x3180, 0xf141, 0x3300, 0xf3c1, 0xf281, 0x3240,
-    0x3600, 0xf6c1, 0xf781, 0x3740, 0xf501, 0x35c0, 0x3480, 0xf441, 0x3c00,
-    0xfcc1, 0xfd81, 0x3d40, 0xff01, 0x3fc0, 0x3e80, 0xfe41, 0xfa01, 0x3ac0,
-    0x3b80, 0xfb41, 0x3900, 0xf9c1, 0xf881, 0x3840, 0x2800, 0xe8c1, 0xe981,
-    0x2940, 0xeb01, 0x2bc0, 0x2a80, 0xea41, 0xee01, 0x2ec0, 0x2f80, 0xef41,
-    0x2d00, 0xedc1, 0xec81, 0x2c40, 0xe401, 0x24c0, 0x2580, 0xe541, 0x2700,
-    0xe7c1, 0xe681, 0x2640, 0x2200, 0xe2c1, 0xe381, 0x2340, 0xe101, 0x21c0,
-    0x2080, 0xe041, 0xa001, 0x60c0, 0x6180, 0xa141, 0x6300, 0xa3c1, 0xa281,
-    0x6240, 0x6600, 0xa6c1, 0xa781, 0x6740, 0xa501, 0x65c0, 0x6480, 0xa441,
-    0x6c00, 0xacc1, 0xad81, 0x6d40, 0xaf01, 0x6fc0, 0x6e80, 0xae41, 0xaa01,
-    0x6ac0, 0x6b80, 0xab41, 0x6900, 0xa9c1, 0xa881, 0x6840, 0x7800, 0xb8c1,
-    0xb981, 0x7940, 0xbb01, 0x7bc0, 0x7a80, 0xba41, 0xbe01, 0x7ec0, 0x7f80,
-    0xbf41, 0x7d00, 0xbdc1, 0xbc81, 0x7c40, 0xb401, 0x74c0, 0x7580, 0xb541,
-    0x7700, 0xb7c1, 0xb681, 0x7640, 0x7200, 0xb2c1, 0xb381, 0x7340, 0xb101,
-    0x71c0, 0x7080, 0xb041, 0x5000, 0x90c1, 0x9181, 0x5140, 0x9301, 0x53c0,
-    0x5280, 0x9241, 0x9601, 0x56c0, 0x5780, 0x9741, 0x5500, 0x95c1, 0x9481,
-    0x5440, 0x9c01, 0x5cc0, 0x5d80, 0x9d41, 0x5f00, 0x9fc1, 0x9e81, 0x5e40,
-    0x5a00, 0x9ac1, 0x9b81, 0x5b40, 0x9901, 0x59c0, 0x5880, 0x9841, 0x8801,
-    0x48c0, 0x4980, 0x8941, 0x4b00, 0x8bc1, 0x8a81, 0x4a40, 0x4e00, 0x8ec1,
-    0x8f81, 0x4f40, 0x8d01, 0x4dc0, 0x4c80, 0x8c41, 0x4400, 0x84c1, 0x8581,
-    0x4540, 0x8701, 0x47c0, 0x4680, 0x8641, 0x8201, 0x42c0, 0x4380, 0x8341,
-    0x4100, 0x81c1, 0x8081, 0x4040,
-};
-
 /*******************************************************************************
  *  Static local functions
 */
@@ -94,28 +62,6 @@ static void prepare_I_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf,
 static bool do_sar_reassembly(tL2C_CCB* p_ccb, BT_HDR* p_buf,
                               uint16_t ctrl_word);
 
-/*******************************************************************************
- *
- * Function         l2c_fcr_updcrc
- *
- * Description      This function computes the CRC using the look-up table.
- *
- * Returns          CRC
- *
- ******************************************************************************/
-static unsigned short l2c_fcr_updcrc(unsigned short icrc, unsigned char* icp,
-                                     int icnt) {
-  unsigned short crc = icrc;
-  unsigned char* cp = icp;
-  int cnt = icnt;
-
-  while (cnt--) {
-    crc = ((crc >> 8) & 0xff) ^ crctab[(crc & 0xff) ^ *cp++];
-  }
-
-  return (crc);
-}
-
 /*******************************************************************************
  *
  * Function         l2c_fcr_tx_get_fcs
@@ -128,7 +74,7 @@ static unsigned short l2c_fcr_updcrc(unsigned short icrc, unsigned char* icp,
 static uint16_t l2c_fcr_tx_get_fcs(BT_HDR* p_buf) {
   uint8_t* p = ((uint8_t*)(p_buf + 1)) + p_buf->offset;
 
-  return (l2c_fcr_updcrc(L2CAP_FCR_INIT_CRC, p, p_buf->len));
+  return bluetooth::l2cap::Fcs::Update(L2CAP_FCR_INIT_CRC, p, p_buf->len);
 }
 
 /*******************************************************************************
@@ -146,8 +92,8 @@ static uint16_t l2c_fcr_rx_get_fcs(BT_HDR* p_buf) {
   /* offset points past the L2CAP header, but the CRC check includes it */
   p -= L2CAP_PKT_OVERHEAD;
 
-  return (
-      l2c_fcr_updcrc(L2CAP_FCR_INIT_CRC, p, p_buf->len + L2CAP_PKT_OVERHEAD));
+  return bluetooth::l2cap::Fcs::Update(L2CAP_FCR_INIT_CRC, p,
+                                       p_buf->len + L2CAP_PKT_OVERHEAD);
 }
 
 /*******************************************************************************
@@ -212,16 +158,118 @@ void l2c_fcr_cleanup(tL2C_CCB* p_ccb) {
 
   osi_free_and_reset((void**)&p_fcrb->p_rx_sdu);
 
-  fixed_queue_free(p_fcrb->waiting_for_ack_q, osi_free);
-  p_fcrb->waiting_for_ack_q = NULL;
+  l2c_fcr_buf_q_free(&p_fcrb->waiting_for_ack_q);
+  l2c_fcr_buf_q_free(&p_fcrb->srej_rcv_hold_q);
+  l2c_fcr_buf_q_free(&p_fcrb->retrans_q);
 
-  fixed_queue_free(p_fcrb->srej_rcv_hold_q, osi_free);
-  p_fcrb->srej_rcv_hold_q = NULL;
+  memset(p_fcrb, 0, sizeof(tL2C_FCRB));
+}
 
-  fixed_queue_free(p_fcrb->retrans_q, osi_free);
-  p_fcrb->retrans_q = NULL;
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_buf_q_enqueue
+ *
+ * Description      This function appends a buffer to an eRTM buffer queue,
+ *                  growing the ring if it is full.
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+void l2c_fcr_buf_q_enqueue(tL2C_FCR_BUF_Q* p_q, BT_HDR* p_buf) {
+  CHECK(p_q != NULL);
+  CHECK(p_buf != NULL);
 
-  memset(p_fcrb, 0, sizeof(tL2C_FCRB));
+  if (p_q->count == p_q->capacity) {
+    uint16_t new_capacity =
+        (p_q->capacity == 0) ? L2C_FCR_BUF_Q_INIT_SIZE : p_q->capacity * 2;
+    CHECK(new_capacity > p_q->capacity);
+    BT_HDR** p_bufs = (BT_HDR**)osi_malloc(new_capacity * sizeof(BT_HDR*));
+
+    for (uint16_t xx = 0; xx < p_q->count; xx++)
+      p_bufs[xx] = p_q->p_bufs[(p_q->head + xx) & (p_q->capacity - 1)];
+
+    osi_free(p_q->p_bufs);
+    p_q->p_bufs = p_bufs;
+    p_q->capacity = new_capacity;
+    p_q->head = 0;
+  }
+
+  p_q->p_bufs[(p_q->head + p_q->count) & (p_q->capacity - 1)] = p_buf;
+  p_q->count++;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_buf_q_dequeue
+ *
+ * Description      This function removes the oldest buffer from an eRTM
+ *                  buffer queue.
+ *
+ * Returns          pointer to buffer or NULL if the queue is empty
+ *
+ ******************************************************************************/
+BT_HDR* l2c_fcr_buf_q_dequeue(tL2C_FCR_BUF_Q* p_q) {
+  CHECK(p_q != NULL);
+  if (p_q->count == 0) return NULL;
+
+  BT_HDR* p_buf = p_q->p_bufs[p_q->head];
+  p_q->head = (p_q->head + 1) & (p_q->capacity - 1);
+  p_q->count--;
+  return p_buf;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_buf_q_at
+ *
+ * Description      This function returns the buffer at a given position in an
+ *                  eRTM buffer queue, 0 being the oldest.
+ *
+ * Returns          pointer to buffer or NULL if index is out of range
+ *
+ ******************************************************************************/
+BT_HDR* l2c_fcr_buf_q_at(const tL2C_FCR_BUF_Q* p_q, uint16_t index) {
+  CHECK(p_q != NULL);
+  if (index >= p_q->count) return NULL;
+
+  return p_q->p_bufs[(p_q->head + index) & (p_q->capacity - 1)];
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_buf_q_peek_last
+ *
+ * Description      This function returns the newest buffer in an eRTM buffer
+ *                  queue without removing it.
+ *
+ * Returns          pointer to buffer or NULL if the queue is empty
+ *
+ ******************************************************************************/
+BT_HDR* l2c_fcr_buf_q_peek_last(const tL2C_FCR_BUF_Q* p_q) {
+  CHECK(p_q != NULL);
+  if (p_q->count == 0) return NULL;
+
+  return l2c_fcr_buf_q_at(p_q, p_q->count - 1);
+}
+
+/*******************************************************************************
+ *
+ * Function         l2c_fcr_buf_q_free
+ *
+ * Description      This function frees all buffers held in an eRTM buffer
+ *                  queue along with the ring storage itself.
+ *
+ * Returns          -
+ *
+ ******************************************************************************/
+void l2c_fcr_buf_q_free(tL2C_FCR_BUF_Q* p_q) {
+  CHECK(p_q != NULL);
+
+  BT_HDR* p_buf;
+  while ((p_buf = l2c_fcr_buf_q_dequeue(p_q)) != NULL) osi_free(p_buf);
+
+  osi_free(p_q->p_bufs);
+  memset(p_q, 0, sizeof(tL2C_FCR_BUF_Q));
 }
 
 /*******************************************************************************
@@ -231,6 +279,10 @@ void l2c_fcr_cleanup(tL2C_CCB* p_ccb) {
  * Description      This function allocates and copies requested part of a
  *                  buffer at a new-offset.
  *
+ *                  Segments cannot share the SDU buffer: the headers, FCS and
+ *                  HCI preamble are written in place in front of and after
+ *                  each segment, and the lower layers free what they send.
+ *
  * Returns          pointer to new buffer
  *
  ******************************************************************************/
@@ -242,7 +294,7 @@ BT_HDR* l2c_fcr_clone_buf(BT_HDR* p_buf, uint16_t new_offset,
    * the FCS (Frame Check Sequence) at the end of the buffer.
    */
   uint16_t buf_size = no_of_bytes + sizeof(BT_HDR) + new_offset + L2CAP_FCS_LEN;
-  BT_HDR* p_buf2 = (BT_HDR*)osi_malloc(buf_size);
+  BT_HDR* p_buf2 = (BT_HDR*)osi_pool_malloc(buf_size);
 
   p_buf2->offset = new_offset;
   p_buf2->len = no_of_bytes;
@@ -266,7 +318,7 @@ bool l2c_fcr_is_flow_controlled(tL2C_CCB* p_ccb) {
   if (p_ccb->peer_cfg.fcr.mode == L2CAP_FCR_ERTM_MODE) {
     /* Check if remote side flowed us off or the transmit window is full */
     if ((p_ccb->fcrb.remote_busy) ||
-        (fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q) >=
+        (p_ccb->fcrb.waiting_for_ack_q.count >=
          p_ccb->peer_cfg.fcr.tx_win_sz)) {
       return (true);
     }
@@ -402,7 +454,7 @@ void l2c_fcr_send_S_frame(tL2C_CCB* p_ccb, uint16_t function_code,
   ctrl_word |= (p_ccb->fcrb.next_seq_expected << L2CAP_FCR_REQ_SEQ_BITS_SHIFT);
   ctrl_word |= pf_bit;
 
-  BT_HDR* p_buf = (BT_HDR*)osi_malloc(L2CAP_CMD_BUF_SIZE);
+  BT_HDR* p_buf = (BT_HDR*)osi_pool_malloc(L2CAP_CMD_BUF_SIZE);
   p_buf->offset = HCI_DATA_PREAMBLE_SIZE;
   p_buf->len = L2CAP_PKT_OVERHEAD + L2CAP_FCR_OVERHEAD;
 
@@ -525,7 +577,7 @@ void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
       "%u, wt_q.cnt %u, tries %u",
       p_ccb->fcrb.next_tx_seq, p_ccb->fcrb.last_rx_ack,
       p_ccb->fcrb.next_seq_expected, p_ccb->fcrb.last_ack_sent,
-      fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q), p_ccb->fcrb.num_tries);
+      p_ccb->fcrb.waiting_for_ack_q.count, p_ccb->fcrb.num_tries);
 
   /* Verify FCS if using */
   p = ((uint8_t*)(p_buf + 1)) + p_buf->offset + p_buf->len - L2CAP_FCS_LEN;
@@ -579,7 +631,7 @@ void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
     /* P and F are mutually exclusive */
     if (ctrl_word & L2CAP_FCR_S_FRAME_BIT) ctrl_word &= ~L2CAP_FCR_P_BIT;
 
-    if (fixed_queue_is_empty(p_ccb->fcrb.waiting_for_ack_q))
+    if (p_ccb->fcrb.waiting_for_ack_q.count == 0)
       p_ccb->fcrb.num_tries = 0;
 
     l2c_fcr_stop_timer(p_ccb);
@@ -607,11 +659,11 @@ void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
   /* If we have some buffers held while doing SREJ, and SREJ has cleared,
    * process them now */
   if ((!p_ccb->fcrb.srej_sent) &&
-      (!fixed_queue_is_empty(p_ccb->fcrb.srej_rcv_hold_q))) {
-    fixed_queue_t* temp_q = p_ccb->fcrb.srej_rcv_hold_q;
-    p_ccb->fcrb.srej_rcv_hold_q = fixed_queue_new(SIZE_MAX);
+      (p_ccb->fcrb.srej_rcv_hold_q.count != 0)) {
+    tL2C_FCR_BUF_Q temp_q = p_ccb->fcrb.srej_rcv_hold_q;
+    memset(&p_ccb->fcrb.srej_rcv_hold_q, 0, sizeof(tL2C_FCR_BUF_Q));
 
-    while ((p_buf = (BT_HDR*)fixed_queue_try_dequeue(temp_q)) != NULL) {
+    while ((p_buf = l2c_fcr_buf_q_dequeue(&temp_q)) != NULL) {
       if (p_ccb->in_use && (p_ccb->chnl_state == CST_OPEN)) {
         /* Get the control word */
         p = ((uint8_t*)(p_buf + 1)) + p_buf->offset - L2CAP_FCR_OVERHEAD;
@@ -639,7 +691,7 @@ void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
         l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_REJ, 0);
       }
     }
-    fixed_queue_free(temp_q, NULL);
+    l2c_fcr_buf_q_free(&temp_q);
 
     /* Now, if needed, send one RR for the whole held queue */
     if ((!p_ccb->fcrb.rej_sent) && (!p_ccb->fcrb.srej_sent) &&
@@ -655,7 +707,7 @@ void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
   }
 
   /* If a window has opened, check if we can send any more packets */
-  if ((!fixed_queue_is_empty(p_ccb->fcrb.retrans_q) ||
+  if (((p_ccb->fcrb.retrans_q.count != 0) ||
        !fixed_queue_is_empty(p_ccb->xmit_hold_q)) &&
       (!p_ccb->fcrb.wait_ack) && (!l2c_fcr_is_flow_controlled(p_ccb))) {
     l2c_link_check_send_pkts(p_ccb->p_lcb, 0, NULL);
@@ -722,7 +774,13 @@ void l2c_lcc_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf) {
       return;
     }
 
-    p_data = (BT_HDR*)osi_malloc(BT_HDR_SIZE + sdu_length);
+    /* An SDU carried in a single K-frame is delivered in place */
+    if (sdu_length == p_buf->len) {
+      l2c_csm_execute(p_ccb, L2CEVT_L2CAP_DATA, p_buf);
+      return;
+    }
+
+    p_data = (BT_HDR*)osi_pool_malloc(BT_HDR_SIZE + sdu_length);
     if (p_data == NULL) {
       osi_free(p_buf);
       return;
@@ -785,7 +843,7 @@ void l2c_fcr_proc_tout(tL2C_CCB* p_ccb) {
       "l2c_fcr_proc_tout:  CID: 0x%04x  num_tries: %u (max: %u)  wait_ack: %u  "
       "ack_q_count: %u",
       p_ccb->local_cid, p_ccb->fcrb.num_tries, p_ccb->peer_cfg.fcr.max_transmit,
-      p_ccb->fcrb.wait_ack, fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q));
+      p_ccb->fcrb.wait_ack, p_ccb->fcrb.waiting_for_ack_q.count);
 
   if ((p_ccb->peer_cfg.fcr.max_transmit != 0) &&
       (++p_ccb->fcrb.num_tries > p_ccb->peer_cfg.fcr.max_transmit)) {
@@ -842,7 +900,7 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
        (L2CAP_FCR_SUP_SREJ << L2CAP_FCR_SUP_SHIFT)) &&
       ((ctrl_word & L2CAP_FCR_P_BIT) == 0)) {
     /* If anything still waiting for ack, restart the timer if it was stopped */
-    if (!fixed_queue_is_empty(p_fcrb->waiting_for_ack_q))
+    if (p_fcrb->waiting_for_ack_q.count != 0)
       l2c_fcr_start_timer(p_ccb);
 
     return (true);
@@ -855,13 +913,13 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
   num_bufs_acked = (req_seq - p_fcrb->last_rx_ack) & L2CAP_FCR_SEQ_MODULO;
 
   /* Verify the request sequence is in range before proceeding */
-  if (num_bufs_acked > fixed_queue_length(p_fcrb->waiting_for_ack_q)) {
+  if (num_bufs_acked > p_fcrb->waiting_for_ack_q.count) {
     /* The channel is closed if ReqSeq is not in range */
     L2CAP_TRACE_WARNING(
         "L2CAP eRTM Frame BAD Req_Seq - ctrl_word: 0x%04x  req_seq 0x%02x  "
         "last_rx_ack: 0x%02x  QCount: %u",
         ctrl_word, req_seq, p_fcrb->last_rx_ack,
-        fixed_queue_length(p_fcrb->waiting_for_ack_q));
+        p_fcrb->waiting_for_ack_q.count);
 
     l2cu_disconnect_chnl(p_ccb);
     return (false);
@@ -877,7 +935,7 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
 
     for (xx = 0; xx < num_bufs_acked; xx++) {
       BT_HDR* p_tmp =
-          (BT_HDR*)fixed_queue_try_dequeue(p_fcrb->waiting_for_ack_q);
+          l2c_fcr_buf_q_dequeue(&p_fcrb->waiting_for_ack_q);
       ls = p_tmp->layer_specific & L2CAP_FCR_SAR_BITS;
 
       if ((ls == L2CAP_FCR_UNSEG_SDU) || (ls == L2CAP_FCR_END_SDU))
@@ -893,7 +951,7 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
     if ((p_ccb->p_rcb) && (p_ccb->p_rcb->api.pL2CA_TxComplete_Cb) &&
         (full_sdus_xmitted)) {
       /* Special case for eRTM, if all packets sent, send 0xFFFF */
-      if (fixed_queue_is_empty(p_fcrb->waiting_for_ack_q) &&
+      if ((p_fcrb->waiting_for_ack_q.count == 0) &&
           fixed_queue_is_empty(p_ccb->xmit_hold_q)) {
         full_sdus_xmitted = 0xFFFF;
       }
@@ -904,7 +962,7 @@ static bool process_reqseq(tL2C_CCB* p_ccb, uint16_t ctrl_word) {
   }
 
   /* If anything still waiting for ack, restart the timer if it was stopped */
-  if (!fixed_queue_is_empty(p_fcrb->waiting_for_ack_q))
+  if (p_fcrb->waiting_for_ack_q.count != 0)
     l2c_fcr_start_timer(p_ccb);
   return (true);
 }
@@ -1037,28 +1095,26 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
       if (p_fcrb->srej_sent) {
         /* If SREJ sent, save the frame for later processing as long as it is in
          * sequence */
-        next_srej =
-            (((BT_HDR*)fixed_queue_try_peek_last(p_fcrb->srej_rcv_hold_q))
-                 ->layer_specific +
-             1) &
-            L2CAP_FCR_SEQ_MODULO;
+        next_srej = (l2c_fcr_buf_q_peek_last(&p_fcrb->srej_rcv_hold_q)
+                         ->layer_specific +
+                     1) &
+                    L2CAP_FCR_SEQ_MODULO;
 
         if ((tx_seq == next_srej) &&
-            (fixed_queue_length(p_fcrb->srej_rcv_hold_q) <
-             p_ccb->our_cfg.fcr.tx_win_sz)) {
+            (p_fcrb->srej_rcv_hold_q.count < p_ccb->our_cfg.fcr.tx_win_sz)) {
           L2CAP_TRACE_DEBUG(
               "process_i_frame() Lost: %u  tx_seq:%u  ExpTxSeq %u  Rej: %u  "
               "SRej1",
               num_lost, tx_seq, p_fcrb->next_seq_expected, p_fcrb->rej_sent);
 
           p_buf->layer_specific = tx_seq;
-          fixed_queue_enqueue(p_fcrb->srej_rcv_hold_q, p_buf);
+          l2c_fcr_buf_q_enqueue(&p_fcrb->srej_rcv_hold_q, p_buf);
         } else {
           L2CAP_TRACE_WARNING(
               "process_i_frame() CID: 0x%04x  frame dropped in Srej Sent "
               "next_srej:%u  hold_q.count:%u  win_sz:%u",
               p_ccb->local_cid, next_srej,
-              fixed_queue_length(p_fcrb->srej_rcv_hold_q),
+              p_fcrb->srej_rcv_hold_q.count,
               p_ccb->our_cfg.fcr.tx_win_sz);
 
           p_fcrb->rej_after_srej = true;
@@ -1085,15 +1141,15 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
           p_fcrb->rej_sent = true;
           l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_REJ, 0);
         } else {
-          if (!fixed_queue_is_empty(p_fcrb->srej_rcv_hold_q)) {
+          if (p_fcrb->srej_rcv_hold_q.count != 0) {
             L2CAP_TRACE_ERROR(
                 "process_i_frame() CID: 0x%04x  sending SREJ tx_seq:%d "
                 "hold_q.count:%u",
                 p_ccb->local_cid, tx_seq,
-                fixed_queue_length(p_fcrb->srej_rcv_hold_q));
+                p_fcrb->srej_rcv_hold_q.count);
           }
           p_buf->layer_specific = tx_seq;
-          fixed_queue_enqueue(p_fcrb->srej_rcv_hold_q, p_buf);
+          l2c_fcr_buf_q_enqueue(&p_fcrb->srej_rcv_hold_q, p_buf);
           p_fcrb->srej_sent = true;
           l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_SREJ, 0);
         }
@@ -1139,7 +1195,7 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
       }
     } else if ((fixed_queue_is_empty(p_ccb->xmit_hold_q) ||
                 l2c_fcr_is_flow_controlled(p_ccb)) &&
-               fixed_queue_is_empty(p_ccb->fcrb.srej_rcv_hold_q)) {
+               (p_ccb->fcrb.srej_rcv_hold_q.count == 0)) {
       l2c_fcr_send_S_frame(p_ccb, L2CAP_FCR_SUP_RR, 0);
     }
   }
@@ -1151,6 +1207,10 @@ static void process_i_frame(tL2C_CCB* p_ccb, BT_HDR* p_buf, uint16_t ctrl_word,
  *
  * Description      Process SAR bits and re-assemble frame
  *
+ *                  Segments are copied into one SDU buffer as they arrive.
+ *                  Every L2CAP client reads a contiguous BT_HDR, so a
+ *                  scatter list would have to be flattened before delivery.
+ *
  * Returns          true if all OK, else false
  *
  ******************************************************************************/
@@ -1202,7 +1262,7 @@ static bool do_sar_reassembly(tL2C_CCB* p_ccb, BT_HDR* p_buf,
                             p_fcrb->rx_sdu_len, p_ccb->max_rx_mtu);
         packet_ok = false;
       } else {
-        p_fcrb->p_rx_sdu = (BT_HDR*)osi_malloc(
+        p_fcrb->p_rx_sdu = (BT_HDR*)osi_pool_malloc(
             BT_HDR_SIZE + OBX_BUF_MIN_OFFSET + p_fcrb->rx_sdu_len);
         p_fcrb->p_rx_sdu->offset = OBX_BUF_MIN_OFFSET;
         p_fcrb->p_rx_sdu->len = 0;
@@ -1274,7 +1334,7 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
   uint8_t buf_seq;
   uint16_t ctrl_word;
 
-  if ((!fixed_queue_is_empty(p_ccb->fcrb.waiting_for_ack_q)) &&
+  if ((p_ccb->fcrb.waiting_for_ack_q.count != 0) &&
       (p_ccb->peer_cfg.fcr.max_transmit != 0) &&
       (p_ccb->fcrb.num_tries >= p_ccb->peer_cfg.fcr.max_transmit)) {
     L2CAP_TRACE_EVENT(
@@ -1282,7 +1342,7 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
         "%u) ack_q_count: %u",
         p_ccb->fcrb.last_rx_ack, p_ccb->local_cid, p_ccb->fcrb.num_tries,
         p_ccb->peer_cfg.fcr.max_transmit,
-        fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q));
+        p_ccb->fcrb.waiting_for_ack_q.count);
 
     l2cu_disconnect_chnl(p_ccb);
     return (false);
@@ -1290,38 +1350,30 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
 
   /* tx_seq indicates whether to retransmit a specific sequence or all (if ==
    * L2C_FCR_RETX_ALL_PKTS) */
-  list_t* list_ack = NULL;
-  const list_node_t* node_ack = NULL;
-  if (!fixed_queue_is_empty(p_ccb->fcrb.waiting_for_ack_q)) {
-    list_ack = fixed_queue_get_list(p_ccb->fcrb.waiting_for_ack_q);
-    node_ack = list_begin(list_ack);
-  }
+  const tL2C_FCR_BUF_Q* p_ack_q = &p_ccb->fcrb.waiting_for_ack_q;
+  uint16_t ack_idx = 0;
   if (tx_seq != L2C_FCR_RETX_ALL_PKTS) {
     /* If sending only one, the sequence number tells us which one. Look for it.
     */
-    if (list_ack != NULL) {
-      for (; node_ack != list_end(list_ack); node_ack = list_next(node_ack)) {
-        p_buf = (BT_HDR*)list_node(node_ack);
-        /* Get the old control word */
-        p = ((uint8_t*)(p_buf + 1)) + p_buf->offset + L2CAP_PKT_OVERHEAD;
+    for (; ack_idx < p_ack_q->count; ack_idx++) {
+      p_buf = l2c_fcr_buf_q_at(p_ack_q, ack_idx);
+      /* Get the old control word */
+      p = ((uint8_t*)(p_buf + 1)) + p_buf->offset + L2CAP_PKT_OVERHEAD;
 
-        STREAM_TO_UINT16(ctrl_word, p);
+      STREAM_TO_UINT16(ctrl_word, p);
 
-        buf_seq =
-            (ctrl_word & L2CAP_FCR_TX_SEQ_BITS) >> L2CAP_FCR_TX_SEQ_BITS_SHIFT;
+      buf_seq =
+          (ctrl_word & L2CAP_FCR_TX_SEQ_BITS) >> L2CAP_FCR_TX_SEQ_BITS_SHIFT;
 
-        L2CAP_TRACE_DEBUG(
-            "retransmit_i_frames()   cur seq: %u  looking for: %u", buf_seq,
-            tx_seq);
+      L2CAP_TRACE_DEBUG("retransmit_i_frames()   cur seq: %u  looking for: %u",
+                        buf_seq, tx_seq);
 
-        if (tx_seq == buf_seq) break;
-      }
+      if (tx_seq == buf_seq) break;
     }
 
     if (!p_buf) {
       L2CAP_TRACE_ERROR("retransmit_i_frames() UNKNOWN seq: %u  q_count: %u",
-                        tx_seq,
-                        fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q));
+                        tx_seq, p_ack_q->count);
       return (true);
     }
   } else {
@@ -1340,31 +1392,27 @@ static bool retransmit_i_frames(tL2C_CCB* p_ccb, uint8_t tx_seq) {
     }
 
     /* Also flush our retransmission queue */
-    while (!fixed_queue_is_empty(p_ccb->fcrb.retrans_q))
-      osi_free(fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q));
+    while (p_ccb->fcrb.retrans_q.count != 0)
+      osi_free(l2c_fcr_buf_q_dequeue(&p_ccb->fcrb.retrans_q));
 
-    if (list_ack != NULL) node_ack = list_begin(list_ack);
   }
 
-  if (list_ack != NULL) {
-    while (node_ack != list_end(list_ack)) {
-      p_buf = (BT_HDR*)list_node(node_ack);
-      node_ack = list_next(node_ack);
-
-      BT_HDR* p_buf2 = l2c_fcr_clone_buf(p_buf, p_buf->offset, p_buf->len);
-      if (p_buf2) {
-        p_buf2->layer_specific = p_buf->layer_specific;
+  for (; ack_idx < p_ack_q->count; ack_idx++) {
+    p_buf = l2c_fcr_buf_q_at(p_ack_q, ack_idx);
 
-        fixed_queue_enqueue(p_ccb->fcrb.retrans_q, p_buf2);
-      }
+    BT_HDR* p_buf2 = l2c_fcr_clone_buf(p_buf, p_buf->offset, p_buf->len);
+    if (p_buf2) {
+      p_buf2->layer_specific = p_buf->layer_specific;
 
-      if ((tx_seq != L2C_FCR_RETX_ALL_PKTS) || (p_buf2 == NULL)) break;
+      l2c_fcr_buf_q_enqueue(&p_ccb->fcrb.retrans_q, p_buf2);
     }
+
+    if ((tx_seq != L2C_FCR_RETX_ALL_PKTS) || (p_buf2 == NULL)) break;
   }
 
   l2c_link_check_send_pkts(p_ccb->p_lcb, 0, NULL);
 
-  if (fixed_queue_length(p_ccb->fcrb.waiting_for_ack_q)) {
+  if (p_ack_q->count) {
     p_ccb->fcrb.num_tries++;
     l2c_fcr_start_timer(p_ccb);
   }
@@ -1395,7 +1443,7 @@ BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
 
   /* If there is anything in the retransmit queue, that goes first
   */
-  p_buf = (BT_HDR*)fixed_queue_try_dequeue(p_ccb->fcrb.retrans_q);
+  p_buf = l2c_fcr_buf_q_dequeue(&p_ccb->fcrb.retrans_q);
   if (p_buf != NULL) {
     /* Update Rx Seq and FCS if we acked some packets while this one was queued
      */
@@ -1505,14 +1553,14 @@ BT_HDR* l2c_fcr_get_next_xmit_sdu_seg(tL2C_CCB* p_ccb,
       p_xmit->len -= L2CAP_FCS_LEN;
 
       /* Pretend we sent it and it got lost */
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_xmit);
+      l2c_fcr_buf_q_enqueue(&p_ccb->fcrb.waiting_for_ack_q, p_xmit);
       return (NULL);
     } else {
       /* We will not save the FCS in case we reconfigure and change options */
       p_wack->len -= L2CAP_FCS_LEN;
 
       p_wack->layer_specific = p_xmit->layer_specific;
-      fixed_queue_enqueue(p_ccb->fcrb.waiting_for_ack_q, p_wack);
+      l2c_fcr_buf_q_enqueue(&p_ccb->fcrb.waiting_for_ack_q, p_wack);
     }
 
   }
@@ -224,6 +224,19 @@ typedef enum : uint16_t {
 
 typedef uint8_t tL2C_BLE_FIXED_CHNLS_MASK;
 
+/* Initial number of entries in an eRTM buffer queue: one full sequence space */
+#define L2C_FCR_BUF_Q_INIT_SIZE (L2CAP_FCR_SEQ_MODULO + 1)
+
+/* Single-threaded FIFO of buffers used by the eRTM window. The backing array is
+ * allocated on first use and doubles when full, so steady-state traffic does
+ * not allocate or take locks per frame. Zero-initialized means empty. */
+typedef struct {
+  BT_HDR** p_bufs;   /* Ring storage, capacity entries */
+  uint16_t capacity; /* Always a power of two once allocated */
+  uint16_t head;     /* Index of the oldest buffer */
+  uint16_t count;    /* Number of buffers held */
+} tL2C_FCR_BUF_Q;
+
 typedef struct {
   uint8_t next_tx_seq;       /* Next sequence number to be Tx'ed */
   uint8_t last_rx_ack;       /* Last sequence number ack'ed by the peer */
@@ -243,10 +256,10 @@ typedef struct {
 
   uint16_t rx_sdu_len; /* Length of the SDU being received */
   BT_HDR* p_rx_sdu;    /* Buffer holding the SDU being received */
-  fixed_queue_t*
+  tL2C_FCR_BUF_Q
       waiting_for_ack_q;          /* Buffers sent and waiting for peer to ack */
-  fixed_queue_t* srej_rcv_hold_q; /* Buffers rcvd but held pending SREJ rsp */
-  fixed_queue_t* retrans_q;       /* Buffers being retransmitted */
+  tL2C_FCR_BUF_Q srej_rcv_hold_q; /* Buffers rcvd but held pending SREJ rsp */
+  tL2C_FCR_BUF_Q retrans_q;       /* Buffers being retransmitted */
 
   alarm_t* ack_timer;         /* Timer delaying RR */
   alarm_t* mon_retrans_timer; /* Timer Monitor or Retransmission */
@@ -301,9 +314,10 @@ typedef struct t_l2c_ccb {
   struct t_l2c_ccb* p_next_ccb; /* Next CCB in the chain */
   struct t_l2c_ccb* p_prev_ccb; /* Previous CCB in the chain */
   struct t_l2c_linkcb* p_lcb;   /* Link this CCB is assigned to */
+  struct t_l2c_ccb* p_next_rcid_hash; /* Next CCB in remote CID hash bucket */
 
   uint16_t local_cid;  /* Local CID */
-  uint16_t remote_cid; /* Remote CID */
+  uint16_t remote_cid; /* Remote CID, set via l2cu_set_ccb_remote_cid */
 
   alarm_t* l2c_ccb_timer; /* CCB Timer Entry */
 
@@ -432,11 +446,14 @@ typedef struct t_l2c_linkcb {
  private:
   uint16_t handle_; /* The handle used with LM */
   friend void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle);
+  friend void l2cu_invalidate_lcb_handle(struct t_l2c_linkcb& p_lcb);
   void SetHandle(uint16_t handle) { handle_ = handle; }
+  void InvalidateHandle() { handle_ = HCI_INVALID_HANDLE; }
 
  public:
   uint16_t Handle() const { return handle_; }
-  void InvalidateHandle() { handle_ = HCI_INVALID_HANDLE; }
+
+  struct t_l2c_linkcb* p_next_addr_hash; /* Next LCB in BD address bucket */
 
   tL2C_CCB_Q ccb_queue; /* Queue of CCBs on this LCB */
 
@@ -568,6 +585,14 @@ typedef struct t_l2c_linkcb {
   }
 } tL2C_LCB;
 
+/* Sizes of the lookup indexes kept in tL2C_CB. HCI connection handles are
+ * 12 bits so they index a table directly, BD addresses and remote CIDs are
+ * hashed into power of two bucket arrays.
+*/
+#define L2C_HANDLE_TABLE_SIZE 0x1000
+#define L2C_LCB_ADDR_HASH_SIZE 64
+#define L2C_RCID_HASH_SIZE 256
+
 /* Define the L2CAP control structure
 */
 typedef struct {
@@ -597,6 +622,12 @@ typedef struct {
   tL2C_CCB* p_free_ccb_first; /* Pointer to first free CCB */
   tL2C_CCB* p_free_ccb_last;  /* Pointer to last  free CCB */
 
+  /* Lookup indexes maintained on LCB/CCB allocate and release so that the
+   * per-packet lookups do not scan the pools */
+  tL2C_LCB* lcb_by_handle[L2C_HANDLE_TABLE_SIZE];
+  tL2C_LCB* lcb_addr_hash[L2C_LCB_ADDR_HASH_SIZE];
+  tL2C_CCB* ccb_rcid_hash[L2C_RCID_HASH_SIZE];
+
   bool disallow_switch;     /* false, to allow switch at create conn */
   uint16_t num_lm_acl_bufs; /* # of ACL buffers on controller */
   uint16_t idle_timeout;    /* Idle timeout */
@@ -689,6 +720,7 @@ extern void l2cu_release_lcb(tL2C_LCB* p_lcb);
 extern tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                           tBT_TRANSPORT transport);
 extern tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle);
+extern void l2cu_invalidate_lcb_handle(tL2C_LCB& p_lcb);
 
 extern bool l2cu_set_acl_priority(const RawAddress& bd_addr,
                                   tL2CAP_PRIORITY priority,
@@ -705,6 +737,7 @@ extern void l2cu_release_ccb(tL2C_CCB* p_ccb);
 extern tL2C_CCB* l2cu_find_ccb_by_cid(tL2C_LCB* p_lcb, uint16_t local_cid);
 extern tL2C_CCB* l2cu_find_ccb_by_remote_cid(tL2C_LCB* p_lcb,
                                              uint16_t remote_cid);
+extern void l2cu_set_ccb_remote_cid(tL2C_CCB* p_ccb, uint16_t remote_cid);
 extern bool l2c_is_cmd_rejected(uint8_t cmd_code, uint8_t id, tL2C_LCB* p_lcb);
 
 extern void l2cu_send_peer_cmd_reject(tL2C_LCB* p_lcb, uint16_t reason,
@@ -820,6 +853,11 @@ extern void l2c_enqueue_peer_data(tL2C_CCB* p_ccb, BT_HDR* p_buf);
  ***********************************
 */
 extern void l2c_fcr_cleanup(tL2C_CCB* p_ccb);
+extern void l2c_fcr_buf_q_enqueue(tL2C_FCR_BUF_Q* p_q, BT_HDR* p_buf);
+extern BT_HDR* l2c_fcr_buf_q_dequeue(tL2C_FCR_BUF_Q* p_q);
+extern BT_HDR* l2c_fcr_buf_q_at(const tL2C_FCR_BUF_Q* p_q, uint16_t index);
+extern BT_HDR* l2c_fcr_buf_q_peek_last(const tL2C_FCR_BUF_Q* p_q);
+extern void l2c_fcr_buf_q_free(tL2C_FCR_BUF_Q* p_q);
 extern void l2c_fcr_proc_pdu(tL2C_CCB* p_ccb, BT_HDR* p_buf);
 extern void l2c_fcr_proc_tout(tL2C_CCB* p_ccb);
 extern void l2c_fcr_proc_ack_tout(tL2C_CCB* p_ccb);
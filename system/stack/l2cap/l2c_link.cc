@@ -221,7 +221,7 @@ void l2c_link_hci_conn_comp(tHCI_STATUS status, uint16_t handle,
     LOG_WARN("Delaying connection as reached max number of links:%u",
              HCI_ERR_MAX_NUM_OF_CONNECTIONS);
     p_lcb->link_state = LST_CONNECT_HOLDING;
-    p_lcb->InvalidateHandle();
+    l2cu_invalidate_lcb_handle(*p_lcb);
   } else {
     /* Just in case app decides to try again in the callback context */
     p_lcb->link_state = LST_DISCONNECTING;
@@ -1373,7 +1373,7 @@ tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb) {
         if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
           if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) continue;
 
-          if (fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+          if (p_ccb->fcrb.retrans_q.count == 0) {
             if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
 
             /* If in eRTM mode, check for window closure */
@@ -1439,7 +1439,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
       if (p_ccb->fcrb.wait_ack || p_ccb->fcrb.remote_busy) continue;
 
       /* No more checks needed if sending from the reatransmit queue */
-      if (fixed_queue_is_empty(p_ccb->fcrb.retrans_q)) {
+      if (p_ccb->fcrb.retrans_q.count == 0) {
         if (fixed_queue_is_empty(p_ccb->xmit_hold_q)) continue;
 
         /* If in eRTM mode, check for window closure */
@@ -1486,10 +1486,11 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
     p_buf = l2c_lcc_get_next_xmit_sdu_seg(p_ccb, &last_piece_of_sdu);
     p_ccb->peer_conn_cfg.credits--;
 
-    if (last_piece_of_sdu) {
-      // TODO: send callback up the stack. Investigate setting p_cbi->cb to
-      // notify after controller ack send.
-    }
+    /* Report each SDU once its last segment goes to the controller, like
+     * the basic mode SDUs below. */
+    if (last_piece_of_sdu && p_ccb->p_rcb &&
+        p_ccb->p_rcb->api.pL2CA_TxComplete_Cb)
+      (*p_ccb->p_rcb->api.pL2CA_TxComplete_Cb)(p_ccb->local_cid, 1);
 
   } else {
     if (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_BASIC_MODE) {
@@ -1505,6 +1506,7 @@ BT_HDR* l2cu_get_next_buffer_to_send(tL2C_LCB* p_lcb) {
   }
 
   if (p_ccb->p_rcb && p_ccb->p_rcb->api.pL2CA_TxComplete_Cb &&
+      (p_ccb->p_lcb->transport != BT_TRANSPORT_LE) &&
       (p_ccb->peer_cfg.fcr.mode != L2CAP_FCR_ERTM_MODE))
     (*p_ccb->p_rcb->api.pL2CA_TxComplete_Cb)(p_ccb->local_cid, 1);
 
@@ -45,6 +45,46 @@
 
 tL2C_CCB* l2cu_get_next_channel_in_rr(tL2C_LCB* p_lcb); // TODO Move
 
+static size_t l2cu_lcb_addr_hash(const RawAddress& bd_addr,
+                                 tBT_TRANSPORT transport) {
+  size_t hash = transport;
+  for (size_t i = 0; i < RawAddress::kLength; i++) {
+    hash = hash * 31 + bd_addr.address[i];
+  }
+  return hash & (L2C_LCB_ADDR_HASH_SIZE - 1);
+}
+
+static size_t l2cu_ccb_rcid_hash(const tL2C_LCB* p_lcb, uint16_t remote_cid) {
+  size_t lcb_index = p_lcb - l2cb.lcb_pool;
+  return (remote_cid ^ (lcb_index * 0x9E5)) & (L2C_RCID_HASH_SIZE - 1);
+}
+
+static void l2cu_unlink_lcb_addr_hash(tL2C_LCB* p_lcb) {
+  tL2C_LCB** pp = &l2cb.lcb_addr_hash[l2cu_lcb_addr_hash(
+      p_lcb->remote_bd_addr, p_lcb->transport)];
+  for (; *pp; pp = &(*pp)->p_next_addr_hash) {
+    if (*pp == p_lcb) {
+      *pp = p_lcb->p_next_addr_hash;
+      break;
+    }
+  }
+  p_lcb->p_next_addr_hash = NULL;
+}
+
+static void l2cu_unlink_ccb_rcid_hash(tL2C_CCB* p_ccb) {
+  if (p_ccb->p_lcb == NULL || p_ccb->remote_cid == 0) return;
+
+  tL2C_CCB** pp =
+      &l2cb.ccb_rcid_hash[l2cu_ccb_rcid_hash(p_ccb->p_lcb, p_ccb->remote_cid)];
+  for (; *pp; pp = &(*pp)->p_next_rcid_hash) {
+    if (*pp == p_ccb) {
+      *pp = p_ccb->p_next_rcid_hash;
+      break;
+    }
+  }
+  p_ccb->p_next_rcid_hash = NULL;
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_lcb
@@ -63,13 +103,15 @@ tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
     if (!p_lcb->in_use) {
       alarm_free(p_lcb->l2c_lcb_timer);
       alarm_free(p_lcb->info_resp_timer);
+      l2cu_unlink_lcb_addr_hash(p_lcb);
+      l2cu_invalidate_lcb_handle(*p_lcb);
       memset(p_lcb, 0, sizeof(tL2C_LCB));
 
       p_lcb->remote_bd_addr = p_bd_addr;
 
       p_lcb->in_use = true;
       p_lcb->link_state = LST_DISCONNECTED;
-      p_lcb->InvalidateHandle();
+      l2cu_invalidate_lcb_handle(*p_lcb);
       p_lcb->l2c_lcb_timer = alarm_new("l2c_lcb.l2c_lcb_timer");
       p_lcb->info_resp_timer = alarm_new("l2c_lcb.info_resp_timer");
       p_lcb->idle_timeout = l2cb.idle_timeout;
@@ -80,6 +122,11 @@ tL2C_LCB* l2cu_allocate_lcb(const RawAddress& p_bd_addr, bool is_bonding,
         p_lcb->ResetBonding();
       }
       p_lcb->transport = transport;
+
+      size_t bucket = l2cu_lcb_addr_hash(p_bd_addr, transport);
+      p_lcb->p_next_addr_hash = l2cb.lcb_addr_hash[bucket];
+      l2cb.lcb_addr_hash[bucket] = p_lcb;
+
       p_lcb->tx_data_len =
           controller_get_interface()->get_ble_default_data_packet_length();
       p_lcb->le_sec_pending_q = fixed_queue_new(SIZE_MAX);
@@ -105,7 +152,27 @@ void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle) {
     LOG_WARN("Should not replace active handle:%hu with new handle:%hu",
              p_lcb.Handle(), handle);
   }
+  l2cu_invalidate_lcb_handle(p_lcb);
   p_lcb.SetHandle(handle);
+  if (handle < L2C_HANDLE_TABLE_SIZE) l2cb.lcb_by_handle[handle] = &p_lcb;
+}
+
+/*******************************************************************************
+ *
+ * Function         l2cu_invalidate_lcb_handle
+ *
+ * Description      Invalidate the HCI handle of an LCB and drop it from the
+ *                  handle lookup table.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2cu_invalidate_lcb_handle(struct t_l2c_linkcb& p_lcb) {
+  uint16_t handle = p_lcb.Handle();
+  if (handle < L2C_HANDLE_TABLE_SIZE && l2cb.lcb_by_handle[handle] == &p_lcb) {
+    l2cb.lcb_by_handle[handle] = NULL;
+  }
+  p_lcb.InvalidateHandle();
 }
 
 /*******************************************************************************
@@ -152,6 +219,7 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
 
   p_lcb->in_use = false;
   p_lcb->ResetBonding();
+  l2cu_unlink_lcb_addr_hash(p_lcb);
 
   /* Stop and free timers */
   alarm_free(p_lcb->l2c_lcb_timer);
@@ -224,24 +292,30 @@ void l2cu_release_lcb(tL2C_LCB* p_lcb) {
     fixed_queue_free(p_lcb->le_sec_pending_q, NULL);
     p_lcb->le_sec_pending_q = NULL;
   }
+
+  /* The LCB keeps its handle until reallocated, drop it from the index */
+  uint16_t handle = p_lcb->Handle();
+  if (handle < L2C_HANDLE_TABLE_SIZE && l2cb.lcb_by_handle[handle] == p_lcb) {
+    l2cb.lcb_by_handle[handle] = NULL;
+  }
 }
 
 /*******************************************************************************
  *
  * Function         l2cu_find_lcb_by_bd_addr
  *
- * Description      Look through all active LCBs for a match based on the
- *                  remote BD address.
+ * Description      Look through the active LCBs hashed to the same bucket for a
+ *                  match based on the remote BD address and transport.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_bd_addr(const RawAddress& p_bd_addr,
                                    tBT_TRANSPORT transport) {
-  int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  tL2C_LCB* p_lcb =
+      l2cb.lcb_addr_hash[l2cu_lcb_addr_hash(p_bd_addr, transport)];
 
-  for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
+  for (; p_lcb; p_lcb = p_lcb->p_next_addr_hash) {
     if ((p_lcb->in_use) && p_lcb->transport == transport &&
         (p_lcb->remote_bd_addr == p_bd_addr)) {
       return (p_lcb);
@@ -1440,9 +1514,6 @@ tL2C_CCB* l2cu_allocate_ccb(tL2C_LCB* p_lcb, uint16_t cid) {
   p_ccb->tx_mps = BT_DEFAULT_BUFFER_SIZE - 32;
 
   p_ccb->xmit_hold_q = fixed_queue_new(SIZE_MAX);
-  p_ccb->fcrb.srej_rcv_hold_q = fixed_queue_new(SIZE_MAX);
-  p_ccb->fcrb.retrans_q = fixed_queue_new(SIZE_MAX);
-  p_ccb->fcrb.waiting_for_ack_q = fixed_queue_new(SIZE_MAX);
 
   p_ccb->cong_sent = false;
   p_ccb->buff_quota = 2; /* This gets set after config */
@@ -1563,6 +1634,8 @@ void l2cu_release_ccb(tL2C_CCB* p_ccb) {
 
   l2c_fcr_cleanup(p_ccb);
 
+  l2cu_unlink_ccb_rcid_hash(p_ccb);
+
   /* Channel may not be assigned to any LCB if it was just pre-reserved */
   if ((p_lcb) && ((p_ccb->local_cid >= L2CAP_BASE_APPL_CID))) {
     l2cu_dequeue_ccb(p_ccb);
@@ -1587,7 +1660,7 @@ void l2cu_release_ccb(tL2C_CCB* p_ccb) {
   /* Flag as not in use */
   p_ccb->in_use = false;
   // Clear Remote CID and Local Id
-  p_ccb->remote_cid = 0;
+  l2cu_set_ccb_remote_cid(p_ccb, 0);
   p_ccb->local_id = 0;
 
   /* If no channels on the connection, start idle timeout */
@@ -1621,8 +1694,8 @@ void l2cu_release_ccb(tL2C_CCB* p_ccb) {
  *
  * Function         l2cu_find_ccb_by_remote_cid
  *
- * Description      Look through all active CCBs on a link for a match based
- *                  on the remote CID.
+ * Description      Look through the active CCBs hashed to the same bucket for
+ *                  a match based on the link and the remote CID.
  *
  * Returns          pointer to matched CCB, or NULL if no match
  *
@@ -1634,14 +1707,39 @@ tL2C_CCB* l2cu_find_ccb_by_remote_cid(tL2C_LCB* p_lcb, uint16_t remote_cid) {
   if (!p_lcb) {
     return NULL;
   } else {
-    for (p_ccb = p_lcb->ccb_queue.p_first_ccb; p_ccb; p_ccb = p_ccb->p_next_ccb)
-      if ((p_ccb->in_use) && (p_ccb->remote_cid == remote_cid)) return (p_ccb);
+    for (p_ccb = l2cb.ccb_rcid_hash[l2cu_ccb_rcid_hash(p_lcb, remote_cid)];
+         p_ccb; p_ccb = p_ccb->p_next_rcid_hash)
+      if ((p_ccb->in_use) && (p_ccb->p_lcb == p_lcb) &&
+          (p_ccb->remote_cid == remote_cid))
+        return (p_ccb);
   }
 
   /* If here, no match found */
   return (NULL);
 }
 
+/*******************************************************************************
+ *
+ * Function         l2cu_set_ccb_remote_cid
+ *
+ * Description      Set the remote CID of a dynamic channel and keep the
+ *                  remote CID lookup index up to date. A remote CID of 0
+ *                  removes the channel from the index.
+ *
+ * Returns          void
+ *
+ ******************************************************************************/
+void l2cu_set_ccb_remote_cid(tL2C_CCB* p_ccb, uint16_t remote_cid) {
+  l2cu_unlink_ccb_rcid_hash(p_ccb);
+  p_ccb->remote_cid = remote_cid;
+
+  if (p_ccb->p_lcb == NULL || remote_cid == 0) return;
+
+  size_t bucket = l2cu_ccb_rcid_hash(p_ccb->p_lcb, remote_cid);
+  p_ccb->p_next_rcid_hash = l2cb.ccb_rcid_hash[bucket];
+  l2cb.ccb_rcid_hash[bucket] = p_ccb;
+}
+
 /*******************************************************************************
  *
  * Function         l2cu_allocate_rcb
@@ -3257,16 +3355,25 @@ void l2cu_send_peer_ble_credit_based_disconn_req(tL2C_CCB* p_ccb) {
  *
  * Function         l2cu_find_lcb_by_handle
  *
- * Description      Look through all active LCBs for a match based on the
- *                  HCI handle.
+ * Description      Find the active LCB for an HCI handle. Valid handles are
+ *                  looked up directly in the handle table, anything else
+ *                  falls back to scanning all LCBs.
  *
  * Returns          pointer to matched LCB, or NULL if no match
  *
  ******************************************************************************/
 tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle) {
   int xx;
-  tL2C_LCB* p_lcb = &l2cb.lcb_pool[0];
+  tL2C_LCB* p_lcb;
 
+  if (handle < L2C_HANDLE_TABLE_SIZE) {
+    p_lcb = l2cb.lcb_by_handle[handle];
+    if (p_lcb && p_lcb->in_use && p_lcb->Handle() == handle) return (p_lcb);
+    return (NULL);
+  }
+
+  /* Handles outside the HCI range are not indexed */
+  p_lcb = &l2cb.lcb_pool[0];
   for (xx = 0; xx < MAX_L2CAP_LINKS; xx++, p_lcb++) {
     if ((p_lcb->in_use) && (p_lcb->Handle() == handle)) {
       return (p_lcb);
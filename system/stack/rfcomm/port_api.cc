@@ -27,6 +27,7 @@
 #include "stack/include/port_api.h"
 
 #include <base/logging.h>
+#include <sys/uio.h>
 
 #include <cstdint>
 
@@ -928,7 +929,10 @@ int PORT_WriteDataCO(uint16_t handle, int* p_len) {
 
   // max_read = available < max_read ? available : max_read;
 
-  while (available) {
+  if (p_port->peer_mtu < length) length = p_port->peer_mtu;
+
+  bool write_failed = false;
+  while (available && !write_failed) {
     /* if we're over buffer high water mark, we're done */
     if ((p_port->tx.queue_size > PORT_TX_HIGH_WM) ||
         (fixed_queue_length(p_port->tx.queue) > PORT_TX_BUF_HIGH_WM)) {
@@ -941,43 +945,76 @@ int PORT_WriteDataCO(uint16_t handle, int* p_len) {
       break;
     }
 
-    /* continue with rfcomm data write */
-    p_buf = (BT_HDR*)osi_malloc(RFCOMM_DATA_BUF_SIZE);
-    p_buf->offset = L2CAP_MIN_OFFSET + RFCOMM_MIN_OFFSET;
-    p_buf->layer_specific = handle;
-
-    if (p_port->peer_mtu < length) length = p_port->peer_mtu;
-    if (available < (int)length) length = (uint16_t)available;
-    p_buf->len = length;
-    p_buf->event = BT_EVT_TO_BTU_SP_DATA;
-
-    // memcpy ((uint8_t *)(p_buf + 1) + p_buf->offset, p_data, length);
-    // if(recv(fd, (uint8_t *)(p_buf + 1) + p_buf->offset, (int)length, 0) !=
-    // (int)length)
-    if (!p_port->p_data_co_callback(handle,
-                                    (uint8_t*)(p_buf + 1) + p_buf->offset,
-                                    length, DATA_CO_CALLBACK_TYPE_OUTGOING)) {
+    /* Read as many buffers with one call-out as the queue can take before it
+     * reaches its high water marks, counting them as queued */
+    BT_HDR* p_bufs[PORT_TX_BUF_READ_BATCH];
+    struct iovec iov[PORT_TX_BUF_READ_BATCH];
+    int count = 0;
+    int batch_len = 0;
+    do {
+      uint16_t buf_len = length;
+      if (available - batch_len < (int)buf_len)
+        buf_len = (uint16_t)(available - batch_len);
+
+      p_buf = (BT_HDR*)osi_pool_malloc(RFCOMM_DATA_BUF_SIZE);
+      p_buf->offset = L2CAP_MIN_OFFSET + RFCOMM_MIN_OFFSET;
+      p_buf->layer_specific = handle;
+      p_buf->len = buf_len;
+      p_buf->event = BT_EVT_TO_BTU_SP_DATA;
+
+      iov[count].iov_base = (uint8_t*)(p_buf + 1) + p_buf->offset;
+      iov[count].iov_len = buf_len;
+      p_bufs[count++] = p_buf;
+      batch_len += buf_len;
+    } while ((count < PORT_TX_BUF_READ_BATCH) && (batch_len < available) &&
+             (p_port->tx.queue_size + batch_len <= PORT_TX_HIGH_WM) &&
+             (fixed_queue_length(p_port->tx.queue) + count <=
+              PORT_TX_BUF_HIGH_WM));
+
+    if (!p_port->p_data_co_callback(handle, (uint8_t*)iov, count,
+                                    DATA_CO_CALLBACK_TYPE_OUTGOING_IOV)) {
       error(
-          "p_data_co_callback DATA_CO_CALLBACK_TYPE_OUTGOING failed, length:%d",
-          length);
+          "p_data_co_callback DATA_CO_CALLBACK_TYPE_OUTGOING_IOV failed, "
+          "length:%d",
+          batch_len);
+      for (int i = 0; i < count; i++) osi_free(p_bufs[i]);
       return (PORT_UNKNOWN_ERROR);
     }
 
-    RFCOMM_TRACE_EVENT("PORT_WriteData %d bytes", length);
-
-    rc = port_write(p_port, p_buf);
-
-    /* If queue went below the threashold need to send flow control */
-    event |= port_flow_control_user(p_port);
-
-    if (rc == PORT_SUCCESS) event |= PORT_EV_TXCHAR;
-
-    if ((rc != PORT_SUCCESS) && (rc != PORT_CMD_PENDING)) break;
+    for (int i = 0; i < count; i++) {
+      uint16_t buf_len = p_bufs[i]->len;
+      RFCOMM_TRACE_EVENT("PORT_WriteData %d bytes", buf_len);
+
+      rc = port_write(p_port, p_bufs[i]);
+
+      /* If queue went below the threashold need to send flow control */
+      event |= port_flow_control_user(p_port);
+
+      if (rc == PORT_SUCCESS) event |= PORT_EV_TXCHAR;
+
+      if ((rc != PORT_SUCCESS) && (rc != PORT_CMD_PENDING)) {
+        /* The port dropped this buffer, as it did when the buffers were read
+         * one at a time. The rest of the batch is already read from the app,
+         * so it waits in the pending queue rather than being lost. The batch
+         * was sized below the high water marks, so this stays within the
+         * critical ones. */
+        for (int j = i + 1; j < count; j++) {
+          uint16_t pending_len = p_bufs[j]->len;
+          fixed_queue_enqueue(p_port->tx.queue, p_bufs[j]);
+          p_port->tx.queue_size += pending_len;
+          *p_len += pending_len;
+          available -= (int)pending_len;
+        }
+        write_failed = true;
+        break;
+      }
 
-    *p_len += length;
-    available -= (int)length;
+      *p_len += buf_len;
+      available -= (int)buf_len;
+    }
   }
-  if (!available && (rc != PORT_CMD_PENDING) && (rc != PORT_TX_QUEUE_DISABLED))
+  if (!available && !write_failed && (rc != PORT_CMD_PENDING) &&
+      (rc != PORT_TX_QUEUE_DISABLED))
     event |= PORT_EV_TXEMPTY;
 
   /* Mask out all events that are not of interest to user */
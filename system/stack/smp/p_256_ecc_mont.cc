@@ -0,0 +1,465 @@
+/******************************************************************************
+ *
+ *  Copyright 2022 The Android Open Source Project
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at:
+ *
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ *
+ ******************************************************************************/
+
+/*******************************************************************************
+ *
+ *  This file contains a constant-time P-256 scalar multiplication used for
+ *  LE Secure Connections public key generation and DHKey computation.
+ *
+ *  Field elements are kept as four 64-bit limbs in the Montgomery domain
+ *  (R = 2^256). Points use homogeneous projective coordinates with the
+ *  complete addition and doubling formulas for a = -3 from Renes, Costello
+ *  and Batina, "Complete addition formulas for prime order elliptic curves"
+ *  (https://eprint.iacr.org/2015/1060), so no operation branches on the
+ *  point at infinity or on P == Q. Table lookups scan every entry and select
+ *  with masks, so the memory access pattern is independent of the scalar.
+ *
+ ******************************************************************************/
+
+#include <string.h>
+
+#include <cstdint>
+
+#include "p_256_ecc_pp.h"
+#include "p_256_multprecision.h"
+
+namespace {
+
+constexpr int kLimbs = 4;
+
+typedef uint64_t felem[kLimbs];
+
+typedef struct {
+  felem x;
+  felem y;
+  felem z;
+} ProjectivePoint;
+
+// p = 2^256 - 2^224 + 2^192 + 2^96 - 1, little endian limbs
+constexpr felem kP = {0xffffffffffffffff, 0x00000000ffffffff,
+                      0x0000000000000000, 0xffffffff00000001};
+
+// R^2 mod p, used to convert into the Montgomery domain
+constexpr felem kRR = {0x0000000000000003, 0xfffffffbffffffff,
+                       0xfffffffffffffffe, 0x00000004fffffffd};
+
+// Fixed-window width for variable base multiplication
+constexpr int kWindowBits = 4;
+constexpr int kWindowSize = 1 << kWindowBits;
+
+// Comb parameters for fixed base multiplication: kCombTeeth bits spaced
+// kCombSpacing apart select one of 2^kCombTeeth precomputed multiples of G.
+constexpr int kCombTeeth = 6;
+constexpr int kCombSpacing = (256 + kCombTeeth - 1) / kCombTeeth;
+constexpr int kCombSize = 1 << kCombTeeth;
+
+// lo + hi * 2^64 = a * b + c + d, never overflows
+inline uint64_t mac(uint64_t a, uint64_t b, uint64_t c, uint64_t d,
+                    uint64_t* hi) {
+#if defined(__SIZEOF_INT128__)
+  unsigned __int128 t = (unsigned __int128)a * b + c + d;
+  *hi = (uint64_t)(t >> 64);
+  return (uint64_t)t;
+#else
+  uint64_t a_lo = (uint32_t)a, a_hi = a >> 32;
+  uint64_t b_lo = (uint32_t)b, b_hi = b >> 32;
+  uint64_t p0 = a_lo * b_lo;
+  uint64_t p1 = a_lo * b_hi;
+  uint64_t p2 = a_hi * b_lo;
+  uint64_t p3 = a_hi * b_hi;
+  uint64_t mid = (p0 >> 32) + (uint32_t)p1 + (uint32_t)p2;
+  uint64_t lo = (mid << 32) | (uint32_t)p0;
+  uint64_t h = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+  lo += c;
+  h += (lo < c);
+  lo += d;
+  h += (lo < d);
+  *hi = h;
+  return lo;
+#endif
+}
+
+// lo = a + b + carry_in, *carry = carry out
+inline uint64_t adc(uint64_t a, uint64_t b, uint64_t carry_in,
+                    uint64_t* carry) {
+  uint64_t t = a + carry_in;
+  uint64_t c = (t < carry_in);
+  t += b;
+  c |= (t < b);
+  *carry = c;
+  return t;
+}
+
+// lo = a - b - borrow_in, *borrow = borrow out
+inline uint64_t sbb(uint64_t a, uint64_t b, uint64_t borrow_in,
+                    uint64_t* borrow) {
+  uint64_t t = a - b;
+  uint64_t br = (t > a);
+  uint64_t r = t - borrow_in;
+  br |= (r > t);
+  *borrow = br;
+  return r;
+}
+
+// c = mask ? a : b, mask is all ones or all zeros
+inline void felem_select(felem c, uint64_t mask, const felem a,
+                         const felem b) {
+  for (int i = 0; i < kLimbs; i++) c[i] = (a[i] & mask) | (b[i] & ~mask);
+}
+
+inline void felem_copy(felem c, const felem a) {
+  for (int i = 0; i < kLimbs; i++) c[i] = a[i];
+}
+
+// Reduces t (which is < 2p) given its carry limb, c = t mod p
+inline void felem_reduce_once(felem c, const uint64_t t[kLimbs],
+                              uint64_t carry) {
+  felem r;
+  uint64_t borrow = 0;
+  for (int i = 0; i < kLimbs; i++) r[i] = sbb(t[i], kP[i], borrow, &borrow);
+  // Keep t if the subtraction underflowed without a carry to absorb it
+  sbb(carry, 0, borrow, &borrow);
+  felem_select(c, 0 - borrow, t, r);
+}
+
+// c = (a + b) mod p
+void felem_add(felem c, const felem a, const felem b) {
+  uint64_t t[kLimbs];
+  uint64_t carry = 0;
+  for (int i = 0; i < kLimbs; i++) t[i] = adc(a[i], b[i], carry, &carry);
+  felem_reduce_once(c, t, carry);
+}
+
+// c = (a - b) mod p
+void felem_sub(felem c, const felem a, const felem b) {
+  uint64_t t[kLimbs];
+  uint64_t borrow = 0;
+  for (int i = 0; i < kLimbs; i++) t[i] = sbb(a[i], b[i], borrow, &borrow);
+  uint64_t mask = 0 - borrow;
+  uint64_t carry = 0;
+  for (int i = 0; i < kLimbs; i++) c[i] = adc(t[i], kP[i] & mask, carry, &carry);
+}
+
+// c = a * b * R^-1 mod p. -p^-1 mod 2^64 is 1 for P-256, so the Montgomery
+// quotient digit is simply the lowest limb of the accumulator.
+void felem_mul(felem c, const felem a, const felem b) {
+  uint64_t t[kLimbs + 2] = {0};
+
+  for (int i = 0; i < kLimbs; i++) {
+    uint64_t carry = 0;
+    for (int j = 0; j < kLimbs; j++) t[j] = mac(a[j], b[i], t[j], carry, &carry);
+    t[kLimbs] = adc(t[kLimbs], carry, 0, &t[kLimbs + 1]);
+
+    uint64_t m = t[0];
+    mac(m, kP[0], t[0], 0, &carry);
+    for (int j = 1; j < kLimbs; j++)
+      t[j - 1] = mac(m, kP[j], t[j], carry, &carry);
+    t[kLimbs - 1] = adc(t[kLimbs], carry, 0, &carry);
+    t[kLimbs] = t[kLimbs + 1] + carry;
+    t[kLimbs + 1] = 0;
+  }
+
+  felem_reduce_once(c, t, t[kLimbs]);
+}
+
+inline void felem_sqr(felem c, const felem a) { felem_mul(c, a, a); }
+
+void felem_from_words(felem c, const uint32_t* a) {
+  for (int i = 0; i < kLimbs; i++)
+    c[i] = (uint64_t)a[2 * i] | ((uint64_t)a[2 * i + 1] << 32);
+}
+
+void felem_to_words(uint32_t* c, const felem a) {
+  for (int i = 0; i < kLimbs; i++) {
+    c[2 * i] = (uint32_t)a[i];
+    c[2 * i + 1] = (uint32_t)(a[i] >> 32);
+  }
+}
+
+inline void felem_to_mont(felem c, const felem a) { felem_mul(c, a, kRR); }
+
+inline void felem_from_mont(felem c, const felem a) {
+  constexpr felem one = {1, 0, 0, 0};
+  felem_mul(c, a, one);
+}
+
+// c = a^(p-2) = a^-1 mod p, in the Montgomery domain. The exponent is public
+// so the square-and-multiply branches leak nothing about a.
+void felem_inv(felem c, const felem a) {
+  felem e;
+  felem r;
+  uint64_t borrow = 0;
+  e[0] = sbb(kP[0], 2, 0, &borrow);
+  for (int i = 1; i < kLimbs; i++) e[i] = sbb(kP[i], 0, borrow, &borrow);
+
+  felem_copy(r, a);
+  for (int bit = 254; bit >= 0; bit--) {
+    felem_sqr(r, r);
+    if ((e[bit / 64] >> (bit % 64)) & 1) felem_mul(r, r, a);
+  }
+  felem_copy(c, r);
+}
+
+typedef struct {
+  felem one;
+  felem b;
+} MontConstants;
+
+const MontConstants& mont_constants() {
+  static const MontConstants constants = [] {
+    MontConstants k;
+    constexpr felem one = {1, 0, 0, 0};
+    felem b;
+    p_256_init_curve();
+    felem_from_words(b, curve_p256.b);
+    felem_to_mont(k.one, one);
+    felem_to_mont(k.b, b);
+    return k;
+  }();
+  return constants;
+}
+
+void point_set_infinity(ProjectivePoint* q) {
+  const MontConstants& k = mont_constants();
+  memset(q->x, 0, sizeof(q->x));
+  felem_copy(q->y, k.one);
+  memset(q->z, 0, sizeof(q->z));
+}
+
+void point_from_affine(ProjectivePoint* q, const Point* p) {
+  const MontConstants& k = mont_constants();
+  felem t;
+  felem_from_words(t, p->x);
+  felem_to_mont(q->x, t);
+  felem_from_words(t, p->y);
+  felem_to_mont(q->y, t);
+  felem_copy(q->z, k.one);
+}
+
+void point_to_affine(Point* q, const ProjectivePoint* p) {
+  felem zinv;
+  felem t;
+  felem_inv(zinv, p->z);
+
+  felem_mul(t, p->x, zinv);
+  felem_from_mont(t, t);
+  felem_to_words(q->x, t);
+
+  felem_mul(t, p->y, zinv);
+  felem_from_mont(t, t);
+  felem_to_words(q->y, t);
+
+  // 1 for a finite point, 0 for the point at infinity
+  felem_mul(t, p->z, zinv);
+  felem_from_mont(t, t);
+  felem_to_words(q->z, t);
+}
+
+// r = p + q, complete for all inputs including p == q and infinity
+void point_add(ProjectivePoint* r, const ProjectivePoint* p,
+               const ProjectivePoint* q) {
+  const felem& b = mont_constants().b;
+  felem t0, t1, t2, t3, t4, x3, y3, z3;
+
+  felem_mul(t0, p->x, q->x);  // t0=X1*X2
+  felem_mul(t1, p->y, q->y);  // t1=Y1*Y2
+  felem_mul(t2, p->z, q->z);  // t2=Z1*Z2
+  felem_add(t3, p->x, p->y);  // t3=X1+Y1
+  felem_add(t4, q->x, q->y);  // t4=X2+Y2
+  felem_mul(t3, t3, t4);      // t3=t3*t4
+  felem_add(t4, t0, t1);      // t4=t0+t1
+  felem_sub(t3, t3, t4);      // t3=t3-t4
+  felem_add(t4, p->y, p->z);  // t4=Y1+Z1
+  felem_add(x3, q->y, q->z);  // X3=Y2+Z2
+  felem_mul(t4, t4, x3);      // t4=t4*X3
+  felem_add(x3, t1, t2);      // X3=t1+t2
+  felem_sub(t4, t4, x3);      // t4=t4-X3
+  felem_add(x3, p->x, p->z);  // X3=X1+Z1
+  felem_add(y3, q->x, q->z);  // Y3=X2+Z2
+  felem_mul(x3, x3, y3);      // X3=X3*Y3
+  felem_add(y3, t0, t2);      // Y3=t0+t2
+  felem_sub(y3, x3, y3);      // Y3=X3-Y3
+  felem_mul(z3, b, t2);       // Z3=b*t2
+  felem_sub(x3, y3, z3);      // X3=Y3-Z3
+  felem_add(z3, x3, x3);      // Z3=X3+X3
+  felem_add(x3, x3, z3);      // X3=X3+Z3
+  felem_sub(z3, t1, x3);      // Z3=t1-X3
+  felem_add(x3, t1, x3);      // X3=t1+X3
+  felem_mul(y3, b, y3);       // Y3=b*Y3
+  felem_add(t1, t2, t2);      // t1=t2+t2
+  felem_add(t2, t1, t2);      // t2=t1+t2
+  felem_sub(y3, y3, t2);      // Y3=Y3-t2
+  felem_sub(y3, y3, t0);      // Y3=Y3-t0
+  felem_add(t1, y3, y3);      // t1=Y3+Y3
+  felem_add(y3, t1, y3);      // Y3=t1+Y3
+  felem_add(t1, t0, t0);      // t1=t0+t0
+  felem_add(t0, t1, t0);      // t0=t1+t0
+  felem_sub(t0, t0, t2);      // t0=t0-t2
+  felem_mul(t1, t4, y3);      // t1=t4*Y3
+  felem_mul(t2, t0, y3);      // t2=t0*Y3
+  felem_mul(y3, x3, z3);      // Y3=X3*Z3
+  felem_add(y3, y3, t2);      // Y3=Y3+t2
+  felem_mul(x3, t3, x3);      // X3=t3*X3
+  felem_sub(x3, x3, t1);      // X3=X3-t1
+  felem_mul(z3, t4, z3);      // Z3=t4*Z3
+  felem_mul(t1, t3, t0);      // t1=t3*t0
+  felem_add(z3, z3, t1);      // Z3=Z3+t1
+
+  felem_copy(r->x, x3);
+  felem_copy(r->y, y3);
+  felem_copy(r->z, z3);
+}
+
+// r = 2p, complete for all inputs including infinity
+void point_double(ProjectivePoint* r, const ProjectivePoint* p) {
+  const felem& b = mont_constants().b;
+  felem t0, t1, t2, t3, x3, y3, z3;
+
+  felem_sqr(t0, p->x);        // t0=X^2
+  felem_sqr(t1, p->y);        // t1=Y^2
+  felem_sqr(t2, p->z);        // t2=Z^2
+  felem_mul(t3, p->x, p->y);  // t3=X*Y
+  felem_add(t3, t3, t3);      // t3=t3+t3
+  felem_mul(z3, p->x, p->z);  // Z3=X*Z
+  felem_add(z3, z3, z3);      // Z3=Z3+Z3
+  felem_mul(y3, b, t2);       // Y3=b*t2
+  felem_sub(y3, y3, z3);      // Y3=Y3-Z3
+  felem_add(x3, y3, y3);      // X3=Y3+Y3
+  felem_add(y3, x3, y3);      // Y3=X3+Y3
+  felem_sub(x3, t1, y3);      // X3=t1-Y3
+  felem_add(y3, t1, y3);      // Y3=t1+Y3
+  felem_mul(y3, x3, y3);      // Y3=X3*Y3
+  felem_mul(x3, x3, t3);      // X3=X3*t3
+  felem_add(t3, t2, t2);      // t3=t2+t2
+  felem_add(t2, t2, t3);      // t2=t2+t3
+  felem_mul(z3, b, z3);       // Z3=b*Z3
+  felem_sub(z3, z3, t2);      // Z3=Z3-t2
+  felem_sub(z3, z3, t0);      // Z3=Z3-t0
+  felem_add(t3, z3, z3);      // t3=Z3+Z3
+  felem_add(z3, z3, t3);      // Z3=Z3+t3
+  felem_add(t3, t0, t0);      // t3=t0+t0
+  felem_add(t0, t3, t0);      // t0=t3+t0
+  felem_sub(t0, t0, t2);      // t0=t0-t2
+  felem_mul(t0, t0, z3);      // t0=t0*Z3
+  felem_add(y3, y3, t0);      // Y3=Y3+t0
+  felem_mul(t0, p->y, p->z);  // t0=Y*Z
+  felem_add(t0, t0, t0);      // t0=t0+t0
+  felem_mul(z3, t0, z3);      // Z3=t0*Z3
+  felem_sub(x3, x3, z3);      // X3=X3-Z3
+  felem_mul(z3, t0, t1);      // Z3=t0*t1
+  felem_add(z3, z3, z3);      // Z3=Z3+Z3
+  felem_add(z3, z3, z3);      // Z3=Z3+Z3
+
+  felem_copy(r->x, x3);
+  felem_copy(r->y, y3);
+  felem_copy(r->z, z3);
+}
+
+// q = table[index], reading every entry so the access pattern is fixed
+void point_select(ProjectivePoint* q, const ProjectivePoint* table, int size,
+                  uint32_t index) {
+  memset(q, 0, sizeof(ProjectivePoint));
+  for (int i = 0; i < size; i++) {
+    uint64_t mask = (uint64_t)((uint32_t)i ^ index) - 1;
+    mask = 0 - (mask >> 63);
+    for (int j = 0; j < kLimbs; j++) {
+      q->x[j] |= table[i].x[j] & mask;
+      q->y[j] |= table[i].y[j] & mask;
+      q->z[j] |= table[i].z[j] & mask;
+    }
+  }
+}
+
+inline uint32_t scalar_bit(const uint32_t* n, int bit) {
+  if (bit >= KEY_LENGTH_DWORDS_P256 * DWORD_BITS) return 0;
+  return (n[bit >> DWORD_BITS_SHIFT] >> (bit & (DWORD_BITS - 1))) & 1;
+}
+
+typedef struct {
+  ProjectivePoint entry[kCombSize];
+} CombTable;
+
+// entry[j] = sum of 2^(t * kCombSpacing) * G over the bits t set in j
+const CombTable& comb_table() {
+  static const CombTable* table = [] {
+    CombTable* t = new CombTable;
+    ProjectivePoint base[kCombTeeth];
+
+    p_256_init_curve();
+    point_from_affine(&base[0], &curve_p256.G);
+    for (int i = 1; i < kCombTeeth; i++) {
+      base[i] = base[i - 1];
+      for (int j = 0; j < kCombSpacing; j++) point_double(&base[i], &base[i]);
+    }
+
+    point_set_infinity(&t->entry[0]);
+    for (int j = 1; j < kCombSize; j++) {
+      int top = 31 - __builtin_clz(j);
+      point_add(&t->entry[j], &t->entry[j ^ (1 << top)], &base[top]);
+    }
+    return t;
+  }();
+  return *table;
+}
+
+}  // namespace
+
+// Fixed-window scalar multiplication, q = n * p
+void ECC_PointMult_Mont(Point* q, const Point* p, const uint32_t* n) {
+  ProjectivePoint table[kWindowSize];
+  ProjectivePoint r;
+  ProjectivePoint t;
+
+  point_set_infinity(&table[0]);
+  point_from_affine(&table[1], p);
+  for (int i = 2; i < kWindowSize; i++)
+    point_add(&table[i], &table[i - 1], &table[1]);
+
+  point_set_infinity(&r);
+  for (int i = KEY_LENGTH_DWORDS_P256 * DWORD_BITS - kWindowBits; i >= 0;
+       i -= kWindowBits) {
+    for (int j = 0; j < kWindowBits; j++) point_double(&r, &r);
+
+    uint32_t window = (n[i >> DWORD_BITS_SHIFT] >> (i & (DWORD_BITS - 1))) &
+                      (kWindowSize - 1);
+    point_select(&t, table, kWindowSize, window);
+    point_add(&r, &r, &t);
+  }
+
+  point_to_affine(q, &r);
+}
+
+// Comb scalar multiplication of the generator, q = n * G
+void ECC_PointMultBase(Point* q, const uint32_t* n) {
+  const CombTable& comb = comb_table();
+  ProjectivePoint r;
+  ProjectivePoint t;
+
+  point_set_infinity(&r);
+  for (int i = kCombSpacing - 1; i >= 0; i--) {
+    point_double(&r, &r);
+
+    uint32_t index = 0;
+    for (int j = 0; j < kCombTeeth; j++)
+      index |= scalar_bit(n, j * kCombSpacing + i) << j;
+    point_select(&t, comb.entry, kCombSize, index);
+    point_add(&r, &r, &t);
+  }
+
+  point_to_affine(q, &r);
+}
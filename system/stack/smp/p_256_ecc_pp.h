@@ -60,6 +60,14 @@ bool ECC_ValidatePoint(const Point& p);
 
 void ECC_PointMult_Bin_NAF(Point* q, Point* p, uint32_t* n);
 
-#define ECC_PointMult(q, p, n) ECC_PointMult_Bin_NAF(q, p, n)
+// Constant-time q = n * p using 64-bit Montgomery field arithmetic.
+// p is affine, n is little endian 32-bit words. Unlike
+// ECC_PointMult_Bin_NAF neither p nor n is modified.
+void ECC_PointMult_Mont(Point* q, const Point* p, const uint32_t* n);
+
+// Constant-time q = n * G using a precomputed comb table for the generator.
+void ECC_PointMultBase(Point* q, const uint32_t* n);
+
+#define ECC_PointMult(q, p, n) ECC_PointMult_Mont(q, p, n)
 
 void p_256_init_curve();
@@ -38,8 +38,11 @@
 #include "stack/btm/security_device_record.h"
 #include "stack/include/acl_api.h"
 #include "stack/include/acl_hci_link_interface.h"
+#include "stack/include/bt_types.h"
+#include "stack/include/btm_api.h"
 #include "stack/include/btm_client_interface.h"
 #include "stack/include/hcidefs.h"
+#include "stack/include/inq_hci_link_interface.h"
 #include "stack/include/sec_hci_link_interface.h"
 #include "stack/l2cap/l2c_int.h"
 #include "test/mock/mock_osi_list.h"
@@ -394,3 +397,117 @@ TEST_F(StackBtmWithInitFreeTest, BTM_SetEncryption) {
 
   wipe_secrets_and_remove(device_record);
 }
+
+class BtmInqDbTest : public StackBtmWithInitFreeTest {
+ protected:
+  void SetUp() override {
+    StackBtmWithInitFreeTest::SetUp();
+    ASSERT_EQ(BTM_SUCCESS, BTM_ClearInqDb(nullptr));
+    tBTM_INQUIRY_VAR_ST* p_inq = &btm_cb.btm_inq_vars;
+    p_inq->p_bd_db = (tINQ_BDADDR*)osi_calloc(BT_DEFAULT_BUFFER_SIZE);
+    p_inq->max_bd_entries =
+        (uint16_t)(BT_DEFAULT_BUFFER_SIZE / sizeof(tINQ_BDADDR));
+    p_inq->inq_active = BTM_GENERAL_INQUIRY_ACTIVE;
+    p_inq->p_inq_results_cb = [](tBTM_INQ_RESULTS* p_inq_results,
+                                 const uint8_t* p_eir, uint16_t eir_len) {
+      num_results_++;
+    };
+    num_results_ = 0;
+  }
+
+  void TearDown() override {
+    btm_cb.btm_inq_vars.inq_active = BTM_INQUIRY_INACTIVE;
+    osi_free_and_reset((void**)&btm_cb.btm_inq_vars.p_bd_db);
+    BTM_ClearInqDb(nullptr);
+    StackBtmWithInitFreeTest::TearDown();
+  }
+
+  static RawAddress DeviceAddress(uint16_t device) {
+    return RawAddress({0xC0, 0x00, 0x00, 0x00, (uint8_t)(device >> 8),
+                       (uint8_t)device});
+  }
+
+  void InquiryResult(const RawAddress& bd_addr) {
+    uint8_t event[1 + 14] = {};
+    uint8_t* p = event;
+    UINT8_TO_STREAM(p, 1);
+    BDADDR_TO_STREAM(p, bd_addr);
+    btm_process_inq_results(event, sizeof(event), BTM_INQ_RESULT_STANDARD);
+  }
+
+  void ExtendedInquiryResult(const RawAddress& bd_addr, uint8_t rssi,
+                             const std::vector<uint8_t>& eir) {
+    uint8_t event[1 + 14 + HCI_EXT_INQ_RESPONSE_LEN] = {};
+    uint8_t* p = event;
+    UINT8_TO_STREAM(p, 1);
+    BDADDR_TO_STREAM(p, bd_addr);
+    p += 1 + 1 + DEV_CLASS_LEN + 2;
+    UINT8_TO_STREAM(p, rssi);
+    ARRAY_TO_STREAM(p, eir.data(), (int)eir.size());
+    btm_process_inq_results(event, sizeof(event), BTM_INQ_RESULT_EXTENDED);
+  }
+
+  static int num_results_;
+};
+
+int BtmInqDbTest::num_results_ = 0;
+
+TEST_F(BtmInqDbTest, full_database_recycles_least_recently_heard_entry) {
+  for (uint16_t i = 0; i < BTM_INQ_DB_SIZE; i++) {
+    InquiryResult(DeviceAddress(i));
+  }
+  ASSERT_EQ(BTM_INQ_DB_SIZE, num_results_);
+
+  // Device 0 is heard again and device 1 is only read, so device 1 is the
+  // least recently heard one
+  InquiryResult(DeviceAddress(0));
+  ASSERT_NE(nullptr, BTM_InqDbRead(DeviceAddress(1)));
+  InquiryResult(DeviceAddress(BTM_INQ_DB_SIZE));
+
+  ASSERT_NE(nullptr, BTM_InqDbRead(DeviceAddress(0)));
+  ASSERT_EQ(nullptr, BTM_InqDbRead(DeviceAddress(1)));
+  for (uint16_t i = 2; i <= BTM_INQ_DB_SIZE; i++) {
+    tBTM_INQ_INFO* p_info = BTM_InqDbRead(DeviceAddress(i));
+    ASSERT_NE(nullptr, p_info);
+    ASSERT_EQ(DeviceAddress(i), p_info->results.remote_bd_addr);
+  }
+
+  int num_entries = 0;
+  for (tBTM_INQ_INFO* p_info = BTM_InqDbFirst(); p_info != nullptr;
+       p_info = BTM_InqDbNext(p_info)) {
+    num_entries++;
+  }
+  ASSERT_EQ(BTM_INQ_DB_SIZE, num_entries);
+}
+
+TEST_F(BtmInqDbTest, entries_released_by_reset_are_not_found) {
+  InquiryResult(DeviceAddress(0));
+
+  // The database is wiped without going through the index, the entries of
+  // new devices take the slot device 0 used to have
+  memset(btm_cb.btm_inq_vars.inq_db, 0, sizeof(btm_cb.btm_inq_vars.inq_db));
+  for (uint16_t i = 1; i <= BTM_INQ_DB_SIZE + 1; i++) {
+    InquiryResult(DeviceAddress(i));
+  }
+
+  ASSERT_EQ(nullptr, BTM_InqDbRead(DeviceAddress(0)));
+  ASSERT_EQ(nullptr, BTM_InqDbRead(DeviceAddress(1)));
+  for (uint16_t i = 2; i <= BTM_INQ_DB_SIZE + 1; i++) {
+    ASSERT_NE(nullptr, BTM_InqDbRead(DeviceAddress(i)));
+  }
+}
+
+TEST_F(BtmInqDbTest, repeated_extended_inquiry_result_is_reported_once) {
+  std::vector<uint8_t> eir = {0x05, 0x09, 'T', 'e', 's', 't'};
+  ExtendedInquiryResult(DeviceAddress(0), 0xC0, eir);
+  ExtendedInquiryResult(DeviceAddress(0), 0xC0, eir);
+  ASSERT_EQ(1, num_results_);
+
+  // A stronger signal is still reported
+  ExtendedInquiryResult(DeviceAddress(0), 0xC8, eir);
+  ASSERT_EQ(2, num_results_);
+
+  eir = {0x05, 0x09, 'N', 'a', 'm', 'e'};
+  ExtendedInquiryResult(DeviceAddress(0), 0xC0, eir);
+  ASSERT_EQ(3, num_results_);
+}
@@ -18,6 +18,7 @@
 
 #include "common/init_flags.h"
 #include "internal_include/bt_trace.h"
+#include "osi/include/allocator.h"
 #include "stack/btm/btm_int_types.h"
 #include "stack/include/l2cap_hci_link_interface.h"
 #include "stack/l2cap/l2c_int.h"
@@ -65,3 +66,97 @@ TEST_F(StackL2capTest, l2cble_process_data_length_change_event) {
   l2cble_process_data_length_change_event(0x1234, 0x001b, 0x001b);
   ASSERT_EQ(0x001b, l2cb.lcb_pool[0].tx_data_len);
 }
+
+TEST_F(StackL2capTest, l2cu_find_lcb_by_handle) {
+  l2cb.lcb_pool[0].in_use = true;
+  l2cb.lcb_pool[1].in_use = true;
+  l2cu_set_lcb_handle(l2cb.lcb_pool[0], 0x0001);
+  l2cu_set_lcb_handle(l2cb.lcb_pool[1], 0x0eff);
+
+  ASSERT_EQ(&l2cb.lcb_pool[0], l2cu_find_lcb_by_handle(0x0001));
+  ASSERT_EQ(&l2cb.lcb_pool[1], l2cu_find_lcb_by_handle(0x0eff));
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0002));
+
+  // Released links are not found even though they keep their handle
+  l2cb.lcb_pool[1].in_use = false;
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0eff));
+
+  // Reassigning the handle to another link updates the table
+  l2cb.lcb_pool[2].in_use = true;
+  l2cu_set_lcb_handle(l2cb.lcb_pool[2], 0x0eff);
+  ASSERT_EQ(&l2cb.lcb_pool[2], l2cu_find_lcb_by_handle(0x0eff));
+
+  l2cu_invalidate_lcb_handle(l2cb.lcb_pool[0]);
+  ASSERT_EQ(HCI_INVALID_HANDLE, l2cb.lcb_pool[0].Handle());
+  ASSERT_EQ(nullptr, l2cu_find_lcb_by_handle(0x0001));
+}
+
+TEST_F(StackL2capTest, l2cu_find_ccb_by_remote_cid) {
+  tL2C_LCB* p_lcb_a = &l2cb.lcb_pool[0];
+  tL2C_LCB* p_lcb_b = &l2cb.lcb_pool[1];
+  p_lcb_a->in_use = true;
+  p_lcb_b->in_use = true;
+
+  // Same remote CID on two links, plus enough channels to share buckets
+  for (int i = 0; i < MAX_L2CAP_CHANNELS; i++) {
+    tL2C_CCB* p_ccb = &l2cb.ccb_pool[i];
+    p_ccb->in_use = true;
+    p_ccb->p_lcb = (i % 2) ? p_lcb_b : p_lcb_a;
+    l2cu_set_ccb_remote_cid(p_ccb, L2CAP_BASE_APPL_CID + i / 2);
+  }
+
+  for (int i = 0; i < MAX_L2CAP_CHANNELS; i++) {
+    tL2C_CCB* p_ccb = &l2cb.ccb_pool[i];
+    ASSERT_EQ(p_ccb, l2cu_find_ccb_by_remote_cid(p_ccb->p_lcb,
+                                                 L2CAP_BASE_APPL_CID + i / 2));
+  }
+  ASSERT_EQ(nullptr, l2cu_find_ccb_by_remote_cid(p_lcb_a, 0x0001));
+  ASSERT_EQ(nullptr,
+            l2cu_find_ccb_by_remote_cid(nullptr, L2CAP_BASE_APPL_CID));
+
+  // Changing and clearing the remote CID updates the index
+  tL2C_CCB* p_ccb = &l2cb.ccb_pool[0];
+  l2cu_set_ccb_remote_cid(p_ccb, 0x7fff);
+  ASSERT_EQ(p_ccb, l2cu_find_ccb_by_remote_cid(p_lcb_a, 0x7fff));
+  ASSERT_EQ(nullptr, l2cu_find_ccb_by_remote_cid(p_lcb_a, L2CAP_BASE_APPL_CID));
+
+  l2cu_set_ccb_remote_cid(p_ccb, 0);
+  ASSERT_EQ(nullptr, l2cu_find_ccb_by_remote_cid(p_lcb_a, 0x7fff));
+  ASSERT_EQ(&l2cb.ccb_pool[2],
+            l2cu_find_ccb_by_remote_cid(p_lcb_a, L2CAP_BASE_APPL_CID + 1));
+}
+
+TEST_F(StackL2capTest, l2c_fcr_buf_q) {
+  tL2C_FCR_BUF_Q q = {};
+  ASSERT_EQ(nullptr, l2c_fcr_buf_q_dequeue(&q));
+  ASSERT_EQ(nullptr, l2c_fcr_buf_q_peek_last(&q));
+
+  // Offset the ring head so that growing has to unwrap it
+  for (int i = 0; i < 10; i++) {
+    l2c_fcr_buf_q_enqueue(&q, (BT_HDR*)osi_calloc(sizeof(BT_HDR)));
+    osi_free(l2c_fcr_buf_q_dequeue(&q));
+  }
+
+  const int kNumBufs = 3 * L2C_FCR_BUF_Q_INIT_SIZE;
+  for (int i = 0; i < kNumBufs; i++) {
+    BT_HDR* p_buf = (BT_HDR*)osi_calloc(sizeof(BT_HDR));
+    p_buf->layer_specific = i;
+    l2c_fcr_buf_q_enqueue(&q, p_buf);
+    ASSERT_EQ(i, l2c_fcr_buf_q_peek_last(&q)->layer_specific);
+  }
+  ASSERT_EQ(kNumBufs, q.count);
+
+  for (int i = 0; i < kNumBufs; i++) {
+    ASSERT_EQ(i, l2c_fcr_buf_q_at(&q, i)->layer_specific);
+  }
+  ASSERT_EQ(nullptr, l2c_fcr_buf_q_at(&q, kNumBufs));
+
+  BT_HDR* p_buf = l2c_fcr_buf_q_dequeue(&q);
+  ASSERT_EQ(0, p_buf->layer_specific);
+  osi_free(p_buf);
+  ASSERT_EQ(1, l2c_fcr_buf_q_at(&q, 0)->layer_specific);
+
+  l2c_fcr_buf_q_free(&q);
+  ASSERT_EQ(0, q.count);
+  ASSERT_EQ(nullptr, q.p_bufs);
+}
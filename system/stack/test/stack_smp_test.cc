@@ -409,4 +409,91 @@ TEST(SmpEccValidationTest, test_invalid_points) {
 
   EXPECT_FALSE(ECC_ValidatePoint(p));
 }
+
+// Test data from Bluetooth Core Specification
+// Version 5.0 | Vol 2, Part G | 7.1.2, Sample 1
+static const uint32_t kSample1PrivateA[KEY_LENGTH_DWORDS_P256] = {
+    0xcd3c1abd, 0x5899b8a6, 0xeb40b799, 0x4aff607b,
+    0xd2103f50, 0x74c9b3e3, 0xa3c55f38, 0x3f49f6d4};
+static const uint32_t kSample1PublicAX[KEY_LENGTH_DWORDS_P256] = {
+    0x0e359de6, 0xcc030148, 0xacf4fddb, 0xeff49111,
+    0xe9f9a5b9, 0x5e2c83a7, 0xf297be2c, 0x20b003d2};
+static const uint32_t kSample1PublicAY[KEY_LENGTH_DWORDS_P256] = {
+    0x1589d28b, 0x741c8ed0, 0x8fed3024, 0x766345c2,
+    0x5a52155c, 0x63329abf, 0x652aeb6d, 0xdc809c49};
+static const uint32_t kSample1PrivateB[KEY_LENGTH_DWORDS_P256] = {
+    0xf47fc5fd, 0x6b4fdd49, 0xf19d7cfb, 0x59cb9ac2,
+    0xeed4e72a, 0x900afcfb, 0x32f6bb9a, 0x55188b3d};
+static const uint32_t kSample1PublicBX[KEY_LENGTH_DWORDS_P256] = {
+    0x2faaa190, 0x559077b2, 0x8615a69f, 0x47b58afd,
+    0xf19e4c00, 0x09592284, 0x1faf1d96, 0x1ea1f0f0};
+static const uint32_t kSample1PublicBY[KEY_LENGTH_DWORDS_P256] = {
+    0x15b1214a, 0x5f89aff9, 0xe28e3676, 0x472d1130,
+    0x9ab85160, 0x7356703a, 0x429dad37, 0x4c55f33e};
+static const uint32_t kSample1DHKey[KEY_LENGTH_DWORDS_P256] = {
+    0x73bfa698, 0x868d34f3, 0xb4f866f1, 0x99796b13,
+    0x0a397d9b, 0x341010a6, 0x57c8ad05, 0xec0234a3};
+
+TEST(SmpEccMontTest, test_public_key_generation) {
+  p_256_init_curve();
+  Point public_key;
+
+  ECC_PointMultBase(&public_key, kSample1PrivateA);
+  EXPECT_EQ(0, memcmp(public_key.x, kSample1PublicAX, BT_OCTET32_LEN));
+  EXPECT_EQ(0, memcmp(public_key.y, kSample1PublicAY, BT_OCTET32_LEN));
+  EXPECT_TRUE(ECC_ValidatePoint(public_key));
+
+  ECC_PointMult(&public_key, &curve_p256.G, kSample1PrivateB);
+  EXPECT_EQ(0, memcmp(public_key.x, kSample1PublicBX, BT_OCTET32_LEN));
+  EXPECT_EQ(0, memcmp(public_key.y, kSample1PublicBY, BT_OCTET32_LEN));
+  EXPECT_TRUE(ECC_ValidatePoint(public_key));
+}
+
+TEST(SmpEccMontTest, test_dhkey_computation) {
+  p_256_init_curve();
+  Point peer_key;
+  Point dhkey;
+
+  memcpy(peer_key.x, kSample1PublicBX, BT_OCTET32_LEN);
+  memcpy(peer_key.y, kSample1PublicBY, BT_OCTET32_LEN);
+  ECC_PointMult(&dhkey, &peer_key, kSample1PrivateA);
+  EXPECT_EQ(0, memcmp(dhkey.x, kSample1DHKey, BT_OCTET32_LEN));
+
+  memcpy(peer_key.x, kSample1PublicAX, BT_OCTET32_LEN);
+  memcpy(peer_key.y, kSample1PublicAY, BT_OCTET32_LEN);
+  ECC_PointMult(&dhkey, &peer_key, kSample1PrivateB);
+  EXPECT_EQ(0, memcmp(dhkey.x, kSample1DHKey, BT_OCTET32_LEN));
+}
+
+// The constant-time implementation must agree with the reference NAF one
+TEST(SmpEccMontTest, test_matches_bin_naf) {
+  p_256_init_curve();
+  uint32_t seed = 0x12345678;
+
+  for (int i = 0; i < 32; i++) {
+    uint32_t private_key[KEY_LENGTH_DWORDS_P256];
+    uint32_t private_key_copy[KEY_LENGTH_DWORDS_P256];
+    for (uint32_t& word : private_key) {
+      seed = seed * 1103515245 + 12345;
+      word = seed;
+    }
+    // Keep the scalar below the group order
+    private_key[KEY_LENGTH_DWORDS_P256 - 1] &= 0x7fffffff;
+
+    Point base = curve_p256.G;
+    Point expected;
+    Point public_key;
+    Point public_key_comb;
+    memcpy(private_key_copy, private_key, BT_OCTET32_LEN);
+    ECC_PointMult_Bin_NAF(&expected, &base, private_key_copy);
+    ECC_PointMult_Mont(&public_key, &curve_p256.G, private_key);
+    ECC_PointMultBase(&public_key_comb, private_key);
+
+    EXPECT_EQ(0, memcmp(expected.x, public_key.x, BT_OCTET32_LEN));
+    EXPECT_EQ(0, memcmp(expected.y, public_key.y, BT_OCTET32_LEN));
+    EXPECT_EQ(0, memcmp(expected.x, public_key_comb.x, BT_OCTET32_LEN));
+    EXPECT_EQ(0, memcmp(expected.y, public_key_comb.y, BT_OCTET32_LEN));
+    EXPECT_TRUE(ECC_ValidatePoint(public_key));
+  }
+}
 }  // namespace testing
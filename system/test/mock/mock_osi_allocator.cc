@@ -66,6 +66,15 @@ void* osi_malloc(size_t size) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_allocator::osi_malloc(size);
 }
+// Pooled allocations share the state of their unpooled counterparts
+void* osi_pool_calloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_allocator::osi_calloc(size);
+}
+void* osi_pool_malloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_allocator::osi_malloc(size);
+}
 char* osi_strdup(const char* str) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_allocator::osi_strdup(str);
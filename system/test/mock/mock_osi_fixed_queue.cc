@@ -45,7 +45,6 @@ struct fixed_queue_flush fixed_queue_flush;
 struct fixed_queue_free fixed_queue_free;
 struct fixed_queue_get_dequeue_fd fixed_queue_get_dequeue_fd;
 struct fixed_queue_get_enqueue_fd fixed_queue_get_enqueue_fd;
-struct fixed_queue_get_list fixed_queue_get_list;
 struct fixed_queue_is_empty fixed_queue_is_empty;
 struct fixed_queue_length fixed_queue_length;
 struct fixed_queue_new fixed_queue_new;
@@ -54,6 +53,7 @@ struct fixed_queue_try_dequeue fixed_queue_try_dequeue;
 struct fixed_queue_try_enqueue fixed_queue_try_enqueue;
 struct fixed_queue_try_peek_first fixed_queue_try_peek_first;
 struct fixed_queue_try_peek_last fixed_queue_try_peek_last;
+struct fixed_queue_try_peek_at fixed_queue_try_peek_at;
 struct fixed_queue_try_remove_from_queue fixed_queue_try_remove_from_queue;
 struct fixed_queue_unregister_dequeue fixed_queue_unregister_dequeue;
 
@@ -90,10 +90,6 @@ int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_fixed_queue::fixed_queue_get_enqueue_fd(queue);
 }
-list_t* fixed_queue_get_list(fixed_queue_t* queue) {
-  mock_function_count_map[__func__]++;
-  return test::mock::osi_fixed_queue::fixed_queue_get_list(queue);
-}
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_fixed_queue::fixed_queue_is_empty(queue);
@@ -128,6 +124,10 @@ void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_fixed_queue::fixed_queue_try_peek_last(queue);
 }
+void* fixed_queue_try_peek_at(fixed_queue_t* queue, size_t index) {
+  mock_function_count_map[__func__]++;
+  return test::mock::osi_fixed_queue::fixed_queue_try_peek_at(queue, index);
+}
 void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
   mock_function_count_map[__func__]++;
   return test::mock::osi_fixed_queue::fixed_queue_try_remove_from_queue(queue,
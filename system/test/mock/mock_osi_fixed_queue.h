@@ -132,17 +132,6 @@ struct fixed_queue_get_enqueue_fd {
 };
 extern struct fixed_queue_get_enqueue_fd fixed_queue_get_enqueue_fd;
 
-// Name: fixed_queue_get_list
-// Params: fixed_queue_t* queue
-// Return: list_t*
-struct fixed_queue_get_list {
-  list_t* return_value{0};
-  std::function<list_t*(fixed_queue_t* queue)> body{
-      [this](fixed_queue_t* queue) { return return_value; }};
-  list_t* operator()(fixed_queue_t* queue) { return body(queue); };
-};
-extern struct fixed_queue_get_list fixed_queue_get_list;
-
 // Name: fixed_queue_is_empty
 // Params: fixed_queue_t* queue
 // Return: bool
@@ -237,6 +226,19 @@ struct fixed_queue_try_peek_last {
 };
 extern struct fixed_queue_try_peek_last fixed_queue_try_peek_last;
 
+// Name: fixed_queue_try_peek_at
+// Params: fixed_queue_t* queue, size_t index
+// Return: void*
+struct fixed_queue_try_peek_at {
+  void* return_value{};
+  std::function<void*(fixed_queue_t* queue, size_t index)> body{
+      [this](fixed_queue_t* queue, size_t index) { return return_value; }};
+  void* operator()(fixed_queue_t* queue, size_t index) {
+    return body(queue, index);
+  };
+};
+extern struct fixed_queue_try_peek_at fixed_queue_try_peek_at;
+
 // Name: fixed_queue_try_remove_from_queue
 // Params: fixed_queue_t* queue, void* data
 // Return: void*
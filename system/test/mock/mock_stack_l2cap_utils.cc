@@ -98,6 +98,9 @@ tL2C_LCB* l2cu_find_lcb_by_handle(uint16_t handle) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void l2cu_invalidate_lcb_handle(tL2C_LCB& p_lcb) {
+  mock_function_count_map[__func__]++;
+}
 tL2C_LCB* l2cu_find_lcb_by_state(tL2C_LINK_STATE state) {
   mock_function_count_map[__func__]++;
   return nullptr;
@@ -273,6 +276,9 @@ void l2cu_send_peer_info_rsp(tL2C_LCB* p_lcb, uint8_t remote_id,
 void l2cu_set_acl_hci_header(BT_HDR* p_buf, tL2C_CCB* p_ccb) {
   mock_function_count_map[__func__]++;
 }
+void l2cu_set_ccb_remote_cid(tL2C_CCB* p_ccb, uint16_t remote_cid) {
+  mock_function_count_map[__func__]++;
+}
 void l2cu_set_lcb_handle(struct t_l2c_linkcb& p_lcb, uint16_t handle) {
   mock_function_count_map[__func__]++;
 }
@@ -8,6 +8,12 @@
 #   $ ./test/run_benchmarks.sh bluetooth_benchmark_example
 
 known_benchmarks=(
+  bluetooth_benchmark_a2dp_buffers
+  bluetooth_benchmark_btif_sock
+  bluetooth_benchmark_btif_sock_thread
+  bluetooth_benchmark_l2cap_dispatch
+  bluetooth_benchmark_l2cap_fcr
+  bluetooth_benchmark_smp_p256
   bluetooth_benchmark_thread_performance
   bluetooth_benchmark_timer_performance
 )
@@ -309,6 +309,14 @@ void* osi_malloc(size_t size) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void* osi_pool_calloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
+void* osi_pool_malloc(size_t size) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
 
 bool fixed_queue_is_empty(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
@@ -330,10 +338,6 @@ int fixed_queue_get_enqueue_fd(const fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return 0;
 }
-list_t* fixed_queue_get_list(fixed_queue_t* queue) {
-  mock_function_count_map[__func__]++;
-  return nullptr;
-}
 size_t fixed_queue_capacity(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return 0;
@@ -374,6 +378,10 @@ void* fixed_queue_try_peek_last(fixed_queue_t* queue) {
   mock_function_count_map[__func__]++;
   return nullptr;
 }
+void* fixed_queue_try_peek_at(fixed_queue_t* queue, size_t index) {
+  mock_function_count_map[__func__]++;
+  return nullptr;
+}
 void* fixed_queue_try_remove_from_queue(fixed_queue_t* queue, void* data) {
   mock_function_count_map[__func__]++;
   return nullptr;
@@ -17,9 +17,13 @@
 #include <gflags/gflags.h>
 #include <unwindstack/AndroidUnwinder.h>
 
+#include <cinttypes>
+#include <cstdlib>
 #include <future>
 #include <optional>
+#include <random>
 
+#include "model/controller/dual_mode_controller.h"
 #include "model/setup/async_manager.h"
 #include "net/posix/posix_async_socket_connector.h"
 #include "net/posix/posix_async_socket_server.h"
@@ -30,6 +34,7 @@ using ::android::bluetooth::root_canal::TestEnvironment;
 using ::android::net::PosixAsyncSocketConnector;
 using ::android::net::PosixAsyncSocketServer;
 using rootcanal::AsyncManager;
+using rootcanal::DualModeController;
 
 DEFINE_string(controller_properties_file, "",
               "controller_properties.json file path");
@@ -37,6 +42,12 @@ DEFINE_string(default_commands_file, "",
               "commands file which root-canal runs it as default");
 DEFINE_bool(enable_hci_sniffer, false, "enable hci sniffer");
 DEFINE_bool(enable_baseband_sniffer, false, "enable baseband sniffer");
+DEFINE_bool(virtual_time, false,
+            "run in virtual time, advanced with the advance_time command");
+DEFINE_uint64(seed, 0, "random seed, 0 picks a random one");
+DEFINE_uint32(link_layer_shards, 0,
+              "run the devices on this many threads, 0 keeps them on the "
+              "event thread");
 
 constexpr uint16_t kTestPort = 6401;
 constexpr uint16_t kHciServerPort = 6402;
@@ -116,6 +127,14 @@ int main(int argc, char** argv) {
       }
     }
   }
+  uint64_t seed = FLAGS_seed;
+  if (seed == 0) {
+    seed = std::random_device{}();
+  }
+  LOG_INFO("Random seed: %" PRIu64, seed);
+  std::srand(static_cast<unsigned>(seed));
+  DualModeController::SetRandomSeed(seed);
+
   AsyncManager am;
   TestEnvironment root_canal(
       std::make_shared<PosixAsyncSocketServer>(test_port, &am),
@@ -124,7 +143,8 @@ int main(int argc, char** argv) {
       std::make_shared<PosixAsyncSocketServer>(link_ble_server_port, &am),
       std::make_shared<PosixAsyncSocketConnector>(&am),
       FLAGS_controller_properties_file, FLAGS_default_commands_file,
-      FLAGS_enable_hci_sniffer, FLAGS_enable_baseband_sniffer);
+      FLAGS_enable_hci_sniffer, FLAGS_enable_baseband_sniffer,
+      FLAGS_virtual_time, FLAGS_link_layer_shards);
   std::promise<void> barrier;
   std::future<void> barrier_future = barrier.get_future();
   root_canal.initialize(std::move(barrier));
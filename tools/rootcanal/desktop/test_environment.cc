@@ -46,6 +46,21 @@ void TestEnvironment::initialize(std::promise<void> barrier) {
 
   barrier_ = std::move(barrier);
 
+  // Before any task is scheduled, the timer tick included
+  if (enable_virtual_time_) {
+    LOG_INFO("Running in virtual time");
+    async_manager_.EnableVirtualTime();
+  }
+  // Before any device is added
+  if (link_layer_shards_ > 0) {
+    test_model_.EnableShards(link_layer_shards_, enable_virtual_time_);
+  }
+  test_channel_.RegisterAdvanceTime(
+      [this](std::chrono::milliseconds duration,
+             const std::function<void()>& on_reached) {
+        return async_manager_.AdvanceVirtualTime(duration, on_reached);
+      });
+
   auto user_id = async_manager_.GetNextUserId();
   test_channel_transport_.RegisterCommandHandler(
       [this, user_id](const std::string& name,
@@ -56,7 +56,9 @@ class TestEnvironment {
                   const std::string& controller_properties_file = "",
                   const std::string& default_commands_file = "",
                   bool enable_hci_sniffer = false,
-                  bool enable_baseband_sniffer = false)
+                  bool enable_baseband_sniffer = false,
+                  bool enable_virtual_time = false,
+                  size_t link_layer_shards = 0)
       : test_socket_server_(test_port),
         hci_socket_server_(hci_server_port),
         link_socket_server_(link_server_port),
@@ -66,6 +68,8 @@ class TestEnvironment {
         default_commands_file_(default_commands_file),
         enable_hci_sniffer_(enable_hci_sniffer),
         enable_baseband_sniffer_(enable_baseband_sniffer),
+        enable_virtual_time_(enable_virtual_time),
+        link_layer_shards_(link_layer_shards),
         controller_(std::make_shared<rootcanal::DualModeController>(
             controller_properties_file)) {}
 
@@ -84,6 +88,8 @@ class TestEnvironment {
   std::string default_commands_file_;
   bool enable_hci_sniffer_;
   bool enable_baseband_sniffer_;
+  bool enable_virtual_time_;
+  size_t link_layer_shards_;
   bool test_channel_open_{false};
   std::promise<void> barrier_;
 
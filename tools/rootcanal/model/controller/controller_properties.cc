@@ -295,6 +295,13 @@ ControllerProperties::ControllerProperties(const std::string& file_name)
   ParseUint(root, "lmp_subversion", lmp_subversion);
   ParseUint(root, "company_identifier", company_identifier);
 
+  ParseUint(root, "num_hci_command_packets", num_hci_command_packets);
+  if (num_hci_command_packets == 0) {
+    // The host would never be allowed to send a command
+    LOG_WARN("Invalid num_hci_command_packets 0, using 1 instead");
+    num_hci_command_packets = 1;
+  }
+
   ParseUintArray(root, "supported_commands", supported_commands);
   ParseUintArray(root, "lmp_features", lmp_features);
   ParseUint(root, "le_features", le_features);
@@ -54,6 +54,11 @@ struct ControllerProperties {
   uint16_t lmp_subversion{0};
   uint16_t company_identifier{0x00E0};  // Google
 
+  // Num_HCI_Command_Packets returned in the Command Complete and Command
+  // Status events (Vol 4, Part E § 7.7.14): the number of commands the host
+  // may send without waiting for their completion.
+  uint8_t num_hci_command_packets{1};
+
   // Local Supported Commands (Vol 4, Part E § 7.4.2).
   std::array<uint8_t, 64> supported_commands;
 
@@ -17,6 +17,7 @@
 #include "dual_mode_controller.h"
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <random>
 
@@ -33,11 +34,16 @@ using std::vector;
 namespace rootcanal {
 constexpr char DualModeController::kControllerPropertiesFile[];
 constexpr uint16_t DualModeController::kSecurityManagerNumKeys;
-constexpr uint16_t kNumCommandPackets = 0x01;
 constexpr uint16_t kLeMaximumAdvertisingDataLength = 256;
 constexpr uint16_t kLeMaximumDataLength = 64;
 constexpr uint16_t kLeMaximumDataTime = 0x148;
 
+// Seed of the LE Rand generators, and the number of controllers seeded from it
+// so far. Each controller mixes its index into the seed, so that controllers
+// draw different numbers, reproducibly for a given seed.
+static std::atomic_uint64_t random_seed{std::random_device{}()};
+static std::atomic_uint64_t num_seeded_controllers{0};
+
 // Device methods.
 std::string DualModeController::GetTypeString() const {
   return "Simulated Bluetooth Controller";
@@ -59,7 +65,7 @@ void DualModeController::SendCommandCompleteUnknownOpCodeEvent(
     uint16_t command_opcode) const {
   std::unique_ptr<bluetooth::packet::RawBuilder> raw_builder_ptr =
       std::make_unique<bluetooth::packet::RawBuilder>();
-  raw_builder_ptr->AddOctets1(kNumCommandPackets);
+  raw_builder_ptr->AddOctets1(properties_.num_hci_command_packets);
   raw_builder_ptr->AddOctets2(command_opcode);
   raw_builder_ptr->AddOctets1(
       static_cast<uint8_t>(ErrorCode::UNKNOWN_HCI_COMMAND));
@@ -79,6 +85,12 @@ DualModeController::DualModeController(const std::string& properties_filename,
 #endif
   loopback_mode_ = LoopbackMode::NO_LOOPBACK;
 
+  // std::seed_seq keeps the low 32 bits of each value
+  uint64_t random_seed_value = random_seed.load();
+  std::seed_seq seed{random_seed_value, random_seed_value >> 32,
+                     num_seeded_controllers.fetch_add(1)};
+  random_generator_.seed(seed);
+
   Address public_address{};
   ASSERT(Address::FromString("3C:5A:B4:04:05:06", public_address));
   SetAddress(public_address);
@@ -326,7 +338,7 @@ void DualModeController::SniffSubrating(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(gd_hci::SniffSubratingCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       command_view.GetConnectionHandle()));
 }
 
@@ -494,8 +506,8 @@ void DualModeController::Reset(CommandView command) {
     loopback_mode_ = LoopbackMode::NO_LOOPBACK;
   }
 
-  send_event_(bluetooth::hci::ResetCompleteBuilder::Create(kNumCommandPackets,
-                                                           ErrorCode::SUCCESS));
+  send_event_(bluetooth::hci::ResetCompleteBuilder::Create(
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadBufferSize(CommandView command) {
@@ -503,7 +515,7 @@ void DualModeController::ReadBufferSize(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(bluetooth::hci::ReadBufferSizeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       properties_.acl_data_packet_length, properties_.sco_data_packet_length,
       properties_.total_num_acl_data_packets,
       properties_.total_num_sco_data_packets));
@@ -515,7 +527,7 @@ void DualModeController::ReadEncryptionKeySize(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(bluetooth::hci::ReadEncryptionKeySizeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       command_view.GetConnectionHandle(),
       link_layer_controller_.GetEncryptionKeySize()));
 }
@@ -524,7 +536,7 @@ void DualModeController::HostBufferSize(CommandView command) {
   auto command_view = gd_hci::HostBufferSizeView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::HostBufferSizeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadLocalVersionInformation(CommandView command) {
@@ -540,7 +552,8 @@ void DualModeController::ReadLocalVersionInformation(CommandView command) {
 
   send_event_(
       bluetooth::hci::ReadLocalVersionInformationCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS, local_version_information));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+          local_version_information));
 }
 
 void DualModeController::ReadRemoteVersionInformation(CommandView command) {
@@ -554,14 +567,14 @@ void DualModeController::ReadRemoteVersionInformation(CommandView command) {
       command_view.GetConnectionHandle());
 
   send_event_(bluetooth::hci::ReadRemoteVersionInformationStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::ReadBdAddr(CommandView command) {
   auto command_view = gd_hci::ReadBdAddrView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::ReadBdAddrCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, GetAddress()));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, GetAddress()));
 }
 
 void DualModeController::ReadLocalSupportedCommands(CommandView command) {
@@ -574,7 +587,8 @@ void DualModeController::ReadLocalSupportedCommands(CommandView command) {
               supported_commands.begin());
 
   send_event_(bluetooth::hci::ReadLocalSupportedCommandsCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, supported_commands));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+      supported_commands));
 }
 
 void DualModeController::ReadLocalSupportedFeatures(CommandView command) {
@@ -582,7 +596,7 @@ void DualModeController::ReadLocalSupportedFeatures(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(bluetooth::hci::ReadLocalSupportedFeaturesCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       link_layer_controller_.GetLmpFeatures()));
 }
 
@@ -590,7 +604,7 @@ void DualModeController::ReadLocalSupportedCodecs(CommandView command) {
   auto command_view = gd_hci::ReadLocalSupportedCodecsV1View::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::ReadLocalSupportedCodecsV1CompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       properties_.supported_standard_codecs,
       properties_.supported_vendor_specific_codecs));
 }
@@ -601,7 +615,7 @@ void DualModeController::ReadLocalExtendedFeatures(CommandView command) {
   uint8_t page_number = command_view.GetPageNumber();
 
   send_event_(bluetooth::hci::ReadLocalExtendedFeaturesCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, page_number,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, page_number,
       link_layer_controller_.GetMaxLmpFeaturesPageNumber(),
       link_layer_controller_.GetLmpFeatures(page_number)));
 }
@@ -617,7 +631,7 @@ void DualModeController::ReadRemoteExtendedFeatures(CommandView command) {
       command_view.GetConnectionHandle());
 
   send_event_(bluetooth::hci::ReadRemoteExtendedFeaturesStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::SwitchRole(CommandView command) {
@@ -630,7 +644,7 @@ void DualModeController::SwitchRole(CommandView command) {
                                                   command_view.GetRole());
 
   send_event_(bluetooth::hci::SwitchRoleStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::ReadRemoteSupportedFeatures(CommandView command) {
@@ -644,7 +658,7 @@ void DualModeController::ReadRemoteSupportedFeatures(CommandView command) {
       command_view.GetConnectionHandle());
 
   send_event_(bluetooth::hci::ReadRemoteSupportedFeaturesStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::ReadClockOffset(CommandView command) {
@@ -659,7 +673,7 @@ void DualModeController::ReadClockOffset(CommandView command) {
       OpCode::READ_CLOCK_OFFSET, command_view.GetPayload(), handle);
 
   send_event_(bluetooth::hci::ReadClockOffsetStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 // Deprecated command, removed in v4.2.
@@ -674,7 +688,7 @@ void DualModeController::AddScoConnection(CommandView command) {
       command_view.GetConnectionHandle(), command_view.GetPacketType());
 
   send_event_(bluetooth::hci::AddScoConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::SetupSynchronousConnection(CommandView command) {
@@ -691,7 +705,7 @@ void DualModeController::SetupSynchronousConnection(CommandView command) {
       command_view.GetPacketType());
 
   send_event_(bluetooth::hci::SetupSynchronousConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::AcceptSynchronousConnection(CommandView command) {
@@ -708,7 +722,7 @@ void DualModeController::AcceptSynchronousConnection(CommandView command) {
       command_view.GetPacketType());
 
   send_event_(bluetooth::hci::AcceptSynchronousConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::EnhancedSetupSynchronousConnection(
@@ -853,7 +867,7 @@ void DualModeController::EnhancedSetupSynchronousConnection(
 
   send_event_(
       bluetooth::hci::EnhancedSetupSynchronousConnectionStatusBuilder::Create(
-          status, kNumCommandPackets));
+          status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::EnhancedAcceptSynchronousConnection(
@@ -998,7 +1012,7 @@ void DualModeController::EnhancedAcceptSynchronousConnection(
 
   send_event_(
       bluetooth::hci::EnhancedAcceptSynchronousConnectionStatusBuilder::Create(
-          status, kNumCommandPackets));
+          status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::RejectSynchronousConnection(CommandView command) {
@@ -1011,7 +1025,7 @@ void DualModeController::RejectSynchronousConnection(CommandView command) {
       command_view.GetBdAddr(), (uint16_t)command_view.GetReason());
 
   send_event_(bluetooth::hci::RejectSynchronousConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::IoCapabilityRequestReply(CommandView command) {
@@ -1032,7 +1046,7 @@ void DualModeController::IoCapabilityRequestReply(CommandView command) {
   auto status = link_layer_controller_.IoCapabilityRequestReply(
       peer, io_capability, oob_data_present_flag, authentication_requirements);
   send_event_(bluetooth::hci::IoCapabilityRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, peer));
+      properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1049,7 +1063,7 @@ void DualModeController::UserConfirmationRequestReply(CommandView command) {
   auto status = link_layer_controller_.UserConfirmationRequestReply(peer);
   send_event_(
       bluetooth::hci::UserConfirmationRequestReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1068,7 +1082,7 @@ void DualModeController::UserConfirmationRequestNegativeReply(
       link_layer_controller_.UserConfirmationRequestNegativeReply(peer);
   send_event_(
       bluetooth::hci::UserConfirmationRequestNegativeReplyCompleteBuilder::
-          Create(kNumCommandPackets, status, peer));
+          Create(properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1091,7 +1105,7 @@ void DualModeController::PinCodeRequestReply(CommandView command) {
   }
 
   send_event_(bluetooth::hci::PinCodeRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, peer));
+      properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1109,7 +1123,7 @@ void DualModeController::PinCodeRequestNegativeReply(CommandView command) {
   auto status = link_layer_controller_.PinCodeRequestNegativeReply(peer);
   send_event_(
       bluetooth::hci::PinCodeRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1127,7 +1141,7 @@ void DualModeController::UserPasskeyRequestReply(CommandView command) {
   auto status =
       link_layer_controller_.UserPasskeyRequestReply(peer, numeric_value);
   send_event_(bluetooth::hci::UserPasskeyRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, peer));
+      properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1144,7 +1158,7 @@ void DualModeController::UserPasskeyRequestNegativeReply(CommandView command) {
   auto status = link_layer_controller_.UserPasskeyRequestNegativeReply(peer);
   send_event_(
       bluetooth::hci::UserPasskeyRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1162,7 +1176,7 @@ void DualModeController::RemoteOobDataRequestReply(CommandView command) {
       peer, command_view.GetC(), command_view.GetR());
 
   send_event_(bluetooth::hci::RemoteOobDataRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, peer));
+      properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1180,7 +1194,7 @@ void DualModeController::RemoteOobDataRequestNegativeReply(
   auto status = link_layer_controller_.RemoteOobDataRequestNegativeReply(peer);
   send_event_(
       bluetooth::hci::RemoteOobDataRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1199,7 +1213,7 @@ void DualModeController::IoCapabilityRequestNegativeReply(CommandView command) {
       link_layer_controller_.IoCapabilityRequestNegativeReply(peer, reason);
   send_event_(
       bluetooth::hci::IoCapabilityRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1220,7 +1234,7 @@ void DualModeController::RemoteOobExtendedDataRequestReply(
 
   send_event_(
       bluetooth::hci::RemoteOobExtendedDataRequestReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, peer));
+          properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1233,7 +1247,8 @@ void DualModeController::ReadInquiryResponseTransmitPowerLevel(
   uint8_t tx_power = 20;  // maximum
   send_event_(
       bluetooth::hci::ReadInquiryResponseTransmitPowerLevelCompleteBuilder::
-          Create(kNumCommandPackets, ErrorCode::SUCCESS, tx_power));
+          Create(properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+                 tx_power));
 }
 
 void DualModeController::SendKeypressNotification(CommandView command) {
@@ -1249,7 +1264,7 @@ void DualModeController::SendKeypressNotification(CommandView command) {
   auto status = link_layer_controller_.SendKeypressNotification(
       peer, command_view.GetNotificationType());
   send_event_(bluetooth::hci::SendKeypressNotificationCompleteBuilder::Create(
-      kNumCommandPackets, status, peer));
+      properties_.num_hci_command_packets, status, peer));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1259,7 +1274,7 @@ void DualModeController::EnhancedFlush(CommandView command) {
 
   auto handle = command_view.GetConnectionHandle();
   send_event_(bluetooth::hci::EnhancedFlushStatusBuilder::Create(
-      ErrorCode::SUCCESS, kNumCommandPackets));
+      ErrorCode::SUCCESS, properties_.num_hci_command_packets));
 
   // TODO: When adding a queue of ACL packets.
   // Send the Enhanced Flush Complete event after discarding
@@ -1275,7 +1290,8 @@ void DualModeController::SetEventMaskPage2(CommandView command) {
       std::make_unique<bluetooth::packet::RawBuilder>(std::vector<uint8_t>(
           {static_cast<uint8_t>(bluetooth::hci::ErrorCode::SUCCESS)}));
   send_event_(bluetooth::hci::CommandCompleteBuilder::Create(
-      kNumCommandPackets, command.GetOpCode(), std::move(payload)));
+      properties_.num_hci_command_packets, command.GetOpCode(),
+      std::move(payload)));
 }
 
 void DualModeController::ReadLocalOobData(CommandView command) {
@@ -1298,7 +1314,7 @@ void DualModeController::WriteSimplePairingMode(CommandView command) {
   auto enabled = command_view.GetSimplePairingMode() == gd_hci::Enable::ENABLED;
   link_layer_controller_.SetSecureSimplePairingSupport(enabled);
   send_event_(bluetooth::hci::WriteSimplePairingModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ChangeConnectionPacketType(CommandView command) {
@@ -1314,7 +1330,7 @@ void DualModeController::ChangeConnectionPacketType(CommandView command) {
       link_layer_controller_.ChangeConnectionPacketType(handle, packet_type);
 
   send_event_(bluetooth::hci::ChangeConnectionPacketTypeStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::WriteLeHostSupport(CommandView command) {
@@ -1324,7 +1340,7 @@ void DualModeController::WriteLeHostSupport(CommandView command) {
       command_view.GetLeSupportedHost() == gd_hci::Enable::ENABLED;
   link_layer_controller_.SetLeHostSupport(le_support);
   send_event_(bluetooth::hci::WriteLeHostSupportCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::WriteSecureConnectionsHostSupport(
@@ -1337,7 +1353,7 @@ void DualModeController::WriteSecureConnectionsHostSupport(
       bluetooth::hci::Enable::ENABLED);
   send_event_(
       bluetooth::hci::WriteSecureConnectionsHostSupportCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::SetEventMask(CommandView command) {
@@ -1345,7 +1361,7 @@ void DualModeController::SetEventMask(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.SetEventMask(command_view.GetEventMask());
   send_event_(bluetooth::hci::SetEventMaskCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadInquiryMode(CommandView command) {
@@ -1354,7 +1370,7 @@ void DualModeController::ReadInquiryMode(CommandView command) {
   ASSERT(command_view.IsValid());
   gd_hci::InquiryMode inquiry_mode = gd_hci::InquiryMode::STANDARD;
   send_event_(bluetooth::hci::ReadInquiryModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, inquiry_mode));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, inquiry_mode));
 }
 
 void DualModeController::WriteInquiryMode(CommandView command) {
@@ -1364,7 +1380,7 @@ void DualModeController::WriteInquiryMode(CommandView command) {
   link_layer_controller_.SetInquiryMode(
       static_cast<uint8_t>(command_view.GetInquiryMode()));
   send_event_(bluetooth::hci::WriteInquiryModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadPageScanType(CommandView command) {
@@ -1373,7 +1389,7 @@ void DualModeController::ReadPageScanType(CommandView command) {
   ASSERT(command_view.IsValid());
   gd_hci::PageScanType page_scan_type = gd_hci::PageScanType::STANDARD;
   send_event_(bluetooth::hci::ReadPageScanTypeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, page_scan_type));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, page_scan_type));
 }
 
 void DualModeController::WritePageScanType(CommandView command) {
@@ -1381,7 +1397,7 @@ void DualModeController::WritePageScanType(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WritePageScanTypeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadInquiryScanType(CommandView command) {
@@ -1390,7 +1406,8 @@ void DualModeController::ReadInquiryScanType(CommandView command) {
   ASSERT(command_view.IsValid());
   gd_hci::InquiryScanType inquiry_scan_type = gd_hci::InquiryScanType::STANDARD;
   send_event_(bluetooth::hci::ReadInquiryScanTypeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, inquiry_scan_type));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+      inquiry_scan_type));
 }
 
 void DualModeController::WriteInquiryScanType(CommandView command) {
@@ -1398,7 +1415,7 @@ void DualModeController::WriteInquiryScanType(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WriteInquiryScanTypeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::AuthenticationRequested(CommandView command) {
@@ -1413,7 +1430,7 @@ void DualModeController::AuthenticationRequested(CommandView command) {
   auto status = link_layer_controller_.AuthenticationRequested(handle);
 
   send_event_(bluetooth::hci::AuthenticationRequestedStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1432,7 +1449,7 @@ void DualModeController::SetConnectionEncryption(CommandView command) {
       link_layer_controller_.SetConnectionEncryption(handle, encryption_enable);
 
   send_event_(bluetooth::hci::SetConnectionEncryptionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1446,7 +1463,7 @@ void DualModeController::ChangeConnectionLinkKey(CommandView command) {
   auto status = link_layer_controller_.ChangeConnectionLinkKey(handle);
 
   send_event_(bluetooth::hci::ChangeConnectionLinkKeyStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::CentralLinkKey(CommandView command) {
@@ -1459,7 +1476,7 @@ void DualModeController::CentralLinkKey(CommandView command) {
   auto status = link_layer_controller_.CentralLinkKey(key_flag);
 
   send_event_(bluetooth::hci::CentralLinkKeyStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::WriteAuthenticationEnable(CommandView command) {
@@ -1469,14 +1486,14 @@ void DualModeController::WriteAuthenticationEnable(CommandView command) {
   link_layer_controller_.SetAuthenticationEnable(
       command_view.GetAuthenticationEnable());
   send_event_(bluetooth::hci::WriteAuthenticationEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadAuthenticationEnable(CommandView command) {
   auto command_view = gd_hci::ReadAuthenticationEnableView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::ReadAuthenticationEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       static_cast<bluetooth::hci::AuthenticationEnable>(
           link_layer_controller_.GetAuthenticationEnable())));
 }
@@ -1487,7 +1504,7 @@ void DualModeController::WriteClassOfDevice(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.SetClassOfDevice(command_view.GetClassOfDevice());
   send_event_(bluetooth::hci::WriteClassOfDeviceCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadPageTimeout(CommandView command) {
@@ -1496,7 +1513,7 @@ void DualModeController::ReadPageTimeout(CommandView command) {
   ASSERT(command_view.IsValid());
   uint16_t page_timeout = 0x2000;
   send_event_(bluetooth::hci::ReadPageTimeoutCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, page_timeout));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, page_timeout));
 }
 
 void DualModeController::WritePageTimeout(CommandView command) {
@@ -1504,7 +1521,7 @@ void DualModeController::WritePageTimeout(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WritePageTimeoutCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::HoldMode(CommandView command) {
@@ -1520,7 +1537,7 @@ void DualModeController::HoldMode(CommandView command) {
                                                 hold_mode_min_interval);
 
   send_event_(bluetooth::hci::HoldModeStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::SniffMode(CommandView command) {
@@ -1539,7 +1556,7 @@ void DualModeController::SniffMode(CommandView command) {
                                                  sniff_attempt, sniff_timeout);
 
   send_event_(bluetooth::hci::SniffModeStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::ExitSniffMode(CommandView command) {
@@ -1552,7 +1569,7 @@ void DualModeController::ExitSniffMode(CommandView command) {
       link_layer_controller_.ExitSniffMode(command_view.GetConnectionHandle());
 
   send_event_(bluetooth::hci::ExitSniffModeStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::QosSetup(CommandView command) {
@@ -1572,7 +1589,7 @@ void DualModeController::QosSetup(CommandView command) {
                                       peak_bandwidth, latency, delay_variation);
 
   send_event_(bluetooth::hci::QosSetupStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::RoleDiscovery(CommandView command) {
@@ -1586,7 +1603,7 @@ void DualModeController::RoleDiscovery(CommandView command) {
   auto status = link_layer_controller_.RoleDiscovery(handle, &role);
 
   send_event_(bluetooth::hci::RoleDiscoveryCompleteBuilder::Create(
-      kNumCommandPackets, status, handle, role));
+      properties_.num_hci_command_packets, status, handle, role));
 }
 
 void DualModeController::ReadDefaultLinkPolicySettings(CommandView command) {
@@ -1597,7 +1614,7 @@ void DualModeController::ReadDefaultLinkPolicySettings(CommandView command) {
   uint16_t settings = link_layer_controller_.ReadDefaultLinkPolicySettings();
   send_event_(
       bluetooth::hci::ReadDefaultLinkPolicySettingsCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS, settings));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS, settings));
 }
 
 void DualModeController::WriteDefaultLinkPolicySettings(CommandView command) {
@@ -1609,7 +1626,7 @@ void DualModeController::WriteDefaultLinkPolicySettings(CommandView command) {
       command_view.GetDefaultLinkPolicySettings());
   send_event_(
       bluetooth::hci::WriteDefaultLinkPolicySettingsCompleteBuilder::Create(
-          kNumCommandPackets, status));
+          properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::FlowSpecification(CommandView command) {
@@ -1631,7 +1648,7 @@ void DualModeController::FlowSpecification(CommandView command) {
       peak_bandwidth, access_latency);
 
   send_event_(bluetooth::hci::FlowSpecificationStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::ReadLinkPolicySettings(CommandView command) {
@@ -1647,7 +1664,7 @@ void DualModeController::ReadLinkPolicySettings(CommandView command) {
       link_layer_controller_.ReadLinkPolicySettings(handle, &settings);
 
   send_event_(bluetooth::hci::ReadLinkPolicySettingsCompleteBuilder::Create(
-      kNumCommandPackets, status, handle, settings));
+      properties_.num_hci_command_packets, status, handle, settings));
 }
 
 void DualModeController::WriteLinkPolicySettings(CommandView command) {
@@ -1663,7 +1680,7 @@ void DualModeController::WriteLinkPolicySettings(CommandView command) {
       link_layer_controller_.WriteLinkPolicySettings(handle, settings);
 
   send_event_(bluetooth::hci::WriteLinkPolicySettingsCompleteBuilder::Create(
-      kNumCommandPackets, status, handle));
+      properties_.num_hci_command_packets, status, handle));
 }
 
 void DualModeController::WriteLinkSupervisionTimeout(CommandView command) {
@@ -1679,7 +1696,7 @@ void DualModeController::WriteLinkSupervisionTimeout(CommandView command) {
       link_layer_controller_.WriteLinkSupervisionTimeout(handle, timeout);
   send_event_(
       bluetooth::hci::WriteLinkSupervisionTimeoutCompleteBuilder::Create(
-          kNumCommandPackets, status, handle));
+          properties_.num_hci_command_packets, status, handle));
 }
 
 void DualModeController::ReadLocalName(CommandView command) {
@@ -1692,7 +1709,7 @@ void DualModeController::ReadLocalName(CommandView command) {
               local_name.begin());
 
   send_event_(bluetooth::hci::ReadLocalNameCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, local_name));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, local_name));
 }
 
 void DualModeController::WriteLocalName(CommandView command) {
@@ -1705,7 +1722,7 @@ void DualModeController::WriteLocalName(CommandView command) {
   }
   link_layer_controller_.SetName(name_vec);
   send_event_(bluetooth::hci::WriteLocalNameCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::WriteExtendedInquiryResponse(CommandView command) {
@@ -1715,7 +1732,7 @@ void DualModeController::WriteExtendedInquiryResponse(CommandView command) {
       command_view.GetPayload().begin() + 1, command_view.GetPayload().end()));
   send_event_(
       bluetooth::hci::WriteExtendedInquiryResponseCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::RefreshEncryptionKey(CommandView command) {
@@ -1724,7 +1741,7 @@ void DualModeController::RefreshEncryptionKey(CommandView command) {
   ASSERT(command_view.IsValid());
   uint16_t handle = command_view.GetConnectionHandle();
   send_event_(bluetooth::hci::RefreshEncryptionKeyStatusBuilder::Create(
-      ErrorCode::SUCCESS, kNumCommandPackets));
+      ErrorCode::SUCCESS, properties_.num_hci_command_packets));
   // TODO: Support this in the link layer
   send_event_(bluetooth::hci::EncryptionKeyRefreshCompleteBuilder::Create(
       ErrorCode::SUCCESS, handle));
@@ -1737,7 +1754,7 @@ void DualModeController::WriteVoiceSetting(CommandView command) {
   link_layer_controller_.SetVoiceSetting(command_view.GetVoiceSetting());
 
   send_event_(bluetooth::hci::WriteVoiceSettingCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadNumberOfSupportedIac(CommandView command) {
@@ -1746,7 +1763,8 @@ void DualModeController::ReadNumberOfSupportedIac(CommandView command) {
   ASSERT(command_view.IsValid());
   uint8_t num_support_iac = 0x1;
   send_event_(bluetooth::hci::ReadNumberOfSupportedIacCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, num_support_iac));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+      num_support_iac));
 }
 
 void DualModeController::ReadCurrentIacLap(CommandView command) {
@@ -1756,7 +1774,7 @@ void DualModeController::ReadCurrentIacLap(CommandView command) {
   gd_hci::Lap lap;
   lap.lap_ = 0x30;
   send_event_(bluetooth::hci::ReadCurrentIacLapCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, {lap}));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, {lap}));
 }
 
 void DualModeController::WriteCurrentIacLap(CommandView command) {
@@ -1764,7 +1782,7 @@ void DualModeController::WriteCurrentIacLap(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WriteCurrentIacLapCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadPageScanActivity(CommandView command) {
@@ -1774,7 +1792,8 @@ void DualModeController::ReadPageScanActivity(CommandView command) {
   uint16_t interval = 0x1000;
   uint16_t window = 0x0012;
   send_event_(bluetooth::hci::ReadPageScanActivityCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, interval, window));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, interval,
+      window));
 }
 
 void DualModeController::WritePageScanActivity(CommandView command) {
@@ -1782,7 +1801,7 @@ void DualModeController::WritePageScanActivity(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WritePageScanActivityCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadInquiryScanActivity(CommandView command) {
@@ -1792,7 +1811,8 @@ void DualModeController::ReadInquiryScanActivity(CommandView command) {
   uint16_t interval = 0x1000;
   uint16_t window = 0x0012;
   send_event_(bluetooth::hci::ReadInquiryScanActivityCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, interval, window));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, interval,
+      window));
 }
 
 void DualModeController::WriteInquiryScanActivity(CommandView command) {
@@ -1800,7 +1820,7 @@ void DualModeController::WriteInquiryScanActivity(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::WriteInquiryScanActivityCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadScanEnable(CommandView command) {
@@ -1808,7 +1828,8 @@ void DualModeController::ReadScanEnable(CommandView command) {
       gd_hci::DiscoveryCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::ReadScanEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, gd_hci::ScanEnable::NO_SCANS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+      gd_hci::ScanEnable::NO_SCANS));
 }
 
 void DualModeController::WriteScanEnable(CommandView command) {
@@ -1829,7 +1850,7 @@ void DualModeController::WriteScanEnable(CommandView command) {
   link_layer_controller_.SetInquiryScanEnable(inquiry_scan);
   link_layer_controller_.SetPageScanEnable(page_scan);
   send_event_(bluetooth::hci::WriteScanEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadSynchronousFlowControlEnable(CommandView command) {
@@ -1842,7 +1863,7 @@ void DualModeController::ReadSynchronousFlowControlEnable(CommandView command) {
   }
   send_event_(
       bluetooth::hci::ReadSynchronousFlowControlEnableCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS, enabled));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS, enabled));
 }
 
 void DualModeController::WriteSynchronousFlowControlEnable(
@@ -1854,14 +1875,14 @@ void DualModeController::WriteSynchronousFlowControlEnable(
   link_layer_controller_.SetScoFlowControlEnable(enabled);
   send_event_(
       bluetooth::hci::WriteSynchronousFlowControlEnableCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::SetEventFilter(CommandView command) {
   auto command_view = gd_hci::SetEventFilterView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::SetEventFilterCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::Inquiry(CommandView command) {
@@ -1872,15 +1893,16 @@ void DualModeController::Inquiry(CommandView command) {
   auto length = command_view.GetInquiryLength();
   if (max_responses > 0xff || length < 1 || length > 0x30) {
     send_event_(bluetooth::hci::InquiryStatusBuilder::Create(
-        ErrorCode::INVALID_HCI_COMMAND_PARAMETERS, kNumCommandPackets));
+        ErrorCode::INVALID_HCI_COMMAND_PARAMETERS,
+        properties_.num_hci_command_packets));
     return;
   }
   link_layer_controller_.SetInquiryLAP(command_view.GetLap().lap_);
   link_layer_controller_.SetInquiryMaxResponses(max_responses);
   link_layer_controller_.StartInquiry(std::chrono::milliseconds(length * 1280));
 
-  send_event_(bluetooth::hci::InquiryStatusBuilder::Create(ErrorCode::SUCCESS,
-                                                           kNumCommandPackets));
+  send_event_(bluetooth::hci::InquiryStatusBuilder::Create(
+      ErrorCode::SUCCESS, properties_.num_hci_command_packets));
 }
 
 void DualModeController::InquiryCancel(CommandView command) {
@@ -1889,7 +1911,7 @@ void DualModeController::InquiryCancel(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.InquiryCancel();
   send_event_(bluetooth::hci::InquiryCancelCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::AcceptConnectionRequest(CommandView command) {
@@ -1903,7 +1925,7 @@ void DualModeController::AcceptConnectionRequest(CommandView command) {
   auto status =
       link_layer_controller_.AcceptConnectionRequest(addr, try_role_switch);
   send_event_(bluetooth::hci::AcceptConnectionRequestStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::RejectConnectionRequest(CommandView command) {
@@ -1915,7 +1937,7 @@ void DualModeController::RejectConnectionRequest(CommandView command) {
   uint8_t reason = static_cast<uint8_t>(command_view.GetReason());
   auto status = link_layer_controller_.RejectConnectionRequest(addr, reason);
   send_event_(bluetooth::hci::RejectConnectionRequestStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LinkKeyRequestReply(CommandView command) {
@@ -1929,7 +1951,7 @@ void DualModeController::LinkKeyRequestReply(CommandView command) {
   auto key = command_view.GetLinkKey();
   auto status = link_layer_controller_.LinkKeyRequestReply(addr, key);
   send_event_(bluetooth::hci::LinkKeyRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, addr));
+      properties_.num_hci_command_packets, status, addr));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1944,7 +1966,7 @@ void DualModeController::LinkKeyRequestNegativeReply(CommandView command) {
   auto status = link_layer_controller_.LinkKeyRequestNegativeReply(addr);
   send_event_(
       bluetooth::hci::LinkKeyRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, addr));
+          properties_.num_hci_command_packets, status, addr));
 #endif /* ROOTCANAL_LMP */
 }
 
@@ -1970,7 +1992,7 @@ void DualModeController::DeleteStoredLinkKey(CommandView command) {
   }
 
   send_event_(bluetooth::hci::DeleteStoredLinkKeyCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, deleted_keys));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, deleted_keys));
 }
 
 void DualModeController::RemoteNameRequest(CommandView command) {
@@ -1984,7 +2006,7 @@ void DualModeController::RemoteNameRequest(CommandView command) {
       OpCode::REMOTE_NAME_REQUEST, command_view.GetPayload(), remote_addr);
 
   send_event_(bluetooth::hci::RemoteNameRequestStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeSetEventMask(CommandView command) {
@@ -1992,7 +2014,7 @@ void DualModeController::LeSetEventMask(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.SetLeEventMask(command_view.GetLeEventMask());
   send_event_(bluetooth::hci::LeSetEventMaskCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetHostFeature(CommandView command) {
@@ -2003,7 +2025,7 @@ void DualModeController::LeSetHostFeature(CommandView command) {
       static_cast<uint8_t>(command_view.GetBitNumber()),
       static_cast<uint8_t>(command_view.GetBitValue()));
   send_event_(bluetooth::hci::LeSetHostFeatureCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeReadBufferSize(CommandView command) {
@@ -2016,7 +2038,7 @@ void DualModeController::LeReadBufferSize(CommandView command) {
       properties_.total_num_le_acl_data_packets;
 
   send_event_(bluetooth::hci::LeReadBufferSizeV1CompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, le_buffer_size));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, le_buffer_size));
 }
 
 void DualModeController::LeReadBufferSizeV2(CommandView command) {
@@ -2033,7 +2055,8 @@ void DualModeController::LeReadBufferSizeV2(CommandView command) {
       properties_.total_num_iso_data_packets;
 
   send_event_(bluetooth::hci::LeReadBufferSizeV2CompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, le_buffer_size, iso_buffer_size));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, le_buffer_size,
+      iso_buffer_size));
 }
 
 void DualModeController::LeSetAddressResolutionEnable(CommandView command) {
@@ -2046,7 +2069,7 @@ void DualModeController::LeSetAddressResolutionEnable(CommandView command) {
       bluetooth::hci::Enable::ENABLED);
   send_event_(
       bluetooth::hci::LeSetAddressResolutionEnableCompleteBuilder::Create(
-          kNumCommandPackets, status));
+          properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeSetResovalablePrivateAddressTimeout(
@@ -2056,7 +2079,8 @@ void DualModeController::LeSetResovalablePrivateAddressTimeout(
       std::make_unique<bluetooth::packet::RawBuilder>(std::vector<uint8_t>(
           {static_cast<uint8_t>(bluetooth::hci::ErrorCode::SUCCESS)}));
   send_event_(bluetooth::hci::CommandCompleteBuilder::Create(
-      kNumCommandPackets, command.GetOpCode(), std::move(payload)));
+      properties_.num_hci_command_packets, command.GetOpCode(),
+      std::move(payload)));
 }
 
 void DualModeController::LeReadLocalSupportedFeatures(CommandView command) {
@@ -2068,7 +2092,8 @@ void DualModeController::LeReadLocalSupportedFeatures(CommandView command) {
 
   send_event_(
       bluetooth::hci::LeReadLocalSupportedFeaturesCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS, properties_.le_features));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+          properties_.le_features));
 }
 
 void DualModeController::LeSetRandomAddress(CommandView command) {
@@ -2078,7 +2103,7 @@ void DualModeController::LeSetRandomAddress(CommandView command) {
   ErrorCode status = link_layer_controller_.LeSetRandomAddress(
       command_view.GetRandomAddress());
   send_event_(bluetooth::hci::LeSetRandomAddressCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeSetAdvertisingParameters(CommandView command) {
@@ -2100,7 +2125,7 @@ void DualModeController::LeSetAdvertisingParameters(CommandView command) {
       static_cast<uint8_t>(command_view.GetAdvertisingFilterPolicy()));
 
   send_event_(bluetooth::hci::LeSetAdvertisingParametersCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeReadAdvertisingPhysicalChannelTxPower(
@@ -2111,7 +2136,7 @@ void DualModeController::LeReadAdvertisingPhysicalChannelTxPower(
   ASSERT(command_view.IsValid());
   send_event_(
       bluetooth::hci::LeReadAdvertisingPhysicalChannelTxPowerCompleteBuilder::
-          Create(kNumCommandPackets, ErrorCode::SUCCESS,
+          Create(properties_.num_hci_command_packets, ErrorCode::SUCCESS,
                  link_layer_controller_.GetLeAdvertisingTxPower()));
 }
 
@@ -2127,7 +2152,7 @@ void DualModeController::LeSetAdvertisingData(CommandView command) {
   ASSERT(command_view.GetPayload().size() == 32);
   link_layer_controller_.SetLeAdvertisingData(payload_bytes);
   send_event_(bluetooth::hci::LeSetAdvertisingDataCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetScanResponseData(CommandView command) {
@@ -2138,7 +2163,7 @@ void DualModeController::LeSetScanResponseData(CommandView command) {
   link_layer_controller_.SetLeScanResponseData(std::vector<uint8_t>(
       command_view.GetPayload().begin() + 1, command_view.GetPayload().end()));
   send_event_(bluetooth::hci::LeSetScanResponseDataCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetAdvertisingEnable(CommandView command) {
@@ -2152,7 +2177,7 @@ void DualModeController::LeSetAdvertisingEnable(CommandView command) {
   auto status = link_layer_controller_.SetLeAdvertisingEnable(
       command_view.GetAdvertisingEnable() == gd_hci::Enable::ENABLED);
   send_event_(bluetooth::hci::LeSetAdvertisingEnableCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeSetScanParameters(CommandView command) {
@@ -2167,7 +2192,7 @@ void DualModeController::LeSetScanParameters(CommandView command) {
   link_layer_controller_.SetLeScanFilterPolicy(
       static_cast<uint8_t>(command_view.GetScanningFilterPolicy()));
   send_event_(bluetooth::hci::LeSetScanParametersCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetScanEnable(CommandView command) {
@@ -2186,7 +2211,7 @@ void DualModeController::LeSetScanEnable(CommandView command) {
   link_layer_controller_.SetLeFilterDuplicates(
       command_view.GetFilterDuplicates() == gd_hci::Enable::ENABLED);
   send_event_(bluetooth::hci::LeSetScanEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeCreateConnection(CommandView command) {
@@ -2223,7 +2248,7 @@ void DualModeController::LeCreateConnection(CommandView command) {
   auto status = link_layer_controller_.SetLeConnect(true, false);
 
   send_event_(bluetooth::hci::LeCreateConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeConnectionUpdate(CommandView command) {
@@ -2237,7 +2262,7 @@ void DualModeController::LeConnectionUpdate(CommandView command) {
       command_view.GetSupervisionTimeout());
 
   send_event_(bluetooth::hci::LeConnectionUpdateStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::CreateConnection(CommandView command) {
@@ -2261,7 +2286,7 @@ void DualModeController::CreateConnection(CommandView command) {
       address, packet_type, page_scan_mode, clock_offset, allow_role_switch);
 
   send_event_(bluetooth::hci::CreateConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::CreateConnectionCancel(CommandView command) {
@@ -2275,7 +2300,7 @@ void DualModeController::CreateConnectionCancel(CommandView command) {
   auto status = link_layer_controller_.CreateConnectionCancel(address);
 
   send_event_(bluetooth::hci::CreateConnectionCancelCompleteBuilder::Create(
-      kNumCommandPackets, status, address));
+      properties_.num_hci_command_packets, status, address));
 }
 
 void DualModeController::Disconnect(CommandView command) {
@@ -2290,7 +2315,7 @@ void DualModeController::Disconnect(CommandView command) {
       handle, ErrorCode(command_view.GetReason()));
 
   send_event_(bluetooth::hci::DisconnectStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeConnectionCancel(CommandView command) {
@@ -2300,7 +2325,7 @@ void DualModeController::LeConnectionCancel(CommandView command) {
   ASSERT(command_view.IsValid());
   ErrorCode status = link_layer_controller_.SetLeConnect(false, false);
   send_event_(bluetooth::hci::LeCreateConnectionCancelCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 
   send_event_(bluetooth::hci::LeConnectionCompleteBuilder::Create(
       ErrorCode::UNKNOWN_CONNECTION, kReservedHandle,
@@ -2317,7 +2342,7 @@ void DualModeController::LeReadFilterAcceptListSize(CommandView command) {
           gd_hci::AclCommandView::Create(command)));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::LeReadFilterAcceptListSizeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       properties_.le_filter_accept_list_size));
 }
 
@@ -2328,7 +2353,7 @@ void DualModeController::LeClearFilterAcceptList(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.LeFilterAcceptListClear();
   send_event_(bluetooth::hci::LeClearFilterAcceptListCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeAddDeviceToFilterAcceptList(CommandView command) {
@@ -2346,7 +2371,7 @@ void DualModeController::LeAddDeviceToFilterAcceptList(CommandView command) {
   }
   send_event_(
       bluetooth::hci::LeAddDeviceToFilterAcceptListCompleteBuilder::Create(
-          kNumCommandPackets, result));
+          properties_.num_hci_command_packets, result));
 }
 
 void DualModeController::LeRemoveDeviceFromFilterAcceptList(
@@ -2367,7 +2392,7 @@ void DualModeController::LeRemoveDeviceFromFilterAcceptList(
   }
   send_event_(
       bluetooth::hci::LeRemoveDeviceFromFilterAcceptListCompleteBuilder::Create(
-          kNumCommandPackets, status));
+          properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeClearResolvingList(CommandView command) {
@@ -2376,7 +2401,7 @@ void DualModeController::LeClearResolvingList(CommandView command) {
   ASSERT(command_view.IsValid());
   link_layer_controller_.LeResolvingListClear();
   send_event_(bluetooth::hci::LeClearResolvingListCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeReadResolvingListSize(CommandView command) {
@@ -2384,7 +2409,7 @@ void DualModeController::LeReadResolvingListSize(CommandView command) {
       gd_hci::LeSecurityCommandView::Create(command));
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::LeReadResolvingListSizeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       properties_.le_resolving_list_size));
 }
 
@@ -2398,7 +2423,7 @@ void DualModeController::LeReadMaximumDataLength(CommandView command) {
   data_length.supported_max_tx_octets_ = kLeMaximumDataLength + 10;
   data_length.supported_max_tx_time_ = kLeMaximumDataTime + 10;
   send_event_(bluetooth::hci::LeReadMaximumDataLengthCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, data_length));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, data_length));
 }
 
 void DualModeController::LeReadSuggestedDefaultDataLength(CommandView command) {
@@ -2408,7 +2433,7 @@ void DualModeController::LeReadSuggestedDefaultDataLength(CommandView command) {
   ASSERT(command_view.IsValid());
   send_event_(
       bluetooth::hci::LeReadSuggestedDefaultDataLengthCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS,
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS,
           le_suggested_default_data_bytes_, le_suggested_default_data_time_));
 }
 
@@ -2423,7 +2448,7 @@ void DualModeController::LeWriteSuggestedDefaultDataLength(
   if (bytes > 0xFB || bytes < 0x1B || time < 0x148 || time > 0x4290) {
     send_event_(
         bluetooth::hci::LeWriteSuggestedDefaultDataLengthCompleteBuilder::
-            Create(kNumCommandPackets,
+            Create(properties_.num_hci_command_packets,
                    ErrorCode::INVALID_HCI_COMMAND_PARAMETERS));
     return;
   }
@@ -2431,7 +2456,7 @@ void DualModeController::LeWriteSuggestedDefaultDataLength(
   le_suggested_default_data_time_ = time;
   send_event_(
       bluetooth::hci::LeWriteSuggestedDefaultDataLengthCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeAddDeviceToResolvingList(CommandView command) {
@@ -2451,7 +2476,7 @@ void DualModeController::LeAddDeviceToResolvingList(CommandView command) {
       command_view.GetPeerIdentityAddress(), peer_address_type,
       command_view.GetPeerIrk(), command_view.GetLocalIrk());
   send_event_(bluetooth::hci::LeAddDeviceToResolvingListCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeRemoveDeviceFromResolvingList(CommandView command) {
@@ -2472,7 +2497,7 @@ void DualModeController::LeRemoveDeviceFromResolvingList(CommandView command) {
       command_view.GetPeerIdentityAddress(), peer_address_type);
   send_event_(
       bluetooth::hci::LeRemoveDeviceFromResolvingListCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetExtendedScanParameters(CommandView command) {
@@ -2498,7 +2523,7 @@ void DualModeController::LeSetExtendedScanParameters(CommandView command) {
   }
   send_event_(
       bluetooth::hci::LeSetExtendedScanParametersCompleteBuilder::Create(
-          kNumCommandPackets, status));
+          properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeSetExtendedScanEnable(CommandView command) {
@@ -2514,7 +2539,7 @@ void DualModeController::LeSetExtendedScanEnable(CommandView command) {
   link_layer_controller_.SetLeFilterDuplicates(
       command_view.GetFilterDuplicates() == gd_hci::FilterDuplicates::ENABLED);
   send_event_(bluetooth::hci::LeSetExtendedScanEnableCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeExtendedCreateConnection(CommandView command) {
@@ -2550,7 +2575,7 @@ void DualModeController::LeExtendedCreateConnection(CommandView command) {
   auto status = link_layer_controller_.SetLeConnect(true, true);
 
   send_event_(bluetooth::hci::LeExtendedCreateConnectionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeSetPrivacyMode(CommandView command) {
@@ -2577,7 +2602,7 @@ void DualModeController::LeSetPrivacyMode(CommandView command) {
   }
 
   send_event_(bluetooth::hci::LeSetPrivacyModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeReadIsoTxSync(CommandView command) {
@@ -2612,7 +2637,7 @@ void DualModeController::LeCreateCis(CommandView command) {
   ErrorCode status =
       link_layer_controller_.LeCreateCis(command_view.GetCisConfig());
   send_event_(bluetooth::hci::LeCreateCisStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeRemoveCig(CommandView command) {
@@ -2624,7 +2649,7 @@ void DualModeController::LeRemoveCig(CommandView command) {
   uint8_t cig = command_view.GetCigId();
   ErrorCode status = link_layer_controller_.LeRemoveCig(cig);
   send_event_(bluetooth::hci::LeRemoveCigCompleteBuilder::Create(
-      kNumCommandPackets, status, cig));
+      properties_.num_hci_command_packets, status, cig));
 }
 
 void DualModeController::LeAcceptCisRequest(CommandView command) {
@@ -2636,7 +2661,7 @@ void DualModeController::LeAcceptCisRequest(CommandView command) {
   ErrorCode status = link_layer_controller_.LeAcceptCisRequest(
       command_view.GetConnectionHandle());
   send_event_(bluetooth::hci::LeAcceptCisRequestStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeRejectCisRequest(CommandView command) {
@@ -2663,7 +2688,7 @@ void DualModeController::LeCreateBig(CommandView command) {
       command_view.GetFraming(), command_view.GetEncryption(),
       command_view.GetBroadcastCode());
   send_event_(bluetooth::hci::LeCreateBigStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeTerminateBig(CommandView command) {
@@ -2675,7 +2700,7 @@ void DualModeController::LeTerminateBig(CommandView command) {
   ErrorCode status = link_layer_controller_.LeTerminateBig(
       command_view.GetBigHandle(), command_view.GetReason());
   send_event_(bluetooth::hci::LeTerminateBigStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeBigCreateSync(CommandView command) {
@@ -2690,7 +2715,7 @@ void DualModeController::LeBigCreateSync(CommandView command) {
       command_view.GetMse(), command_view.GetBigSyncTimeout(),
       command_view.GetBis());
   send_event_(bluetooth::hci::LeBigCreateSyncStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeBigTerminateSync(CommandView command) {
@@ -2708,7 +2733,7 @@ void DualModeController::LeRequestPeerSca(CommandView command) {
   ErrorCode status = link_layer_controller_.LeRequestPeerSca(
       command_view.GetConnectionHandle());
   send_event_(bluetooth::hci::LeRequestPeerScaStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeSetupIsoDataPath(CommandView command) {
@@ -2746,7 +2771,7 @@ void DualModeController::LeReadRemoteFeatures(CommandView command) {
       OpCode::LE_READ_REMOTE_FEATURES, command_view.GetPayload(), handle);
 
   send_event_(bluetooth::hci::LeReadRemoteFeaturesStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeEncrypt(CommandView command) {
@@ -2758,28 +2783,28 @@ void DualModeController::LeEncrypt(CommandView command) {
       command_view.GetKey(), command_view.GetPlaintextData());
 
   send_event_(bluetooth::hci::LeEncryptCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, encrypted_data));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, encrypted_data));
 }
 
-static std::random_device rd{};
-static std::mt19937_64 s_mt{rd()};
+void DualModeController::SetRandomSeed(uint64_t seed) { random_seed = seed; }
 
 void DualModeController::LeRand(CommandView command) {
   auto command_view = gd_hci::LeRandView::Create(
       gd_hci::LeSecurityCommandView::Create(command));
   ASSERT(command_view.IsValid());
 
-  uint64_t random_val = s_mt();
+  uint64_t random_val = random_generator_();
 
   send_event_(bluetooth::hci::LeRandCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, random_val));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS, random_val));
 }
 
 void DualModeController::LeReadSupportedStates(CommandView command) {
   auto command_view = gd_hci::LeReadSupportedStatesView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::LeReadSupportedStatesCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS, properties_.le_supported_states));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
+      properties_.le_supported_states));
 }
 
 void DualModeController::LeRemoteConnectionParameterRequestReply(
@@ -2796,7 +2821,8 @@ void DualModeController::LeRemoteConnectionParameterRequestReply(
       command_view.GetMaximumCeLength());
   send_event_(
       gd_hci::LeRemoteConnectionParameterRequestReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, command_view.GetConnectionHandle()));
+          properties_.num_hci_command_packets, status,
+          command_view.GetConnectionHandle()));
 }
 
 void DualModeController::LeRemoteConnectionParameterRequestNegativeReply(
@@ -2811,7 +2837,7 @@ void DualModeController::LeRemoteConnectionParameterRequestNegativeReply(
           command_view.GetConnectionHandle(), command_view.GetReason());
   send_event_(
       gd_hci::LeRemoteConnectionParameterRequestNegativeReplyCompleteBuilder::
-          Create(kNumCommandPackets, status,
+          Create(properties_.num_hci_command_packets, status,
                  command_view.GetConnectionHandle()));
 }
 
@@ -2832,7 +2858,7 @@ void DualModeController::LeVendorCap(CommandView command) {
   raw_builder_ptr->AddOctets(properties_.le_vendor_capabilities);
 
   send_event_(bluetooth::hci::CommandCompleteBuilder::Create(
-      kNumCommandPackets, OpCode::LE_GET_VENDOR_CAPABILITIES,
+      properties_.num_hci_command_packets, OpCode::LE_GET_VENDOR_CAPABILITIES,
       std::move(raw_builder_ptr)));
 }
 
@@ -2868,7 +2894,7 @@ void DualModeController::LeSetAdvertisingSetRandomAddress(CommandView command) {
       command_view.GetAdvertisingHandle(), command_view.GetRandomAddress());
   send_event_(
       bluetooth::hci::LeSetAdvertisingSetRandomAddressCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetExtendedAdvertisingParameters(
@@ -2889,7 +2915,7 @@ void DualModeController::LeSetExtendedAdvertisingParameters(
 
   send_event_(
       bluetooth::hci::LeSetExtendedAdvertisingParametersCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS, 0xa5));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS, 0xa5));
 }
 
 void DualModeController::LeSetExtendedAdvertisingData(CommandView command) {
@@ -2904,7 +2930,7 @@ void DualModeController::LeSetExtendedAdvertisingData(CommandView command) {
       raw_command_view.GetAdvertisingData());
   send_event_(
       bluetooth::hci::LeSetExtendedAdvertisingDataCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetExtendedScanResponseData(CommandView command) {
@@ -2921,7 +2947,7 @@ void DualModeController::LeSetExtendedScanResponseData(CommandView command) {
       raw_command_view.GetScanResponseData());
   send_event_(
       bluetooth::hci::LeSetExtendedScanResponseDataCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::LeSetExtendedAdvertisingEnable(CommandView command) {
@@ -2938,7 +2964,7 @@ void DualModeController::LeSetExtendedAdvertisingEnable(CommandView command) {
   }
   send_event_(
       bluetooth::hci::LeSetExtendedAdvertisingEnableCompleteBuilder::Create(
-          kNumCommandPackets, status));
+          properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeReadMaximumAdvertisingDataLength(
@@ -2948,7 +2974,7 @@ void DualModeController::LeReadMaximumAdvertisingDataLength(
   ASSERT(command_view.IsValid());
   send_event_(
       bluetooth::hci::LeReadMaximumAdvertisingDataLengthCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS,
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS,
           kLeMaximumAdvertisingDataLength));
 }
 
@@ -2961,7 +2987,7 @@ void DualModeController::LeReadNumberOfSupportedAdvertisingSets(
   send_event_(
       bluetooth::hci::LeReadNumberOfSupportedAdvertisingSetsCompleteBuilder::
           Create(
-              kNumCommandPackets, ErrorCode::SUCCESS,
+              properties_.num_hci_command_packets, ErrorCode::SUCCESS,
               link_layer_controller_.LeReadNumberOfSupportedAdvertisingSets()));
 }
 
@@ -2972,7 +2998,7 @@ void DualModeController::LeRemoveAdvertisingSet(CommandView command) {
   auto status = link_layer_controller_.LeRemoveAdvertisingSet(
       command_view.GetAdvertisingHandle());
   send_event_(bluetooth::hci::LeRemoveAdvertisingSetCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeClearAdvertisingSets(CommandView command) {
@@ -2981,7 +3007,7 @@ void DualModeController::LeClearAdvertisingSets(CommandView command) {
   ASSERT(command_view.IsValid());
   auto status = link_layer_controller_.LeClearAdvertisingSets();
   send_event_(bluetooth::hci::LeClearAdvertisingSetsCompleteBuilder::Create(
-      kNumCommandPackets, status));
+      properties_.num_hci_command_packets, status));
 }
 
 void DualModeController::LeExtendedScanParams(CommandView command) {
@@ -3002,7 +3028,7 @@ void DualModeController::LeStartEncryption(CommandView command) {
       command_view.GetEdiv(), command_view.GetLtk());
 
   send_event_(bluetooth::hci::LeStartEncryptionStatusBuilder::Create(
-      status, kNumCommandPackets));
+      status, properties_.num_hci_command_packets));
 }
 
 void DualModeController::LeLongTermKeyRequestReply(CommandView command) {
@@ -3015,7 +3041,7 @@ void DualModeController::LeLongTermKeyRequestReply(CommandView command) {
       handle, command_view.GetLongTermKey());
 
   send_event_(bluetooth::hci::LeLongTermKeyRequestReplyCompleteBuilder::Create(
-      kNumCommandPackets, status, handle));
+      properties_.num_hci_command_packets, status, handle));
 }
 
 void DualModeController::LeLongTermKeyRequestNegativeReply(
@@ -3030,7 +3056,7 @@ void DualModeController::LeLongTermKeyRequestNegativeReply(
 
   send_event_(
       bluetooth::hci::LeLongTermKeyRequestNegativeReplyCompleteBuilder::Create(
-          kNumCommandPackets, status, handle));
+          properties_.num_hci_command_packets, status, handle));
 }
 
 void DualModeController::ReadClassOfDevice(CommandView command) {
@@ -3039,7 +3065,7 @@ void DualModeController::ReadClassOfDevice(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(bluetooth::hci::ReadClassOfDeviceCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       link_layer_controller_.GetClassOfDevice()));
 }
 
@@ -3048,7 +3074,7 @@ void DualModeController::ReadVoiceSetting(CommandView command) {
   ASSERT(command_view.IsValid());
 
   send_event_(bluetooth::hci::ReadVoiceSettingCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       link_layer_controller_.GetVoiceSetting()));
 }
 
@@ -3060,7 +3086,7 @@ void DualModeController::ReadConnectionAcceptTimeout(CommandView command) {
 
   send_event_(
       bluetooth::hci::ReadConnectionAcceptTimeoutCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS,
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS,
           link_layer_controller_.GetConnectionAcceptTimeout()));
 }
 
@@ -3075,14 +3101,14 @@ void DualModeController::WriteConnectionAcceptTimeout(CommandView command) {
 
   send_event_(
       bluetooth::hci::WriteConnectionAcceptTimeoutCompleteBuilder::Create(
-          kNumCommandPackets, ErrorCode::SUCCESS));
+          properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 void DualModeController::ReadLoopbackMode(CommandView command) {
   auto command_view = gd_hci::ReadLoopbackModeView::Create(command);
   ASSERT(command_view.IsValid());
   send_event_(bluetooth::hci::ReadLoopbackModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS,
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS,
       static_cast<LoopbackMode>(loopback_mode_)));
 }
 
@@ -3101,7 +3127,7 @@ void DualModeController::WriteLoopbackMode(CommandView command) {
       ErrorCode::SUCCESS, sco_handle, GetAddress(),
       bluetooth::hci::LinkType::SCO, bluetooth::hci::Enable::DISABLED));
   send_event_(bluetooth::hci::WriteLoopbackModeCompleteBuilder::Create(
-      kNumCommandPackets, ErrorCode::SUCCESS));
+      properties_.num_hci_command_packets, ErrorCode::SUCCESS));
 }
 
 }  // namespace rootcanal
@@ -20,6 +20,7 @@
 
 #include <cstdint>
 #include <memory>
+#include <random>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -64,12 +65,20 @@ class DualModeController : public Device {
 
   ~DualModeController() = default;
 
+  // Seeds the generators of LE Rand, which are otherwise seeded from
+  // std::random_device, to make runs reproducible. Applies to the controllers
+  // created afterwards.
+  static void SetRandomSeed(uint64_t seed);
+
   // Device methods.
   virtual std::string GetTypeString() const override;
 
   virtual void IncomingPacket(
       model::packets::LinkLayerPacketView incoming) override;
 
+  // The link layer reports the RSSI of the packets to the host
+  virtual bool ReceivesRssi() const override { return true; }
+
   virtual void TimerTick() override;
 
   virtual void Close() override;
@@ -626,8 +635,13 @@ class DualModeController : public Device {
   // Controller configuration.
   ControllerProperties properties_;
 
+  // Generator of LE Rand and of the resolvable private addresses. Per
+  // controller, as controllers may run on different shard threads.
+  std::mt19937_64 random_generator_;
+
   // Link Layer state.
-  LinkLayerController link_layer_controller_{address_, properties_};
+  LinkLayerController link_layer_controller_{address_, properties_,
+                                             random_generator_};
 
  private:
   // Set a timer for a future action
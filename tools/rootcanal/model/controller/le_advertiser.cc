@@ -16,6 +16,8 @@
 
 #include "le_advertiser.h"
 
+#include "model/setup/clock.h"
+
 using namespace bluetooth::hci;
 using namespace std::literals;
 
@@ -105,7 +107,7 @@ void LeAdvertiser::EnableExtended(std::chrono::milliseconds duration_ms) {
   Duration adv_direct_ind_interval_low = 10000us;  // 10ms
   Duration adv_direct_ind_interval_high = 3750us;  // 3.75ms
   Duration duration = duration_ms;
-  TimePoint now = std::chrono::steady_clock::now();
+  TimePoint now = Clock::now();
 
   bluetooth::hci::Address resolvable_address = get_address_();
   switch (own_address_type_) {
@@ -22,6 +22,7 @@
 #endif /* ROOTCANAL_LMP */
 
 #include "crypto_toolbox/crypto_toolbox.h"
+#include "model/setup/clock.h"
 #include "os/log.h"
 #include "packet/raw_builder.h"
 
@@ -45,13 +46,12 @@ constexpr uint16_t kNumCommandPackets = 0x01;
 constexpr milliseconds kNoDelayMs(0);
 
 // TODO: Model Rssi?
-static uint8_t GetRssi() {
-  static uint8_t rssi = 0;
-  rssi += 5;
-  if (rssi > 128) {
-    rssi = rssi % 7;
+uint8_t LinkLayerController::GetRssi() {
+  rssi_ += 5;
+  if (rssi_ > 128) {
+    rssi_ = rssi_ % 7;
   }
-  return -(rssi);
+  return -(rssi_);
 }
 
 const Address& LinkLayerController::GetAddress() const { return address_; }
@@ -188,9 +188,11 @@ void LinkLayerController::SendLeLinkLayerPacketWithRssi(
 
 #ifdef ROOTCANAL_LMP
 LinkLayerController::LinkLayerController(const Address& address,
-                                         const ControllerProperties& properties)
+                                         const ControllerProperties& properties,
+                                         std::mt19937_64& random_generator)
     : address_(address),
       properties_(properties),
+      random_generator_(random_generator),
       lm_(nullptr, link_manager_destroy) {
   ops_ = {
       .user_pointer = this,
@@ -249,8 +251,11 @@ LinkLayerController::LinkLayerController(const Address& address,
 }
 #else
 LinkLayerController::LinkLayerController(const Address& address,
-                                         const ControllerProperties& properties)
-    : address_(address), properties_(properties) {}
+                                         const ControllerProperties& properties,
+                                         std::mt19937_64& random_generator)
+    : address_(address),
+      properties_(properties),
+      random_generator_(random_generator) {}
 #endif
 
 void LinkLayerController::SendLeLinkLayerPacket(
@@ -1454,19 +1459,21 @@ static bool rpa_matches_irk(
 }
 
 static Address generate_rpa(
-    std::array<uint8_t, LinkLayerController::kIrkSize> irk) {
+    std::array<uint8_t, LinkLayerController::kIrkSize> irk,
+    std::mt19937_64& random_generator) {
   // most significant bit, bit7, bit6 is 01 to be resolvable random
   // Bits of the random part of prand shall not be all 1 or all 0
+  uint64_t random = random_generator();
   std::array<uint8_t, 3> prand;
-  prand[0] = std::rand();
-  prand[1] = std::rand();
-  prand[2] = std::rand();
+  prand[0] = (uint8_t)random;
+  prand[1] = (uint8_t)(random >> 8);
+  prand[2] = (uint8_t)(random >> 16);
 
   constexpr uint8_t BLE_RESOLVE_ADDR_MSB = 0x40;
   prand[2] &= ~0xC0;  // BLE Address mask
   if ((prand[0] == 0x00 && prand[1] == 0x00 && prand[2] == 0x00) ||
       (prand[0] == 0xFF && prand[1] == 0xFF && prand[2] == 0x3F)) {
-    prand[0] = (uint8_t)(std::rand() % 0xFE + 1);
+    prand[0] = (uint8_t)((random >> 24) % 0xFE + 1);
   }
   prand[2] |= BLE_RESOLVE_ADDR_MSB;
 
@@ -1588,7 +1595,7 @@ void LinkLayerController::IncomingLeAdvertisementPacket(
         resolved = true;
         resolved_address = entry.address;
         resolved_address_type = entry.address_type;
-        rpa = generate_rpa(entry.local_irk);
+        rpa = generate_rpa(entry.local_irk, random_generator_);
       }
     }
   }
@@ -2371,7 +2378,7 @@ void LinkLayerController::Close() {
 }
 
 void LinkLayerController::LeAdvertising() {
-  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point now = Clock::now();
   for (auto& advertiser : advertisers_) {
     auto event = advertiser.GetEvent(now);
     if (event != nullptr) {
@@ -3410,7 +3417,7 @@ ErrorCode LinkLayerController::SetLeExtendedAdvertisingParameters(
           for (const auto& entry : le_resolving_list_) {
             if (entry.address == peer_address.GetAddress() &&
                 entry.address_type == peer_address.GetAddressType()) {
-              return generate_rpa(entry.local_irk);
+              return generate_rpa(entry.local_irk, random_generator_);
             }
           }
         }
@@ -3998,7 +4005,7 @@ void LinkLayerController::Reset() {
     CancelScheduledTask(inquiry_timer_task_id_);
     inquiry_timer_task_id_ = kInvalidTaskId;
   }
-  last_inquiry_ = steady_clock::now();
+  last_inquiry_ = Clock::now();
   page_scan_enable_ = false;
   inquiry_scan_enable_ = false;
 #ifdef ROOTCANAL_LMP
@@ -4039,7 +4046,7 @@ void LinkLayerController::SetInquiryMaxResponses(uint8_t max) {
 }
 
 void LinkLayerController::Inquiry() {
-  steady_clock::time_point now = steady_clock::now();
+  steady_clock::time_point now = Clock::now();
   if (duration_cast<milliseconds>(now - last_inquiry_) < milliseconds(2000)) {
     return;
   }
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <random>
+
 #include "hci/address.h"
 #include "hci/hci_packets.h"
 #include "include/phy.h"
@@ -55,7 +57,8 @@ class LinkLayerController {
   ErrorCode LeSetHostFeature(uint8_t bit_number, uint8_t bit_value);
 
   LinkLayerController(const Address& address,
-                      const ControllerProperties& properties);
+                      const ControllerProperties& properties,
+                      std::mt19937_64& random_generator);
 
   ErrorCode SendCommandToRemoteByAddress(
       OpCode opcode, bluetooth::packet::PacketView<true> args,
@@ -125,6 +128,9 @@ class LinkLayerController {
   void IncomingPacketWithRssi(model::packets::LinkLayerPacketView incoming,
                               uint8_t rssi);
 
+  // RSSI of the packets received without one
+  uint8_t GetRssi();
+
  public:
   const Address& GetAddress() const;
 
@@ -629,6 +635,7 @@ class LinkLayerController {
  private:
   const Address& address_;
   const ControllerProperties& properties_;
+  std::mt19937_64& random_generator_;
 
   // Host Supported Features (Vol 2, Part C § 3.3 Feature Mask Definition).
   // Page 1 of the LMP feature mask.
@@ -646,6 +653,10 @@ class LinkLayerController {
   // LE Random Address (Vol 4, Part E § 7.8.4).
   Address random_address_{Address::kEmpty};
 
+  // Last RSSI given by GetRssi(). Per controller, as controllers may run on
+  // different shard threads.
+  uint8_t rssi_{0};
+
   // HCI configuration parameters.
   //
   // Provide the current HCI Configuration Parameters as defined in section
@@ -16,6 +16,7 @@
 
 #include "beacon.h"
 
+#include "model/setup/clock.h"
 #include "model/setup/device_boutique.h"
 
 namespace rootcanal {
@@ -47,7 +48,7 @@ Beacon::Beacon(const std::vector<std::string>& args) : Beacon() {
 }
 
 void Beacon::TimerTick() {
-  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::steady_clock::time_point now = Clock::now();
   if ((now - advertising_last_) >= advertising_interval_) {
     advertising_last_ = now;
     SendLinkLayerPacket(
@@ -42,6 +42,9 @@ class Beacon : public Device {
   virtual void IncomingPacket(
       model::packets::LinkLayerPacketView packet) override;
 
+  // Beacons only answer the scans sent to them
+  virtual bool ReceivesOnlyAddressedPackets() const override { return true; }
+
  protected:
   model::packets::AdvertisementType advertising_type_{};
   std::array<uint8_t, 31> advertising_data_{};
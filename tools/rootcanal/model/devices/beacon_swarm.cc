@@ -64,8 +64,10 @@ BeaconSwarm::BeaconSwarm(const vector<std::string>& args) : Beacon(args) {
 
 void BeaconSwarm::TimerTick() {
   // Rotate the advertising address.
-  uint8_t* low_order_byte = address_.data();
+  Address address = address_;
+  uint8_t* low_order_byte = address.data();
   *low_order_byte += 1;
+  SetAddress(address);
   Beacon::TimerTick();
 }
 
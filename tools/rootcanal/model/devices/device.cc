@@ -18,13 +18,41 @@
 
 #include <vector>
 
+#include "os/log.h"
+
 namespace rootcanal {
 
 std::string Device::ToString() const {
   return GetTypeString() + "@" + address_.ToString();
 }
 
+void Device::SetAddress(Address address) {
+  address_ = address;
+  if (ReceivesOnlyAddressedPackets()) {
+    for (auto& phy : phy_layers_) {
+      if (phy != nullptr) {
+        phy->ReceiveOnlyAddressedTo(address_);
+      }
+    }
+  }
+}
+
+void Device::SetPosition(Position position) {
+  position_ = position;
+  for (auto& phy : phy_layers_) {
+    if (phy != nullptr) {
+      phy->SetPosition(position);
+    }
+  }
+}
+
 void Device::RegisterPhyLayer(std::shared_ptr<PhyLayer> phy) {
+  if (ReceivesOnlyAddressedPackets()) {
+    phy->ReceiveOnlyAddressedTo(address_);
+  }
+  if (position_) {
+    phy->SetPosition(*position_);
+  }
   phy_layers_.push_back(phy);
 }
 
@@ -48,6 +76,25 @@ void Device::UnregisterPhyLayer(Phy::Type phy_type, uint32_t factory_id) {
   }
 }
 
+void Device::ReceiveLinkLayerPacket(
+    model::packets::LinkLayerPacketView packet) {
+  if (!ReceivesRssi() &&
+      packet.GetType() == model::packets::PacketType::RSSI_WRAPPER) {
+    auto rssi_wrapper = model::packets::RssiWrapperView::Create(packet);
+    if (!rssi_wrapper.IsValid()) {
+      LOG_WARN("Dropping invalid RSSI wrapper");
+      return;
+    }
+    packet =
+        model::packets::LinkLayerPacketView::Create(rssi_wrapper.GetPayload());
+    if (!packet.IsValid()) {
+      LOG_WARN("Dropping invalid wrapped packet");
+      return;
+    }
+  }
+  IncomingPacket(std::move(packet));
+}
+
 void Device::SendLinkLayerPacket(
     std::shared_ptr<model::packets::LinkLayerPacketBuilder> to_send,
     Phy::Type phy_type) {
@@ -19,6 +19,7 @@
 #include <chrono>
 #include <cstdint>
 #include <map>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -44,11 +45,14 @@ class Device {
   virtual std::string ToString() const;
 
   // Set the device's Bluetooth address.
-  void SetAddress(Address address) { address_ = address; }
+  void SetAddress(Address address);
 
   // Get the device's Bluetooth address.
   const Address& GetAddress() const { return address_; }
 
+  // Set the device's position on the phys, in meters.
+  void SetPosition(Position position);
+
   // Let the device know that time has passed.
   virtual void TimerTick() {}
 
@@ -58,8 +62,21 @@ class Device {
 
   void UnregisterPhyLayer(Phy::Type phy_type, uint32_t factory_id);
 
+  // Called by the phys with the packets sent to the device. Unwraps the RSSI
+  // wrapper of positioned senders for the devices that do not read it, and
+  // passes the packet to IncomingPacket().
+  void ReceiveLinkLayerPacket(model::packets::LinkLayerPacketView packet);
+
   virtual void IncomingPacket(model::packets::LinkLayerPacketView){};
 
+  // Devices which handle RSSI_WRAPPER packets return true, so that they get
+  // the RSSI of the packets they receive.
+  virtual bool ReceivesRssi() const { return false; }
+
+  // Devices which only handle the packets sent to their address return true,
+  // so that phys do not deliver them any other packet.
+  virtual bool ReceivesOnlyAddressedPackets() const { return false; }
+
   virtual void SendLinkLayerPacket(
       std::shared_ptr<model::packets::LinkLayerPacketBuilder> packet,
       Phy::Type phy_type);
@@ -79,6 +96,8 @@ class Device {
   // Bluetooth activities.
   Address address_;
 
+  std::optional<Position> position_;
+
   // Callback to be invoked when this device is closed.
   std::function<void()> close_callback_;
 };
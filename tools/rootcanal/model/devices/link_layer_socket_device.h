@@ -51,6 +51,9 @@ class LinkLayerSocketDevice : public Device {
   virtual void IncomingPacket(
       model::packets::LinkLayerPacketView packet) override;
 
+  // The packets are forwarded as they are, to a remote controller
+  virtual bool ReceivesRssi() const override { return true; }
+
   virtual void TimerTick() override;
 
   static constexpr size_t kSizeBytes = sizeof(uint32_t);
@@ -41,6 +41,8 @@ class Sniffer : public Device {
   virtual void IncomingPacket(
       model::packets::LinkLayerPacketView packet) override;
 
+  virtual bool ReceivesRssi() const override { return true; }
+
  private:
   static bool registered_;
 };
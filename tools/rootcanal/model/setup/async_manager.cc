@@ -19,13 +19,16 @@
 #include <algorithm>
 #include <atomic>
 #include <condition_variable>
+#include <cstring>
 #include <mutex>
 #include <thread>
+#include <unordered_map>
 #include <vector>
 
+#include "clock.h"
 #include "fcntl.h"
 #include "os/log.h"
-#include "sys/select.h"
+#include "sys/epoll.h"
 #include "unistd.h"
 
 namespace rootcanal {
@@ -38,15 +41,20 @@ namespace rootcanal {
 // objects of this class may coexist simultaneosly as they share no state.
 // After construction of this objects nothing happens beyond some very simple
 // member initialization. When the first FD is set up for watching the object
-// starts a new thread which watches the given (and later provided) FDs using
-// select() inside a loop. A special FD (a pipe) is also watched which is
-// used to notify the thread of internal changes on the object state (like
-// the addition of new FDs to watch on). Every access to internal state is
-// synchronized using a single internal mutex. The thread is only stopped on
-// destruction of the object, by modifying a flag, which is the only member
-// variable accessed without acquiring the lock (because the notification to
-// the thread is done later by writing to a pipe which means the thread will
-// be notified regardless of what phase of the loop it is in that moment)
+// creates an epoll instance and starts a new thread which waits on it inside a
+// loop. FDs are added to and removed from the epoll instance as they are
+// watched and unwatched, so a wakeup only costs as much as the number of FDs
+// that are ready, and there is no FD_SETSIZE limit on the FD numbers. Reads
+// are level-triggered: a callback that does not drain its FD is called again.
+// A special FD (a pipe) is also watched which is used to notify the thread
+// when it has to stop. Every access to internal state is synchronized using a
+// single internal mutex, which is also held while callbacks run so that a
+// callback is never called after StopWatchingFileDescriptor() returns. The
+// thread is only stopped on destruction of the object, by modifying a flag,
+// which is the only member variable accessed without acquiring the lock
+// (because the notification to the thread is done later by writing to a pipe
+// which means the thread will be notified regardless of what phase of the
+// loop it is in that moment)
 
 // The scheduling of asynchronous tasks, periodic or not, is handled by the
 // AsyncTaskManager class. Like the one for FDs, this class shares no internal
@@ -54,8 +62,10 @@ namespace rootcanal {
 // this class, also nothing interesting happens upon construction, but only
 // after a Task has been scheduled and access to internal state is synchronized
 // using a single internal mutex. When the first task is scheduled a thread
-// is started which monitors a queue of tasks. The queue is peeked to see
-// when the next task should be carried out and then the thread performs a
+// is started which monitors a queue of tasks, kept as a binary heap on the
+// due time. Cancelled tasks are only flagged and are dropped when they reach
+// the front of the heap, or all at once when they become the majority. The
+// heap is peeked to see when the next task should be carried out and then the thread performs a
 // (absolute) timed wait on a condition variable. The wait ends because of a
 // time out or a notify on the cond var, the former means a task is due
 // for execution while the later means there has been a change in internal
@@ -91,16 +101,16 @@ static inline AsyncTaskId NextAsyncTaskId(const AsyncTaskId id) {
 // no need to treat that case.
 static const int kNotificationBufferSize = 10;
 
+// Maximum number of ready FDs handled per wakeup of the reading thread, the
+// others are reported by the next call to epoll_wait()
+static const int kMaxEpollEvents = 64;
+
 // Async File Descriptor Watcher Implementation:
 class AsyncManager::AsyncFdWatcher {
  public:
   int WatchFdForNonBlockingReads(
       int file_descriptor, const ReadCallback& on_read_fd_ready_callback) {
-    // add file descriptor and callback
-    {
-      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-      watched_shared_fds_[file_descriptor] = on_read_fd_ready_callback;
-    }
+    std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
 
     // start the thread if not started yet
     int started = tryStartThread();
@@ -109,15 +119,32 @@ class AsyncManager::AsyncFdWatcher {
       return started;
     }
 
-    // notify the thread so that it knows of the new FD
-    notifyThread();
+    // add file descriptor and callback, the thread picks up the new FD from
+    // the epoll instance without being notified
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = file_descriptor;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, file_descriptor, &event) < 0 &&
+        !(errno == EEXIST &&
+          epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, file_descriptor, &event) == 0)) {
+      LOG_ERROR("%s: Unable to watch fd %d: %s", __func__, file_descriptor,
+                strerror(errno));
+      watched_shared_fds_.erase(file_descriptor);
+      return -1;
+    }
+    watched_shared_fds_[file_descriptor] = on_read_fd_ready_callback;
 
     return 0;
   }
 
   void StopWatchingFileDescriptor(int file_descriptor) {
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-    watched_shared_fds_.erase(file_descriptor);
+    if (watched_shared_fds_.erase(file_descriptor) == 0) {
+      return;
+    }
+    // Fails harmlessly if the FD has already been closed, which removed it
+    // from the epoll instance
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, file_descriptor, nullptr);
   }
 
   AsyncFdWatcher() = default;
@@ -135,6 +162,9 @@ class AsyncManager::AsyncFdWatcher {
 
     if (std::this_thread::get_id() != thread_.get_id()) {
       thread_.join();
+      close(epoll_fd_);
+      close(notification_listen_fd_);
+      close(notification_write_fd_);
     } else {
       LOG_WARN("%s: Starting thread stop from inside the reading thread itself",
                __func__);
@@ -149,12 +179,18 @@ class AsyncManager::AsyncFdWatcher {
   }
 
  private:
-  // Make sure to call this with at least one file descriptor ready to be
-  // watched upon or the thread routine will return immediately
+  // Must be called while holding internal_mutex_
   int tryStartThread() {
     if (std::atomic_exchange(&running_, true)) {
       return 0;  // if already running
     }
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+      LOG_ERROR("%s: Unable to create the epoll instance: %s", __func__,
+                strerror(errno));
+      running_ = false;
+      return -1;
+    }
     // set up the communication channel
     int pipe_fds[2];
     if (pipe2(pipe_fds, O_NONBLOCK)) {
@@ -162,10 +198,16 @@ class AsyncManager::AsyncFdWatcher {
           "%s:Unable to establish a communication channel to the reading "
           "thread",
           __func__);
+      close(epoll_fd_);
+      running_ = false;
       return -1;
     }
     notification_listen_fd_ = pipe_fds[0];
     notification_write_fd_ = pipe_fds[1];
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = notification_listen_fd_;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, notification_listen_fd_, &event);
 
     thread_ = std::thread([this]() { ThreadRoutine(); });
     if (!thread_.joinable()) {
@@ -184,58 +226,39 @@ class AsyncManager::AsyncFdWatcher {
     return 0;
   }
 
-  int setUpFileDescriptorSet(fd_set& read_fds) {
-    // add comm channel to the set
-    FD_SET(notification_listen_fd_, &read_fds);
-    int nfds = notification_listen_fd_;
-
-    // add watched FDs to the set
-    {
-      std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-      for (auto& fdp : watched_shared_fds_) {
-        FD_SET(fdp.first, &read_fds);
-        nfds = std::max(fdp.first, nfds);
-      }
-    }
-    return nfds;
-  }
-
-  // check the comm channel and read everything there
-  bool consumeThreadNotifications(fd_set& read_fds) {
-    if (FD_ISSET(notification_listen_fd_, &read_fds)) {
-      char buffer[kNotificationBufferSize];
-      while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
-                                     kNotificationBufferSize)) ==
-             kNotificationBufferSize) {
-      }
-      return true;
+  // read everything there is in the comm channel
+  void consumeThreadNotifications() {
+    char buffer[kNotificationBufferSize];
+    while (TEMP_FAILURE_RETRY(read(notification_listen_fd_, buffer,
+                                   kNotificationBufferSize)) ==
+           kNotificationBufferSize) {
     }
-    return false;
   }
 
-  // check all file descriptors and call callbacks if necesary
-  void runAppropriateCallbacks(fd_set& read_fds) {
-    std::vector<decltype(watched_shared_fds_)::value_type> fds;
+  // call the callbacks of the ready file descriptors
+  void runAppropriateCallbacks(const struct epoll_event* events,
+                               int num_events) {
     std::unique_lock<std::recursive_mutex> guard(internal_mutex_);
-    for (auto& fdc : watched_shared_fds_) {
-      if (FD_ISSET(fdc.first, &read_fds)) {
-        fds.push_back(fdc);
+    for (int i = 0; i < num_events; i++) {
+      int fd = events[i].data.fd;
+      // An earlier callback may have stopped watching this FD
+      auto it = watched_shared_fds_.find(fd);
+      if (it == watched_shared_fds_.end()) {
+        continue;
       }
-    }
-    for (auto& p : fds) {
-      p.second(p.first);
+      // The callback may stop watching its own FD, which destroys the map entry
+      ReadCallback callback = it->second;
+      callback(fd);
     }
   }
 
   void ThreadRoutine() {
+    struct epoll_event events[kMaxEpollEvents];
     while (running_) {
-      fd_set read_fds;
-      FD_ZERO(&read_fds);
-      int nfds = setUpFileDescriptorSet(read_fds);
-
       // wait until there is data available to read on some FD
-      int retval = select(nfds + 1, &read_fds, NULL, NULL, NULL);
-      if (retval <= 0) {  // there was some error or a timeout
+      int num_events = TEMP_FAILURE_RETRY(
+          epoll_wait(epoll_fd_, events, kMaxEpollEvents, -1));
+      if (num_events < 0) {
         LOG_ERROR(
             "%s: There was an error while waiting for data on the file "
             "descriptors: %s",
@@ -243,14 +266,18 @@ class AsyncManager::AsyncFdWatcher {
         continue;
       }
 
-      consumeThreadNotifications(read_fds);
+      for (int i = 0; i < num_events; i++) {
+        if (events[i].data.fd == notification_listen_fd_) {
+          consumeThreadNotifications();
+        }
+      }
 
       // Do not read if there was a call to stop running
       if (!running_) {
         break;
       }
 
-      runAppropriateCallbacks(read_fds);
+      runAppropriateCallbacks(events, num_events);
     }
   }
 
@@ -258,7 +285,9 @@ class AsyncManager::AsyncFdWatcher {
   std::thread thread_;
   std::recursive_mutex internal_mutex_;
 
-  std::map<int, ReadCallback> watched_shared_fds_;
+  std::unordered_map<int, ReadCallback> watched_shared_fds_;
+
+  int epoll_fd_{-1};
 
   // A pair of FD to send information to the reading thread
   int notification_listen_fd_{};
@@ -272,16 +301,16 @@ class AsyncManager::AsyncTaskManager {
 
   AsyncTaskId ExecAsync(AsyncUserId user_id, std::chrono::milliseconds delay,
                         const TaskCallback& callback) {
-    return scheduleTask(std::make_shared<Task>(
-        std::chrono::steady_clock::now() + delay, callback, user_id));
+    return scheduleTask(
+        std::make_shared<Task>(Now() + delay, callback, user_id));
   }
 
   AsyncTaskId ExecAsyncPeriodically(AsyncUserId user_id,
                                     std::chrono::milliseconds delay,
                                     std::chrono::milliseconds period,
                                     const TaskCallback& callback) {
-    return scheduleTask(std::make_shared<Task>(
-        std::chrono::steady_clock::now() + delay, period, callback, user_id));
+    return scheduleTask(
+        std::make_shared<Task>(Now() + delay, period, callback, user_id));
   }
 
   bool CancelAsyncTask(AsyncTaskId async_task_id) {
@@ -303,6 +332,32 @@ class AsyncManager::AsyncTaskManager {
     return true;
   }
 
+  void EnableVirtualTime() {
+    std::unique_lock<std::mutex> guard(internal_mutex_);
+    if (!task_queue_.empty()) {
+      LOG_WARN("%s: Tasks scheduled in real time are pending", __func__);
+    }
+    virtual_time_ = true;
+    virtual_time_limit_ = kVirtualTimeEpoch;
+    set_virtual_now_with_lock_held(kVirtualTimeEpoch);
+  }
+
+  bool AdvanceVirtualTime(std::chrono::milliseconds duration,
+                          const TaskCallback& on_reached) {
+    std::shared_ptr<Task> task;
+    {
+      std::unique_lock<std::mutex> guard(internal_mutex_);
+      if (!virtual_time_) {
+        return false;
+      }
+      virtual_time_limit_ += duration;
+      task = std::make_shared<Task>(virtual_time_limit_, on_reached,
+                                    kVirtualTimeUserId);
+    }
+    // Also wakes up the thread, which may now run the tasks until the limit
+    return scheduleTask(task) != kInvalidTaskId;
+  }
+
   AsyncTaskManager() = default;
   AsyncTaskManager(const AsyncTaskManager&) = delete;
   AsyncTaskManager& operator=(const AsyncTaskManager&) = delete;
@@ -314,6 +369,10 @@ class AsyncManager::AsyncTaskManager {
       std::unique_lock<std::mutex> guard(internal_mutex_);
       tasks_by_id_.clear();
       task_queue_.clear();
+      cancelled_tasks_in_queue_ = 0;
+      if (virtual_time_) {
+        Clock::DisableVirtualTime();
+      }
       if (!running_) {
         return 0;
       }
@@ -331,6 +390,16 @@ class AsyncManager::AsyncTaskManager {
   }
 
  private:
+  // Virtual time starts a day after the steady clock epoch, so that the
+  // time_points the model initializes to the epoch are long past, as they
+  // are in real time
+  static constexpr std::chrono::steady_clock::time_point kVirtualTimeEpoch{
+      std::chrono::hours(24)};
+
+  // Owner of the tasks notifying the end of AdvanceVirtualTime; user ids
+  // handed out by GetNextUserId() start at 1
+  static constexpr AsyncUserId kVirtualTimeUserId = 0;
+
   // Holds the data for each task
   class Task {
    public:
@@ -365,16 +434,18 @@ class AsyncManager::AsyncTaskManager {
     bool periodic;
     std::chrono::milliseconds period{};
     std::mutex in_callback; // Taken when the callback is active
+    bool cancelled{false};  // Left in the heap until popped or compacted
     TaskCallback callback;
     AsyncTaskId task_id;
     AsyncUserId user_id;
   };
 
-  // A comparator class to put shared pointers to tasks in an ordered set
+  // A comparator class to keep shared pointers to tasks in a heap with the
+  // earliest task at the front
   struct task_p_comparator {
     bool operator()(const std::shared_ptr<Task>& t1,
                     const std::shared_ptr<Task>& t2) const {
-      return *t1 < *t2;
+      return *t2 < *t1;
     }
   };
 
@@ -391,16 +462,57 @@ class AsyncManager::AsyncTaskManager {
     if (thread_.get_id() != std::this_thread::get_id()) {
       auto task = tasks_by_id_[async_task_id];
       const std::lock_guard<std::mutex> lock(task->in_callback);
-      task_queue_.erase(task);
+      mark_task_cancelled_with_lock_held(task);
       tasks_by_id_.erase(async_task_id);
     } else {
-      task_queue_.erase(tasks_by_id_[async_task_id]);
+      mark_task_cancelled_with_lock_held(tasks_by_id_[async_task_id]);
       tasks_by_id_.erase(async_task_id);
     }
 
     return true;
   }
 
+  // Every task in tasks_by_id_ is in the heap, so is a task being cancelled
+  void mark_task_cancelled_with_lock_held(const std::shared_ptr<Task>& task) {
+    task->cancelled = true;
+    cancelled_tasks_in_queue_++;
+    // Rebuild the heap when cancelled tasks make up most of it, so that tasks
+    // cancelled long before they are due do not accumulate
+    if (cancelled_tasks_in_queue_ > task_queue_.size() / 2) {
+      task_queue_.erase(
+          std::remove_if(task_queue_.begin(), task_queue_.end(),
+                         [](const std::shared_ptr<Task>& queued_task) {
+                           return queued_task->cancelled;
+                         }),
+          task_queue_.end());
+      std::make_heap(task_queue_.begin(), task_queue_.end(),
+                     task_p_comparator());
+      cancelled_tasks_in_queue_ = 0;
+    }
+  }
+
+  void push_task_with_lock_held(const std::shared_ptr<Task>& task) {
+    task_queue_.push_back(task);
+    std::push_heap(task_queue_.begin(), task_queue_.end(),
+                   task_p_comparator());
+  }
+
+  std::shared_ptr<Task> pop_task_with_lock_held() {
+    std::pop_heap(task_queue_.begin(), task_queue_.end(), task_p_comparator());
+    std::shared_ptr<Task> task = std::move(task_queue_.back());
+    task_queue_.pop_back();
+    return task;
+  }
+
+  // Drops the cancelled tasks from the front of the heap, so that the front
+  // (if any) is the next task to run
+  void pop_cancelled_tasks_with_lock_held() {
+    while (!task_queue_.empty() && task_queue_.front()->cancelled) {
+      pop_task_with_lock_held();
+      cancelled_tasks_in_queue_--;
+    }
+  }
+
   AsyncTaskId scheduleTask(const std::shared_ptr<Task>& task) {
     {
       std::unique_lock<std::mutex> guard(internal_mutex_);
@@ -414,7 +526,7 @@ class AsyncManager::AsyncTaskManager {
       // add task to the queue and map
       tasks_by_id_[lastTaskId_] = task;
       tasks_by_user_id_[task->user_id].insert(task->task_id);
-      task_queue_.insert(task);
+      push_task_with_lock_held(task);
     }
     // start thread if necessary
     int started = tryStartThread();
@@ -428,6 +540,26 @@ class AsyncManager::AsyncTaskManager {
     return task->task_id;
   }
 
+  std::chrono::steady_clock::time_point Now() const {
+    return virtual_time_ ? virtual_now_.load()
+                         : std::chrono::steady_clock::now();
+  }
+
+  void set_virtual_now_with_lock_held(
+      std::chrono::steady_clock::time_point time) {
+    virtual_now_ = time;
+    Clock::SetVirtualTime(time);
+  }
+
+  // Whether the task at the front of the heap should run now. In virtual time
+  // the clock jumps to it instead of waiting for it.
+  bool is_front_task_due_with_lock_held() const {
+    if (virtual_time_) {
+      return task_queue_.front()->time <= virtual_time_limit_;
+    }
+    return task_queue_.front()->time < std::chrono::steady_clock::now();
+  }
+
   bool isTaskIdInUse(const AsyncTaskId& task_id) const {
     return tasks_by_id_.count(task_id) != 0;
   }
@@ -456,16 +588,20 @@ class AsyncManager::AsyncTaskManager {
       bool run_it = false;
       {
         std::unique_lock<std::mutex> guard(internal_mutex_);
+        pop_cancelled_tasks_with_lock_held();
         if (!task_queue_.empty()) {
-          task_p = *(task_queue_.begin());
-          if (task_p->time < std::chrono::steady_clock::now()) {
+          task_p = task_queue_.front();
+          if (is_front_task_due_with_lock_held()) {
             run_it = true;
+            if (virtual_time_ && task_p->time > virtual_now_.load()) {
+              set_virtual_now_with_lock_held(task_p->time);
+            }
             callback = task_p->callback;
-            task_queue_.erase(task_p);  // need to remove and add again if
+            pop_task_with_lock_held();  // need to remove and add again if
                                         // periodic to update order
             if (task_p->isPeriodic()) {
               task_p->time += task_p->period;
-              task_queue_.insert(task_p);
+              push_task_with_lock_held(task_p);
             } else {
               tasks_by_user_id_[task_p->user_id].erase(task_p->task_id);
               tasks_by_id_.erase(task_p->task_id);
@@ -482,12 +618,18 @@ class AsyncManager::AsyncTaskManager {
         // check for termination right before waiting
         if (!running_) break;
         // wait until time for the next task (if any)
-        if (task_queue_.size() > 0) {
+        pop_cancelled_tasks_with_lock_held();
+        if (virtual_time_) {
+          // Nothing to wait for until a task is due before the limit
+          if (task_queue_.empty() || !is_front_task_due_with_lock_held()) {
+            internal_cond_var_.wait(guard);
+          }
+        } else if (task_queue_.size() > 0) {
           // Make a copy of the time_point because wait_until takes a reference
           // to it and may read it after waiting, by which time the task may
           // have been freed (e.g. via CancelAsyncTask).
           std::chrono::steady_clock::time_point time =
-              (*task_queue_.begin())->time;
+              task_queue_.front()->time;
           internal_cond_var_.wait_until(guard, time);
         } else {
           internal_cond_var_.wait(guard);
@@ -505,7 +647,13 @@ class AsyncManager::AsyncTaskManager {
   AsyncUserId lastUserId_{1};
   std::map<AsyncTaskId, std::shared_ptr<Task>> tasks_by_id_;
   std::map<AsyncUserId, std::set<AsyncTaskId>> tasks_by_user_id_;
-  std::set<std::shared_ptr<Task>, task_p_comparator> task_queue_;
+  // Binary heap ordered by task_p_comparator
+  std::vector<std::shared_ptr<Task>> task_queue_;
+  size_t cancelled_tasks_in_queue_ = 0;
+
+  std::atomic_bool virtual_time_{false};
+  std::atomic<std::chrono::steady_clock::time_point> virtual_now_{};
+  std::chrono::steady_clock::time_point virtual_time_limit_{};
 };
 
 // Async Manager Implementation:
@@ -559,6 +707,15 @@ bool AsyncManager::CancelAsyncTasksFromUser(rootcanal::AsyncUserId user_id) {
   return taskManager_p_->CancelAsyncTasksFromUser(user_id);
 }
 
+void AsyncManager::EnableVirtualTime() {
+  taskManager_p_->EnableVirtualTime();
+}
+
+bool AsyncManager::AdvanceVirtualTime(std::chrono::milliseconds duration,
+                                      const TaskCallback& on_reached) {
+  return taskManager_p_->AdvanceVirtualTime(duration, on_reached);
+}
+
 void AsyncManager::Synchronize(const CriticalCallback& critical) {
   std::unique_lock<std::mutex> guard(synchronization_mutex_);
   critical();
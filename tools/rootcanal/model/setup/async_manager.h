@@ -91,6 +91,19 @@ class AsyncManager {
   //   completed, unless cancel is called from the running task.
   bool CancelAsyncTasksFromUser(AsyncUserId user_id);
 
+  // Switches the tasks to virtual time. Virtual time starts at a fixed epoch
+  // and only moves forward as far as AdvanceVirtualTime() allows: tasks due
+  // before that limit run in the order of their due time without waiting for
+  // it, and Clock::now() reads the due time of the last task run. It must be
+  // called before any task is scheduled.
+  void EnableVirtualTime();
+
+  // Lets virtual time run |duration| past its current limit. |on_reached| is
+  // called on the task thread once the tasks due until the new limit have run.
+  // Returns false if virtual time is not enabled.
+  bool AdvanceVirtualTime(std::chrono::milliseconds duration,
+                          const TaskCallback& on_reached);
+
   // Execs the given code in a synchronized manner. It is guaranteed that code
   // given on (possibly)concurrent calls to this member function on the same
   // AsyncManager object will never be executed simultaneously. It is the
@@ -0,0 +1,45 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "clock.h"
+
+#include <atomic>
+
+namespace rootcanal {
+
+namespace {
+std::atomic_bool virtual_time_enabled{false};
+std::atomic<Clock::duration::rep> virtual_time{0};
+}  // namespace
+
+Clock::time_point Clock::now() {
+  if (virtual_time_enabled.load(std::memory_order_acquire)) {
+    return time_point(duration(virtual_time.load(std::memory_order_acquire)));
+  }
+  return std::chrono::steady_clock::now();
+}
+
+void Clock::SetVirtualTime(time_point time) {
+  virtual_time.store(time.time_since_epoch().count(),
+                     std::memory_order_release);
+  virtual_time_enabled.store(true, std::memory_order_release);
+}
+
+void Clock::DisableVirtualTime() {
+  virtual_time_enabled.store(false, std::memory_order_release);
+}
+
+}  // namespace rootcanal
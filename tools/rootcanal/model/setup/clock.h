@@ -0,0 +1,41 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <chrono>
+
+namespace rootcanal {
+
+// Time source of the simulated devices. It reads the steady clock, unless the
+// AsyncManager running the simulation is in virtual time (see
+// AsyncManager::EnableVirtualTime), in which case it reads the due time of the
+// task being run. The model must use it instead of std::chrono::steady_clock
+// for its timestamps and timeouts to follow virtual time.
+class Clock {
+ public:
+  using duration = std::chrono::steady_clock::duration;
+  using time_point = std::chrono::steady_clock::time_point;
+
+  static time_point now();
+
+  // Used by the AsyncManager in virtual time. A single AsyncManager of the
+  // process may drive the virtual time at once.
+  static void SetVirtualTime(time_point time);
+  static void DisableVirtualTime();
+};
+
+}  // namespace rootcanal
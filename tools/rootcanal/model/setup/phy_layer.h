@@ -16,10 +16,21 @@
 
 #pragma once
 
+#include "hci/address.h"
 #include "include/phy.h"
 #include "packets/link_layer_packets.h"
 namespace rootcanal {
 
+using ::bluetooth::hci::Address;
+
+// Position of a device in meters. Phys use the distance between two
+// positioned devices for the RSSI of their packets and to cull the devices
+// out of range.
+struct Position {
+  double x;
+  double y;
+};
+
 class PhyLayer {
  public:
   PhyLayer(Phy::Type phy_type, uint32_t id,
@@ -41,6 +52,12 @@ class PhyLayer {
 
   virtual bool IsFactoryId(uint32_t factory_id) = 0;
 
+  // Restricts the packets delivered to the device to the ones sent to
+  // |address|, which lets the phy skip the device for every other packet.
+  virtual void ReceiveOnlyAddressedTo(Address address) = 0;
+
+  virtual void SetPosition(Position position) = 0;
+
   virtual void Unregister() = 0;
 
   Phy::Type GetType() { return phy_type_; }
@@ -16,10 +16,74 @@
 
 #include "phy_layer_factory.h"
 
+#include <algorithm>
+#include <cmath>
+#include <mutex>
 #include <sstream>
 
+#include "packet/raw_builder.h"
+
 namespace rootcanal {
 
+namespace {
+
+// Transmit power of the packets that are not wrapped with one by the sender
+constexpr int8_t kDefaultTxPower = 0;
+
+// Log-distance path loss at 2.4 GHz: 40 dB at 1 meter, 20 dB more per decade
+uint8_t GetRssi(int8_t tx_power, double distance) {
+  double path_loss = 40 + 20 * std::log10(std::max(distance, 1.0));
+  return static_cast<uint8_t>(
+      static_cast<int8_t>(std::clamp(tx_power - path_loss, -127.0, 20.0)));
+}
+
+model::packets::LinkLayerPacketView ToView(
+    const model::packets::LinkLayerPacketBuilder& packet) {
+  auto bytes = std::make_shared<std::vector<uint8_t>>();
+  bluetooth::packet::BitInserter i(*bytes);
+  bytes->reserve(packet.size());
+  packet.Serialize(i);
+  auto packet_view =
+      bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(bytes);
+  auto link_layer_packet_view =
+      model::packets::LinkLayerPacketView::Create(packet_view);
+  ASSERT(link_layer_packet_view.IsValid());
+  return link_layer_packet_view;
+}
+
+// Wraps |packet| with the RSSI of a receiver |distance| meters away from the
+// sender, in place of the wrapper in which the sender may have put its
+// transmit power
+model::packets::LinkLayerPacketView WrapWithRssi(
+    model::packets::LinkLayerPacketView packet, double distance) {
+  int8_t tx_power = kDefaultTxPower;
+  std::vector<uint8_t> payload;
+  if (packet.GetType() == model::packets::PacketType::RSSI_WRAPPER) {
+    auto rssi_wrapper = model::packets::RssiWrapperView::Create(packet);
+    ASSERT(rssi_wrapper.IsValid());
+    tx_power = static_cast<int8_t>(rssi_wrapper.GetRssi());
+    auto wrapped = rssi_wrapper.GetPayload();
+    payload.assign(wrapped.begin(), wrapped.end());
+  } else {
+    payload.assign(packet.begin(), packet.end());
+  }
+  return ToView(*model::packets::RssiWrapperBuilder::Create(
+      packet.GetSourceAddress(), packet.GetDestinationAddress(),
+      GetRssi(tx_power, distance),
+      std::make_unique<bluetooth::packet::RawBuilder>(std::move(payload))));
+}
+
+void RemovePhyLayer(std::vector<std::shared_ptr<PhyLayer>>& phy_layers,
+                    uint32_t id) {
+  phy_layers.erase(std::remove_if(phy_layers.begin(), phy_layers.end(),
+                                  [id](const std::shared_ptr<PhyLayer>& phy) {
+                                    return phy->GetId() == id;
+                                  }),
+                   phy_layers.end());
+}
+
+}  // namespace
+
 PhyLayerFactory::PhyLayerFactory(Phy::Type phy_type, uint32_t factory_id)
     : phy_type_(phy_type), factory_id_(factory_id) {}
 
@@ -31,63 +95,163 @@ std::shared_ptr<PhyLayer> PhyLayerFactory::GetPhyLayer(
     const std::function<void(model::packets::LinkLayerPacketView)>&
         device_receive,
     uint32_t device_id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   std::shared_ptr<PhyLayer> new_phy = std::make_shared<PhyLayerImpl>(
       phy_type_, next_id_++, device_receive, device_id, this);
   phy_layers_.push_back(new_phy);
+  receive_all_.push_back(new_phy);
   return new_phy;
 }
 
 void PhyLayerFactory::UnregisterPhyLayer(uint32_t id) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
   for (auto phy : phy_layers_) {
     if (phy->GetId() == id) {
       phy_layers_.remove(phy);
+      auto address = receive_addresses_.find(id);
+      if (address == receive_addresses_.end()) {
+        RemovePhyLayer(receive_all_, id);
+      } else {
+        auto& addressed = receive_addressed_[address->second];
+        RemovePhyLayer(addressed, id);
+        if (addressed.empty()) {
+          receive_addressed_.erase(address->second);
+        }
+        receive_addresses_.erase(address);
+      }
+      positions_.erase(id);
       return;
     }
   }
 }
 
 void PhyLayerFactory::UnregisterAllPhyLayers() {
-  while (!phy_layers_.empty()) {
-    if (phy_layers_.begin() != phy_layers_.end()) {
-      auto id = (*phy_layers_.begin())->GetId();
-      UnregisterPhyLayer(id);
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  phy_layers_.clear();
+  receive_all_.clear();
+  receive_addressed_.clear();
+  receive_addresses_.clear();
+  positions_.clear();
+}
+
+void PhyLayerFactory::SetRange(std::optional<double> range) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  range_ = range;
+}
+
+void PhyLayerFactory::ReceiveOnlyAddressedTo(uint32_t id, Address address) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  std::shared_ptr<PhyLayer> phy;
+  auto current = receive_addresses_.find(id);
+  if (current == receive_addresses_.end()) {
+    auto it = std::find_if(receive_all_.begin(), receive_all_.end(),
+                           [id](const std::shared_ptr<PhyLayer>& phy) {
+                             return phy->GetId() == id;
+                           });
+    if (it == receive_all_.end()) {
+      return;
+    }
+    phy = *it;
+    receive_all_.erase(it);
+  } else {
+    if (current->second == address) {
+      return;
+    }
+    auto& addressed = receive_addressed_[current->second];
+    auto it = std::find_if(addressed.begin(), addressed.end(),
+                           [id](const std::shared_ptr<PhyLayer>& phy) {
+                             return phy->GetId() == id;
+                           });
+    phy = *it;
+    addressed.erase(it);
+    if (addressed.empty()) {
+      receive_addressed_.erase(current->second);
     }
   }
+  receive_addresses_[id] = address;
+  receive_addressed_[address].push_back(phy);
+}
+
+void PhyLayerFactory::SetPosition(uint32_t id, Position position) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  positions_[id] = position;
+}
+
+std::optional<Position> PhyLayerFactory::GetPosition(uint32_t id) const {
+  if (positions_.empty()) {
+    return {};
+  }
+  auto position = positions_.find(id);
+  if (position == positions_.end()) {
+    return {};
+  }
+  return position->second;
 }
 
 void PhyLayerFactory::Send(
     const std::shared_ptr<model::packets::LinkLayerPacketBuilder> packet,
     uint32_t id, [[maybe_unused]] uint32_t device_id) {
-  // Convert from a Builder to a View
-  auto bytes = std::make_shared<std::vector<uint8_t>>();
-  bluetooth::packet::BitInserter i(*bytes);
-  bytes->reserve(packet->size());
-  packet->Serialize(i);
-  auto packet_view =
-      bluetooth::packet::PacketView<bluetooth::packet::kLittleEndian>(bytes);
-  auto link_layer_packet_view =
-      model::packets::LinkLayerPacketView::Create(packet_view);
-  ASSERT(link_layer_packet_view.IsValid());
-
-  Send(link_layer_packet_view, id, device_id);
+  // Serialized once, every receiver gets a view of the same bytes
+  Send(ToView(*packet), id, device_id);
 }
 
 void PhyLayerFactory::Send(model::packets::LinkLayerPacketView packet,
                            uint32_t id, [[maybe_unused]] uint32_t device_id) {
-  for (const auto& phy : phy_layers_) {
-    if (id != phy->GetId()) {
-      phy->Receive(packet);
+  // The receivers are picked with the lock held and called without it, as
+  // they may send packets or register phy layers in turn.
+  std::vector<Delivery> deliveries;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    std::optional<Position> sender_position = GetPosition(id);
+    AddDeliveries(receive_all_, id, sender_position, deliveries);
+    auto addressed = receive_addressed_.find(packet.GetDestinationAddress());
+    if (addressed != receive_addressed_.end()) {
+      AddDeliveries(addressed->second, id, sender_position, deliveries);
     }
   }
+  for (auto& delivery : deliveries) {
+    if (delivery.distance) {
+      delivery.phy->Receive(WrapWithRssi(packet, *delivery.distance));
+    } else {
+      delivery.phy->Receive(packet);
+    }
+  }
+}
+
+void PhyLayerFactory::AddDeliveries(
+    const std::vector<std::shared_ptr<PhyLayer>>& phys, uint32_t id,
+    const std::optional<Position>& sender_position,
+    std::vector<Delivery>& deliveries) const {
+  for (auto& phy : phys) {
+    if (phy->GetId() == id) {
+      continue;
+    }
+    std::optional<Position> receiver_position;
+    if (sender_position) {
+      receiver_position = GetPosition(phy->GetId());
+    }
+    if (!receiver_position) {
+      deliveries.push_back({phy, {}});
+      continue;
+    }
+    double distance = std::hypot(sender_position->x - receiver_position->x,
+                                 sender_position->y - receiver_position->y);
+    if (range_ && distance > *range_) {
+      continue;
+    }
+    deliveries.push_back({phy, distance});
+  }
 }
 
 void PhyLayerFactory::TimerTick() {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   for (auto& phy : phy_layers_) {
     phy->TimerTick();
   }
 }
 
 std::string PhyLayerFactory::ToString() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
   std::stringstream factory;
   switch (phy_type_) {
     case Phy::Type::LOW_ENERGY:
@@ -127,6 +291,14 @@ void PhyLayerImpl::Send(model::packets::LinkLayerPacketView packet) {
 
 void PhyLayerImpl::Unregister() { factory_->UnregisterPhyLayer(GetId()); }
 
+void PhyLayerImpl::ReceiveOnlyAddressedTo(Address address) {
+  factory_->ReceiveOnlyAddressedTo(GetId(), address);
+}
+
+void PhyLayerImpl::SetPosition(Position position) {
+  factory_->SetPosition(GetId(), position);
+}
+
 bool PhyLayerImpl::IsFactoryId(uint32_t id) {
   return factory_->GetFactoryId() == id;
 }
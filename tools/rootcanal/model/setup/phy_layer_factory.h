@@ -18,6 +18,9 @@
 
 #include <list>
 #include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <unordered_map>
 #include <vector>
 
 #include "include/phy.h"
@@ -47,6 +50,10 @@ class PhyLayerFactory {
 
   void UnregisterAllPhyLayers();
 
+  // Devices farther apart than |range| meters do not receive each other's
+  // packets, when both are positioned. No range means no culling.
+  void SetRange(std::optional<double> range);
+
   virtual void TimerTick();
 
   virtual std::string ToString() const;
@@ -61,9 +68,41 @@ class PhyLayerFactory {
   std::list<std::shared_ptr<PhyLayer>> phy_layers_;
 
  private:
+  void ReceiveOnlyAddressedTo(uint32_t id, Address address);
+  void SetPosition(uint32_t id, Position position);
+
+  // A receiver of a packet, with its distance to the sender if both are
+  // positioned
+  struct Delivery {
+    std::shared_ptr<PhyLayer> phy;
+    std::optional<double> distance;
+  };
+
+  void AddDeliveries(const std::vector<std::shared_ptr<PhyLayer>>& phys,
+                     uint32_t id,
+                     const std::optional<Position>& sender_position,
+                     std::vector<Delivery>& deliveries) const;
+
+  std::optional<Position> GetPosition(uint32_t id) const;
+
   Phy::Type phy_type_;
   uint32_t next_id_{1};
   const uint32_t factory_id_;
+
+  // Held exclusively to change the phy layers and their indexes, shared to
+  // pick the receivers of a packet. Devices run on several threads when the
+  // test model is sharded, see ShardPool.
+  mutable std::shared_mutex mutex_;
+
+  // Every phy layer in phy_layers_ is in one of the delivery indexes: either
+  // it receives every packet, or only the packets sent to its address.
+  std::vector<std::shared_ptr<PhyLayer>> receive_all_;
+  std::unordered_map<Address, std::vector<std::shared_ptr<PhyLayer>>>
+      receive_addressed_;
+  std::unordered_map<uint32_t, Address> receive_addresses_;
+
+  std::unordered_map<uint32_t, Position> positions_;
+  std::optional<double> range_;
 };
 
 class PhyLayerImpl : public PhyLayer {
@@ -80,6 +119,8 @@ class PhyLayerImpl : public PhyLayer {
   void Receive(model::packets::LinkLayerPacketView packet) override;
   void Unregister() override;
   bool IsFactoryId(uint32_t factory_id) override;
+  void ReceiveOnlyAddressedTo(Address address) override;
+  void SetPosition(Position position) override;
   void TimerTick() override;
 
  private:
@@ -0,0 +1,113 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "shard_pool.h"
+
+#include <deque>
+#include <thread>
+#include <utility>
+
+#include "os/log.h"
+
+namespace rootcanal {
+
+class ShardPool::Shard {
+ public:
+  explicit Shard(ShardPool* pool)
+      : pool_(pool), thread_([this]() { ThreadRoutine(); }) {}
+
+  ~Shard() {
+    {
+      std::unique_lock<std::mutex> guard(mutex_);
+      running_ = false;
+    }
+    tasks_ready_.notify_one();
+    thread_.join();
+  }
+
+  void Post(TaskCallback task) {
+    {
+      std::unique_lock<std::mutex> guard(mutex_);
+      tasks_.push_back(std::move(task));
+    }
+    tasks_ready_.notify_one();
+  }
+
+ private:
+  void ThreadRoutine() {
+    std::deque<TaskCallback> tasks;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> guard(mutex_);
+        tasks_ready_.wait(guard,
+                          [this]() { return !tasks_.empty() || !running_; });
+        if (tasks_.empty()) {
+          return;
+        }
+        // Run the whole batch without the lock, so that posting from the other
+        // shards does not wait for it
+        tasks.swap(tasks_);
+      }
+      size_t count = tasks.size();
+      for (auto& task : tasks) {
+        task();
+      }
+      tasks.clear();
+      pool_->OnTasksDone(count);
+    }
+  }
+
+  ShardPool* pool_;
+  std::mutex mutex_;
+  std::condition_variable tasks_ready_;
+  std::deque<TaskCallback> tasks_;
+  bool running_{true};
+  // Last, so that it starts once the members above are constructed
+  std::thread thread_;
+};
+
+ShardPool::ShardPool(size_t num_shards) {
+  ASSERT(num_shards > 0);
+  for (size_t i = 0; i < num_shards; i++) {
+    shards_.push_back(std::make_unique<Shard>(this));
+  }
+}
+
+ShardPool::~ShardPool() {
+  WaitForIdle();
+  shards_.clear();
+}
+
+void ShardPool::Post(size_t shard, TaskCallback task) {
+  pending_tasks_.fetch_add(1);
+  shards_[shard % shards_.size()]->Post(std::move(task));
+}
+
+void ShardPool::WaitForIdle() {
+  std::unique_lock<std::mutex> guard(idle_mutex_);
+  idle_.wait(guard, [this]() { return pending_tasks_.load() == 0; });
+}
+
+void ShardPool::OnTasksDone(size_t count) {
+  if (pending_tasks_.fetch_sub(count) == count) {
+    // Under the lock, so that the wakeup cannot fall between the check of a
+    // waiter and its wait
+    std::unique_lock<std::mutex> guard(idle_mutex_);
+    idle_.notify_all();
+  }
+}
+
+}  // namespace rootcanal
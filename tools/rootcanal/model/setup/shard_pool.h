@@ -0,0 +1,69 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "model/setup/async_manager.h"
+
+namespace rootcanal {
+
+// Runs tasks on a fixed number of worker threads, the shards. The tasks posted
+// to a shard run one at a time, on the thread of the shard, in the order they
+// were posted. The test model pins every device to a shard so that the device
+// is only ever entered from that thread, and the devices of different shards
+// run in parallel.
+// Post() may be called from any thread, shards included. WaitForIdle() must
+// not be called from a shard, which would wait for itself.
+class ShardPool {
+ public:
+  explicit ShardPool(size_t num_shards);
+  ShardPool(const ShardPool&) = delete;
+  ShardPool& operator=(const ShardPool&) = delete;
+
+  // Waits for the tasks posted to run, then stops the threads.
+  ~ShardPool();
+
+  size_t size() const { return shards_.size(); }
+
+  void Post(size_t shard, TaskCallback task);
+
+  // Blocks until no task is left to run, counting the tasks posted by the
+  // tasks run while waiting.
+  void WaitForIdle();
+
+ private:
+  class Shard;
+
+  // Called by the shards once they have run |count| tasks.
+  void OnTasksDone(size_t count);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+
+  // Tasks posted and not done yet. Tasks post theirs before they are done, so
+  // it only drops to zero once every shard is idle.
+  std::atomic<size_t> pending_tasks_{0};
+  std::mutex idle_mutex_;
+  std::condition_variable idle_;
+};
+
+}  // namespace rootcanal
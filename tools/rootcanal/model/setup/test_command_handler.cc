@@ -46,10 +46,13 @@ TestCommandHandler::TestCommandHandler(TestModel& test_model)
   SET_HANDLER("del_device_from_phy", DelDeviceFromPhy);
   SET_HANDLER("list", List);
   SET_HANDLER("set_device_address", SetDeviceAddress);
+  SET_HANDLER("set_device_position", SetDevicePosition);
+  SET_HANDLER("set_phy_range", SetPhyRange);
   SET_HANDLER("set_timer_period", SetTimerPeriod);
   SET_HANDLER("start_timer", StartTimer);
   SET_HANDLER("stop_timer", StopTimer);
   SET_HANDLER("reset", Reset);
+  SET_HANDLER("advance_time", AdvanceTime);
 #undef SET_HANDLER
 }
 
@@ -119,6 +122,13 @@ void TestCommandHandler::RegisterSendResponse(
   send_response_("RegisterSendResponse called");
 }
 
+void TestCommandHandler::RegisterAdvanceTime(
+    const std::function<bool(std::chrono::milliseconds,
+                             const std::function<void()>&)>
+        callback) {
+  advance_time_ = callback;
+}
+
 void TestCommandHandler::Add(const vector<std::string>& args) {
   if (args.size() < 1) {
     response_string_ = "TestCommandHandler 'add' takes an argument";
@@ -262,6 +272,35 @@ void TestCommandHandler::SetDeviceAddress(const vector<std::string>& args) {
   send_response_(response_string_);
 }
 
+void TestCommandHandler::SetDevicePosition(const vector<std::string>& args) {
+  if (args.size() != 3) {
+    response_string_ =
+        "TestCommandHandler 'set_device_position' takes three arguments";
+    send_response_(response_string_);
+    return;
+  }
+  size_t device_id = std::stoi(args[0]);
+  Position position{std::stod(args[1]), std::stod(args[2])};
+  model_.SetDevicePosition(device_id, position);
+  response_string_ =
+      "set_device_position " + args[0] + " " + args[1] + " " + args[2];
+  send_response_(response_string_);
+}
+
+void TestCommandHandler::SetPhyRange(const vector<std::string>& args) {
+  if (args.size() != 2) {
+    response_string_ = "TestCommandHandler 'set_phy_range' takes two arguments";
+    send_response_(response_string_);
+    return;
+  }
+  size_t phy_index = std::stoi(args[0]);
+  double range = std::stod(args[1]);
+  model_.SetPhyRange(phy_index,
+                     range > 0 ? std::optional<double>(range) : std::nullopt);
+  response_string_ = "set_phy_range " + args[0] + " " + args[1];
+  send_response_(response_string_);
+}
+
 void TestCommandHandler::SetTimerPeriod(const vector<std::string>& args) {
   if (args.size() != 1) {
     LOG_INFO("SetTimerPeriod takes 1 argument");
@@ -305,4 +344,26 @@ void TestCommandHandler::Reset(const std::vector<std::string>& args) {
   send_response_(response_string_);
 }
 
+void TestCommandHandler::AdvanceTime(const std::vector<std::string>& args) {
+  if (args.size() != 1) {
+    response_string_ = "advance_time takes 1 argument";
+    send_response_(response_string_);
+    return;
+  }
+  char* end = nullptr;
+  long duration_ms = strtol(args[0].c_str(), &end, 0);
+  if (end == args[0].c_str() || *end != '\0' || duration_ms < 0) {
+    response_string_ = "invalid duration " + args[0];
+    send_response_(response_string_);
+    return;
+  }
+  std::string reached = "advanced time by " + args[0] + " ms";
+  if (!advance_time_ ||
+      !advance_time_(std::chrono::milliseconds(duration_ms),
+                     [this, reached]() { send_response_(reached); })) {
+    response_string_ = "virtual time is not enabled";
+    send_response_(response_string_);
+  }
+}
+
 }  // namespace rootcanal
@@ -18,6 +18,7 @@
 
 #include <unistd.h>
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -49,6 +50,13 @@ class TestCommandHandler {
   void RegisterSendResponse(
       const std::function<void(const std::string&)> callback);
 
+  // Sets the callback advancing the virtual time of the simulation, which
+  // calls its second argument once the time is reached.
+  void RegisterAdvanceTime(
+      const std::function<bool(std::chrono::milliseconds,
+                               const std::function<void()>&)>
+          callback);
+
   // Commands:
 
   // Add a device
@@ -78,6 +86,12 @@ class TestCommandHandler {
   // Change the device's MAC address
   void SetDeviceAddress(const std::vector<std::string>& args);
 
+  // Place the device on the phys, for RSSI and range
+  void SetDevicePosition(const std::vector<std::string>& args);
+
+  // Change the range of a phy, 0 for unlimited
+  void SetPhyRange(const std::vector<std::string>& args);
+
   // Timer management functions
   void SetTimerPeriod(const std::vector<std::string>& args);
 
@@ -87,6 +101,10 @@ class TestCommandHandler {
 
   void Reset(const std::vector<std::string>& args);
 
+  // Let virtual time run for the given number of milliseconds, responds once
+  // every event until then has happened
+  void AdvanceTime(const std::vector<std::string>& args);
+
   // For manual testing
   void AddDefaults();
 
@@ -101,6 +119,9 @@ class TestCommandHandler {
 
   std::function<void(const std::string&)> send_response_;
 
+  std::function<bool(std::chrono::milliseconds, const std::function<void()>&)>
+      advance_time_;
+
   TestCommandHandler(const TestCommandHandler& cmdPckt) = delete;
   TestCommandHandler& operator=(const TestCommandHandler& cmdPckt) = delete;
 };
@@ -56,6 +56,74 @@ TestModel::~TestModel() {
   StopTimer();
 }
 
+void TestModel::EnableShards(size_t num_shards, bool virtual_time) {
+  if (!devices_.empty()) {
+    LOG_WARN("Can't shard the %zu devices already added", devices_.size());
+    return;
+  }
+  LOG_INFO("Running the devices on %zu shards", num_shards);
+  wait_for_device_tasks_ = virtual_time;
+  shards_ = std::make_unique<ShardPool>(num_shards);
+}
+
+void TestModel::RunOnDevice(size_t device_index, TaskCallback task) {
+  if (shards_ == nullptr) {
+    task();
+    return;
+  }
+  shards_->Post(device_index, std::move(task));
+}
+
+AsyncTaskId TestModel::ScheduleDeviceTask(AsyncUserId user_id,
+                                          size_t device_index,
+                                          std::chrono::milliseconds delay,
+                                          TaskCallback task) {
+  if (shards_ == nullptr) {
+    return schedule_task_(user_id, delay, task);
+  }
+  auto task_id = std::make_shared<AsyncTaskId>(kInvalidTaskId);
+  auto cancelled = std::make_shared<bool>(false);
+  // Held until the task is recorded, as it may be due on the shard before
+  std::unique_lock<std::mutex> lock(device_tasks_mutex_);
+  *task_id = schedule_task_(
+      user_id, delay, [this, device_index, task_id, cancelled, task]() {
+        shards_->Post(device_index, [this, task_id, cancelled, task]() {
+          {
+            std::unique_lock<std::mutex> lock(device_tasks_mutex_);
+            if (*cancelled) {
+              return;
+            }
+            // Unless the id was given to a new task in the meantime
+            auto device_task = device_tasks_.find(*task_id);
+            if (device_task != device_tasks_.end() &&
+                device_task->second.cancelled == cancelled) {
+              device_tasks_.erase(device_task);
+            }
+          }
+          task();
+        });
+        // The virtual time is the due time of this task until it returns
+        if (wait_for_device_tasks_) {
+          shards_->WaitForIdle();
+        }
+      });
+  device_tasks_[*task_id] = DeviceTask{user_id, cancelled};
+  return *task_id;
+}
+
+void TestModel::CancelDeviceTask(AsyncTaskId task_id) {
+  cancel_task_(task_id);
+  if (shards_ == nullptr) {
+    return;
+  }
+  std::unique_lock<std::mutex> lock(device_tasks_mutex_);
+  auto device_task = device_tasks_.find(task_id);
+  if (device_task != device_tasks_.end()) {
+    *device_task->second.cancelled = true;
+    device_tasks_.erase(device_task);
+  }
+}
+
 void TestModel::SetTimerPeriod(std::chrono::milliseconds new_period) {
   timer_period_ = new_period;
 
@@ -91,7 +159,9 @@ void TestModel::Del(size_t dev_index) {
   }
   schedule_task_(model_user_id_, std::chrono::milliseconds(0),
                  [this, dev_index]() {
-                   devices_[dev_index]->UnregisterPhyLayers();
+                   auto dev = devices_[dev_index];
+                   RunOnDevice(dev_index,
+                               [dev]() { dev->UnregisterPhyLayers(); });
                    devices_[dev_index] = nullptr;
                  });
 }
@@ -126,11 +196,22 @@ void TestModel::AddDeviceToPhy(size_t dev_index, size_t phy_index) {
     return;
   }
   auto dev = devices_[dev_index];
-  dev->RegisterPhyLayer(phys_[phy_index]->GetPhyLayer(
-      [dev](model::packets::LinkLayerPacketView packet) {
-        dev->IncomingPacket(std::move(packet));
-      },
-      dev_index));
+  std::function<void(model::packets::LinkLayerPacketView)> device_receive;
+  if (shards_ == nullptr) {
+    device_receive = [dev](model::packets::LinkLayerPacketView packet) {
+      dev->ReceiveLinkLayerPacket(std::move(packet));
+    };
+  } else {
+    // The packet is passed to the shard of the receiver as is: it is a view
+    // of bytes which are not written again once sent.
+    device_receive = [this, dev,
+                      dev_index](model::packets::LinkLayerPacketView packet) {
+      shards_->Post(dev_index,
+                    [dev, packet]() { dev->ReceiveLinkLayerPacket(packet); });
+    };
+  }
+  auto phy = phys_[phy_index]->GetPhyLayer(device_receive, dev_index);
+  RunOnDevice(dev_index, [dev, phy]() { dev->RegisterPhyLayer(phy); });
 }
 
 void TestModel::DelDeviceFromPhy(size_t dev_index, size_t phy_index) {
@@ -144,9 +225,12 @@ void TestModel::DelDeviceFromPhy(size_t dev_index, size_t phy_index) {
   }
   schedule_task_(model_user_id_, std::chrono::milliseconds(0),
                  [this, dev_index, phy_index]() {
-                   devices_[dev_index]->UnregisterPhyLayer(
-                       phys_[phy_index]->GetType(),
-                       phys_[phy_index]->GetFactoryId());
+                   auto dev = devices_[dev_index];
+                   auto type = phys_[phy_index]->GetType();
+                   auto factory_id = phys_[phy_index]->GetFactoryId();
+                   RunOnDevice(dev_index, [dev, type, factory_id]() {
+                     dev->UnregisterPhyLayer(type, factory_id);
+                   });
                  });
 }
 
@@ -187,20 +271,24 @@ size_t TestModel::AddHciConnection(std::shared_ptr<HciDevice> dev) {
   dev->SetAddress(addr);
 
   LOG_INFO("initialized %s", addr.ToString().c_str());
-  for (size_t i = 0; i < phys_.size(); i++) {
-    AddDeviceToPhy(index, i);
-  }
+  // Set up before the phys can deliver packets to the device, which may
+  // happen on its shard at once
   AsyncUserId user_id = get_user_id_();
-  dev->RegisterTaskScheduler([user_id, this](std::chrono::milliseconds delay,
-                                             TaskCallback task_callback) {
-    return schedule_task_(user_id, delay, std::move(task_callback));
+  dev->RegisterTaskScheduler([user_id, index, this](
+                                 std::chrono::milliseconds delay,
+                                 TaskCallback task_callback) {
+    return ScheduleDeviceTask(user_id, index, delay, std::move(task_callback));
   });
-  dev->RegisterTaskCancel(cancel_task_);
+  dev->RegisterTaskCancel(
+      [this](AsyncTaskId task_id) { CancelDeviceTask(task_id); });
   dev->RegisterCloseCallback([this, index, user_id] {
     schedule_task_(
         user_id, std::chrono::milliseconds(0),
         [this, index, user_id]() { OnConnectionClosed(index, user_id); });
   });
+  for (size_t i = 0; i < phys_.size(); i++) {
+    AddDeviceToPhy(index, i);
+  }
   return index;
 }
 
@@ -211,7 +299,19 @@ void TestModel::OnConnectionClosed(size_t index, AsyncUserId user_id) {
   }
 
   cancel_tasks_from_user_(user_id);
-  devices_[index]->UnregisterPhyLayers();
+  if (shards_ != nullptr) {
+    std::unique_lock<std::mutex> lock(device_tasks_mutex_);
+    for (auto it = device_tasks_.begin(); it != device_tasks_.end();) {
+      if (it->second.user_id == user_id) {
+        *it->second.cancelled = true;
+        it = device_tasks_.erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+  auto dev = devices_[index];
+  RunOnDevice(index, [dev]() { dev->UnregisterPhyLayers(); });
   devices_[index] = nullptr;
 }
 
@@ -220,7 +320,25 @@ void TestModel::SetDeviceAddress(size_t index, Address address) {
     LOG_WARN("Can't find device %zu", index);
     return;
   }
-  devices_[index]->SetAddress(std::move(address));
+  auto dev = devices_[index];
+  RunOnDevice(index, [dev, address]() { dev->SetAddress(address); });
+}
+
+void TestModel::SetDevicePosition(size_t index, Position position) {
+  if (index >= devices_.size() || devices_[index] == nullptr) {
+    LOG_WARN("Can't find device %zu", index);
+    return;
+  }
+  auto dev = devices_[index];
+  RunOnDevice(index, [dev, position]() { dev->SetPosition(position); });
+}
+
+void TestModel::SetPhyRange(size_t phy_index, std::optional<double> range) {
+  if (phy_index >= phys_.size()) {
+    LOG_WARN("Can't find phy %zu", phy_index);
+    return;
+  }
+  phys_[phy_index]->SetRange(range);
 }
 
 const std::string& TestModel::List() {
@@ -243,11 +361,23 @@ const std::string& TestModel::List() {
 }
 
 void TestModel::TimerTick() {
+  if (shards_ == nullptr) {
+    for (size_t i = 0; i < devices_.size(); i++) {
+      if (devices_[i] != nullptr) {
+        devices_[i]->TimerTick();
+      }
+    }
+    return;
+  }
   for (size_t i = 0; i < devices_.size(); i++) {
     if (devices_[i] != nullptr) {
-      devices_[i]->TimerTick();
+      auto dev = devices_[i];
+      shards_->Post(i, [dev]() { dev->TimerTick(); });
     }
   }
+  // The tick is over once the packets sent on it are handled, so that the
+  // shards do not fall behind the timer or virtual time
+  shards_->WaitForIdle();
 }
 
 void TestModel::Reset() {
@@ -256,7 +386,8 @@ void TestModel::Reset() {
     LOG_INFO("Running Reset task");
     for (size_t i = 0; i < devices_.size(); i++) {
       if (devices_[i] != nullptr) {
-        devices_[i]->UnregisterPhyLayers();
+        auto dev = devices_[i];
+        RunOnDevice(i, [dev]() { dev->UnregisterPhyLayers(); });
       }
     }
     devices_.clear();
@@ -20,15 +20,19 @@
 
 #include <chrono>      // for milliseconds
 #include <functional>  // for function
-#include <memory>      // for shared_ptr
-#include <string>      // for string
-#include <vector>      // for vector
+#include <memory>         // for shared_ptr, unique_ptr
+#include <mutex>          // for mutex
+#include <optional>       // for optional
+#include <string>         // for string
+#include <unordered_map>  // for unordered_map
+#include <vector>         // for vector
 
 #include "hci/address.h"                       // for Address
 #include "model/devices/hci_device.h"          // for HciDevice
 #include "model/setup/async_manager.h"         // for AsyncUserId, AsyncTaskId
 #include "phy.h"                               // for Phy, Phy::Type
 #include "phy_layer_factory.h"                 // for PhyLayerFactory
+#include "shard_pool.h"                        // for ShardPool
 
 namespace rootcanal {
 class Device;
@@ -54,6 +58,14 @@ class TestModel {
   TestModel(TestModel& model) = delete;
   TestModel& operator=(const TestModel& model) = delete;
 
+  // Runs the devices on |num_shards| threads instead of the thread of the
+  // test model, see ShardPool. Devices are pinned to a shard by index and
+  // everything that enters a device, its packets included, is posted to its
+  // shard. Must be called before any device is added. In |virtual_time|, the
+  // model waits for the shards after posting each device task, so that the
+  // task runs before the virtual time moves past its due time.
+  void EnableShards(size_t num_shards, bool virtual_time = false);
+
   // Commands:
 
   // Add a device, return its index
@@ -91,6 +103,12 @@ class TestModel {
   // Set the device's Bluetooth address
   void SetDeviceAddress(size_t device_index, Address device_address);
 
+  // Set the device's position, in meters
+  void SetDevicePosition(size_t device_index, Position position);
+
+  // Set the range of the phy, in meters, no range means unlimited
+  void SetPhyRange(size_t phy_index, std::optional<double> range);
+
   // Let devices know about the passage of time
   void TimerTick();
   void StartTimer();
@@ -104,6 +122,16 @@ class TestModel {
   void Reset();
 
  private:
+  // Runs |task| on the shard of the device, or right away when not sharded
+  void RunOnDevice(size_t device_index, TaskCallback task);
+
+  // Task scheduler and cancel of the HCI devices. When sharded, the tasks run
+  // on the shard of their device.
+  AsyncTaskId ScheduleDeviceTask(AsyncUserId user_id, size_t device_index,
+                                 std::chrono::milliseconds delay,
+                                 TaskCallback task);
+  void CancelDeviceTask(AsyncTaskId task_id);
+
   std::vector<std::unique_ptr<PhyLayerFactory>> phys_;
   std::vector<std::shared_ptr<Device>> devices_;
   std::string list_string_;
@@ -124,6 +152,22 @@ class TestModel {
   AsyncUserId model_user_id_;
   AsyncTaskId timer_tick_task_{kInvalidTaskId};
   std::chrono::milliseconds timer_period_{};
+
+  // The device tasks which are due may wait in the queue of their shard, after
+  // the task which cancels them. They are flagged to be skipped when
+  // cancelled, until they run.
+  struct DeviceTask {
+    AsyncUserId user_id;
+    std::shared_ptr<bool> cancelled;
+  };
+  std::mutex device_tasks_mutex_;
+  std::unordered_map<AsyncTaskId, DeviceTask> device_tasks_;
+
+  // Set in virtual time, see EnableShards
+  bool wait_for_device_tasks_{false};
+
+  // Last, so that the shards are stopped before the devices and phys go
+  std::unique_ptr<ShardPool> shards_;
 };
 
 }  // namespace rootcanal
@@ -214,6 +214,18 @@ class TestChannelShell(cmd.Cmd):
     """
         self._test_channel.send_command('set_device_address', args.split())
 
+    def do_set_device_position(self, args):
+        """Arguments: dev_num x y Place device dev_num at (x, y) meters, for the RSSI of its packets and the phy range.
+
+    """
+        self._test_channel.send_command('set_device_position', args.split())
+
+    def do_set_phy_range(self, args):
+        """Arguments: phy_num range Positioned devices farther than range meters apart on phy phy_num do not hear each other, 0 for unlimited.
+
+    """
+        self._test_channel.send_command('set_phy_range', args.split())
+
     def do_list(self, args):
         """Arguments: [dev_num [attr]] List the devices from the controller, optionally filtered by device and attr.
 
@@ -235,6 +247,11 @@ class TestChannelShell(cmd.Cmd):
     """
         self._test_channel.send_command('stop_timer', args.split())
 
+    def do_advance_time(self, args):
+        """Arguments: time_ms Let virtual time run for time_ms milliseconds (requires --virtual_time).
+    """
+        self._test_channel.send_command('advance_time', args.split())
+
     def do_wait(self, args):
         """Arguments: time in seconds (float).
     """
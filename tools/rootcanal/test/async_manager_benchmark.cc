@@ -0,0 +1,184 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <vector>
+
+#include "model/setup/async_manager.h"
+
+using ::benchmark::State;
+
+namespace rootcanal {
+namespace {
+
+// Every fake host is a connected socket pair: the host writes to one end and
+// RootCanal watches the other end, as for HCI and link layer sockets. The
+// benchmarks measure the time from a host write to the read callback with
+// 1 to 2000 hosts connected, which goes past FD_SETSIZE.
+
+class FakeHosts {
+ public:
+  FakeHosts(AsyncManager& async_manager, int num_hosts)
+      : async_manager_(async_manager) {
+    for (int i = 0; i < num_hosts; i++) {
+      int fds[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+        break;
+      }
+      host_fds_.push_back(fds[0]);
+      watched_fds_.push_back(fds[1]);
+      async_manager_.WatchFdForNonBlockingReads(fds[1], [this](int fd) {
+        char buffer[64];
+        ssize_t n = read(fd, buffer, sizeof(buffer));
+        if (n > 0) {
+          received_.fetch_add(n, std::memory_order_release);
+        }
+      });
+    }
+  }
+
+  ~FakeHosts() {
+    for (int fd : watched_fds_) {
+      async_manager_.StopWatchingFileDescriptor(fd);
+      close(fd);
+    }
+    for (int fd : host_fds_) {
+      close(fd);
+    }
+  }
+
+  size_t size() const { return host_fds_.size(); }
+
+  void Send(size_t host) {
+    char byte = 'x';
+    if (write(host_fds_[host], &byte, 1) != 1) {
+      abort();
+    }
+  }
+
+  // Spins until |count| bytes in total have been read by callbacks
+  void WaitForReceived(int64_t count) const {
+    while (received_.load(std::memory_order_acquire) < count) {
+    }
+  }
+
+ private:
+  AsyncManager& async_manager_;
+  std::vector<int> host_fds_;
+  std::vector<int> watched_fds_;
+  std::atomic<int64_t> received_{0};
+};
+
+bool RaiseFdLimit(int num_hosts) {
+  struct rlimit limit;
+  if (getrlimit(RLIMIT_NOFILE, &limit) != 0) {
+    return false;
+  }
+  rlim_t needed = 2 * num_hosts + 64;
+  if (limit.rlim_cur < needed) {
+    limit.rlim_cur = std::min(limit.rlim_max, needed);
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+  }
+  return limit.rlim_cur >= needed;
+}
+
+// One host at a time sends a byte, round robin over the hosts
+void BM_ReadEventLatency(State& state) {
+  int num_hosts = state.range(0);
+  if (!RaiseFdLimit(num_hosts)) {
+    state.SkipWithError("Not enough file descriptors");
+    return;
+  }
+  AsyncManager async_manager;
+  FakeHosts hosts(async_manager, num_hosts);
+  if (hosts.size() != static_cast<size_t>(num_hosts)) {
+    state.SkipWithError("Unable to connect every host");
+    return;
+  }
+  int64_t sent = 0;
+  for (auto _ : state) {
+    hosts.Send(sent % num_hosts);
+    hosts.WaitForReceived(++sent);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ReadEventLatency)
+    ->Arg(1)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(1000)
+    ->Arg(2000)
+    ->UseRealTime();
+
+// Every host sends a byte at once, the time is until all are read
+void BM_ReadEventFanIn(State& state) {
+  int num_hosts = state.range(0);
+  if (!RaiseFdLimit(num_hosts)) {
+    state.SkipWithError("Not enough file descriptors");
+    return;
+  }
+  AsyncManager async_manager;
+  FakeHosts hosts(async_manager, num_hosts);
+  if (hosts.size() != static_cast<size_t>(num_hosts)) {
+    state.SkipWithError("Unable to connect every host");
+    return;
+  }
+  int64_t sent = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < num_hosts; i++) {
+      hosts.Send(i);
+    }
+    sent += num_hosts;
+    hosts.WaitForReceived(sent);
+  }
+  state.SetItemsProcessed(state.iterations() * num_hosts);
+}
+BENCHMARK(BM_ReadEventFanIn)
+    ->Arg(16)
+    ->Arg(256)
+    ->Arg(1000)
+    ->Arg(2000)
+    ->UseRealTime();
+
+// Scheduling and cancelling a task while |range(0)| other tasks are pending,
+// as link layer timeouts are for every simulated connection
+void BM_ExecAsyncAndCancel(State& state) {
+  using namespace std::chrono_literals;
+  AsyncManager async_manager;
+  AsyncUserId user_id = async_manager.GetNextUserId();
+  for (int i = 0; i < state.range(0); i++) {
+    async_manager.ExecAsync(user_id, 1h, []() {});
+  }
+  for (auto _ : state) {
+    AsyncTaskId task_id = async_manager.ExecAsync(user_id, 1h, []() {});
+    async_manager.CancelAsyncTask(task_id);
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ExecAsyncAndCancel)->Arg(0)->Arg(100)->Arg(10000);
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
@@ -21,11 +21,15 @@
 #include <netdb.h>        // for gethostbyname, h_addr, hostent
 #include <netinet/in.h>   // for sockaddr_in, in_addr, INADDR_ANY
 #include <stdio.h>        // for printf
+#include <sys/resource.h>  // for getrlimit, setrlimit, RLIMIT_NOFILE
+#include <sys/select.h>   // for FD_SETSIZE
 #include <sys/socket.h>   // for socket, AF_INET, accept, bind
 #include <sys/types.h>    // for in_addr_t
 #include <time.h>         // for NULL, size_t
 #include <unistd.h>       // for close, write, read
 
+#include <algorithm>           // for min
+#include <atomic>              // for atomic_int
 #include <condition_variable>  // for condition_variable
 #include <cstdint>             // for uint16_t
 #include <cstring>             // for memset, strcmp, strcpy, strlen
@@ -34,8 +38,10 @@
 #include <string>              // for string
 #include <tuple>               // for tuple
 #include <thread>
+#include <vector>              // for vector
 
-#include "osi/include/osi.h"  // for OSI_NO_INTR
+#include "model/setup/clock.h"  // for Clock
+#include "osi/include/osi.h"     // for OSI_NO_INTR
 
 namespace rootcanal {
 
@@ -477,4 +483,129 @@ TEST_F(AsyncManagerTest, TestCancelAsyncTasksFromUser) {
   ASSERT_FALSE(async_manager_.CancelAsyncTask(task5_id));
 }
 
+TEST_F(AsyncManagerTest, TestTasksRunInOrder) {
+  using namespace std::chrono_literals;
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  std::mutex order_mutex;
+  std::vector<int> order;
+  Event done;
+  for (int i = 4; i >= 0; i--) {
+    async_manager_.ExecAsync(user1, std::chrono::milliseconds(5 * i),
+                             [i, &order, &order_mutex, &done]() {
+                               std::unique_lock<std::mutex> lock(order_mutex);
+                               order.push_back(i);
+                               if (order.size() == 5) done.set();
+                             });
+  }
+  ASSERT_TRUE(done.wait_for(1s));
+  ASSERT_EQ(order, std::vector<int>({0, 1, 2, 3, 4}));
+}
+
+TEST_F(AsyncManagerTest, TestCancelManyTasks) {
+  using namespace std::chrono_literals;
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  std::atomic_int cancelled_ran{0};
+  std::vector<AsyncTaskId> task_ids;
+  for (int i = 0; i < 1000; i++) {
+    task_ids.push_back(async_manager_.ExecAsync(
+        user1, 20ms, [&cancelled_ran]() { cancelled_ran++; }));
+  }
+  Event kept_ran;
+  async_manager_.ExecAsync(user1, 30ms, [&kept_ran]() { kept_ran.set(); });
+  for (AsyncTaskId task_id : task_ids) {
+    ASSERT_TRUE(async_manager_.CancelAsyncTask(task_id));
+  }
+  ASSERT_TRUE(kept_ran.wait_for(1s));
+  ASSERT_EQ(cancelled_ran, 0);
+}
+
+TEST_F(AsyncManagerTest, TestWatchFdAboveFdSetSize) {
+  // select() could not watch FD numbers from FD_SETSIZE on
+  struct rlimit limit;
+  ASSERT_EQ(getrlimit(RLIMIT_NOFILE, &limit), 0);
+  if (limit.rlim_cur <= FD_SETSIZE + 1) {
+    limit.rlim_cur = std::min<rlim_t>(limit.rlim_max, 2 * FD_SETSIZE);
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+  }
+  if (limit.rlim_cur <= FD_SETSIZE + 1) {
+    GTEST_SKIP() << "Not allowed to open an FD above FD_SETSIZE";
+  }
+
+  int fds[2];
+  ASSERT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+  int high_fd = fcntl(fds[0], F_DUPFD, FD_SETSIZE);
+  ASSERT_GE(high_fd, FD_SETSIZE) << strerror(errno);
+  close(fds[0]);
+
+  Event read_ready;
+  async_manager_.WatchFdForNonBlockingReads(high_fd, [&read_ready](int fd) {
+    char buffer;
+    EXPECT_EQ(read(fd, &buffer, 1), 1);
+    read_ready.set();
+  });
+  ASSERT_EQ(write(fds[1], "x", 1), 1);
+  ASSERT_TRUE(read_ready.wait_for(std::chrono::seconds(1)));
+
+  async_manager_.StopWatchingFileDescriptor(high_fd);
+  close(high_fd);
+  close(fds[1]);
+}
+
+TEST_F(AsyncManagerTest, TestVirtualTimeJumpsToNextTask) {
+  using namespace std::chrono_literals;
+  async_manager_.EnableVirtualTime();
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  Clock::time_point start = Clock::now();
+  std::mutex times_mutex;
+  std::vector<Clock::duration> times;
+  for (auto delay : {2h, 1h, 3h}) {
+    async_manager_.ExecAsync(user1, delay, [start, &times, &times_mutex]() {
+      std::unique_lock<std::mutex> lock(times_mutex);
+      times.push_back(Clock::now() - start);
+    });
+  }
+  // Nothing runs until time is allowed to advance
+  std::this_thread::sleep_for(10ms);
+  {
+    std::unique_lock<std::mutex> lock(times_mutex);
+    ASSERT_TRUE(times.empty());
+  }
+  Event reached;
+  ASSERT_TRUE(async_manager_.AdvanceVirtualTime(
+      150min, [&reached]() { reached.set(); }));
+  ASSERT_TRUE(reached.wait_for(1s));
+  {
+    std::unique_lock<std::mutex> lock(times_mutex);
+    ASSERT_EQ(times, std::vector<Clock::duration>({1h, 2h}));
+  }
+  ASSERT_EQ(Clock::now() - start, 150min);
+  reached.reset();
+  ASSERT_TRUE(
+      async_manager_.AdvanceVirtualTime(1h, [&reached]() { reached.set(); }));
+  ASSERT_TRUE(reached.wait_for(1s));
+  std::unique_lock<std::mutex> lock(times_mutex);
+  ASSERT_EQ(times, std::vector<Clock::duration>({1h, 2h, 3h}));
+}
+
+TEST_F(AsyncManagerTest, TestVirtualTimePeriodicTask) {
+  using namespace std::chrono_literals;
+  async_manager_.EnableVirtualTime();
+  AsyncUserId user1 = async_manager_.GetNextUserId();
+  std::atomic_int ticks{0};
+  async_manager_.ExecAsyncPeriodically(user1, 0ms, 5ms,
+                                       [&ticks]() { ticks++; });
+  // Ten minutes of 5 ms timer ticks run without waiting for them
+  Event reached;
+  ASSERT_TRUE(async_manager_.AdvanceVirtualTime(
+      10min, [&reached]() { reached.set(); }));
+  ASSERT_TRUE(reached.wait_for(5s));
+  ASSERT_EQ(ticks, 10 * 60 * 200 + 1);
+}
+
+TEST_F(AsyncManagerTest, TestAdvanceTimeNeedsVirtualTime) {
+  ASSERT_FALSE(
+      async_manager_.AdvanceVirtualTime(std::chrono::milliseconds(1), []() {}));
+}
+
 }  // namespace rootcanal
@@ -0,0 +1,198 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "hci/hci_packets.h"
+#include "model/devices/device.h"
+#include "model/setup/async_manager.h"
+#include "model/setup/test_model.h"
+#include "packet/raw_builder.h"
+
+using ::benchmark::Counter;
+using ::benchmark::State;
+
+namespace rootcanal {
+namespace {
+
+// Every iteration is one timer tick of the test model, with |range(0)| shards
+// (0 runs the devices on the thread of the model). On every tick, each of 64
+// devices sends a burst of ACL packets to its peer on a BR/EDR phy, and
+// handles the packets of its peer the way LinkLayerController forwards them
+// to its host. The peers are neighbours by index, so on different shards.
+
+constexpr size_t kNumDevices = 64;
+constexpr size_t kBurst = 16;
+// A 2-DH5 packet
+constexpr size_t kAclPayloadSize = 679;
+
+class AclPeer : public Device {
+ public:
+  AclPeer(Address peer) : peer_(peer), payload_(kAclPayloadSize) {}
+
+  std::string GetTypeString() const override { return "acl_peer"; }
+
+  // Only delivered the packets of its peer, so that the benchmark measures
+  // the delivery and handling of the packets rather than their filtering
+  bool ReceivesOnlyAddressedPackets() const override { return true; }
+
+  void TimerTick() override {
+    for (size_t i = 0; i < kBurst; i++) {
+      auto raw_builder = std::make_unique<bluetooth::packet::RawBuilder>();
+      raw_builder->AddOctets2(kHandle);
+      raw_builder->AddOctets2(static_cast<uint16_t>(payload_.size()));
+      raw_builder->AddOctets(payload_);
+      SendLinkLayerPacket(model::packets::AclBuilder::Create(
+                              GetAddress(), peer_, std::move(raw_builder)),
+                          Phy::Type::BR_EDR);
+    }
+  }
+
+  void IncomingPacket(model::packets::LinkLayerPacketView packet) override {
+    auto acl = model::packets::AclView::Create(packet);
+    if (!acl.IsValid()) {
+      return;
+    }
+    auto payload = acl.GetPayload();
+    auto payload_bytes =
+        std::make_shared<std::vector<uint8_t>>(payload.begin(), payload.end());
+    auto acl_view = bluetooth::hci::AclView::Create(
+        bluetooth::hci::PacketView<bluetooth::hci::kLittleEndian>(
+            payload_bytes));
+    if (!acl_view.IsValid()) {
+      return;
+    }
+    auto to_host = bluetooth::hci::AclBuilder::Create(
+        acl_view.GetHandle(), acl_view.GetPacketBoundaryFlag(),
+        acl_view.GetBroadcastFlag(),
+        std::make_unique<bluetooth::packet::RawBuilder>(std::vector<uint8_t>(
+            acl_view.GetPayload().begin(), acl_view.GetPayload().end())));
+    std::vector<uint8_t> bytes;
+    bytes.reserve(to_host->size());
+    bluetooth::packet::BitInserter inserter(bytes);
+    to_host->Serialize(inserter);
+    received_++;
+  }
+
+  // Read by the model thread once the shards are idle
+  int64_t received_{0};
+
+ private:
+  static constexpr uint16_t kHandle = 0x001;
+  Address peer_;
+  std::vector<uint8_t> payload_;
+};
+
+Address GetDeviceAddress(size_t index) {
+  char address[18];
+  snprintf(address, sizeof(address), "ac:1c:00:00:%02zx:%02zx",
+           (index >> 8) & 0xff, index & 0xff);
+  Address result;
+  Address::FromString(address, result);
+  return result;
+}
+
+class Simulation {
+ public:
+  Simulation(size_t num_shards)
+      : model_(
+            [this]() { return async_manager_.GetNextUserId(); },
+            [this](AsyncUserId user_id, std::chrono::milliseconds delay,
+                   const TaskCallback& task) {
+              return async_manager_.ExecAsync(user_id, delay, task);
+            },
+            [this](AsyncUserId user_id, std::chrono::milliseconds delay,
+                   std::chrono::milliseconds period, const TaskCallback& task) {
+              return async_manager_.ExecAsyncPeriodically(user_id, delay,
+                                                          period, task);
+            },
+            [this](AsyncUserId user_id) {
+              async_manager_.CancelAsyncTasksFromUser(user_id);
+            },
+            [this](AsyncTaskId task_id) {
+              async_manager_.CancelAsyncTask(task_id);
+            },
+            [](const std::string&, int, Phy::Type) { return nullptr; }) {
+    if (num_shards > 0) {
+      model_.EnableShards(num_shards);
+    }
+    size_t phy_index = model_.AddPhy(Phy::Type::BR_EDR);
+    for (size_t i = 0; i < kNumDevices; i++) {
+      auto device = std::make_shared<AclPeer>(GetDeviceAddress(i ^ 1));
+      device->SetAddress(GetDeviceAddress(i));
+      size_t device_index = model_.Add(device);
+      model_.AddDeviceToPhy(device_index, phy_index);
+      devices_.push_back(device);
+    }
+  }
+
+  // Devices and their phy layers point to each other
+  ~Simulation() {
+    for (auto& device : devices_) {
+      device->UnregisterPhyLayers();
+    }
+  }
+
+  // Returns once the packets sent on the tick are handled
+  void Tick() { model_.TimerTick(); }
+
+  int64_t received() const {
+    int64_t received = 0;
+    for (auto& device : devices_) {
+      received += device->received_;
+    }
+    return received;
+  }
+
+ private:
+  AsyncManager async_manager_;
+  TestModel model_;
+  std::vector<std::shared_ptr<AclPeer>> devices_;
+};
+
+void BM_LinkLayerAclThroughput(State& state) {
+  Simulation simulation(state.range(0));
+  for (auto _ : state) {
+    simulation.Tick();
+  }
+  int64_t received = simulation.received();
+  if (received != static_cast<int64_t>(state.iterations() * kNumDevices *
+                                       kBurst)) {
+    state.SkipWithError("Lost link layer packets");
+    return;
+  }
+  state.SetItemsProcessed(received);
+  state.counters["link_layer_packets"] =
+      Counter(static_cast<double>(received), Counter::kIsRate);
+}
+BENCHMARK(BM_LinkLayerAclThroughput)
+    ->Arg(0)
+    ->Arg(1)
+    ->Arg(2)
+    ->Arg(4)
+    ->Arg(8)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "model/devices/beacon_swarm.h"
+#include "model/setup/clock.h"
+#include "model/setup/phy_layer_factory.h"
+
+using ::benchmark::State;
+
+namespace rootcanal {
+namespace {
+
+// Every iteration is one advertising round of |range(0)| beacon_swarm devices
+// on a LE phy, heard by one scanner which, as controllers do, receives every
+// packet. Time is virtual so that every TimerTick() is an advertising event.
+
+class Scanner : public Device {
+ public:
+  std::string GetTypeString() const override { return "scanner"; }
+
+  void IncomingPacket(model::packets::LinkLayerPacketView) override {
+    received_++;
+  }
+
+  int64_t received_{0};
+};
+
+class Swarm {
+ public:
+  Swarm(int num_beacons) : phy_(Phy::Type::LOW_ENERGY, 0) {
+    scanner_ = std::make_shared<Scanner>();
+    AddToPhy(scanner_);
+    for (int i = 0; i < num_beacons; i++) {
+      char address[18];
+      snprintf(address, sizeof(address), "be:ac:00:%02x:%02x:00",
+               (i >> 8) & 0xff, i & 0xff);
+      auto beacon = std::make_shared<BeaconSwarm>(
+          std::vector<std::string>{"beacon_swarm", address});
+      AddToPhy(beacon);
+      beacons_.push_back(beacon);
+    }
+    Clock::SetVirtualTime(now_);
+  }
+
+  // Devices and their phy layers point to each other
+  ~Swarm() {
+    scanner_->UnregisterPhyLayers();
+    for (auto& beacon : beacons_) {
+      beacon->UnregisterPhyLayers();
+    }
+    Clock::DisableVirtualTime();
+  }
+
+  // Beacons on a grid one meter apart, the scanner in a corner
+  void SetPositions(double range) {
+    size_t side = std::ceil(std::sqrt(beacons_.size()));
+    scanner_->SetPosition({0, 0});
+    for (size_t i = 0; i < beacons_.size(); i++) {
+      beacons_[i]->SetPosition(
+          {static_cast<double>(i % side), static_cast<double>(i / side)});
+    }
+    phy_.SetRange(range);
+  }
+
+  void AdvertisingRound() {
+    now_ += std::chrono::milliseconds(1280);
+    Clock::SetVirtualTime(now_);
+    for (auto& beacon : beacons_) {
+      beacon->TimerTick();
+    }
+  }
+
+  int64_t received() const { return scanner_->received_; }
+
+ private:
+  void AddToPhy(std::shared_ptr<Device> device) {
+    device->RegisterPhyLayer(phy_.GetPhyLayer(
+        [device](model::packets::LinkLayerPacketView packet) {
+          device->ReceiveLinkLayerPacket(std::move(packet));
+        },
+        next_device_id_++));
+  }
+
+  PhyLayerFactory phy_;
+  std::shared_ptr<Scanner> scanner_;
+  std::vector<std::shared_ptr<Device>> beacons_;
+  uint32_t next_device_id_{0};
+  Clock::time_point now_{std::chrono::hours(24)};
+};
+
+void SetCounters(State& state, const Swarm& swarm) {
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["received_per_round"] =
+      static_cast<double>(swarm.received()) / state.iterations();
+}
+
+void BM_BeaconSwarmRound(State& state) {
+  Swarm swarm(state.range(0));
+  for (auto _ : state) {
+    swarm.AdvertisingRound();
+  }
+  SetCounters(state, swarm);
+}
+BENCHMARK(BM_BeaconSwarmRound)->RangeMultiplier(10)->Range(10, 10000);
+
+// The scanner only hears the beacons within 10 meters, with their RSSI
+void BM_BeaconSwarmRoundInRange(State& state) {
+  Swarm swarm(state.range(0));
+  swarm.SetPositions(10);
+  for (auto _ : state) {
+    swarm.AdvertisingRound();
+  }
+  SetCounters(state, swarm);
+}
+BENCHMARK(BM_BeaconSwarmRoundInRange)->RangeMultiplier(10)->Range(10, 10000);
+
+}  // namespace
+}  // namespace rootcanal
+
+BENCHMARK_MAIN();
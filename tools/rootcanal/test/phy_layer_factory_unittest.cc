@@ -0,0 +1,172 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/phy_layer_factory.h"
+
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+#include "model/devices/beacon.h"
+
+namespace rootcanal {
+
+using model::packets::LinkLayerPacketView;
+using model::packets::PacketType;
+
+namespace {
+
+const Address kAddress1{{0x01, 0x00, 0x00, 0x00, 0x00, 0x01}};
+const Address kAddress2{{0x02, 0x00, 0x00, 0x00, 0x00, 0x02}};
+const Address kAddress3{{0x03, 0x00, 0x00, 0x00, 0x00, 0x03}};
+
+std::unique_ptr<model::packets::LeScanBuilder> Scan(Address destination) {
+  return model::packets::LeScanBuilder::Create(kAddress1, destination);
+}
+
+}  // namespace
+
+class PhyLayerFactoryTest : public ::testing::Test {
+ protected:
+  // Adds a phy layer recording the packets it receives
+  std::shared_ptr<PhyLayer> AddPhyLayer(
+      std::vector<LinkLayerPacketView>* received) {
+    return phy_.GetPhyLayer(
+        [received](LinkLayerPacketView packet) { received->push_back(packet); },
+        next_device_id_++);
+  }
+
+  PhyLayerFactory phy_{Phy::Type::LOW_ENERGY, 0};
+  uint32_t next_device_id_{0};
+};
+
+TEST_F(PhyLayerFactoryTest, BroadcastSkipsAddressedOnlyPhyLayers) {
+  std::vector<LinkLayerPacketView> received_all;
+  std::vector<LinkLayerPacketView> received_addressed;
+  auto sender = AddPhyLayer(&received_all);
+  auto receive_all = AddPhyLayer(&received_all);
+  auto receive_addressed = AddPhyLayer(&received_addressed);
+  receive_addressed->ReceiveOnlyAddressedTo(kAddress2);
+
+  sender->Send(Scan(Address::kEmpty));
+  ASSERT_EQ(received_all.size(), 1u);
+  ASSERT_TRUE(received_addressed.empty());
+
+  sender->Send(Scan(kAddress2));
+  ASSERT_EQ(received_all.size(), 2u);
+  ASSERT_EQ(received_addressed.size(), 1u);
+  ASSERT_EQ(received_addressed[0].GetDestinationAddress(), kAddress2);
+
+  sender->Send(Scan(kAddress3));
+  ASSERT_EQ(received_all.size(), 3u);
+  ASSERT_EQ(received_addressed.size(), 1u);
+}
+
+TEST_F(PhyLayerFactoryTest, AddressedOnlyPhyLayerFollowsAddressChanges) {
+  std::vector<LinkLayerPacketView> received_all;
+  std::vector<LinkLayerPacketView> received_addressed;
+  auto sender = AddPhyLayer(&received_all);
+  auto receive_addressed = AddPhyLayer(&received_addressed);
+  receive_addressed->ReceiveOnlyAddressedTo(kAddress2);
+  receive_addressed->ReceiveOnlyAddressedTo(kAddress3);
+
+  sender->Send(Scan(kAddress2));
+  ASSERT_TRUE(received_addressed.empty());
+  sender->Send(Scan(kAddress3));
+  ASSERT_EQ(received_addressed.size(), 1u);
+
+  receive_addressed->Unregister();
+  sender->Send(Scan(kAddress3));
+  ASSERT_EQ(received_addressed.size(), 1u);
+}
+
+TEST_F(PhyLayerFactoryTest, SenderDoesNotReceiveItsPackets) {
+  std::vector<LinkLayerPacketView> received;
+  auto sender = AddPhyLayer(&received);
+  sender->ReceiveOnlyAddressedTo(kAddress1);
+  sender->Send(Scan(kAddress1));
+  ASSERT_TRUE(received.empty());
+}
+
+TEST_F(PhyLayerFactoryTest, RangeCullsAndRssiFollowsDistance) {
+  std::vector<LinkLayerPacketView> received_near;
+  std::vector<LinkLayerPacketView> received_far;
+  std::vector<LinkLayerPacketView> received_anywhere;
+  auto sender = AddPhyLayer(&received_anywhere);
+  auto near_phy = AddPhyLayer(&received_near);
+  auto far_phy = AddPhyLayer(&received_far);
+  auto anywhere = AddPhyLayer(&received_anywhere);
+  sender->SetPosition({0, 0});
+  near_phy->SetPosition({3, 4});
+  far_phy->SetPosition({30, 40});
+  phy_.SetRange(10);
+
+  sender->Send(Scan(Address::kEmpty));
+  ASSERT_TRUE(received_far.empty());
+  // Devices without a position hear everything, as before
+  ASSERT_EQ(received_anywhere.size(), 1u);
+  ASSERT_EQ(received_anywhere[0].GetType(), PacketType::LE_SCAN);
+
+  ASSERT_EQ(received_near.size(), 1u);
+  ASSERT_EQ(received_near[0].GetType(), PacketType::RSSI_WRAPPER);
+  auto rssi_wrapper = model::packets::RssiWrapperView::Create(received_near[0]);
+  ASSERT_TRUE(rssi_wrapper.IsValid());
+  // 0 dBm less 40 dB at 1 meter and 20 dB per decade, 5 meters away
+  ASSERT_EQ(static_cast<int8_t>(rssi_wrapper.GetRssi()), -53);
+  auto wrapped = LinkLayerPacketView::Create(rssi_wrapper.GetPayload());
+  ASSERT_TRUE(wrapped.IsValid());
+  ASSERT_EQ(wrapped.GetType(), PacketType::LE_SCAN);
+  ASSERT_EQ(wrapped.GetSourceAddress(), kAddress1);
+
+  phy_.SetRange({});
+  sender->Send(Scan(Address::kEmpty));
+  ASSERT_EQ(received_far.size(), 1u);
+}
+
+TEST_F(PhyLayerFactoryTest, PositionedBeaconAnswersPositionedScanner) {
+  std::vector<LinkLayerPacketView> received;
+  auto scanner = AddPhyLayer(&received);
+  scanner->SetPosition({0, 0});
+  auto beacon = std::make_shared<Beacon>();
+  beacon->SetAddress(kAddress2);
+  beacon->SetPosition({3, 4});
+  beacon->RegisterPhyLayer(phy_.GetPhyLayer(
+      [beacon](LinkLayerPacketView packet) {
+        beacon->ReceiveLinkLayerPacket(packet);
+      },
+      next_device_id_++));
+
+  // The beacon gets the scan without the RSSI wrapper of the phy
+  scanner->Send(Scan(kAddress2));
+  ASSERT_EQ(received.size(), 1u);
+  ASSERT_EQ(received[0].GetType(), PacketType::RSSI_WRAPPER);
+  auto rssi_wrapper = model::packets::RssiWrapperView::Create(received[0]);
+  ASSERT_TRUE(rssi_wrapper.IsValid());
+  auto wrapped = LinkLayerPacketView::Create(rssi_wrapper.GetPayload());
+  ASSERT_TRUE(wrapped.IsValid());
+  ASSERT_EQ(wrapped.GetSourceAddress(), kAddress2);
+  ASSERT_EQ(wrapped.GetDestinationAddress(), kAddress1);
+  auto scan_response = model::packets::LeAdvertisementView::Create(wrapped);
+  ASSERT_TRUE(scan_response.IsValid());
+  ASSERT_EQ(scan_response.GetAdvertisementType(),
+            model::packets::AdvertisementType::SCAN_RESPONSE);
+
+  // The beacon and its phy layer point to each other
+  beacon->UnregisterPhyLayers();
+}
+
+}  // namespace rootcanal
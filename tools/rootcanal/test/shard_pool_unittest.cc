@@ -0,0 +1,76 @@
+/*
+ * Copyright 2022 The Android Open Source Project
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *      http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "model/setup/shard_pool.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+
+namespace rootcanal {
+
+TEST(ShardPoolTest, TasksOfAShardRunInOrderOnOneThread) {
+  ShardPool shards(4);
+  std::vector<int> order;
+  std::vector<std::thread::id> threads;
+  for (int i = 0; i < 1000; i++) {
+    shards.Post(1, [&order, &threads, i]() {
+      order.push_back(i);
+      threads.push_back(std::this_thread::get_id());
+    });
+  }
+  shards.WaitForIdle();
+  ASSERT_EQ(order.size(), 1000u);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_EQ(order[i], i);
+    ASSERT_EQ(threads[i], threads[0]);
+  }
+  ASSERT_NE(threads[0], std::this_thread::get_id());
+}
+
+TEST(ShardPoolTest, ShardsRunInParallel) {
+  ShardPool shards(2);
+  std::promise<void> started;
+  std::atomic_bool saw_other_shard{false};
+  // Only ends in time if the task of shard 1 runs while shard 0 waits for it
+  shards.Post(0, [&started, &saw_other_shard]() {
+    auto status = started.get_future().wait_for(std::chrono::seconds(1));
+    saw_other_shard = status == std::future_status::ready;
+  });
+  shards.Post(1, [&started]() { started.set_value(); });
+  shards.WaitForIdle();
+  ASSERT_TRUE(saw_other_shard);
+}
+
+TEST(ShardPoolTest, WaitForIdleWaitsForTasksPostedByTasks) {
+  ShardPool shards(3);
+  std::atomic_int hops{0};
+  std::function<void(size_t)> hop = [&shards, &hops, &hop](size_t shard) {
+    if (++hops < 100) {
+      shards.Post(shard + 1, [&hop, shard]() { hop(shard + 1); });
+    }
+  };
+  shards.Post(0, [&hop]() { hop(0); });
+  shards.WaitForIdle();
+  ASSERT_EQ(hops, 100);
+}
+
+}  // namespace rootcanal